@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <SDL.h>
 #include <SDL_mixer.h>
@@ -38,6 +39,13 @@ typedef struct audio_system {
     resource_id music_id;
     xmp_context xmp_context;
     Mix_Chunk *channel_chunks[CHANNEL_MAX];
+
+    // Offline mode; no audio device, mixing is done on request by audio_render().
+    bool offline;
+    bool music_playing;
+    float sound_volume;
+    unsigned int channel_pos[CHANNEL_MAX];
+    float channel_pan[CHANNEL_MAX][2];
 } audio_system;
 
 static audio_system *audio = NULL;
@@ -114,10 +122,20 @@ static Mix_Chunk *audio_get_chunk(int id, float volume, float pitch) {
     return chunk;
 }
 
+static void audio_free_chunk(Mix_Chunk *chunk) {
+    if(audio->offline) {
+        // Mix_FreeChunk expects an opened audio device, so free the buffers ourselves.
+        SDL_free(chunk->abuf);
+        SDL_free(chunk);
+    } else {
+        Mix_FreeChunk(chunk);
+    }
+}
+
 static void audio_sound_finished(int channel) {
     assert(audio);
     if(audio->channel_chunks[channel] != NULL) {
-        Mix_FreeChunk(audio->channel_chunks[channel]);
+        audio_free_chunk(audio->channel_chunks[channel]);
         audio->channel_chunks[channel] = NULL;
     }
 }
@@ -237,15 +255,36 @@ error_0:
     return false;
 }
 
+bool audio_init_offline(int freq, int resampler, float music_volume, float sound_volume) {
+    audio = omf_calloc(1, sizeof(audio_system));
+    if((audio->xmp_context = xmp_create_context()) == NULL) {
+        PERROR("Unable to initialize XMP context.");
+        omf_free(audio);
+        return false;
+    }
+    audio->offline = true;
+    audio->freq = freq;
+    audio->format = AUDIO_S16SYS;
+    audio->channels = 2;
+    audio->resampler = resampler;
+    audio->music_id = NUMBER_OF_RESOURCES;
+    audio_set_sound_volume(sound_volume);
+    audio_set_music_volume(music_volume);
+    INFO("Offline audio: %dHz, 2 channels", freq);
+    return true;
+}
+
 void audio_close() {
     if(audio != NULL) {
         audio_stop_music();
         audio_close_module();
-        Mix_ChannelFinished(NULL);
-        Mix_CloseAudio();
+        if(!audio->offline) {
+            Mix_ChannelFinished(NULL);
+            Mix_CloseAudio();
+        }
         for(int i = 0; i < CHANNEL_MAX; i++) {
             if(audio->channel_chunks[i] != NULL) {
-                Mix_FreeChunk(audio->channel_chunks[i]);
+                audio_free_chunk(audio->channel_chunks[i]);
                 audio->channel_chunks[i] = NULL;
             }
         }
@@ -253,8 +292,12 @@ void audio_close() {
             xmp_free_context(audio->xmp_context);
             audio->xmp_context = NULL;
         }
+        bool offline = audio->offline;
         omf_free(audio);
         audio = NULL;
+        if(offline) {
+            return;
+        }
     }
     Mix_Quit();
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -276,7 +319,17 @@ void audio_play_sound(int id, float volume, float panning, float pitch) {
     pan_left = (panning > 0) ? 1.0f - panning : 1.0f;
     pan_right = (panning < 0) ? 1.0f + panning : 1.0f;
 
-    if((channel = Mix_GroupAvailable(-1)) == -1) {
+    if(audio->offline) {
+        for(channel = 0; channel < CHANNEL_MAX; channel++) {
+            if(audio->channel_chunks[channel] == NULL)
+                break;
+        }
+        if(channel == CHANNEL_MAX)
+            channel = -1;
+    } else {
+        channel = Mix_GroupAvailable(-1);
+    }
+    if(channel == -1) {
         PERROR("Unable to play sound: No free channels");
         goto error_0;
     }
@@ -284,6 +337,13 @@ void audio_play_sound(int id, float volume, float panning, float pitch) {
         PERROR("Unable to play sound: Failed to load chunk");
         goto error_0;
     }
+    if(audio->offline) {
+        audio->channel_chunks[channel] = chunk;
+        audio->channel_pos[channel] = 0;
+        audio->channel_pan[channel][0] = pan_left;
+        audio->channel_pan[channel][1] = pan_right;
+        return;
+    }
     Mix_SetPanning(channel, clamp(pan_left * 255, 0, 255), clamp(pan_right * 255, 0, 255));
     if(Mix_PlayChannel(channel, chunk, 0) == -1) {
         PERROR("Unable to play sound: %s", Mix_GetError());
@@ -310,14 +370,20 @@ void audio_play_music(resource_id id) {
             return;
         }
         audio->music_id = id;
-        Mix_HookMusic(audio_xmp_render, NULL);
+        audio->music_playing = true;
+        if(!audio->offline) {
+            Mix_HookMusic(audio_xmp_render, NULL);
+        }
     }
 }
 
 void audio_stop_music() {
     assert(audio);
-    Mix_HaltMusic();
-    Mix_HookMusic(NULL, NULL);
+    audio->music_playing = false;
+    if(!audio->offline) {
+        Mix_HaltMusic();
+        Mix_HookMusic(NULL, NULL);
+    }
 }
 
 void audio_set_music_volume(float volume) {
@@ -329,7 +395,41 @@ void audio_set_music_volume(float volume) {
 void audio_set_sound_volume(float volume) {
     assert(audio);
     volume = clampf(volume, VOLUME_MIN, VOLUME_MAX);
-    Mix_Volume(-1, volume * MIX_MAX_VOLUME);
+    audio->sound_volume = volume;
+    if(!audio->offline) {
+        Mix_Volume(-1, volume * MIX_MAX_VOLUME);
+    }
+}
+
+void audio_render(int16_t *buf, int frames) {
+    assert(audio);
+    assert(audio->offline);
+    int len = frames * 2;
+    if(audio->music_playing) {
+        xmp_play_buffer(audio->xmp_context, buf, len * sizeof(int16_t), 0);
+    } else {
+        memset(buf, 0, len * sizeof(int16_t));
+    }
+
+    // Same gain as SDL_mixer would use: chunk volume, times channel volume.
+    for(int c = 0; c < CHANNEL_MAX; c++) {
+        Mix_Chunk *chunk = audio->channel_chunks[c];
+        if(chunk == NULL) {
+            continue;
+        }
+        const int16_t *src = (const int16_t *)chunk->abuf;
+        unsigned int src_len = chunk->alen / sizeof(int16_t);
+        float gain = chunk->volume / (float)MIX_MAX_VOLUME * audio->sound_volume;
+        unsigned int pos = audio->channel_pos[c];
+        for(int i = 0; i < len && pos < src_len; i++, pos++) {
+            int v = buf[i] + src[pos] * gain * audio->channel_pan[c][i & 1];
+            buf[i] = clamp(v, INT16_MIN, INT16_MAX);
+        }
+        audio->channel_pos[c] = pos;
+        if(pos >= src_len) {
+            audio_sound_finished(c);
+        }
+    }
 }
 
 const audio_freq *audio_get_freqs() {
@@ -2,6 +2,7 @@
 #define AUDIO_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "resources/ids.h"
 
@@ -41,6 +42,26 @@ typedef struct audio_freq {
  */
 bool audio_init(int freq, bool mono, int resampler, float music_volume, float sound_volume);
 
+/**
+ * Initializes the audio subsystem without an audio device. Output is
+ * mixed to 16-bit stereo on request, using audio_render().
+ *
+ * @param freq Output frequency
+ * @param resampler Music module resampler interpolation
+ * @param music_volume Initial music volume
+ * @param sound_volume Initial audio volume
+ * @return True if initialized, false if not.
+ */
+bool audio_init_offline(int freq, int resampler, float music_volume, float sound_volume);
+
+/**
+ * Mixes the next block of offline audio output.
+ *
+ * @param buf Buffer for interleaved 16-bit stereo samples
+ * @param frames Amount of sample frames to mix
+ */
+void audio_render(int16_t *buf, int frames);
+
 /**
  * Closes the audio subsystem.
  */
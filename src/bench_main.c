@@ -0,0 +1,604 @@
+/*
+ * Microbenchmarks for the utilities and file formats that the game leans on. Every benchmark is first run a few
+ * times to warm up the caches, and then timed over a fixed amount of iterations with the same inputs. Results are
+ * reported as the median, 99th percentile and best time per operation, and can be written as JSON for tracking
+ * them across commits.
+ *
+ * For example, to compare a change against the commit before it:
+ *   openomf_bench --json before.json
+ *   openomf_bench --json after.json
+ */
+
+#include "formats/af.h"
+#include "formats/bk.h"
+#include "formats/error.h"
+#include "formats/script.h"
+#include "formats/sprite.h"
+#include "game/utils/serial.h"
+#include "utils/allocator.h"
+#include "utils/flatmap.h"
+#include "utils/hashmap.h"
+#include "utils/log.h"
+#include "utils/str.h"
+#include "utils/vector.h"
+#include "video/surface.h"
+#include <SDL.h>
+#include <argtable2.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef SHA1_HASH
+static const char *git_sha1_hash = "";
+#else
+static const char *git_sha1_hash = SHA1_HASH;
+#endif
+
+#ifndef BENCH_RESOURCES_DIR
+#define BENCH_RESOURCES_DIR "resources"
+#endif
+
+// Fighter file that is written from the scene file, when none is given
+#define BENCH_AF_FILE "openomf_bench.af"
+
+// Amount of keys, values and items the container benchmarks work on
+#define BENCH_ITEMS 4096
+
+// Sprites are cut from the background image in tiles of this size
+#define BENCH_TILE_W 64
+#define BENCH_TILE_H 50
+#define BENCH_SPRITES ((320 / BENCH_TILE_W) * (200 / BENCH_TILE_H))
+
+#define BENCH_MAX_ITERATIONS 100000
+
+// Animation strings in the style of the ones in the game files
+static const char *bench_scripts[] = {
+    "A10-B10-C10-D10-E10-F10-G10-H10-I10-J10-K10-L10-M10-N10-O10-P10",
+    "bpd1bps1bpn64A1-s11l50B2-C2-D2-E2-F2-G2-H2-I2-J2-K2-L2-M2-N2-O2-P2-Q2-R2-S2-T2",
+    "s4l40A2-B2-C3-D3-bf3E4-F4-G4-H4-I6-J6-K4-L4-M2-N2",
+    "m33mx160my100A1-bpd2bps1B1-C1-D1-E1-F1-G1-H1-I1-J1-K1-L1-M1-N1-O1-P1",
+    "bm10mp5d4s12l60A3-hB3-C3-D6-E6-F6-eG4-H4-I4",
+    "s20l100bpn32bpd4A5-B5-C5-D5-mp1sf20A5-B5-C5-D5-E5-F5-G5-H5",
+};
+
+#define BENCH_SCRIPT_COUNT (int)(sizeof(bench_scripts) / sizeof(bench_scripts[0]))
+
+typedef struct {
+    const char *bk_file;
+    const char *af_file;
+    sd_bk_file bk;
+    sd_sprite sprites[BENCH_SPRITES];
+    sd_script scripts[BENCH_SCRIPT_COUNT];
+    screen_palette pal;
+    surface background;
+    char *rgba;
+    hashmap map;
+    flatmap fmap;
+    serial ser;
+} bench_data;
+
+// Flatmap key in the shape of the texture cache key
+typedef struct {
+    const void *ptr;
+    const void *remap;
+    unsigned short w, h;
+    unsigned char offset;
+} bench_key;
+
+// Runs one iteration of a benchmark. Returns the amount of operations done.
+typedef unsigned int (*bench_fn)(bench_data *data);
+
+typedef struct {
+    const char *name;
+    bench_fn run;
+} bench;
+
+typedef struct {
+    unsigned int ops; // Operations per iteration
+    double median;    // Nanoseconds per operation
+    double p99;
+    double best;
+    double mean;
+} bench_result;
+
+// Results are summed here, so that the compiler can't leave out the work
+static volatile uint32_t bench_sink;
+
+static unsigned int bench_hashmap_put(bench_data *data) {
+    hashmap map;
+    hashmap_create(&map, 8);
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        hashmap_iput(&map, i * 2654435761u, &i, sizeof(i));
+    }
+    hashmap_free(&map);
+    return BENCH_ITEMS;
+}
+
+static unsigned int bench_hashmap_get(bench_data *data) {
+    void *val;
+    unsigned int len;
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        if(hashmap_iget(&data->map, i * 2654435761u, &val, &len) == 0) {
+            bench_sink += *(unsigned int *)val;
+        }
+    }
+    return BENCH_ITEMS;
+}
+
+static unsigned int bench_hashmap_iterate(bench_data *data) {
+    iterator it;
+    hashmap_pair *pair;
+    hashmap_iter_begin(&data->map, &it);
+    while((pair = iter_next(&it)) != NULL) {
+        bench_sink += *(unsigned int *)pair->val;
+    }
+    return BENCH_ITEMS;
+}
+
+// Keys point to surfaces in the texture cache; here they point into this
+static char bench_key_targets[BENCH_ITEMS];
+
+static void bench_key_create(bench_key *key, unsigned int i) {
+    memset(key, 0, sizeof(bench_key));
+    key->ptr = &bench_key_targets[i];
+    key->w = 320;
+    key->h = 200;
+}
+
+static unsigned int bench_flatmap_put(bench_data *data) {
+    flatmap map;
+    bench_key key;
+    flatmap_create(&map, sizeof(bench_key), sizeof(unsigned int), 8);
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        bench_key_create(&key, i);
+        flatmap_put(&map, &key, &i);
+    }
+    flatmap_free(&map);
+    return BENCH_ITEMS;
+}
+
+static unsigned int bench_flatmap_get(bench_data *data) {
+    bench_key key;
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        bench_key_create(&key, i);
+        unsigned int *val = flatmap_get(&data->fmap, &key);
+        if(val != NULL) {
+            bench_sink += *val;
+        }
+    }
+    return BENCH_ITEMS;
+}
+
+static unsigned int bench_vector_append(bench_data *data) {
+    vector vec;
+    vector_create(&vec, sizeof(unsigned int));
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        vector_append(&vec, &i);
+    }
+    vector_free(&vec);
+    return BENCH_ITEMS;
+}
+
+// Deletes every other item while iterating, the way object lists are cleaned up
+static unsigned int bench_vector_delete(bench_data *data) {
+    vector vec;
+    iterator it;
+    unsigned int *item;
+    vector_create(&vec, sizeof(unsigned int));
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        vector_append(&vec, &i);
+    }
+    vector_iter_begin(&vec, &it);
+    while((item = iter_next(&it)) != NULL) {
+        if(*item % 2 == 0) {
+            vector_delete(&vec, &it);
+        }
+    }
+    bench_sink += vector_size(&vec);
+    vector_free(&vec);
+    return BENCH_ITEMS / 2;
+}
+
+static unsigned int bench_str(bench_data *data) {
+    str s;
+    for(int i = 0; i < BENCH_SCRIPT_COUNT * 16; i++) {
+        str_from_c(&s, "  Player ");
+        str_append_c(&s, bench_scripts[i % BENCH_SCRIPT_COUNT]);
+        str_replace(&s, "-", " ", -1);
+        str_strip(&s);
+        str_tolower(&s);
+        bench_sink += str_equal_c(&s, "player") + str_size(&s);
+        str_free(&s);
+    }
+    return BENCH_SCRIPT_COUNT * 16;
+}
+
+static unsigned int bench_script_decode(bench_data *data) {
+    sd_script script;
+    int invalid_pos;
+    for(int i = 0; i < BENCH_SCRIPT_COUNT; i++) {
+        sd_script_create(&script);
+        sd_script_decode(&script, bench_scripts[i], &invalid_pos);
+        bench_sink += script.frame_count;
+        sd_script_free(&script);
+    }
+    return BENCH_SCRIPT_COUNT;
+}
+
+// Looks up the frame on every tick of every script, as playing the animations does
+static unsigned int bench_script_get_frame_at(bench_data *data) {
+    unsigned int ops = 0;
+    for(int i = 0; i < BENCH_SCRIPT_COUNT; i++) {
+        int ticks = sd_script_get_total_ticks(&data->scripts[i]);
+        for(int tick = 0; tick < ticks; tick++) {
+            bench_sink += sd_script_get_frame_at(&data->scripts[i], tick)->sprite;
+        }
+        ops += ticks;
+    }
+    return ops;
+}
+
+static unsigned int bench_sprite_vga_decode(bench_data *data) {
+    sd_vga_image img;
+    for(int i = 0; i < BENCH_SPRITES; i++) {
+        sd_sprite_vga_decode(&img, &data->sprites[i]);
+        bench_sink += img.len;
+        sd_vga_image_free(&img);
+    }
+    return BENCH_SPRITES;
+}
+
+static unsigned int bench_surface_to_rgba(bench_data *data) {
+    surface_to_rgba(&data->background, data->rgba, &data->pal, NULL, 0);
+    bench_sink += data->rgba[0];
+    return 1;
+}
+
+static void write_state(serial *ser) {
+    for(int i = 0; i < BENCH_ITEMS / 4; i++) {
+        serial_write_int8(ser, i);
+        serial_write_int16(ser, i * 3);
+        serial_write_int32(ser, i * 65537);
+        serial_write_float(ser, i * 0.5f);
+    }
+}
+
+static unsigned int bench_serial_write(bench_data *data) {
+    serial ser;
+    serial_create(&ser);
+    write_state(&ser);
+    bench_sink += serial_len(&ser);
+    serial_free(&ser);
+    return BENCH_ITEMS;
+}
+
+static unsigned int bench_serial_read(bench_data *data) {
+    serial_read_reset(&data->ser);
+    for(int i = 0; i < BENCH_ITEMS / 4; i++) {
+        bench_sink += serial_read_int8(&data->ser);
+        bench_sink += serial_read_int16(&data->ser);
+        bench_sink += serial_read_int32(&data->ser);
+        bench_sink += (uint32_t)serial_read_float(&data->ser);
+    }
+    return BENCH_ITEMS;
+}
+
+static unsigned int bench_bk_load(bench_data *data) {
+    sd_bk_file bk;
+    sd_bk_create(&bk);
+    if(sd_bk_load(&bk, data->bk_file) == SD_SUCCESS) {
+        bench_sink += bk.palette_count;
+    }
+    sd_bk_free(&bk);
+    return 1;
+}
+
+static unsigned int bench_af_load(bench_data *data) {
+    sd_af_file af;
+    sd_af_create(&af);
+    if(sd_af_load(&af, data->af_file) == SD_SUCCESS) {
+        bench_sink += af.health;
+    }
+    sd_af_free(&af);
+    return 1;
+}
+
+static const bench benches[] = {
+    {"hashmap_put",         bench_hashmap_put        },
+    {"hashmap_get",         bench_hashmap_get        },
+    {"hashmap_iterate",     bench_hashmap_iterate    },
+    {"flatmap_put",         bench_flatmap_put        },
+    {"flatmap_get",         bench_flatmap_get        },
+    {"vector_append",       bench_vector_append      },
+    {"vector_delete",       bench_vector_delete      },
+    {"str_ops",             bench_str                },
+    {"script_decode",       bench_script_decode      },
+    {"script_get_frame_at", bench_script_get_frame_at},
+    {"sprite_vga_decode",   bench_sprite_vga_decode  },
+    {"surface_to_rgba",     bench_surface_to_rgba    },
+    {"serial_write",        bench_serial_write       },
+    {"serial_read",         bench_serial_read        },
+    {"bk_load",             bench_bk_load            },
+    {"af_load",             bench_af_load            },
+};
+
+#define BENCH_COUNT (int)(sizeof(benches) / sizeof(benches[0]))
+
+/*
+ * Writes a fighter file to run the AF loader on. The game data can't be bundled, so the moves are made up from
+ * the sprites cut from the background, in about the amount and size of a real HAR.
+ */
+static int write_af(bench_data *data, const char *filename) {
+    sd_af_file af;
+    sd_move move;
+    sd_animation ani;
+    sd_af_create(&af);
+    af.health = 200;
+    for(int m = 0; m < 70; m++) {
+        sd_move_create(&move);
+        sd_move_set_move_string(&move, "K1");
+        sd_move_set_footer_string(&move, "Punch");
+        sd_animation_create(&ani);
+        sd_animation_set_anim_string(&ani, bench_scripts[m % BENCH_SCRIPT_COUNT]);
+        for(int i = 0; i < 6; i++) {
+            sd_animation_push_sprite(&ani, &data->sprites[(m + i) % BENCH_SPRITES]);
+        }
+        sd_move_set_animation(&move, &ani);
+        sd_af_set_move(&af, m, &move);
+        sd_animation_free(&ani);
+        sd_move_free(&move);
+    }
+    int ret = sd_af_save(&af, filename);
+    sd_af_free(&af);
+    return ret;
+}
+
+// Loads and builds all the inputs, so that the benchmarks themselves only time the work
+static int bench_data_create(bench_data *data) {
+    int ret;
+    hashmap_create(&data->map, 8);
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        hashmap_iput(&data->map, i * 2654435761u, &i, sizeof(i));
+    }
+    flatmap_create(&data->fmap, sizeof(bench_key), sizeof(unsigned int), 8);
+    for(unsigned int i = 0; i < BENCH_ITEMS; i++) {
+        bench_key key;
+        bench_key_create(&key, i);
+        flatmap_put(&data->fmap, &key, &i);
+    }
+    serial_create(&data->ser);
+    write_state(&data->ser);
+    for(int i = 0; i < BENCH_SPRITES; i++) {
+        sd_sprite_create(&data->sprites[i]);
+    }
+    for(int i = 0; i < BENCH_SCRIPT_COUNT; i++) {
+        sd_script_create(&data->scripts[i]);
+    }
+
+    for(int i = 0; i < BENCH_SCRIPT_COUNT; i++) {
+        int invalid_pos;
+        if((ret = sd_script_decode(&data->scripts[i], bench_scripts[i], &invalid_pos)) != SD_SUCCESS) {
+            PERROR("Decoder error %s at position %d in string \"%s\"", sd_get_error(ret), invalid_pos,
+                   bench_scripts[i]);
+            return 1;
+        }
+    }
+
+    sd_bk_create(&data->bk);
+    if((ret = sd_bk_load(&data->bk, data->bk_file)) != SD_SUCCESS) {
+        PERROR("Unable to load %s: %s", data->bk_file, sd_get_error(ret));
+        return 1;
+    }
+    sd_vga_image *bg = data->bk.background;
+    if(bg == NULL || bg->w < 320 || bg->h < 200 || data->bk.palettes[0] == NULL) {
+        PERROR("%s has no full size background or no palette", data->bk_file);
+        return 1;
+    }
+    memcpy(data->pal.data, data->bk.palettes[0]->data, sizeof(data->pal.data));
+    surface_create_from_data(&data->background, SURFACE_TYPE_PALETTE, bg->w, bg->h, bg->data);
+    data->rgba = omf_calloc(bg->w * bg->h, 4);
+
+    // Palette index 0 is transparent in sprites, as it is in the game
+    for(int i = 0; i < BENCH_SPRITES; i++) {
+        sd_vga_image tile;
+        int x = (i % (320 / BENCH_TILE_W)) * BENCH_TILE_W;
+        int y = (i / (320 / BENCH_TILE_W)) * BENCH_TILE_H;
+        sd_vga_image_create(&tile, BENCH_TILE_W, BENCH_TILE_H);
+        for(int row = 0; row < BENCH_TILE_H; row++) {
+            memcpy(tile.data + row * BENCH_TILE_W, bg->data + (y + row) * bg->w + x, BENCH_TILE_W);
+        }
+        sd_vga_image_stencil_index(&tile, 0);
+        sd_sprite_vga_encode(&data->sprites[i], &tile);
+        sd_vga_image_free(&tile);
+    }
+
+    if(data->af_file == NULL) {
+        if(write_af(data, BENCH_AF_FILE) != SD_SUCCESS) {
+            PERROR("Unable to write %s", BENCH_AF_FILE);
+            return 1;
+        }
+        data->af_file = BENCH_AF_FILE;
+    }
+    return 0;
+}
+
+static void bench_data_free(bench_data *data) {
+    sd_bk_free(&data->bk);
+    for(int i = 0; i < BENCH_SPRITES; i++) {
+        sd_sprite_free(&data->sprites[i]);
+    }
+    for(int i = 0; i < BENCH_SCRIPT_COUNT; i++) {
+        sd_script_free(&data->scripts[i]);
+    }
+    surface_free(&data->background);
+    omf_free(data->rgba);
+    hashmap_free(&data->map);
+    flatmap_free(&data->fmap);
+    serial_free(&data->ser);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static void bench_run(const bench *b, bench_data *data, int warmup, int iterations, double *samples,
+                      bench_result *res) {
+    uint64_t freq = SDL_GetPerformanceFrequency();
+    for(int i = 0; i < warmup; i++) {
+        b->run(data);
+    }
+    double total = 0;
+    for(int i = 0; i < iterations; i++) {
+        uint64_t start = SDL_GetPerformanceCounter();
+        res->ops = b->run(data);
+        uint64_t dur = SDL_GetPerformanceCounter() - start;
+        samples[i] = dur * 1e9 / freq / (res->ops ? res->ops : 1);
+        total += samples[i];
+    }
+    qsort(samples, iterations, sizeof(double), cmp_double);
+    res->median = samples[(iterations - 1) / 2];
+    res->p99 = samples[(iterations - 1) * 99 / 100];
+    res->best = samples[0];
+    res->mean = total / iterations;
+}
+
+static int bench_selected(const bench *b, struct arg_str *filter) {
+    for(int i = 0; i < filter->count; i++) {
+        if(strstr(b->name, filter->sval[i]) != NULL) {
+            return 1;
+        }
+    }
+    return filter->count == 0;
+}
+
+static int write_json(const char *filename, const bench_result *results, struct arg_str *filter, int warmup,
+                      int iterations) {
+    FILE *f = fopen(filename, "w");
+    if(f == NULL) {
+        PERROR("Unable to write %s", filename);
+        return 1;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"version\": \"%d.%d.%d\",\n", V_MAJOR, V_MINOR, V_PATCH);
+    fprintf(f, "  \"commit\": \"%s\",\n", git_sha1_hash);
+    fprintf(f, "  \"warmup\": %d,\n", warmup);
+    fprintf(f, "  \"iterations\": %d,\n", iterations);
+    fprintf(f, "  \"unit\": \"ns/op\",\n");
+    fprintf(f, "  \"benchmarks\": [");
+    int first = 1;
+    for(int i = 0; i < BENCH_COUNT; i++) {
+        if(!bench_selected(&benches[i], filter)) {
+            continue;
+        }
+        const bench_result *r = &results[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"ops\": %u, \"median\": %.2f, \"p99\": %.2f, \"best\": %.2f, "
+                   "\"mean\": %.2f}",
+                first ? "" : ",", benches[i].name, r->ops, r->median, r->p99, r->best, r->mean);
+        first = 0;
+    }
+    fprintf(f, "\n  ]\n}\n");
+    int ret = ferror(f) ? 1 : 0;
+    fclose(f);
+    return ret;
+}
+
+int main(int argc, char *argv[]) {
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_lit *list = arg_lit0("l", "list", "list the benchmarks and exit");
+    struct arg_str *filter =
+        arg_strn("f", "filter", "<name>", 0, BENCH_COUNT, "Only run benchmarks with this in their name");
+    struct arg_int *iterations = arg_int0("i", "iterations", "<n>", "Timed iterations (default: 200)");
+    struct arg_int *warmup = arg_int0("w", "warmup", "<n>", "Iterations before timing (default: 20)");
+    struct arg_file *json = arg_file0("j", "json", "<file>", "Write the results as JSON");
+    struct arg_file *bk = arg_file0(NULL, "bk", "<file>", "Scene file to load (default: resources/openomf.bk)");
+    struct arg_file *af = arg_file0(NULL, "af", "<file>", "Fighter file to load (default: one made up from the bk)");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, list, filter, iterations, warmup, json, bk, af, end};
+    const char *progname = "openomf_bench";
+    int ret = 1;
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        fprintf(stderr, "Error: insufficient memory\n");
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        printf("Usage: %s", progname);
+        arg_print_syntax(stdout, argtable, "\n");
+        printf("\nArguments:\n");
+        arg_print_glossary(stdout, argtable, "%-25s %s\n");
+        ret = 0;
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stderr, end, progname);
+        fprintf(stderr, "Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    if(list->count > 0) {
+        for(int i = 0; i < BENCH_COUNT; i++) {
+            printf("%s\n", benches[i].name);
+        }
+        ret = 0;
+        goto exit_0;
+    }
+
+    int iters = iterations->count > 0 ? iterations->ival[0] : 200;
+    int warmups = warmup->count > 0 && warmup->ival[0] >= 0 ? warmup->ival[0] : 20;
+    if(iters < 1 || iters > BENCH_MAX_ITERATIONS) {
+        fprintf(stderr, "Error: iterations must be between 1 and %d\n", BENCH_MAX_ITERATIONS);
+        goto exit_0;
+    }
+
+    if(log_init(0)) {
+        fprintf(stderr, "Error while initializing log!\n");
+        goto exit_0;
+    }
+
+    bench_data data;
+    memset(&data, 0, sizeof(data));
+    data.bk_file = bk->count > 0 ? bk->filename[0] : BENCH_RESOURCES_DIR "/openomf.bk";
+    data.af_file = af->count > 0 ? af->filename[0] : NULL;
+    if(bench_data_create(&data)) {
+        goto exit_1;
+    }
+
+    bench_result results[BENCH_COUNT];
+    double *samples = omf_calloc(iters, sizeof(double));
+    memset(results, 0, sizeof(results));
+    printf("%-22s %8s %12s %12s %12s\n", "benchmark", "ops", "median ns", "p99 ns", "best ns");
+    for(int i = 0; i < BENCH_COUNT; i++) {
+        if(!bench_selected(&benches[i], filter)) {
+            continue;
+        }
+        bench_run(&benches[i], &data, warmups, iters, samples, &results[i]);
+        printf("%-22s %8u %12.1f %12.1f %12.1f\n", benches[i].name, results[i].ops, results[i].median,
+               results[i].p99, results[i].best);
+    }
+    omf_free(samples);
+
+    ret = 0;
+    if(json->count > 0) {
+        ret = write_json(json->filename[0], results, filter, warmups, iters);
+    }
+
+exit_1:
+    if(af->count == 0) {
+        remove(BENCH_AF_FILE);
+    }
+    bench_data_free(&data);
+    log_close();
+exit_0:
+    arg_freetable(argtable, sizeof(argtable) / sizeof(argtable[0]));
+    return ret;
+}
@@ -4,7 +4,12 @@
 #include "game/scenes/arena.h"
 #include "game/scenes/mechlab.h"
 #include "resources/ids.h"
+#include "game/utils/settings.h"
 #include "utils/allocator.h"
+#include "utils/framepacer.h"
+#include "utils/log.h"
+#include "utils/profiler.h"
+#include "video/capture.h"
 #include <stdio.h>
 
 // utils
@@ -116,7 +121,7 @@ int console_cmd_har(game_state *gs, int argc, char **argv) {
                 int hd = object_get_direction(har_obj);
 
                 object *obj = omf_calloc(1, sizeof(object));
-                object_create(obj, gs, pos, vec2f_create(0, 0));
+                object_create(obj, gs, pos, vec2fx_create(0, 0));
 
                 if(har_create(obj, game_state_get_scene(gs)->af_data[0], hd, player->pilot->har_id,
                               player->pilot->pilot_id, 0)) {
@@ -269,6 +274,112 @@ int console_cmd_rank(game_state *gs, int argc, char **argv) {
     return 1;
 }
 
+static void console_report_line(const char *line, void *userdata) {
+    console_output_addline(line);
+}
+
+int console_cmd_prof(game_state *gs, int argc, char **argv) {
+    if(argc == 1) {
+        if(!profiler_is_enabled()) {
+            console_output_addline("Profiler is off; enable with \"prof on\"");
+            return 0;
+        }
+        profiler_report(console_report_line, NULL);
+        return 0;
+    }
+    if(strcmp(argv[1], "on") == 0) {
+        profiler_set_enabled(1);
+        return 0;
+    }
+    if(strcmp(argv[1], "off") == 0 && !profiler_trace_is_running()) {
+        profiler_set_enabled(0);
+        return 0;
+    }
+    if(strcmp(argv[1], "reset") == 0) {
+        profiler_reset();
+        return 0;
+    }
+    if(strcmp(argv[1], "trace") == 0) {
+        if(!profiler_trace_is_running()) {
+            if(profiler_trace_start() == 0) {
+                console_output_addline("Trace started; stop with \"prof trace <file>\"");
+                return 0;
+            }
+            return 1;
+        }
+        const char *filename = (argc > 2) ? argv[2] : "openomf_trace.json";
+        return profiler_trace_stop(filename);
+    }
+    return 1;
+}
+
+int console_cmd_capture(game_state *gs, int argc, char **argv) {
+    if(capture_stream_is_running()) {
+        capture_stream_stop();
+        console_output_addline("Capture stream stopped");
+        return 0;
+    }
+    const char *filename = (argc > 1) ? argv[1] : "openomf_capture.rgba";
+    if(capture_stream_start(filename, 0) == 0) {
+        console_output_addline("Capture stream started; stop with \"capture\"");
+        return 0;
+    }
+    return 1;
+}
+
+int console_cmd_fps(game_state *gs, int argc, char **argv) {
+    if(argc == 1) {
+        framepacer_report(console_report_line, NULL);
+        return 0;
+    }
+    if(strcmp(argv[1], "reset") == 0) {
+        framepacer_reset_stats();
+        return 0;
+    }
+    int cap;
+    if(argc == 3 && strcmp(argv[1], "cap") == 0 && strtoint(argv[2], &cap) && cap >= 0) {
+        framepacer_set_cap(cap);
+        settings_get()->video.frame_cap = cap;
+        framepacer_reset_stats();
+        return 0;
+    }
+    return 1;
+}
+
+int console_cmd_loglevel(game_state *gs, int argc, char **argv) {
+    static const char *names[] = {"debug", "info", "error", "none"};
+    if(argc == 1) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "Log level is %s", names[log_get_level()]);
+        console_output_addline(buf);
+        return 0;
+    }
+    for(int i = 0; i <= LOG_LEVEL_NONE; i++) {
+        if(strcmp(argv[1], names[i]) == 0) {
+            log_set_level(i);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#ifdef ALLOC_TRACKING
+int console_cmd_allocs(game_state *gs, int argc, char **argv) {
+    if(argc == 2 && strcmp(argv[1], "tick") == 0) {
+        omf_alloc_set_tick_log(!omf_alloc_get_tick_log());
+        console_output_addline(omf_alloc_get_tick_log() ? "Per-tick allocation logging on"
+                                                        : "Per-tick allocation logging off");
+        return 0;
+    }
+    int rows = 10;
+    if(argc == 2 && !strtoint(argv[1], &rows)) {
+        return 1;
+    }
+    omf_alloc_report(console_report_line, NULL, rows > 0 ? rows : 10);
+    return 0;
+}
+#endif
+
 void console_init_cmd() {
     // Add console commands
     console_add_cmd("h", &console_cmd_history, "show command history");
@@ -290,4 +401,11 @@ void console_init_cmd() {
     console_add_cmd("warp", &console_toggle_warp, "Toggle warp speed");
     console_add_cmd("money", &console_cmd_money, "Set tournament mode money");
     console_add_cmd("rank", &console_cmd_rank, "Set tournament mode rank");
+    console_add_cmd("prof", &console_cmd_prof, "Tick profiler. usage: prof [on|off|reset|trace [file]]");
+    console_add_cmd("capture", &console_cmd_capture, "Toggle raw 320x200 video capture. usage: capture [file]");
+    console_add_cmd("fps", &console_cmd_fps, "Show frame rate and frame time variance. usage: fps [reset|cap <fps>]");
+    console_add_cmd("loglevel", &console_cmd_loglevel, "Set log level. usage: loglevel [debug|info|error|none]");
+#ifdef ALLOC_TRACKING
+    console_add_cmd("allocs", &console_cmd_allocs, "Show heap usage per call site. usage: allocs [rows|tick]");
+#endif
 }
@@ -13,7 +13,7 @@
 #include "utils/log.h"
 #include "utils/random.h"
 #include "utils/vec.h"
-#include <math.h>
+#include <stdlib.h>
 
 /* times thrown before we AI learns its lesson */
 #define MAX_TIMES_THROWN 3
@@ -349,7 +349,7 @@ int get_enemy_range(const controller *ctrl) {
     har *h = object_get_userdata(o);
     object *o_enemy = game_state_get_player(o->gs, h->player_id == 1 ? 0 : 1)->har;
 
-    int range_units = fabsf(o_enemy->pos.x - o->pos.x) / 30;
+    int range_units = abs(object_px(o_enemy) - object_px(o)) / 30;
     switch(range_units) {
         case 0:
         case 1:
@@ -1422,7 +1422,7 @@ void set_selected_move(controller *ctrl, af_move *selected_move) {
     a->selected_move = selected_move;
     a->move_str_pos = str_size(&selected_move->move_string) - 1;
     object *o_enemy = game_state_get_player(o->gs, h->player_id == 1 ? 0 : 1)->har;
-    a->move_stats[a->selected_move->id].last_dist = fabsf(o->pos.x - o_enemy->pos.x);
+    a->move_stats[a->selected_move->id].last_dist = abs(object_px(o) - object_px(o_enemy));
     a->blocked = 0;
     // DEBUG("AI selected move %s", str_c(&selected_move->move_string));
 }
@@ -1549,7 +1549,7 @@ int ai_block_har(controller *ctrl, ctrl_event **ev) {
     har *h_enemy = object_get_userdata(o_enemy);
 
     // XXX TODO get maximum move distance from the animation object
-    if(fabsf(o_enemy->pos.x - o->pos.x) < 100 && h_enemy->executing_move && smart_usually(a)) {
+    if(abs(object_px(o_enemy) - object_px(o)) < 100 && h_enemy->executing_move && smart_usually(a)) {
         if(har_is_crouching(h_enemy)) {
             a->cur_act = (o->direction == OBJECT_FACE_RIGHT ? ACT_DOWN | ACT_LEFT : ACT_DOWN | ACT_RIGHT);
             controller_cmd(ctrl, a->cur_act, ev);
@@ -1590,7 +1590,7 @@ int ai_block_projectile(controller *ctrl, ctrl_event **ev) {
             if(object_get_direction(o_prj) == OBJECT_FACE_LEFT) {
                 pos_prj.x = object_get_pos(o_prj).x + ((o_prj->cur_sprite->pos.x * -1) - size_prj.x);
             }
-            if(fabsf(pos_prj.x - o->pos.x) < 120) {
+            if(abs(pos_prj.x - object_px(o)) < 120) {
                 a->cur_act = (o->direction == OBJECT_FACE_RIGHT ? ACT_DOWN | ACT_LEFT : ACT_DOWN | ACT_RIGHT);
                 controller_cmd(ctrl, a->cur_act, ev);
                 return 1;
@@ -38,17 +38,16 @@ void controller_clear_hooks(controller *ctrl) {
     }
 }
 
+// Events themselves live in the tick arena, and are released at the end of the dynamic tick.
+// Only the heap allocated sync payloads need to be freed here.
 void controller_free_chain(ctrl_event *ev) {
     ctrl_event *now = ev;
-    ctrl_event *tmp;
     while(now != NULL) {
-        if(now->type == EVENT_TYPE_SYNC) {
+        if(now->type == EVENT_TYPE_SYNC && now->event_data.ser != NULL) {
             serial_free(now->event_data.ser);
             omf_free(now->event_data.ser);
         }
-        tmp = now->next;
-        omf_free(now);
-        now = tmp;
+        now = now->next;
     }
 }
 
@@ -64,7 +63,7 @@ void controller_cmd(controller *ctrl, int action, ctrl_event **ev) {
         ((*p)->fp)((*p)->source, action);
     }
 
-    new = omf_calloc(1, sizeof(ctrl_event));
+    new = omf_arena_calloc(OMF_ARENA_TICK, 1, sizeof(ctrl_event));
     new->type = EVENT_TYPE_ACTION;
     new->event_data.action = action;
 
@@ -82,7 +81,7 @@ void controller_cmd(controller *ctrl, int action, ctrl_event **ev) {
 void controller_sync(controller *ctrl, const serial *ser, ctrl_event **ev) {
     // a sync event obsoletes all previous events
     controller_free_chain(*ev);
-    *ev = omf_calloc(1, sizeof(ctrl_event));
+    *ev = omf_arena_calloc(OMF_ARENA_TICK, 1, sizeof(ctrl_event));
     (*ev)->type = EVENT_TYPE_SYNC;
     (*ev)->event_data.ser = serial_calloc_copy(ser);
     (*ev)->next = NULL;
@@ -91,7 +90,7 @@ void controller_sync(controller *ctrl, const serial *ser, ctrl_event **ev) {
 void controller_close(controller *ctrl, ctrl_event **ev) {
     // a close event obsoletes all previous events
     controller_free_chain(*ev);
-    *ev = omf_calloc(1, sizeof(ctrl_event));
+    *ev = omf_arena_calloc(OMF_ARENA_TICK, 1, sizeof(ctrl_event));
     (*ev)->type = EVENT_TYPE_CLOSE;
     (*ev)->next = NULL;
 }
@@ -25,7 +25,8 @@ enum
     CTRL_TYPE_GAMEPAD,
     CTRL_TYPE_NETWORK,
     CTRL_TYPE_AI,
-    CTRL_TYPE_REC
+    CTRL_TYPE_REC,
+    CTRL_TYPE_SPECTATOR
 };
 
 enum
@@ -33,7 +34,10 @@ enum
     EVENT_TYPE_ACTION,
     EVENT_TYPE_SYNC,
     EVENT_TYPE_HB,
-    EVENT_TYPE_CLOSE
+    EVENT_TYPE_CLOSE,
+    EVENT_TYPE_SYNC_ACK,
+    EVENT_TYPE_LOCKSTEP,
+    EVENT_TYPE_LOCKSTEP_MODE
 };
 
 typedef struct ctrl_event_t ctrl_event;
@@ -3,8 +3,25 @@
 
 #include "controller/net_controller.h"
 #include "game/utils/serial.h"
+#include "game/utils/sync_delta.h"
+#include "net/lockstep.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
+#include "utils/random.h"
+
+// Game state syncs go on their own channel, so that they don't hold up actions
+#define SYNC_CHANNEL 2
+
+// Amount of sent and received states kept around as bases for the next ones
+#define SYNC_HISTORY 16
+
+// Lockstep inputs are sent unreliably on the action channel, since every message repeats the lost ones
+#define LOCKSTEP_CHANNEL 1
+
+typedef struct {
+    int seq; // 0 if unused
+    serial state;
+} sync_state;
 
 typedef struct {
     ENetHost *host;
@@ -18,6 +35,16 @@ typedef struct {
     int rttpos;
     int rttfilled;
     int tick_offset;
+    sync_state sent[SYNC_HISTORY];     // States sent to the peer
+    sync_state received[SYNC_HISTORY]; // States received from the peer
+    int sync_seq;                      // Sequence number of the last state sent
+    int sync_acked;                    // Last state the peer has acknowledged, or 0
+    int sync_received;                 // Last state received from the peer, or 0
+    int lockstep_delay;                // Input delay of lockstep matches, or -1 if matches are not played so
+    int lockstep_match;                // Number of the current or last lockstep match
+    int lockstep_sent;                 // Tick the lockstep inputs were last sent on
+    uint32_t lockstep_seed;            // Random seed of lockstep matches, picked by the server
+    lockstep *lockstep;                // Inputs of the current match, if it is played in lockstep
 } wtf;
 
 // simple standard deviation calculation
@@ -62,6 +89,179 @@ int net_controller_tick_offset(controller *ctrl) {
     return data->tick_offset;
 }
 
+// Stores a state under the sequence number, over whatever was in its slot
+static void sync_history_put(sync_state *history, int seq, serial *state) {
+    sync_state *slot = &history[seq % SYNC_HISTORY];
+    if(slot->seq != 0) {
+        serial_free(&slot->state);
+    }
+    slot->seq = seq;
+    slot->state = *state;
+}
+
+// Returns the state stored under the sequence number, or NULL if it is no longer there
+static sync_state *sync_history_get(sync_state *history, int seq) {
+    sync_state *slot = &history[seq % SYNC_HISTORY];
+    return (seq != 0 && slot->seq == seq) ? slot : NULL;
+}
+
+static void sync_history_free(sync_state *history) {
+    for(int i = 0; i < SYNC_HISTORY; i++) {
+        if(history[i].seq != 0) {
+            serial_free(&history[i].state);
+            history[i].seq = 0;
+        }
+    }
+}
+
+/*
+ * Decodes a state sync from the peer, and acknowledges it so that the peer can encode the next ones
+ * against it. Syncs that are older than the last one, or based on a state we no longer have, are dropped.
+ */
+static void net_controller_receive_sync(controller *ctrl, serial *ser, ctrl_event **ev) {
+    wtf *data = ctrl->data;
+    int seq = serial_read_int32(ser);
+    int base_seq = serial_read_int32(ser);
+    if(seq <= data->sync_received) {
+        return;
+    }
+    sync_state *base = NULL;
+    if(base_seq != 0) {
+        base = sync_history_get(data->received, base_seq);
+        if(base == NULL) {
+            DEBUG("sync %d is based on unknown state %d", seq, base_seq);
+            return;
+        }
+    }
+
+    serial state;
+    serial_create(&state);
+    if(sync_delta_decode(&state, base ? &base->state : NULL, ser)) {
+        DEBUG("sync %d is broken", seq);
+        serial_free(&state);
+        return;
+    }
+    sync_history_put(data->received, seq, &state);
+    data->sync_received = seq;
+
+    if(data->peer) {
+        serial ack;
+        serial_create(&ack);
+        serial_write_int8(&ack, EVENT_TYPE_SYNC_ACK);
+        serial_write_int32(&ack, seq);
+        ENetPacket *packet = enet_packet_create(ack.data, ack.wpos, ENET_PACKET_FLAG_UNSEQUENCED);
+        serial_free(&ack);
+        enet_peer_send(data->peer, 0, packet);
+    }
+
+    controller_sync(ctrl, &sync_history_get(data->received, seq)->state, ev);
+}
+
+// Sends the local lockstep inputs the peer has not acknowledged. The last message of a match is sent
+// reliably, so that the peer does not keep waiting for inputs that are never coming.
+static void net_controller_lockstep_send(wtf *data, int done) {
+    if(data->peer == NULL) {
+        return;
+    }
+    serial ser;
+    serial_create(&ser);
+    serial_write_int8(&ser, EVENT_TYPE_LOCKSTEP);
+    serial_write_int32(&ser, data->lockstep_match);
+    lockstep_write(data->lockstep, &ser, done);
+    ENetPacket *packet =
+        enet_packet_create(ser.data, ser.wpos, done ? ENET_PACKET_FLAG_RELIABLE : ENET_PACKET_FLAG_UNSEQUENCED);
+    serial_free(&ser);
+    enet_peer_send(data->peer, LOCKSTEP_CHANNEL, packet);
+    enet_host_flush(data->host);
+}
+
+// Has the server play the following matches in lockstep, with the given input delay. Tells the client too.
+void net_controller_set_lockstep(controller *ctrl, int delay) {
+    wtf *data = ctrl->data;
+    data->lockstep_delay = delay;
+    data->lockstep_seed = rand_intmax();
+    if(data->peer) {
+        serial ser;
+        serial_create(&ser);
+        serial_write_int8(&ser, EVENT_TYPE_LOCKSTEP_MODE);
+        serial_write_int8(&ser, delay);
+        serial_write_int32(&ser, data->lockstep_seed);
+        ENetPacket *packet = enet_packet_create(ser.data, ser.wpos, ENET_PACKET_FLAG_RELIABLE);
+        serial_free(&ser);
+        enet_peer_send(data->peer, 0, packet);
+        enet_host_flush(data->host);
+    }
+}
+
+/*
+ * Starts playing a match in lockstep, if the server asked for that. Both ends count the matches, so that
+ * messages left over from the previous match are not taken for this one. Returns 1 if the match is played
+ * in lockstep.
+ */
+int net_controller_lockstep_start(controller *ctrl) {
+    wtf *data = ctrl->data;
+    if(data->lockstep_delay < 0) {
+        return 0;
+    }
+    if(data->lockstep == NULL) {
+        data->lockstep = omf_calloc(1, sizeof(lockstep));
+    }
+    lockstep_create(data->lockstep, data->lockstep_delay);
+    data->lockstep_match++;
+    data->lockstep_sent = -1;
+    DEBUG("lockstep match %d with %d frames of input delay", data->lockstep_match, data->lockstep->delay);
+    return 1;
+}
+
+void net_controller_lockstep_stop(controller *ctrl) {
+    wtf *data = ctrl->data;
+    if(data->lockstep == NULL) {
+        return;
+    }
+    net_controller_lockstep_send(data, 1);
+    omf_free(data->lockstep);
+}
+
+/*
+ * Random seed of the current lockstep match. Both ends seed the game with it before setting up the match,
+ * since the state is not synced in lockstep, and the random events have to go the same way on both.
+ */
+uint32_t net_controller_lockstep_seed(controller *ctrl) {
+    wtf *data = ctrl->data;
+    return data->lockstep_seed ^ (data->lockstep_match * 2654435761u);
+}
+
+// Tells whether the inputs of both players are in for the next frame. Always true outside of lockstep.
+int net_controller_lockstep_ready(controller *ctrl) {
+    wtf *data = ctrl->data;
+    return data->lockstep == NULL || data->disconnected || lockstep_ready(data->lockstep);
+}
+
+// Queues a local action. It is played after the input delay, on both ends.
+void net_controller_lockstep_add(controller *ctrl, int action) {
+    wtf *data = ctrl->data;
+    if(data->lockstep != NULL) {
+        lockstep_add_local(data->lockstep, action);
+    }
+}
+
+// Moves on to the next frame, and hands out the actions of both players that are due on this one
+void net_controller_lockstep_advance(controller *ctrl, ctrl_event **local, ctrl_event **remote) {
+    wtf *data = ctrl->data;
+    if(data->lockstep == NULL || !lockstep_ready(data->lockstep)) {
+        return;
+    }
+    const lockstep_input *local_input;
+    const lockstep_input *remote_input;
+    lockstep_advance(data->lockstep, &local_input, &remote_input);
+    for(int i = 0; i < local_input->count; i++) {
+        controller_cmd(ctrl, local_input->actions[i], local);
+    }
+    for(int i = 0; remote_input != NULL && i < remote_input->count; i++) {
+        controller_cmd(ctrl, remote_input->actions[i], remote);
+    }
+}
+
 void net_controller_free(controller *ctrl) {
     wtf *data = ctrl->data;
     ENetEvent event;
@@ -86,6 +286,11 @@ void net_controller_free(controller *ctrl) {
         }
     }
 done:
+    sync_history_free(data->sent);
+    sync_history_free(data->received);
+    if(data->lockstep) {
+        omf_free(data->lockstep);
+    }
     if(data->host) {
         enet_host_destroy(data->host);
         data->host = NULL;
@@ -143,7 +348,31 @@ int net_controller_tick(controller *ctrl, int ticks, ctrl_event **ev) {
                         }
                     } break;
                     case EVENT_TYPE_SYNC:
-                        controller_sync(ctrl, &ser, ev);
+                        // Syncs left over from before the match would undo frames played since
+                        if(data->lockstep == NULL) {
+                            net_controller_receive_sync(ctrl, &ser, ev);
+                        } else {
+                            DEBUG("dropping state sync during lockstep");
+                        }
+                        break;
+                    case EVENT_TYPE_SYNC_ACK: {
+                        int seq = serial_read_int32(&ser);
+                        if(seq > data->sync_acked && seq <= data->sync_seq) {
+                            data->sync_acked = seq;
+                        }
+                    } break;
+                    case EVENT_TYPE_LOCKSTEP:
+                        // Inputs of another match are either left over, or the peer got there before us
+                        if(data->lockstep != NULL && serial_read_int32(&ser) == data->lockstep_match) {
+                            if(lockstep_read(data->lockstep, &ser)) {
+                                DEBUG("lockstep message is broken");
+                            }
+                        }
+                        break;
+                    case EVENT_TYPE_LOCKSTEP_MODE:
+                        data->lockstep_delay = serial_read_int8(&ser);
+                        data->lockstep_seed = serial_read_int32(&ser);
+                        DEBUG("server plays matches in lockstep, with %d frames of input delay", data->lockstep_delay);
                         break;
                     default:
                         // Event type is unknown or we don't care about it
@@ -189,6 +418,12 @@ int net_controller_tick(controller *ctrl, int ticks, ctrl_event **ev) {
         }
     }
 
+    // Lockstep inputs go out on every tick, also while waiting for the peer, in case it lost the last ones
+    if(data->lockstep != NULL && ticks != data->lockstep_sent) {
+        data->lockstep_sent = ticks;
+        net_controller_lockstep_send(data, 0);
+    }
+
     /*if(!handled) {*/
     /*controller_cmd(ctrl, ACT_STOP, ev);*/
     /*}*/
@@ -201,15 +436,38 @@ int net_controller_update(controller *ctrl, serial *original) {
     ENetHost *host = data->host;
     ENetPacket *packet;
 
+    // In lockstep both ends play the same inputs on the same frames, and come to the same state. A sync
+    // could not be applied on the frame it was taken on either, since the client may already be up to
+    // the input delay ahead of the server.
+    if(data->lockstep != NULL) {
+        return 1;
+    }
+
     if(peer) {
+        // Encode against the last state the peer is known to have. If that is too old, the receiving
+        // end may not have it anymore, and the full state is sent.
+        int seq = data->sync_seq + 1;
+        sync_state *base = NULL;
+        if(seq - data->sync_acked < SYNC_HISTORY) {
+            base = sync_history_get(data->sent, data->sync_acked);
+        }
+
         serial ser;
         serial_create(&ser);
         serial_write_int8(&ser, EVENT_TYPE_SYNC);
-        serial_write(&ser, original->data, original->len);
-        packet = enet_packet_create(ser.data, ser.len, 0);
+        serial_write_int32(&ser, seq);
+        serial_write_int32(&ser, base ? base->seq : 0);
+        sync_delta_encode(&ser, base ? &base->state : NULL, original);
+        TRACE("sync %d: %d bytes, %d bytes of state", seq, (int)ser.wpos, (int)original->wpos);
+        packet = enet_packet_create(ser.data, ser.wpos, 0);
         serial_free(&ser);
-        enet_peer_send(peer, 1, packet);
+        enet_peer_send(peer, SYNC_CHANNEL, packet);
         enet_host_flush(host);
+
+        serial sent;
+        serial_copy(&sent, original);
+        sync_history_put(data->sent, seq, &sent);
+        data->sync_seq = seq;
     } else {
         DEBUG("peer is null~");
     }
@@ -287,6 +545,13 @@ void net_controller_create(controller *ctrl, ENetHost *host, ENetPeer *peer, int
     data->rttpos = 0;
     data->tick_offset = 0;
     data->rttfilled = 0;
+    data->sync_seq = 0;
+    data->sync_acked = 0;
+    data->sync_received = 0;
+    data->lockstep_delay = -1;
+    data->lockstep_match = 0;
+    data->lockstep_seed = 0;
+    data->lockstep = NULL;
     ctrl->data = data;
     ctrl->type = CTRL_TYPE_NETWORK;
     ctrl->tick_fun = &net_controller_tick;
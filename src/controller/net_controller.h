@@ -13,4 +13,12 @@ void net_controller_har_hook(int action, void *cb_data);
 int net_controller_ready(controller *ctrl);
 int net_controller_tick_offset(controller *ctrl);
 
+void net_controller_set_lockstep(controller *ctrl, int delay);
+int net_controller_lockstep_start(controller *ctrl);
+void net_controller_lockstep_stop(controller *ctrl);
+uint32_t net_controller_lockstep_seed(controller *ctrl);
+int net_controller_lockstep_ready(controller *ctrl);
+void net_controller_lockstep_add(controller *ctrl, int action);
+void net_controller_lockstep_advance(controller *ctrl, ctrl_event **local, ctrl_event **remote);
+
 #endif // NET_CONTROLLER_H
@@ -9,12 +9,14 @@ typedef struct {
     int last_action;
     int max_tick;
     hashmap tick_lookup;
+    hashmap checksums;
 } wtf;
 
 void rec_controller_free(controller *ctrl) {
     wtf *data = ctrl->data;
     if(data) {
         hashmap_free(&data->tick_lookup);
+        hashmap_free(&data->checksums);
         omf_free(data);
     }
 }
@@ -72,15 +74,31 @@ int rec_controller_tick(controller *ctrl, int ticks, ctrl_event **ev) {
     return 0;
 }
 
+// Finds the state checksum recorded for the tick, if the recording has one. Returns 0 if found.
+int rec_controller_get_checksum(controller *ctrl, unsigned int tick, uint32_t *checksum) {
+    wtf *data = ctrl->data;
+    uint32_t *value;
+    unsigned int len;
+    if(hashmap_iget(&data->checksums, tick, (void **)(&value), &len) != 0) {
+        return 1;
+    }
+    *checksum = *value;
+    return 0;
+}
+
 void rec_controller_create(controller *ctrl, int player, sd_rec_file *rec) {
     wtf *data = omf_calloc(1, sizeof(wtf));
     data->last_action = ACT_STOP;
     data->last_tick = 0;
     hashmap_create(&data->tick_lookup, 9);
+    hashmap_create(&data->checksums, 9);
     for(unsigned int i = 0; i < rec->move_count; i++) {
         if(rec->moves[i].player_id == player && rec->moves[i].lookup_id == 2) {
             hashmap_iput(&data->tick_lookup, rec->moves[i].tick, &rec->moves[i], sizeof(sd_rec_move));
         }
+        if(rec->moves[i].lookup_id == SD_REC_CHECKSUM) {
+            hashmap_iput(&data->checksums, rec->moves[i].tick, &rec->moves[i].checksum, sizeof(uint32_t));
+        }
     }
     data->max_tick = rec->moves[rec->move_count - 1].tick;
     DEBUG("max tick is %d", data->last_tick);
@@ -7,5 +7,6 @@
 
 void rec_controller_create(controller *ctrl, int player, sd_rec_file *rec);
 void rec_controller_free(controller *ctrl);
+int rec_controller_get_checksum(controller *ctrl, unsigned int tick, uint32_t *checksum);
 
 #endif // REC_CONTROLLER_H
@@ -0,0 +1,205 @@
+#include "controller/spectator_controller.h"
+#include "utils/allocator.h"
+#include "utils/list.h"
+#include "utils/log.h"
+
+// How long to wait for the relay to have a match to watch, in milliseconds
+#define SPECTATOR_WAIT 30000
+
+typedef struct {
+    unsigned int tick;
+    int action;
+} spectator_action;
+
+/*
+ * Connection to the relay, shared by the controllers of both players. The controller of the first
+ * player receives the messages, and applies the snapshots.
+ */
+struct spectator_t {
+    ENetHost *host;
+    ENetPeer *peer;
+    relay_match match;
+    int has_match;
+    int ended;
+    serial snapshot; // Snapshot that has not been applied yet, or empty
+    list actions[2]; // Actions that are not due yet, for both players
+};
+
+typedef struct {
+    spectator *spec;
+    int player;
+} wtf;
+
+static void spectator_clear_actions(spectator *spec) {
+    for(int i = 0; i < 2; i++) {
+        list_free(&spec->actions[i]);
+        list_create(&spec->actions[i]);
+    }
+}
+
+static void spectator_receive(spectator *spec, serial *ser) {
+    switch(serial_read_int8(ser)) {
+        case RELAY_MATCH:
+            if(spec->has_match) {
+                // A new match started, so the one we are watching is over
+                spec->ended = 1;
+                break;
+            }
+            relay_match_read(ser, &spec->match);
+            spec->has_match = 1;
+            break;
+        case RELAY_SNAPSHOT:
+            // Anything received before the snapshot is already included in it
+            spectator_clear_actions(spec);
+            spec->snapshot.wpos = 0;
+            spec->snapshot.rpos = 0;
+            serial_write(&spec->snapshot, ser->data + ser->rpos, ser->wpos - ser->rpos);
+            break;
+        case RELAY_ACTION: {
+            spectator_action action;
+            action.tick = serial_read_int32(ser);
+            int player = serial_read_int8(ser);
+            action.action = serial_read_int16(ser);
+            if(player == 0 || player == 1) {
+                list_append(&spec->actions[player], &action, sizeof(spectator_action));
+            }
+        } break;
+        case RELAY_END:
+            spec->ended = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+static void spectator_service(spectator *spec, int timeout) {
+    ENetEvent event;
+    serial ser;
+    while(enet_host_service(spec->host, &event, timeout) > 0) {
+        switch(event.type) {
+            case ENET_EVENT_TYPE_RECEIVE:
+                serial_create_from(&ser, (const char *)event.packet->data, event.packet->dataLength);
+                spectator_receive(spec, &ser);
+                serial_free(&ser);
+                enet_packet_destroy(event.packet);
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT:
+                DEBUG("relay disconnected");
+                spec->peer = NULL;
+                spec->ended = 1;
+                return;
+            default:
+                break;
+        }
+        if(spec->has_match) {
+            timeout = 0;
+        }
+    }
+}
+
+/*
+ * Connects to the relay, and waits for it to send the match that is going on. Returns NULL if there
+ * is no relay, or no match to watch.
+ */
+spectator *spectator_connect(const char *address, relay_match *match) {
+    spectator *spec = omf_calloc(1, sizeof(spectator));
+    serial_create(&spec->snapshot);
+    list_create(&spec->actions[0]);
+    list_create(&spec->actions[1]);
+    spec->host = enet_host_create(NULL, 1, RELAY_CHANNELS, 0, 0);
+    if(spec->host == NULL) {
+        PERROR("Failed to initialize ENet client");
+        spectator_free(spec);
+        return NULL;
+    }
+    spec->peer = relay_connect(spec->host, address, 5000);
+    if(spec->peer == NULL) {
+        spectator_free(spec);
+        return NULL;
+    }
+
+    serial watch;
+    serial_create(&watch);
+    serial_write_int8(&watch, RELAY_WATCH);
+    relay_send(spec->peer, &watch);
+    serial_free(&watch);
+    enet_host_flush(spec->host);
+
+    INFO("Waiting for a match on relay %s", address);
+    unsigned int start = enet_time_get();
+    while(!spec->has_match && !spec->ended && enet_time_get() - start < SPECTATOR_WAIT) {
+        spectator_service(spec, 100);
+    }
+    if(!spec->has_match) {
+        PERROR("No match to watch on relay %s", address);
+        spectator_free(spec);
+        return NULL;
+    }
+    *match = spec->match;
+    return spec;
+}
+
+void spectator_free(spectator *spec) {
+    if(spec->peer) {
+        enet_peer_disconnect(spec->peer, 0);
+        enet_host_flush(spec->host);
+    }
+    if(spec->host) {
+        enet_host_destroy(spec->host);
+    }
+    list_free(&spec->actions[0]);
+    list_free(&spec->actions[1]);
+    serial_free(&spec->snapshot);
+    omf_free(spec);
+}
+
+void spectator_controller_free(controller *ctrl) {
+    wtf *data = ctrl->data;
+    if(data) {
+        // The first player's controller owns the connection
+        if(data->player == 0) {
+            spectator_free(data->spec);
+        }
+        omf_free(data);
+    }
+}
+
+int spectator_controller_tick(controller *ctrl, int ticks, ctrl_event **ev) {
+    wtf *data = ctrl->data;
+    spectator *spec = data->spec;
+
+    if(data->player == 0) {
+        spectator_service(spec, 0);
+        if(spec->ended) {
+            DEBUG("match is over, closing controller");
+            controller_close(ctrl, ev);
+            return 0;
+        }
+        if(spec->snapshot.wpos > 0) {
+            controller_sync(ctrl, &spec->snapshot, ev);
+            spec->snapshot.wpos = 0;
+            return 0;
+        }
+    }
+
+    // Actions are sent as the host's game handled them, so they are replayed on the same ticks
+    list *actions = &spec->actions[data->player];
+    spectator_action *action;
+    iterator it;
+    list_iter_begin(actions, &it);
+    while((action = iter_next(&it)) != NULL && action->tick <= (unsigned int)ticks) {
+        controller_cmd(ctrl, action->action, ev);
+        list_delete(actions, &it);
+    }
+    return 0;
+}
+
+void spectator_controller_create(controller *ctrl, int player, spectator *spec) {
+    wtf *data = omf_calloc(1, sizeof(wtf));
+    data->spec = spec;
+    data->player = player;
+    ctrl->data = data;
+    ctrl->type = CTRL_TYPE_SPECTATOR;
+    ctrl->dyntick_fun = &spectator_controller_tick;
+    ctrl->free_fun = &spectator_controller_free;
+}
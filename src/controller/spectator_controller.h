@@ -0,0 +1,13 @@
+#ifndef SPECTATOR_CONTROLLER_H
+#define SPECTATOR_CONTROLLER_H
+
+#include "controller/controller.h"
+#include "net/relay.h"
+
+typedef struct spectator_t spectator;
+
+spectator *spectator_connect(const char *address, relay_match *match);
+void spectator_free(spectator *spec);
+void spectator_controller_create(controller *ctrl, int player, spectator *spec);
+
+#endif // SPECTATOR_CONTROLLER_H
@@ -6,21 +6,58 @@
 #include "game/gui/text_render.h"
 #include "game/utils/settings.h"
 #include "resources/languages.h"
+#include "resources/pic_loader.h"
 #include "resources/sounds_loader.h"
 #include "utils/allocator.h"
+#include "utils/framepacer.h"
 #include "utils/log.h"
+#include "utils/profiler.h"
+#include "utils/vector.h"
+#include "video/capture.h"
 #include "video/surface.h"
 #include "video/video.h"
 #include <SDL.h>
 #include <stdio.h>
+#include <string.h>
+
+// Output rates for offline rendering. Audio frames per video frame must be a whole number.
+#define OFFLINE_AUDIO_FREQ 48000
+#define OFFLINE_AUDIO_FRAMES (OFFLINE_AUDIO_FREQ / CAPTURE_STREAM_FPS)
+
+// Length of a static tick, in microseconds
+#define STATIC_TICK_US 10000
 
 static int run = 0;
 static int start_timeout = 30;
-static int take_screenshot = 0;
 static int enable_screen_updates = 1;
-static char screenshot_filename[128];
 
-int engine_init() {
+// Profiler overlay; text is refreshed every PROFILER_OVERLAY_REFRESH frames
+#define PROFILER_OVERLAY_REFRESH 30
+#define PROFILER_OVERLAY_LINES (PROF_ZONE_COUNT + PROF_COUNTER_COUNT + 1)
+static int profiler_overlay = 0;
+static int profiler_overlay_frames = 0;
+static int profiler_overlay_count = 0;
+static char profiler_overlay_text[PROFILER_OVERLAY_LINES][48];
+
+static void profiler_overlay_add_line(const char *line, void *userdata) {
+    if(profiler_overlay_count < PROFILER_OVERLAY_LINES) {
+        snprintf(profiler_overlay_text[profiler_overlay_count++], 48, "%s", line);
+    }
+}
+
+static void profiler_overlay_render() {
+    if(profiler_overlay_frames-- <= 0) {
+        profiler_overlay_count = 0;
+        profiler_report(profiler_overlay_add_line, NULL);
+        profiler_overlay_frames = PROFILER_OVERLAY_REFRESH;
+    }
+    for(int i = 0; i < profiler_overlay_count; i++) {
+        font_render_shadowed(&font_small, profiler_overlay_text[i], 2, 2 + i * font_small.h,
+                             color_create(200, 255, 200, 255), TEXT_SHADOW_RIGHT | TEXT_SHADOW_BOTTOM);
+    }
+}
+
+int engine_init(engine_init_flags *init_flags) {
     settings *setting = settings_get();
 
     int w = setting->video.screen_w;
@@ -36,10 +73,18 @@ int engine_init() {
     float sound_volume = setting->sound.sound_vol / 10.0;
 
     // Initialize everything.
-    if(video_init(w, h, fs, vsync, scaler, scale_factor))
-        goto exit_0;
-    if(!audio_init(frequency, mono, resampler, music_volume, sound_volume))
-        goto exit_1;
+    if(init_flags->render || init_flags->verify) {
+        if(video_init_offline())
+            goto exit_0;
+        if(!audio_init_offline(OFFLINE_AUDIO_FREQ, resampler, music_volume, sound_volume))
+            goto exit_1;
+    } else {
+        if(video_init(w, h, fs, vsync, scaler, scale_factor))
+            goto exit_0;
+        if(!audio_init(frequency, mono, resampler, music_volume, sound_volume))
+            goto exit_1;
+    }
+    video_set_software_render(setting->video.software_render);
     if(sounds_loader_init())
         goto exit_2;
     if(lang_init())
@@ -50,6 +95,11 @@ int engine_init() {
         goto exit_5;
     if(console_init())
         goto exit_6;
+    if(capture_init())
+        goto exit_7;
+    profiler_init();
+    framepacer_init();
+    framepacer_set_cap(setting->video.frame_cap);
 
     // Return successfully
     run = 1;
@@ -57,6 +107,8 @@ int engine_init() {
     return 0;
 
     // If something failed, close in correct order
+exit_7:
+    console_close();
 exit_6:
     altpals_close();
 exit_5:
@@ -73,215 +125,584 @@ exit_0:
     return 1;
 }
 
-void engine_run(engine_init_flags *init_flags) {
-    SDL_Event e;
-    int visual_debugger = 0;
-    int debugger_proceed = 0;
-    int debugger_render = 0;
+// Runs all static and dynamic ticks that fit in the waiting times (in microseconds). Returns the amount of ticks run.
+static int engine_tick(game_state *gs, int *static_wait, int *dynamic_wait) {
+    int ticks = 0;
+    while(*static_wait > STATIC_TICK_US) {
+        // Static tick for gamestate
+        PROFILE_BEGIN(PROF_STATIC_TICK);
+        game_state_static_tick(gs);
 
-    // if mouse_visible_ticks <= 0, hide mouse
-    int mouse_visible_ticks = 1000;
+        // Tick console
+        console_tick();
 
-    INFO(" --- BEGIN GAME LOG ---");
+        // Tick video (tcache)
+        video_tick();
+        PROFILE_END(PROF_STATIC_TICK);
 
-    // Game start timeout.
-    // Wait a moment so that people are mentally prepared
-    // (with the recording software on) for the game to start :)
-    if(!settings_get()->video.crossfade_on) {
-        start_timeout = 0;
+        *static_wait -= STATIC_TICK_US;
+        ticks++;
     }
-    while(start_timeout > 0) {
-        start_timeout--;
+    while(*dynamic_wait > game_state_ms_per_dyntick(gs) * 1000) {
+        // Tick scene
+        PROFILE_BEGIN(PROF_DYNAMIC_TICK);
+        game_state_dynamic_tick(gs);
+        PROFILE_END(PROF_DYNAMIC_TICK);
+
+        // Handle waiting period leftover time
+        *dynamic_wait -= game_state_ms_per_dyntick(gs) * 1000;
+        ticks++;
+    }
+    return ticks;
+}
+
+// Time until engine_tick() has something to do again, in microseconds.
+static int engine_tick_wait(game_state *gs, int static_wait, int dynamic_wait) {
+    int static_left = STATIC_TICK_US - static_wait + 1;
+    int dynamic_left = game_state_ms_per_dyntick(gs) * 1000 - dynamic_wait + 1;
+    int left = (static_left < dynamic_left) ? static_left : dynamic_left;
+    return (left > 0) ? left : 0;
+}
+
+// Output files are named after the recording, with the extension swapped
+static void engine_output_file(char *out, size_t len, const char *rec_file, const char *ext) {
+    char base[255];
+    snprintf(base, sizeof(base), "%s", rec_file);
+    char *old = strrchr(base, '.');
+    if(old != NULL && strpbrk(old, "/\\") == NULL) {
+        *old = 0;
+    }
+    snprintf(out, len, "%s.%s", base, ext);
+}
+
+/*
+ * Plays back a recording as fast as possible, on a fixed clock of CAPTURE_STREAM_FPS frames per second.
+ * Every frame is written to <recording>.rgba, and the mixed audio to <recording>.wav.
+ */
+static void engine_run_offline(game_state *gs, const char *rec_file) {
+    char video_file[270];
+    char audio_file[270];
+    int16_t samples[OFFLINE_AUDIO_FRAMES * 2];
+    SDL_Event e;
+
+    engine_output_file(video_file, sizeof(video_file), rec_file, "rgba");
+    engine_output_file(audio_file, sizeof(audio_file), rec_file, "wav");
+    if(capture_stream_start(video_file, 1)) {
+        return;
+    }
+    if(capture_audio_start(audio_file, OFFLINE_AUDIO_FREQ)) {
+        capture_stream_stop();
+        return;
+    }
+
+    unsigned int frame = 0;
+    uint64_t us = 0;
+    int static_wait = 0;
+    int dynamic_wait = 0;
+    unsigned int start = SDL_GetTicks();
+    while(run && game_state_is_running(gs)) {
         while(SDL_PollEvent(&e)) {
             if(e.type == SDL_QUIT) {
-                return;
+                run = 0;
             }
         }
+
+        // Game time only depends on the frame number, so the output is the same on every run.
+        frame++;
+        uint64_t now = (uint64_t)frame * 1000000 / CAPTURE_STREAM_FPS;
+        static_wait += now - us;
+        dynamic_wait += now - us;
+        us = now;
+
+        game_state_tick_controllers(gs);
+        engine_tick(gs, &static_wait, &dynamic_wait);
+
         video_render_prepare();
+        game_state_render(gs);
         video_render_finish();
+
+        audio_render(samples, OFFLINE_AUDIO_FRAMES);
+        capture_audio_write(samples, OFFLINE_AUDIO_FRAMES);
     }
 
-    // apply volume settings
-    audio_set_sound_volume(settings_get()->sound.sound_vol / 10.0f);
+    capture_stream_stop();
+    capture_audio_stop(OFFLINE_AUDIO_FREQ);
+    INFO("Rendered %u frames (%u seconds) of %s in %u ms", frame, frame / CAPTURE_STREAM_FPS, rec_file,
+         SDL_GetTicks() - start);
+}
 
-    // Set up game
-    game_state *gs = omf_calloc(1, sizeof(game_state));
-    if(game_state_create(gs, init_flags)) {
-        game_state_free(&gs);
-        return;
+// Checks a playback against its golden trace, or stores it as the golden trace. Returns 1 if they differ.
+static int engine_verify_trace(const replay_trace *trace, engine_init_flags *init_flags) {
+    char trace_file[270];
+    engine_output_file(trace_file, sizeof(trace_file), init_flags->rec_file, "trace");
+    if(init_flags->bless) {
+        if(replay_trace_save(trace, trace_file)) {
+            return 1;
+        }
+        INFO("Wrote trace %s", trace_file);
+        return 0;
     }
 
-    // Game loop
-    int frame_start = SDL_GetTicks();
-    int dynamic_wait = 0;
+    replay_trace golden;
+    unsigned int tick = 0;
+    int ret = 1;
+    replay_trace_create(&golden);
+    if(replay_trace_load(&golden, trace_file)) {
+        PERROR("No trace %s to check against; write one with --bless", trace_file);
+        replay_trace_free(&golden);
+        return 1;
+    }
+    const replay_outcome *a = &golden.outcome;
+    const replay_outcome *b = &trace->outcome;
+    switch(replay_trace_compare(&golden, trace, &tick)) {
+        case REPLAY_TRACE_MATCH:
+            INFO("%s matches its trace", init_flags->rec_file);
+            ret = 0;
+            break;
+        case REPLAY_TRACE_DIVERGED:
+            PERROR("%s diverged from its trace at tick %u", init_flags->rec_file, tick);
+            break;
+        case REPLAY_TRACE_LENGTH:
+            PERROR("%s and its trace end on different ticks, the first one missing is %u", init_flags->rec_file,
+                   tick);
+            break;
+        case REPLAY_TRACE_OUTCOME:
+            PERROR("%s ended with winner %d, health %d/%d and score %d/%d; the trace has winner %d, health %d/%d "
+                   "and score %d/%d",
+                   init_flags->rec_file, b->winner, b->health[0], b->health[1], b->score[0], b->score[1], a->winner,
+                   a->health[0], a->health[1], a->score[0], a->score[1]);
+            break;
+    }
+    replay_trace_free(&golden);
+    return ret;
+}
+
+/*
+ * Plays back a recording as fast as possible, on the same fixed clock as engine_run_offline() but without
+ * rendering anything. The state checksum of every tick and the outcome of the match are checked against
+ * the golden trace of the recording. Returns 1 if they differ.
+ */
+static int engine_run_verify(game_state *gs, engine_init_flags *init_flags) {
+    replay_trace trace;
+    SDL_Event e;
+
+    replay_trace_create(&trace);
+    gs->trace = &trace;
+
+    unsigned int frame = 0;
+    uint64_t us = 0;
     int static_wait = 0;
+    int dynamic_wait = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
     while(run && game_state_is_running(gs)) {
-        // Handle events
-        int check_fs;
         while(SDL_PollEvent(&e)) {
-            // Handle other events
-            switch(e.type) {
-                case SDL_QUIT:
-                    run = 0;
+            if(e.type == SDL_QUIT) {
+                run = 0;
+            }
+        }
+        frame++;
+        uint64_t now = (uint64_t)frame * 1000000 / CAPTURE_STREAM_FPS;
+        static_wait += now - us;
+        dynamic_wait += now - us;
+        us = now;
+
+        game_state_tick_controllers(gs);
+        engine_tick(gs, &static_wait, &dynamic_wait);
+    }
+    gs->trace = NULL;
+
+    // Throughput is what engine changes are measured by, besides the trace staying the same
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    unsigned int ticks = vector_size(&trace.ticks);
+    INFO("Played %u ticks of %s in %.0f ms, %.0f ticks per second", ticks, init_flags->rec_file, seconds * 1000,
+         seconds > 0 ? ticks / seconds : 0);
+
+    int ret = engine_verify_trace(&trace, init_flags);
+    replay_trace_free(&trace);
+    return ret;
+}
+
+// Debugging toggles
+static int visual_debugger = 0;
+static int debugger_proceed = 0;
+static int debugger_render = 0;
+
+// if mouse_visible_ticks <= 0, hide mouse
+static int mouse_visible_ticks = 1000;
+
+// With a render thread, the game runs on a thread of its own. Events are polled by the main thread, and
+// queued for the game here.
+static SDL_mutex *event_lock = NULL;
+static vector event_queue;
+static vector event_batch;
+static SDL_atomic_t game_running;
+
+// Handles events that belong to the window, and the thread that owns it.
+static void engine_window_event(SDL_Event *e) {
+    int check_fs;
+    switch(e->type) {
+        case SDL_KEYDOWN:
+            if(e->key.keysym.sym == SDLK_F1) {
+                char filename[64];
+                snprintf(filename, sizeof(filename), "screenshot_%u.png", SDL_GetTicks());
+                capture_screenshot(filename);
+            }
+            if(e->key.keysym.sym == SDLK_F8) {
+                if(capture_stream_is_running()) {
+                    capture_stream_stop();
+                } else {
+                    char filename[64];
+                    snprintf(filename, sizeof(filename), "capture_%u.rgba", SDL_GetTicks());
+                    capture_stream_start(filename, 0);
+                }
+            }
+            break;
+        case SDL_MOUSEMOTION:
+            mouse_visible_ticks = 1000;
+            SDL_ShowCursor(1);
+            break;
+        case SDL_WINDOWEVENT:
+            switch(e->window.event) {
+                case SDL_WINDOWEVENT_MINIMIZED:
+                    DEBUG("MINIMIZED");
+                    enable_screen_updates = 0;
                     break;
-                case SDL_KEYDOWN:
-                    if(e.key.keysym.sym == SDLK_F1) {
-                        take_screenshot = 1;
-                    }
-                    if(e.key.keysym.sym == SDLK_F5) {
-                        visual_debugger = !visual_debugger;
-                    }
-                    if(e.key.keysym.sym == SDLK_SPACE) {
-                        debugger_proceed = 1;
-                    }
-                    if(e.key.keysym.sym == SDLK_F6) {
-                        debugger_render = !debugger_render;
-                    }
+                case SDL_WINDOWEVENT_HIDDEN:
+                    DEBUG("HIDDEN");
+                    enable_screen_updates = 0;
                     break;
-                case SDL_MOUSEMOTION:
-                    mouse_visible_ticks = 1000;
-                    SDL_ShowCursor(1);
+                case SDL_WINDOWEVENT_MAXIMIZED:
+                    DEBUG("MAXIMIZED");
+                    enable_screen_updates = 1;
                     break;
-                case SDL_WINDOWEVENT:
-                    switch(e.window.event) {
-                        case SDL_WINDOWEVENT_MINIMIZED:
-                            DEBUG("MINIMIZED");
-                            enable_screen_updates = 0;
-                            break;
-                        case SDL_WINDOWEVENT_HIDDEN:
-                            DEBUG("HIDDEN");
-                            enable_screen_updates = 0;
-                            break;
-                        case SDL_WINDOWEVENT_MAXIMIZED:
-                            DEBUG("MAXIMIZED");
-                            enable_screen_updates = 1;
-                            break;
-                        case SDL_WINDOWEVENT_RESTORED:
-                            video_get_state(NULL, NULL, &check_fs, NULL);
-                            if(check_fs) {
-                                video_reinit_renderer();
-                            }
-                            DEBUG("RESTORED");
-                            enable_screen_updates = 1;
-                            break;
-                        case SDL_WINDOWEVENT_SHOWN:
-                            enable_screen_updates = 1;
-                            DEBUG("SHOWN");
-                            break;
+                case SDL_WINDOWEVENT_RESTORED:
+                    video_get_state(NULL, NULL, &check_fs, NULL);
+                    if(check_fs) {
+                        video_reinit_renderer();
                     }
+                    DEBUG("RESTORED");
+                    enable_screen_updates = 1;
+                    break;
+                case SDL_WINDOWEVENT_SHOWN:
+                    enable_screen_updates = 1;
+                    DEBUG("SHOWN");
                     break;
             }
+            break;
+    }
+}
 
-            // Console events
-            if(e.type == SDL_KEYDOWN) {
-                if(console_window_is_open() &&
-                   (e.key.keysym.scancode == SDL_SCANCODE_GRAVE || e.key.keysym.sym == SDLK_BACKQUOTE ||
-                    e.key.keysym.sym == SDLK_TAB || e.key.keysym.sym == SDLK_ESCAPE)) {
-                    console_window_close();
-                    continue;
-                } else if(e.key.keysym.sym == SDLK_TAB || e.key.keysym.sym == SDLK_BACKQUOTE ||
-                          e.key.keysym.scancode == SDL_SCANCODE_GRAVE) {
-                    console_window_open();
-                    continue;
+// Handles the rest of the events, on the thread running the game.
+static void engine_game_event(game_state *gs, SDL_Event *e) {
+    switch(e->type) {
+        case SDL_QUIT:
+            run = 0;
+            break;
+        case SDL_KEYDOWN:
+            if(e->key.keysym.sym == SDLK_F5) {
+                visual_debugger = !visual_debugger;
+            }
+            if(e->key.keysym.sym == SDLK_SPACE) {
+                debugger_proceed = 1;
+            }
+            if(e->key.keysym.sym == SDLK_F6) {
+                debugger_render = !debugger_render;
+            }
+            if(e->key.keysym.sym == SDLK_F7) {
+                profiler_overlay = !profiler_overlay;
+                profiler_overlay_frames = 0;
+                if(!profiler_trace_is_running()) {
+                    profiler_set_enabled(profiler_overlay);
                 }
             }
+            break;
+    }
 
-            // If console windows is open, pass events to console.
-            // Otherwise to the objects.
-            if(console_window_is_open()) {
-                console_event(gs, &e);
-            } else {
-                game_state_handle_event(gs, &e);
-            }
+    // Console events
+    if(e->type == SDL_KEYDOWN) {
+        if(console_window_is_open() &&
+           (e->key.keysym.scancode == SDL_SCANCODE_GRAVE || e->key.keysym.sym == SDLK_BACKQUOTE ||
+            e->key.keysym.sym == SDLK_TAB || e->key.keysym.sym == SDLK_ESCAPE)) {
+            console_window_close();
+            return;
+        } else if(e->key.keysym.sym == SDLK_TAB || e->key.keysym.sym == SDLK_BACKQUOTE ||
+                  e->key.keysym.scancode == SDL_SCANCODE_GRAVE) {
+            console_window_open();
+            return;
         }
+    }
 
-        // hide mouse after n ticks
-        if(mouse_visible_ticks > 0) {
-            mouse_visible_ticks -= SDL_GetTicks() - frame_start;
-            if(mouse_visible_ticks <= 0) {
-                SDL_ShowCursor(0);
-            }
+    // If console windows is open, pass events to console.
+    // Otherwise to the objects.
+    if(console_window_is_open()) {
+        console_event(gs, e);
+    } else {
+        game_state_handle_event(gs, e);
+    }
+}
+
+// Hides the mouse after it has not been moved for a while. dt is in microseconds.
+static void engine_mouse_tick(int dt) {
+    if(mouse_visible_ticks > 0) {
+        mouse_visible_ticks -= dt / 1000;
+        if(mouse_visible_ticks <= 0) {
+            SDL_ShowCursor(0);
         }
+    }
+}
 
-        // Tick controllers
-        game_state_tick_controllers(gs);
+static void engine_render(game_state *gs) {
+    PROFILE_BEGIN(PROF_RENDER);
+    video_render_prepare();
+    game_state_render(gs);
+    if(debugger_render) {
+        game_state_debug(gs);
+    }
+    if(profiler_overlay) {
+        profiler_overlay_render();
+    }
+    console_render();
+    PROFILE_END(PROF_RENDER);
+
+    PROFILE_BEGIN(PROF_RENDER_FINISH);
+    video_render_finish();
+    PROFILE_END(PROF_RENDER_FINISH);
+}
+
+// Adds the elapsed time to the tick waiting times, and runs the ticks. Returns the amount of ticks run.
+static int engine_advance(game_state *gs, int dt, int *static_wait, int *dynamic_wait) {
+    // Tick controllers
+    game_state_tick_controllers(gs);
+
+    // Run ticks
+    if(!visual_debugger) {
+        *dynamic_wait += dt;
+        *static_wait += dt;
+    } else if(debugger_proceed) {
+        *dynamic_wait += 20000;
+        *static_wait += 20000;
+        debugger_proceed = 0;
+    }
+    return engine_tick(gs, static_wait, dynamic_wait);
+}
+
+// Time until the loop has something to do again, in microseconds. Events are polled at least once per
+// static tick.
+static int engine_loop_wait(game_state *gs, int elapsed, int static_wait, int dynamic_wait) {
+    if(visual_debugger) {
+        return STATIC_TICK_US;
+    }
+    return engine_tick_wait(gs, static_wait + elapsed, dynamic_wait + elapsed);
+}
 
-        // Render scene
-        int dt = (SDL_GetTicks() - frame_start);
-        frame_start = SDL_GetTicks(); // Reset timer
-        if(!visual_debugger) {
-            dynamic_wait += dt;
-            static_wait += dt;
-        } else if(debugger_proceed) {
-            dynamic_wait += 20;
-            static_wait += 20;
-            debugger_proceed = 0;
+// Game loop. Ticks run on a fixed timestep; a frame is rendered whenever the game state has changed and
+// the frame cap allows it, and in between the loop sleeps until the next deadline.
+static void engine_loop(game_state *gs) {
+    SDL_Event e;
+    uint64_t frame_start = framepacer_now();
+    int dynamic_wait = 0;
+    int static_wait = 0;
+    int render_pending = 1;
+    while(run && game_state_is_running(gs)) {
+        // Handle events
+        while(SDL_PollEvent(&e)) {
+            engine_window_event(&e);
+            engine_game_event(gs, &e);
         }
-        while(static_wait > 10) {
-            // Static tick for gamestate
-            game_state_static_tick(gs);
 
-            // Tick console
-            console_tick();
+        uint64_t now = framepacer_now();
+        int dt = now - frame_start;
+        frame_start = now;
+        engine_mouse_tick(dt);
+
+        PROFILE_BEGIN(PROF_FRAME);
+        if(engine_advance(gs, dt, &static_wait, &dynamic_wait) > 0 || visual_debugger) {
+            render_pending = 1;
+        }
+
+        // Do the actual video rendering jobs. Nothing has changed if no ticks were run, so the frame
+        // would be the same as the last one.
+        if(enable_screen_updates && render_pending && framepacer_next_frame(now) <= now) {
+            render_pending = 0;
+            engine_render(gs);
+            framepacer_frame_done(framepacer_now());
+        }
 
-            // Tick video (tcache)
-            video_tick();
+        PROFILE_END(PROF_FRAME);
+        profiler_frame_end();
 
-            static_wait -= 10;
+        // Sleep until the next tick is due, or the next frame may be shown.
+        now = framepacer_now();
+        uint64_t deadline = now + engine_loop_wait(gs, now - frame_start, static_wait, dynamic_wait);
+        if(enable_screen_updates && render_pending) {
+            uint64_t next_frame = framepacer_next_frame(now);
+            deadline = (next_frame < deadline) ? next_frame : deadline;
         }
-        while(dynamic_wait > game_state_ms_per_dyntick(gs)) {
-            // Tick scene
-            game_state_dynamic_tick(gs);
+        framepacer_sleep_until(deadline);
+    }
+}
 
-            // Handle waiting period leftover time
-            dynamic_wait -= game_state_ms_per_dyntick(gs);
+// Game loop of the game thread. Same as engine_loop(), except that frames are handed over to the render
+// thread as soon as it has taken the previous one, and the render thread takes care of the frame cap.
+static int engine_game_thread(void *userdata) {
+    game_state *gs = userdata;
+    uint64_t frame_start = framepacer_now();
+    int dynamic_wait = 0;
+    int static_wait = 0;
+    int render_pending = 1;
+    while(run && game_state_is_running(gs)) {
+        // Handle events queued by the main thread
+        SDL_LockMutex(event_lock);
+        vector batch = event_batch;
+        event_batch = event_queue;
+        event_queue = batch;
+        SDL_UnlockMutex(event_lock);
+        for(unsigned int i = 0; i < vector_size(&event_batch); i++) {
+            engine_game_event(gs, vector_get(&event_batch, i));
         }
+        vector_clear(&event_batch);
 
-        // Do the actual video rendering jobs
-        if(enable_screen_updates) {
+        uint64_t now = framepacer_now();
+        int dt = now - frame_start;
+        frame_start = now;
 
-            video_render_prepare();
-            game_state_render(gs);
-            if(debugger_render) {
-                game_state_debug(gs);
+        PROFILE_BEGIN(PROF_FRAME);
+        if(engine_advance(gs, dt, &static_wait, &dynamic_wait) > 0 || visual_debugger) {
+            render_pending = 1;
+        }
+        if(render_pending && video_render_ready(0)) {
+            render_pending = 0;
+            engine_render(gs);
+        }
+        PROFILE_END(PROF_FRAME);
+        profiler_frame_end();
+
+        // Sleep until the next tick is due. If a frame is waiting to be recorded, wake up as soon as the
+        // render thread is ready for it.
+        now = framepacer_now();
+        int wait = engine_loop_wait(gs, now - frame_start, static_wait, dynamic_wait);
+        if(render_pending && wait >= 1000) {
+            video_render_ready(wait / 1000);
+        } else {
+            framepacer_sleep_until(now + wait);
+        }
+    }
+    SDL_AtomicSet(&game_running, 0);
+    video_render_wake();
+    return 0;
+}
+
+// Runs the game on a thread of its own, while this thread handles the window and renders the frames.
+static void engine_run_threaded(game_state *gs) {
+    SDL_Event e;
+    event_lock = SDL_CreateMutex();
+    if(event_lock == NULL) {
+        PERROR("Unable to create event lock: %s", SDL_GetError());
+        engine_loop(gs);
+        return;
+    }
+    vector_create(&event_queue, sizeof(SDL_Event));
+    vector_create(&event_batch, sizeof(SDL_Event));
+    SDL_AtomicSet(&game_running, 1);
+    video_set_render_thread(true);
+
+    SDL_Thread *thread = SDL_CreateThread(engine_game_thread, "game", gs);
+    if(thread == NULL) {
+        PERROR("Unable to start game thread: %s", SDL_GetError());
+        video_set_render_thread(false);
+        engine_loop(gs);
+    } else {
+        uint64_t last = framepacer_now();
+        while(SDL_AtomicGet(&game_running)) {
+            while(SDL_PollEvent(&e)) {
+                engine_window_event(&e);
+                SDL_LockMutex(event_lock);
+                vector_append(&event_queue, &e);
+                SDL_UnlockMutex(event_lock);
             }
-            console_render();
-            video_render_finish();
-
-            // If screenshot requested, do it here.
-            if(take_screenshot) {
-                image img;
-                int failed_screenshot = video_screenshot(&img);
-                if(!failed_screenshot) {
-                    snprintf(screenshot_filename, 128, "screenshot_%u.png", SDL_GetTicks());
-                    int scr_ret = image_write_png(&img, screenshot_filename);
-                    if(scr_ret) {
-                        PERROR("Screenshot write operation failed (%s)", screenshot_filename);
-                    } else {
-                        DEBUG("Got a screenshot: %s", screenshot_filename);
-                    }
-                }
 
-                image_free(&img);
-                take_screenshot = 0;
+            uint64_t now = framepacer_now();
+            engine_mouse_tick(now - last);
+            last = now;
+
+            // Present frames as they come, unless the frame cap says otherwise
+            uint64_t next_frame = framepacer_next_frame(now);
+            if(next_frame > now) {
+                uint64_t deadline = now + STATIC_TICK_US;
+                framepacer_sleep_until((next_frame < deadline) ? next_frame : deadline);
+                continue;
+            }
+            if(video_render_frame(STATIC_TICK_US / 1000, enable_screen_updates)) {
+                framepacer_frame_done(framepacer_now());
             }
-        } else {
-            // If screen updates are disabled, then wait
-            SDL_Delay(1);
         }
+        SDL_WaitThread(thread, NULL);
+        video_set_render_thread(false);
+    }
+
+    vector_free(&event_queue);
+    vector_free(&event_batch);
+    SDL_DestroyMutex(event_lock);
+    event_lock = NULL;
+}
+
+int engine_run(engine_init_flags *init_flags) {
+    SDL_Event e;
+    int ret = 0;
+
+    INFO(" --- BEGIN GAME LOG ---");
+
+    // Game start timeout.
+    // Wait a moment so that people are mentally prepared
+    // (with the recording software on) for the game to start :)
+    if(!settings_get()->video.crossfade_on || init_flags->render || init_flags->verify) {
+        start_timeout = 0;
+    }
+    while(start_timeout > 0) {
+        start_timeout--;
+        while(SDL_PollEvent(&e)) {
+            if(e.type == SDL_QUIT) {
+                return 0;
+            }
+        }
+        video_render_prepare();
+        video_render_finish();
+    }
+
+    // apply volume settings
+    audio_set_sound_volume(settings_get()->sound.sound_vol / 10.0f);
+
+    // Set up game
+    game_state *gs = omf_calloc(1, sizeof(game_state));
+    if(game_state_create(gs, init_flags)) {
+        game_state_free(&gs);
+        return init_flags->verify ? 1 : 0;
+    }
+    if(init_flags->verify) {
+        ret = engine_run_verify(gs, init_flags);
+    } else if(init_flags->render) {
+        engine_run_offline(gs, init_flags->rec_file);
+    } else if(settings_get()->video.render_thread) {
+        engine_run_threaded(gs);
+    } else {
+        engine_loop(gs);
     }
 
     // Free scene object
     game_state_free(&gs);
 
     INFO(" --- END GAME LOG ---");
+    return ret;
 }
 
 void engine_close() {
+    profiler_close();
+    capture_close();
     console_close();
     altpals_close();
     fonts_close();
     lang_close();
+    pic_loader_close();
     sounds_loader_close();
     audio_close();
     video_close();
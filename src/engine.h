@@ -4,11 +4,16 @@
 typedef struct engine_init_flags_t {
     unsigned int net_mode;
     unsigned int record;
+    unsigned int rec_checksums; // Embed state checksums in the recorded rec_file
+    unsigned int render;        // Render rec_file to video and audio files, without a display or audio device
+    unsigned int verify;        // Play rec_file without a display, and check its trace against <rec_file>.trace
+    unsigned int bless;         // With verify, write <rec_file>.trace instead of checking against it
     char rec_file[255];
+    char relay_addr[255]; // Relay to watch a match from, with NET_MODE_SPECTATOR
 } engine_init_flags;
 
-int engine_init();                              // Init window, audiodevice, etc.
-void engine_run(engine_init_flags *init_flags); // Run game
+int engine_init(engine_init_flags *init_flags); // Init window, audiodevice, etc.
+int engine_run(engine_init_flags *init_flags);  // Run game. Returns 1 if a verified recording failed.
 void engine_close();                            // Kill window, audiodev
 
 #endif // ENGINE_H
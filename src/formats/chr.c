@@ -31,6 +31,19 @@ int sd_chr_from_trn(sd_chr_file *chr, sd_tournament_file *trn, sd_pilot *pilot)
         chr->enemies[i] = omf_calloc(1, sizeof(sd_chr_enemy));
         sd_pilot_create(&chr->enemies[i]->pilot);
         memcpy(&chr->enemies[i]->pilot, trn->enemies[i], sizeof(sd_pilot));
+        // The CHR file owns its own copies of the pilot photo and quotes, as the tournament may be freed first.
+        sd_pilot *enemy = &chr->enemies[i]->pilot;
+        if(enemy->photo != NULL) {
+            enemy->photo = omf_calloc(1, sizeof(sd_sprite));
+            sd_sprite_copy(enemy->photo, trn->enemies[i]->photo);
+        }
+        for(int m = 0; m < 10; m++) {
+            if(enemy->quotes[m] != NULL) {
+                size_t len = strlen(trn->enemies[i]->quotes[m]) + 1;
+                enemy->quotes[m] = omf_calloc(len, 1);
+                memcpy(enemy->quotes[m], trn->enemies[i]->quotes[m], len);
+            }
+        }
         if(!trn->enemies[i]->secret) {
             ranked++;
             chr->enemies[i]->pilot.rank = ranked;
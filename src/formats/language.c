@@ -2,7 +2,6 @@
 #include <string.h>
 
 #include "formats/error.h"
-#include "formats/internal/memreader.h"
 #include "formats/internal/memwriter.h"
 #include "formats/internal/reader.h"
 #include "formats/internal/writer.h"
@@ -28,6 +27,60 @@ void sd_language_free(sd_language *language) {
     }
 }
 
+/*
+ * Reads the string descriptor table in a single pass. The table ends at the first offset that
+ * points past the end of the file, or where the string data begins. Allocates count + 1 offsets,
+ * and optionally the string array with descriptions filled in. Returns the amount of strings.
+ */
+static unsigned int sd_language_read_table(sd_reader *r, uint32_t **offsets, sd_lang_string **strings) {
+    long file_size = sd_reader_filesize(r);
+    long data_start = file_size;
+    unsigned int count = 0;
+    unsigned int size = 0;
+    uint32_t offset;
+
+    while(sd_reader_pos(r) + 36 <= data_start && (offset = sd_read_udword(r)) < file_size) {
+        if(count + 1 >= size) {
+            size = (size == 0) ? 64 : size * 2;
+            *offsets = omf_realloc(*offsets, size * sizeof(uint32_t));
+            if(strings != NULL) {
+                *strings = omf_realloc(*strings, size * sizeof(sd_lang_string));
+            }
+        }
+        (*offsets)[count] = offset;
+        if(strings != NULL) {
+            memset(&(*strings)[count], 0, sizeof(sd_lang_string));
+            sd_read_buf(r, (*strings)[count].description, 32);
+            (*strings)[count].description[31] = 0;
+        } else {
+            sd_skip(r, 32);
+        }
+        if(offset < data_start) {
+            data_start = offset;
+        }
+        count++;
+    }
+    if(count > 0) {
+        (*offsets)[count] = file_size;
+    }
+    return count;
+}
+
+// Reads and decodes the string between two offsets. Returns NULL on read error.
+static char *sd_language_read_data(sd_reader *r, uint32_t start, uint32_t end) {
+    uint32_t len = (end > start) ? end - start : 0;
+    char *data = omf_calloc(len + 1, 1);
+    if(!sd_reader_set(r, start) || !sd_read_buf(r, data, len)) {
+        omf_free(data);
+        return NULL;
+    }
+    uint8_t key = len & 0xFF;
+    for(uint32_t i = 0; i < len; i++) {
+        data[i] ^= key++;
+    }
+    return data;
+}
+
 int sd_language_load(sd_language *language, const char *filename) {
     if(language == NULL || filename == NULL) {
         return SD_INVALID_INPUT;
@@ -38,62 +91,72 @@ int sd_language_load(sd_language *language, const char *filename) {
         return SD_FILE_OPEN_ERROR;
     }
 
-    // Find out how many strings there are in the file
-    unsigned int string_count = 0;
-    long file_size = sd_reader_filesize(r);
-    while(sd_read_udword(r) < file_size) {
-        sd_skip(r, 32);
-        string_count++;
-    }
-    sd_reader_set(r, 0);
+    // Read titles and offsets
+    uint32_t *offsets = NULL;
+    unsigned int count = sd_language_read_table(r, &offsets, &language->strings);
 
     // There should be at least one string
-    if(string_count <= 0) {
+    if(count == 0) {
+        omf_free(offsets);
+        omf_free(language->strings);
         sd_reader_close(r);
         return SD_FILE_INVALID_TYPE;
     }
+    language->count = count;
 
-    // Some variables etc.
-    unsigned int offset = 0;
-    unsigned int offsets[string_count + 1];
-    language->strings = omf_calloc(string_count, sizeof(sd_lang_string));
-    language->count = string_count;
-
-    // Read titles and offsets
-    unsigned int pos = 0;
-    while((offset = sd_read_udword(r)) < file_size && pos < string_count) {
-        sd_read_buf(r, language->strings[pos].description, 32);
-        language->strings[pos].description[31] = 0;
-        offsets[pos] = offset;
-        pos++;
+    // Read real titles
+    for(unsigned int i = 0; i < count; i++) {
+        language->strings[i].data = sd_language_read_data(r, offsets[i], offsets[i + 1]);
+        if(language->strings[i].data == NULL) {
+            language->strings[i].data = omf_calloc(1, 1);
+        }
     }
 
-    // Valid file with no content
-    if(pos <= 0) {
-        sd_reader_close(r);
-        return SD_SUCCESS;
-    }
+    // All done.
+    omf_free(offsets);
+    sd_reader_close(r);
+    return SD_SUCCESS;
+}
 
-    offsets[pos] = file_size;
+int sd_language_load_index(sd_language_index *index, const char *filename) {
+    if(index == NULL || filename == NULL) {
+        return SD_INVALID_INPUT;
+    }
 
-    // Read real titles
-    for(unsigned i = 0; i < pos; i++) {
-        sd_reader_set(r, offsets[i]);
-        unsigned int len = offsets[i + 1] - offsets[i];
+    sd_reader *r = sd_reader_open(filename);
+    if(!r) {
+        return SD_FILE_OPEN_ERROR;
+    }
 
-        language->strings[i].data = omf_calloc(len + 1, 1);
-        memset(language->strings[i].data, 0, len + 1);
+    memset(index, 0, sizeof(sd_language_index));
+    index->count = sd_language_read_table(r, &index->offsets, NULL);
+    sd_reader_close(r);
+    if(index->count == 0) {
+        omf_free(index->offsets);
+        return SD_FILE_INVALID_TYPE;
+    }
+    return SD_SUCCESS;
+}
 
-        // Read string
-        memreader *mr = memreader_open_from_reader(r, len);
-        memreader_xor(mr, len & 0xFF);
-        memread_buf(mr, language->strings[i].data, len);
-        memreader_close(mr);
+int sd_language_load_string(char **dst, const sd_language_index *index, const char *filename, int num) {
+    if(dst == NULL || index == NULL || filename == NULL || num < 0 || num >= index->count) {
+        return SD_INVALID_INPUT;
     }
 
-    // All done.
+    sd_reader *r = sd_reader_open(filename);
+    if(!r) {
+        return SD_FILE_OPEN_ERROR;
+    }
+    *dst = sd_language_read_data(r, index->offsets[num], index->offsets[num + 1]);
     sd_reader_close(r);
-    return SD_SUCCESS;
+    return (*dst != NULL) ? SD_SUCCESS : SD_FILE_PARSE_ERROR;
+}
+
+void sd_language_index_free(sd_language_index *index) {
+    if(index == NULL)
+        return;
+    omf_free(index->offsets);
+    index->count = 0;
 }
 
 const sd_lang_string *sd_language_get(const sd_language *language, int num) {
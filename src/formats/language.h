@@ -10,6 +10,8 @@
 #ifndef SD_LANGUAGE_H
 #define SD_LANGUAGE_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,6 +35,16 @@ typedef struct {
     sd_lang_string *strings; ///< Language string array
 } sd_language;
 
+/*! \brief Language string index
+ *
+ * Contains only the string offsets of a language file. Strings can be read one at a time
+ * with sd_language_load_string().
+ */
+typedef struct {
+    unsigned int count; ///< Amount of language strings in the file
+    uint32_t *offsets;  ///< String data offsets. Has count + 1 entries; the last one is the end of the data.
+} sd_language_index;
+
 /*! \brief Initialize language structure
  *
  * Initializes the language structure with empty values.
@@ -67,6 +79,46 @@ void sd_language_free(sd_language *language);
  */
 int sd_language_load(sd_language *language, const char *filename);
 
+/*! \brief Load the string index of a language file
+ *
+ * Reads only the string offsets of the given language file. The index must be freed with
+ * sd_language_index_free() afterwards.
+ *
+ * \retval SD_INVALID_INPUT Index or filename was NULL
+ * \retval SD_FILE_OPEN_ERROR File could not be opened.
+ * \retval SD_FILE_INVALID_TYPE File contains no strings.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param index Language index struct pointer.
+ * \param filename Name of the language file to load from.
+ */
+int sd_language_load_index(sd_language_index *index, const char *filename);
+
+/*! \brief Load and decode a single language string
+ *
+ * Reads one string using a previously loaded index. On success, *dst points to a newly
+ * allocated, zero terminated string that must be freed by the caller.
+ *
+ * \retval SD_INVALID_INPUT Invalid pointers, or string entry does not exist.
+ * \retval SD_FILE_OPEN_ERROR File could not be opened.
+ * \retval SD_FILE_PARSE_ERROR String data could not be read.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param dst Pointer to store the string pointer into.
+ * \param index Index loaded with sd_language_load_index() from the same file.
+ * \param filename Name of the language file to load from.
+ * \param num Language entry number to load.
+ */
+int sd_language_load_string(char **dst, const sd_language_index *index, const char *filename, int num);
+
+/*! \brief Free language index
+ *
+ * Frees the offsets of an index loaded with sd_language_load_index().
+ *
+ * \param index Language index struct pointer.
+ */
+void sd_language_index_free(sd_language_index *index);
+
 /*! \brief Save language file
  *
  * Saves the given language file from memory to a file on disk. The structure must be at
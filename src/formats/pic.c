@@ -30,6 +30,33 @@ void free_photos(sd_pic_file *pic) {
     }
 }
 
+static int sd_pic_read_photo(sd_reader *r, sd_pic_photo *photo) {
+    // Read start bytes
+    photo->is_player = sd_read_ubyte(r);
+    photo->sex = sd_read_uword(r);
+
+    // Read palette
+    palette_create(&photo->pal);
+    palette_load_range(r, &photo->pal, 0, 48);
+
+    // This byte is probably an "is there image data" flag
+    // TODO: Find out what this does
+    photo->unk_flag = sd_read_ubyte(r);
+
+    // Sprite
+    photo->sprite = omf_calloc(1, sizeof(sd_sprite));
+    sd_sprite_create(photo->sprite);
+    int ret = sd_sprite_load(r, photo->sprite);
+    if(ret != SD_SUCCESS) {
+        return ret;
+    }
+
+    // Fix length and width
+    photo->sprite->height++;
+    photo->sprite->width++;
+    return SD_SUCCESS;
+}
+
 int sd_pic_load(sd_pic_file *pic, const char *filename) {
     int ret = SD_FILE_PARSE_ERROR;
     if(pic == NULL || filename == NULL) {
@@ -72,29 +99,9 @@ int sd_pic_load(sd_pic_file *pic, const char *filename) {
 
         // Reserve mem
         pic->photos[i] = omf_calloc(1, sizeof(sd_pic_photo));
-
-        // Read start bytes
-        pic->photos[i]->is_player = sd_read_ubyte(r);
-        pic->photos[i]->sex = sd_read_uword(r);
-
-        // Read palette
-        palette_create(&pic->photos[i]->pal);
-        palette_load_range(r, &pic->photos[i]->pal, 0, 48);
-
-        // This byte is probably an "is there image data" flag
-        // TODO: Find out what this does
-        pic->photos[i]->unk_flag = sd_read_ubyte(r);
-
-        // Sprite
-        pic->photos[i]->sprite = omf_calloc(1, sizeof(sd_sprite));
-        sd_sprite_create(pic->photos[i]->sprite);
-        if((ret = sd_sprite_load(r, pic->photos[i]->sprite)) != SD_SUCCESS) {
+        if((ret = sd_pic_read_photo(r, pic->photos[i])) != SD_SUCCESS) {
             goto error_1;
         }
-
-        // Fix length and width
-        pic->photos[i]->sprite->height++;
-        pic->photos[i]->sprite->width++;
     }
 
     sd_reader_close(r);
@@ -168,6 +175,65 @@ error:
     return SD_FILE_WRITE_ERROR;
 }
 
+int sd_pic_load_index(sd_pic_index *index, const char *filename) {
+    int ret = SD_FILE_PARSE_ERROR;
+    if(index == NULL || filename == NULL) {
+        return SD_INVALID_INPUT;
+    }
+
+    sd_reader *r = sd_reader_open(filename);
+    if(!r) {
+        return SD_FILE_OPEN_ERROR;
+    }
+    if(sd_reader_filesize(r) < 200) {
+        goto exit_0;
+    }
+    index->photo_count = sd_read_dword(r);
+    if(index->photo_count >= 256 || index->photo_count < 0) {
+        goto exit_0;
+    }
+    sd_reader_set(r, 200);
+    for(int i = 0; i < index->photo_count; i++) {
+        index->offsets[i] = sd_read_udword(r);
+    }
+    ret = SD_SUCCESS;
+
+exit_0:
+    sd_reader_close(r);
+    return ret;
+}
+
+int sd_pic_load_photo(sd_pic_photo *photo, const sd_pic_index *index, const char *filename, int entry_id) {
+    if(photo == NULL || index == NULL || filename == NULL) {
+        return SD_INVALID_INPUT;
+    }
+    if(entry_id < 0 || entry_id >= index->photo_count) {
+        return SD_INVALID_INPUT;
+    }
+
+    sd_reader *r = sd_reader_open(filename);
+    if(!r) {
+        return SD_FILE_OPEN_ERROR;
+    }
+    memset(photo, 0, sizeof(sd_pic_photo));
+    int ret = SD_FILE_PARSE_ERROR;
+    if(sd_reader_set(r, index->offsets[entry_id])) {
+        ret = sd_pic_read_photo(r, photo);
+    }
+    if(ret != SD_SUCCESS) {
+        sd_pic_photo_free(photo);
+    }
+    sd_reader_close(r);
+    return ret;
+}
+
+void sd_pic_photo_free(sd_pic_photo *photo) {
+    if(photo->sprite) {
+        sd_sprite_free(photo->sprite);
+        omf_free(photo->sprite);
+    }
+}
+
 const sd_pic_photo *sd_pic_get(const sd_pic_file *pic, int entry_id) {
     if(entry_id < 0 || entry_id > pic->photo_count) {
         return NULL;
@@ -40,6 +40,15 @@ typedef struct {
     sd_pic_photo *photos[MAX_PIC_PHOTOS]; ///< Photo array
 } sd_pic_file;
 
+/*! \brief PIC photo offset index
+ *
+ * Contains the photo offsets of a PIC file, for loading single photos.
+ */
+typedef struct {
+    int photo_count;                  ///< Photo count
+    uint32_t offsets[MAX_PIC_PHOTOS]; ///< File offset of each photo
+} sd_pic_index;
+
 /*! \brief Initialize PIC file structure
  *
  * Initializes the PIC file structure with empty values.
@@ -74,6 +83,45 @@ void sd_pic_free(sd_pic_file *pic);
  */
 int sd_pic_load(sd_pic_file *pic, const char *filename);
 
+/*! \brief Load the photo index of a PIC file
+ *
+ * Reads only the photo count and offsets of the given PIC file. Photos can then be loaded
+ * one at a time with sd_pic_load_photo().
+ *
+ * \retval SD_INVALID_INPUT Index or filename was NULL
+ * \retval SD_FILE_OPEN_ERROR File could not be opened.
+ * \retval SD_FILE_PARSE_ERROR File does not look like a PIC file.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param index PIC index struct pointer.
+ * \param filename Name of the PIC file to load from.
+ */
+int sd_pic_load_index(sd_pic_index *index, const char *filename);
+
+/*! \brief Load a single photo from a PIC file
+ *
+ * Loads one photo entry using a previously loaded index. The photo contents must be freed
+ * with sd_pic_photo_free() afterwards.
+ *
+ * \retval SD_INVALID_INPUT Invalid pointers, or photo entry does not exist.
+ * \retval SD_FILE_OPEN_ERROR File could not be opened.
+ * \retval SD_SUCCESS Success.
+ *
+ * \param photo Photo struct pointer to load to.
+ * \param index Index loaded with sd_pic_load_index() from the same file.
+ * \param filename Name of the PIC file to load from.
+ * \param entry_id Photo picture number to load.
+ */
+int sd_pic_load_photo(sd_pic_photo *photo, const sd_pic_index *index, const char *filename, int entry_id);
+
+/*! \brief Free a single PIC photo
+ *
+ * Frees the contents of a photo loaded with sd_pic_load_photo().
+ *
+ * \param photo Photo struct pointer.
+ */
+void sd_pic_photo_free(sd_pic_photo *photo);
+
 /*! \brief Save PIC file
  *
  * Saves the given PIC file from memory to a file on disk. The structure must be at
@@ -119,9 +119,18 @@ int sd_rec_load(sd_rec_file *rec, const char *file) {
 
     // Read blocks
     for(int i = 0; i < rec->move_count; i++) {
+        // Records are not all the same size, so the count above is just a guess.
+        if(sd_reader_pos(r) >= sd_reader_filesize(r)) {
+            rec->move_count = i;
+            break;
+        }
         rec->moves[i].tick = sd_read_udword(r);
         rec->moves[i].lookup_id = sd_read_ubyte(r);
         rec->moves[i].player_id = sd_read_ubyte(r);
+        if(rec->moves[i].lookup_id == SD_REC_CHECKSUM) {
+            rec->moves[i].checksum = sd_read_udword(r);
+            continue;
+        }
         int extra_length = sd_rec_extra_len(rec->moves[i].lookup_id);
         if(extra_length > 0) {
             uint8_t action = sd_read_ubyte(r);
@@ -243,6 +252,10 @@ int sd_rec_save(sd_rec_file *rec, const char *file) {
         sd_write_udword(w, rec->moves[i].tick);
         sd_write_ubyte(w, rec->moves[i].lookup_id);
         sd_write_ubyte(w, rec->moves[i].player_id);
+        if(rec->moves[i].lookup_id == SD_REC_CHECKSUM) {
+            sd_write_udword(w, rec->moves[i].checksum);
+            continue;
+        }
 
         int extra_length = sd_rec_extra_len(rec->moves[i].lookup_id);
         if(extra_length > 0) {
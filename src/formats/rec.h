@@ -21,6 +21,14 @@
 extern "C" {
 #endif
 
+/*! \brief Lookup id of a state checksum record
+ *
+ * Not a part of the original file format. OpenOMF can write these while recording, so that it can tell
+ * where a replay stops playing out the same way the match did. The record has a 4 byte checksum
+ * instead of the action and extra data.
+ */
+#define SD_REC_CHECKSUM 100
+
 /*! \brief REC action record
  *
  * AA record of a single action during the match.
@@ -28,11 +36,12 @@ extern "C" {
  */
 typedef struct {
     uint32_t tick;      ///< Game tick at the moment of this event
-    uint8_t lookup_id;  ///< Extra content id. Valid values 2,3,5,6,10,18.
+    uint8_t lookup_id;  ///< Extra content id. Valid values 2,3,5,6,10,18 and SD_REC_CHECKSUM.
     uint8_t player_id;  ///< Player ID. 0 or 1.
     sd_action action;   ///< Player actions at this tick. A Combination of sd_rec_action enums.
     uint8_t raw_action; ///< Raw action data from the file.
     char *extra_data;   ///< Extra data. Check length using sd_rec_extra_len(). NULL if does not exist.
+    uint32_t checksum;  ///< Game state checksum at this tick. Only used by SD_REC_CHECKSUM records.
 } sd_rec_move;
 
 /*! \brief REC pilot container
@@ -2,11 +2,14 @@
 #include "console/console.h"
 #include "controller/joystick.h"
 #include "controller/keyboard.h"
+#include "controller/net_controller.h"
 #include "controller/rec_controller.h"
+#include "controller/spectator_controller.h"
 #include "formats/error.h"
 #include "formats/pilot.h"
 #include "formats/rec.h"
 #include "game/common_defines.h"
+#include "game/objects/har.h"
 #include "game/protos/object.h"
 #include "game/protos/scene.h"
 #include "game/scenes/arena.h"
@@ -27,7 +30,7 @@
 #include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
-#include "video/tcache.h"
+#include "utils/profiler.h"
 #include "video/video.h"
 #include <SDL.h>
 #include <math.h>
@@ -43,29 +46,22 @@ enum
 };
 
 static void _setup_rec_controller(game_state *gs, int player_id, sd_rec_file *rec);
+static void _setup_spectator_controller(game_state *gs, int player_id, spectator *spec);
 
 // How long the scene waits after order to move to another scene
 // Used for crossfades
 #define FRAME_WAIT_TICKS 30
 
-typedef struct {
-    int layer;      ///< Object rendering layer
-    int persistent; ///< 1 if the object should keep alive across scene boundaries
-    int singleton;  ///< 1 if object should be the only representative of its animation ID
-    object *obj;
-} render_obj;
-
 int game_state_create(game_state *gs, engine_init_flags *init_flags) {
     gs->run = 1;
     gs->paused = 0;
     gs->tick = 0;
     gs->int_tick = 0;
     gs->role = ROLE_CLIENT;
-    gs->next_requires_refresh = 0;
     gs->net_mode = init_flags->net_mode;
     gs->speed = settings_get()->gameplay.speed + 5;
     gs->init_flags = init_flags;
-    vector_create(&gs->objects, sizeof(render_obj));
+    object_pool_create(&gs->objects);
 
     // For screen shake
     gs->screen_shake_horizontal = 0;
@@ -81,6 +77,10 @@ int game_state_create(game_state *gs, engine_init_flags *init_flags) {
 
     // Disable warp (debug) speed by default. This can be set in console.
     gs->warp_speed = 0;
+    gs->desynced = 0;
+    for(int i = 0; i < CHECKSUM_HISTORY; i++) {
+        gs->checksum_ticks[i] = -1;
+    }
 
     // Set up players
     gs->sc = omf_calloc(1, sizeof(scene));
@@ -123,6 +123,38 @@ int game_state_create(game_state *gs, engine_init_flags *init_flags) {
             PERROR("Error while creating arena scene.");
             goto error_1;
         }
+    } else if(init_flags->net_mode == NET_MODE_SPECTATOR) {
+        relay_match match;
+        spectator *spec = spectator_connect(init_flags->relay_addr, &match);
+        if(spec == NULL) {
+            PERROR("Unable to watch a match on relay %s.", init_flags->relay_addr);
+            goto error_0;
+        }
+
+        nscene = SCENE_ARENA0 + match.arena_id;
+        if(scene_create(gs->sc, gs, nscene)) {
+            PERROR("Error while loading scene %d.", nscene);
+            spectator_free(spec);
+            goto error_0;
+        }
+
+        // set the HAR colors, pilot, har type
+        for(int i = 0; i < 2; i++) {
+            sd_pilot_set_player_color(gs->players[i]->pilot, PRIMARY, match.pilots[i].color_3);
+            sd_pilot_set_player_color(gs->players[i]->pilot, SECONDARY, match.pilots[i].color_2);
+            sd_pilot_set_player_color(gs->players[i]->pilot, TERTIARY, match.pilots[i].color_1);
+            gs->players[i]->pilot->har_id = match.pilots[i].har_id;
+            gs->players[i]->pilot->pilot_id = match.pilots[i].pilot_id;
+        }
+
+        // Netplay runs at a fixed speed, and so must the spectators
+        game_state_set_speed(gs, 10);
+        _setup_spectator_controller(gs, 0, spec);
+        _setup_spectator_controller(gs, 1, spec);
+        if(arena_create(gs->sc)) {
+            PERROR("Error while creating arena scene.");
+            goto error_1;
+        }
     } else {
         // Select correct starting scene and load resources
         nscene = (init_flags->net_mode == NET_MODE_NONE ? SCENE_OPENOMF : SCENE_MENU);
@@ -156,7 +188,7 @@ error_1:
     scene_free(gs->sc);
 error_0:
     omf_free(gs->sc);
-    vector_free(&gs->objects);
+    object_pool_free(&gs->objects);
     return 1;
 }
 
@@ -168,28 +200,24 @@ error_0:
  * \param persistent Should object keep active across scene boundaries ?
  */
 int game_state_add_object(game_state *gs, object *obj, int layer, int singleton, int persistent) {
-    render_obj o;
-    o.obj = obj;
-    o.layer = layer;
-    o.singleton = singleton;
-    o.persistent = persistent;
+    object_pool *pool = &gs->objects;
     animation *new_ani = object_get_animation(obj);
     if(singleton) {
-        iterator it;
-        render_obj *robj;
-        vector_iter_begin(&gs->objects, &it);
-        while((robj = iter_next(&it)) != NULL) {
-            animation *ani = object_get_animation(robj->obj);
-            if(ani != NULL && ani->id == new_ani->id && robj->singleton) {
+        for(unsigned int i = 0; i < pool->count; i++) {
+            if(pool->objs[i] == NULL || !(pool->flags[i] & OBJECT_POOL_SINGLETON))
+                continue;
+            animation *ani = object_get_animation(pool->objs[i]);
+            if(ani != NULL && ani->id == new_ani->id) {
                 return 1;
             }
         }
     }
-    vector_append(&gs->objects, &o);
+    int flags = (singleton ? OBJECT_POOL_SINGLETON : 0) | (persistent ? OBJECT_POOL_PERSISTENT : 0);
+    object_pool_add(pool, obj, layer, flags);
 
 #ifdef DEBUGMODE_STFU
     animation *ani = object_get_animation(obj);
-    DEBUG("Added animation %i to game_state on layer %d.", ani->id, layer);
+    TRACE("Added animation %i to game_state on layer %d.", ani->id, layer);
 #endif
     return 0;
 }
@@ -214,16 +242,22 @@ unsigned int game_state_get_speed(game_state *gs) {
     return gs->speed;
 }
 
+// Removes the object from the pool, and frees it.
+static void game_state_remove_at(game_state *gs, unsigned int index) {
+    object *obj = gs->objects.objs[index];
+    object_pool_remove(&gs->objects, obj->handle);
+    object_free(obj);
+    omf_free(obj);
+}
+
 void game_state_del_animation(game_state *gs, int anim_id) {
-    iterator it;
-    render_obj *robj;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        animation *ani = object_get_animation(robj->obj);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] == NULL)
+            continue;
+        animation *ani = object_get_animation(pool->objs[i]);
         if(ani != NULL && ani->id == anim_id) {
-            object_free(robj->obj);
-            omf_free(robj->obj);
-            vector_delete(&gs->objects, &it);
+            game_state_remove_at(gs, i);
             DEBUG("Deleted animation %i from game_state.", anim_id);
             return;
         }
@@ -232,39 +266,32 @@ void game_state_del_animation(game_state *gs, int anim_id) {
 }
 
 void game_state_del_object(game_state *gs, object *target) {
-    iterator it;
-    render_obj *robj;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(target == robj->obj) {
-            object_free(robj->obj);
-            omf_free(robj->obj);
-            vector_delete(&gs->objects, &it);
-            return;
-        }
+    if(target == NULL || object_pool_get(&gs->objects, target->handle) != target) {
+        return;
     }
+    object_pool_remove(&gs->objects, target->handle);
+    object_free(target);
+    omf_free(target);
+}
+
+object *game_state_get_object(game_state *gs, object_handle handle) {
+    return object_pool_get(&gs->objects, handle);
 }
 
 void game_state_get_projectiles(game_state *gs, vector *obj_proj) {
-    iterator it;
-    render_obj *robj;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(object_get_layers(robj->obj) & LAYER_PROJECTILE) {
-            vector_append(obj_proj, &robj->obj);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && object_get_layers(pool->objs[i]) & LAYER_PROJECTILE) {
+            vector_append(obj_proj, &pool->objs[i]);
         }
     }
 }
 
 void game_state_clear_hazards_projectiles(game_state *gs) {
-    iterator it;
-    render_obj *robj;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(object_get_group(robj->obj) == GROUP_PROJECTILE) {
-            object_free(robj->obj);
-            omf_free(robj->obj);
-            vector_delete(&gs->objects, &it);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && object_get_group(pool->objs[i]) == GROUP_PROJECTILE) {
+            game_state_remove_at(gs, i);
         }
     }
 }
@@ -301,55 +328,49 @@ int game_state_handle_event(game_state *gs, SDL_Event *event) {
     return 1;
 }
 
+// Renders all objects on a layer, except HARs. Only the dense layer array is scanned.
+static void game_state_render_layer(game_state *gs, int layer, object *har[2]) {
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->render_layer[i] != layer || pool->objs[i] == NULL)
+            continue;
+        if(pool->objs[i] == har[0] || pool->objs[i] == har[1])
+            continue;
+        object_render(pool->objs[i]);
+    }
+}
+
 void game_state_render(game_state *gs) {
-    iterator it;
-    render_obj *robj;
+    object_pool *pool = &gs->objects;
 
-    // Do palette transformations
+    // Do palette transformations. Transformations mark the colors they change, so only the resources
+    // that use those colors get redrawn. Changed colors are reset for the next frame by the renderer.
+    PROFILE_BEGIN(PROF_RENDER_PALETTE);
     screen_palette *scr_pal = video_get_pal_ref();
-    int pal_changed = 0;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(object_palette_transform(robj->obj, scr_pal) == 1) {
-            pal_changed = 1;
-            gs->next_requires_refresh = 1;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL) {
+            object_palette_transform(pool->objs[i], scr_pal);
         }
     }
-
-    // If changes were made to palette, then
-    // all resources that depend on it must be redrawn.
-    // This will take care of it.
-    if(pal_changed) {
-        scr_pal->version++;
-    } else if(gs->next_requires_refresh) {
-        // Because of caching, we might sometimes get stuck to
-        // a bad/old frame. This will fix it.
-        scr_pal->version++;
-        gs->next_requires_refresh = 0;
-    }
+    PROFILE_END(PROF_RENDER_PALETTE);
 
     // Render scene background
     scene_render(gs->sc);
 
     // Get har objects
+    PROFILE_BEGIN(PROF_RENDER_OBJECTS);
     object *har[2];
     har[0] = game_state_get_player(gs, 0)->har;
     har[1] = game_state_get_player(gs, 1)->har;
 
     // Render BOTTOM layer
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(robj->layer == RENDER_LAYER_BOTTOM) {
-            if(robj->obj == har[0] || robj->obj == har[1])
-                continue;
-            object_render(robj->obj);
-        }
-    }
+    game_state_render_layer(gs, RENDER_LAYER_BOTTOM, har);
 
     // cast object shadows (scrap, projectiles, etc)
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        object_render_shadow(robj->obj);
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL) {
+            object_render_shadow(pool->objs[i]);
+        }
     }
 
     // Render passive HARs here
@@ -360,14 +381,7 @@ void game_state_render(game_state *gs) {
     }
 
     // Render MIDDLE layer
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(robj->layer == RENDER_LAYER_MIDDLE) {
-            if(robj->obj == har[0] || robj->obj == har[1])
-                continue;
-            object_render(robj->obj);
-        }
-    }
+    game_state_render_layer(gs, RENDER_LAYER_MIDDLE, har);
 
     // Render active HARs here
     for(int i = 0; i < 2; i++) {
@@ -377,14 +391,8 @@ void game_state_render(game_state *gs) {
     }
 
     // Render TOP layer
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(robj->layer == RENDER_LAYER_TOP) {
-            if(robj->obj == har[0] || robj->obj == har[1])
-                continue;
-            object_render(robj->obj);
-        }
-    }
+    game_state_render_layer(gs, RENDER_LAYER_TOP, har);
+    PROFILE_END(PROF_RENDER_OBJECTS);
 
     // Render scene overlay (menus, etc.)
     scene_render_overlay(gs->sc);
@@ -408,19 +416,20 @@ int game_load_new(game_state *gs, int scene_id) {
     omf_free(gs->sc);
 
     // Clear up old video cache objects
-    tcache_clear();
+    video_clear_texture_cache();
 
     // Remove old objects
-    render_obj *robj;
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(!robj->persistent) {
-            object_free(robj->obj);
-            omf_free(robj->obj);
-            vector_delete(&gs->objects, &it);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && !(pool->flags[i] & OBJECT_POOL_PERSISTENT)) {
+            game_state_remove_at(gs, i);
         }
     }
+    object_pool_compact(pool);
+
+    // Old scene resources are now unreferenced, so release the scene arena.
+    // Note that texture cache must be cleared before this, since frames of the old scene may still be rendering.
+    omf_arena_reset(OMF_ARENA_SCENE);
 
     // Initialize new scene with BK data etc.
     gs->sc = omf_calloc(1, sizeof(scene));
@@ -520,15 +529,19 @@ error_0:
 }
 
 void game_state_call_collide(game_state *gs) {
-    object *a, *b;
-    unsigned int size = vector_size(&gs->objects);
-    for(int i = 0; i < size; i++) {
-        a = ((render_obj *)vector_get(&gs->objects, i))->obj;
-        for(int k = i + 1; k < size; k++) {
-            b = ((render_obj *)vector_get(&gs->objects, k))->obj;
-            if(a->group != b->group || a->group == OBJECT_NO_GROUP || b->group == OBJECT_NO_GROUP) {
-                if(a->layers & b->layers) {
-                    object_collide(a, b);
+    object_pool *pool = &gs->objects;
+    unsigned int size = pool->count;
+
+    // Pair filtering is done with the mirrored group and layer arrays, so that
+    // the object structs are only touched for pairs that may actually collide.
+    object_pool_sync(pool);
+    for(unsigned int i = 0; i < size; i++) {
+        for(unsigned int k = i + 1; k < size; k++) {
+            int8_t ga = pool->group[i];
+            int8_t gb = pool->group[k];
+            if(ga != gb || ga == OBJECT_NO_GROUP || gb == OBJECT_NO_GROUP) {
+                if(pool->layers[i] & pool->layers[k] && pool->objs[i] != NULL && pool->objs[k] != NULL) {
+                    object_collide(pool->objs[i], pool->objs[k]);
                 }
             }
         }
@@ -536,25 +549,24 @@ void game_state_call_collide(game_state *gs) {
 }
 
 void game_state_cleanup(game_state *gs) {
-    render_obj *robj;
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        if(object_finished(robj->obj)) {
-            /*DEBUG("Animation object %d is finished, removing.", robj->obj->cur_animation->id);*/
-            object_free(robj->obj);
-            omf_free(robj->obj);
-            vector_delete(&gs->objects, &it);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && object_finished(pool->objs[i])) {
+            /*DEBUG("Animation object %d is finished, removing.", pool->objs[i]->cur_animation->id);*/
+            game_state_remove_at(gs, i);
         }
     }
+
+    // Reclaim all entries removed since the last cleanup in one pass.
+    object_pool_compact(pool);
 }
 
 void game_state_call_move(game_state *gs) {
-    render_obj *robj;
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        object_move(robj->obj);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL) {
+            object_move(pool->objs[i]);
+        }
     }
 }
 
@@ -591,14 +603,14 @@ void game_state_ctrl_events_free(game_state *gs) {
 
 // This function is called with changing interval, depending on the value of game speed
 void game_state_call_tick(game_state *gs, int mode) {
-    render_obj *robj;
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] == NULL)
+            continue;
         if(mode == TICK_DYNAMIC) {
-            object_dynamic_tick(robj->obj);
+            object_dynamic_tick(pool->objs[i]);
         } else {
-            object_static_tick(robj->obj);
+            object_static_tick(pool->objs[i]);
         }
     }
 
@@ -631,6 +643,17 @@ void game_state_static_tick(game_state *gs) {
     game_state_call_tick(gs, TICK_STATIC);
 }
 
+// Lockstep netplay can only move on once the inputs of both players are in
+static int game_state_inputs_ready(game_state *gs) {
+    for(int i = 0; i < game_state_num_players(gs); i++) {
+        controller *c = game_player_get_ctrl(game_state_get_player(gs, i));
+        if(c && c->type == CTRL_TYPE_NETWORK && !net_controller_lockstep_ready(c)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
 // This function is called when the game speed requires it
 void game_state_dynamic_tick(game_state *gs) {
     // We want to load another scene
@@ -656,6 +679,12 @@ void game_state_dynamic_tick(game_state *gs) {
         }
     }
 
+    // Wait for the peer. int_tick keeps going, since it is used for ping calculation.
+    if(!game_state_inputs_ready(gs)) {
+        gs->int_tick++;
+        return;
+    }
+
     // Change the screen shake value downwards
     if(gs->screen_shake_horizontal > 0 && !gs->paused) {
         gs->screen_shake_horizontal--;
@@ -683,28 +712,40 @@ void game_state_dynamic_tick(game_state *gs) {
         video_move_target(0, 0);
     }
 
+    PROFILE_BEGIN(PROF_DYN_CONTROLLERS);
     game_state_dyntick_controllers(gs);
+    PROFILE_END(PROF_DYN_CONTROLLERS);
 
     // Tick scene
+    PROFILE_BEGIN(PROF_DYN_SCENE);
     scene_dynamic_tick(gs->sc, game_state_is_paused(gs));
 
     // Poll input. If console is opened, do not poll the controllers.
     if(!console_window_is_open()) {
         scene_input_poll(gs->sc);
     }
+    PROFILE_END(PROF_DYN_SCENE);
 
     if(!game_state_is_paused(gs)) {
         // Clean up objects
+        PROFILE_BEGIN(PROF_DYN_CLEANUP);
         game_state_cleanup(gs);
+        PROFILE_END(PROF_DYN_CLEANUP);
 
         // Call object_move for all objects
+        PROFILE_BEGIN(PROF_DYN_MOVE);
         game_state_call_move(gs);
+        PROFILE_END(PROF_DYN_MOVE);
 
         // Handle physics for all pairs of objects
+        PROFILE_BEGIN(PROF_DYN_COLLIDE);
         game_state_call_collide(gs);
+        PROFILE_END(PROF_DYN_COLLIDE);
 
         // Tick all objects
+        PROFILE_BEGIN(PROF_DYN_OBJECTS);
         game_state_call_tick(gs, TICK_DYNAMIC);
+        PROFILE_END(PROF_DYN_OBJECTS);
 
         // Increment tick
         gs->tick++;
@@ -714,6 +755,12 @@ void game_state_dynamic_tick(game_state *gs) {
     // Free extra controller events
     game_state_ctrl_events_free(gs);
 
+    // Release all tick-transient allocations (controller events, etc.)
+    omf_arena_reset(OMF_ARENA_TICK);
+
+    // Emit allocation statistics for this tick, if tracking is enabled
+    omf_alloc_tick_end(gs->int_tick);
+
     // int_tick is used for ping calculation so it shouldn't be touched
     gs->int_tick++;
 }
@@ -804,6 +851,15 @@ static void _setup_rec_controller(game_state *gs, int player_id, sd_rec_file *re
     game_player_set_ctrl(player, ctrl);
 }
 
+static void _setup_spectator_controller(game_state *gs, int player_id, spectator *spec) {
+    controller *ctrl = omf_calloc(1, sizeof(controller));
+    game_player *player = game_state_get_player(gs, player_id);
+    controller_init(ctrl);
+
+    spectator_controller_create(ctrl, player_id, spec);
+    game_player_set_ctrl(player, ctrl);
+}
+
 void reconfigure_controller(game_state *gs) {
     settings_keyboard *k = &settings_get()->keys;
     if(k->ctrl_type1 == CTRL_TYPE_KEYBOARD) {
@@ -850,15 +906,13 @@ void game_state_free(game_state **_gs) {
     *_gs = NULL;
 
     // Free objects
-    render_obj *robj;
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    while((robj = iter_next(&it)) != NULL) {
-        object_free(robj->obj);
-        omf_free(robj->obj);
-        vector_delete(&gs->objects, &it);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL) {
+            game_state_remove_at(gs, i);
+        }
     }
-    vector_free(&gs->objects);
+    object_pool_free(pool);
 
     // Free scene
     scene_free(gs->sc);
@@ -892,9 +946,104 @@ int game_state_ms_per_dyntick(game_state *gs) {
     return MS_PER_OMF_TICK;
 }
 
+#define STATE_HASH_INIT 2166136261u
+
+// FNV-1a; cheap enough to run over the whole serialized state every tick. Continues from the given hash.
+static uint32_t state_hash(uint32_t hash, const char *data, size_t len) {
+    for(size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void game_state_serialize_body(game_state *gs, serial *ser);
+
+/*
+ * Checksum of the simulation state; the same data that game_state_serialize() writes, apart from the checksum
+ * of the tick it carries. Two games that have been fed the same inputs should end up with the same checksum on
+ * every tick.
+ */
+uint32_t game_state_checksum(game_state *gs) {
+    serial ser;
+    serial_create(&ser);
+    serial_write_int32(&ser, game_state_get_tick(gs));
+    game_state_serialize_body(gs, &ser);
+    uint32_t hash = state_hash(STATE_HASH_INIT, ser.data, serial_len(&ser));
+    serial_free(&ser);
+    return hash;
+}
+
+// Keeps the checksum of the state at the start of the current tick
+void game_state_add_tick_checksum(game_state *gs, uint32_t checksum) {
+    gs->tick_checksums[gs->tick % CHECKSUM_HISTORY] = checksum;
+    gs->checksum_ticks[gs->tick % CHECKSUM_HISTORY] = gs->tick;
+}
+
+// Finds the checksum of the state at the start of the given tick. Returns 1 if it is no longer kept.
+static int game_state_find_tick_checksum(game_state *gs, unsigned int tick, uint32_t *checksum) {
+    if(gs->checksum_ticks[tick % CHECKSUM_HISTORY] != (int)tick) {
+        return 1;
+    }
+    *checksum = gs->tick_checksums[tick % CHECKSUM_HISTORY];
+    return 0;
+}
+
+// Forgets the checksums of the ticks from the given one on, since the state they were taken from was replaced
+static void game_state_drop_tick_checksums(game_state *gs, unsigned int tick) {
+    for(int i = 0; i < CHECKSUM_HISTORY; i++) {
+        if(gs->checksum_ticks[i] >= (int)tick) {
+            gs->checksum_ticks[i] = -1;
+        }
+    }
+}
+
+static void game_state_dump_object(const char *name, object *obj) {
+    INFO("%s: pos %f,%f vel %f,%f gravity %f direction %d", name, fixedpt_to_float(obj->pos.x),
+         fixedpt_to_float(obj->pos.y), fixedpt_to_float(obj->vel.x), fixedpt_to_float(obj->vel.y),
+         fixedpt_to_float(obj->gravity), obj->direction);
+    INFO("%s: animation %d tick %d age %d seed %u", name, obj->cur_animation->id,
+         obj->animation_state.current_tick, obj->age, random_get_seed(&obj->rand_state));
+}
+
+// Logs the simulation state, so that it can be compared with the other side after a desync
+void game_state_dump(game_state *gs) {
+    INFO("State at tick %d: seed %u, paused %d", gs->tick, rand_get_seed(), game_state_is_paused(gs));
+    for(int i = 0; i < 2; i++) {
+        game_player *player = game_state_get_player(gs, i);
+        if(player->har == NULL) {
+            continue;
+        }
+        har *h = object_get_userdata(player->har);
+        const char *name = (i == 0) ? "har 1" : "har 2";
+        game_state_dump_object(name, player->har);
+        INFO("%s: state %d executing %d flinching %d health %d endurance %f score %d", name, h->state,
+             h->executing_move, h->flinching, h->health, h->endurance, game_player_get_score(player)->score);
+    }
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && pool->objs[i]->group == GROUP_PROJECTILE) {
+            game_state_dump_object("projectile", pool->objs[i]);
+        }
+    }
+}
+
+/*
+ * Writes the state. After the tick comes the checksum of the state at the start of the tick, if it is known,
+ * so that the receiving end can tell whether it had the same state on that tick.
+ */
 int game_state_serialize(game_state *gs, serial *ser) {
-    // serialize tick time and random seed, so client can reply state from this point
+    uint32_t checksum = 0;
+    int known = game_state_find_tick_checksum(gs, gs->tick, &checksum) == 0;
     serial_write_int32(ser, game_state_get_tick(gs));
+    serial_write_int8(ser, known);
+    serial_write_int32(ser, checksum);
+    game_state_serialize_body(gs, ser);
+    return 0;
+}
+
+static void game_state_serialize_body(game_state *gs, serial *ser) {
+    // serialize random seed, so client can reply state from this point
     serial_write_int32(ser, rand_get_seed());
     serial_write_int32(ser, game_state_is_paused(gs));
 
@@ -909,32 +1058,48 @@ int game_state_serialize(game_state *gs, serial *ser) {
     serial_create(&objects);
 
     // serialize any HAZARD or PROJECTILE objects
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    render_obj *robj;
+    object_pool *pool = &gs->objects;
     uint8_t count = 0;
-    while((robj = iter_next(&it)) != NULL) {
-        if(robj->obj->group == GROUP_PROJECTILE) {
-            serial_write_int8(&objects, robj->layer);
-            object_serialize(robj->obj, &objects);
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && pool->objs[i]->group == GROUP_PROJECTILE) {
+            serial_write_int8(&objects, pool->render_layer[i]);
+            object_serialize(pool->objs[i], &objects);
             count++;
         }
     }
     serial_write_int8(ser, count);
 
-    serial_write(ser, objects.data, objects.len);
+    serial_write(ser, objects.data, serial_len(&objects));
     serial_free(&objects);
 
     chr_score_serialize(game_player_get_score(game_state_get_player(gs, 0)), ser);
     chr_score_serialize(game_player_get_score(game_state_get_player(gs, 1)), ser);
-
-    return 0;
 }
 
 int game_state_unserialize(game_state *gs, serial *ser, int rtt) {
     int old_tick = gs->tick;
+    size_t start = ser->rpos;
     gs->tick = serial_read_int32(ser);
+    int known = serial_read_int8(ser);
+    uint32_t server_checksum = serial_read_int32(ser);
+    size_t body = ser->rpos;
     int end_tick = gs->tick + ceilf(rtt / 2.0f);
+
+    // Before the state is replaced, check that we had the same one as the server at the start of the tick
+    uint32_t own_checksum;
+    if(known && game_state_find_tick_checksum(gs, gs->tick, &own_checksum) == 0 &&
+       own_checksum != server_checksum) {
+        if(!gs->desynced) {
+            PERROR("Desync at tick %d: state checksum %08x, server had %08x", gs->tick, own_checksum,
+                   server_checksum);
+            game_state_dump(gs);
+            gs->desynced = 1;
+        } else {
+            DEBUG("state differs from the server at tick %d", gs->tick);
+        }
+    }
+    game_state_drop_tick_checksums(gs, gs->tick);
+
     rand_seed(serial_read_int32(ser));
     game_state_set_paused(gs, serial_read_int32(ser));
 
@@ -947,7 +1112,7 @@ int game_state_unserialize(game_state *gs, serial *ser, int rtt) {
         // Create object and specialize it as HAR.
         // Errors are unlikely here, but check anyway.
 
-        object_create(obj, gs, vec2i_create(0, 0), vec2f_create(0, 0));
+        object_create(obj, gs, vec2i_create(0, 0), vec2fx_create(0, 0));
         object_unserialize(obj, ser, gs);
 
         // Set HAR to controller and game_player
@@ -967,14 +1132,10 @@ int game_state_unserialize(game_state *gs, serial *ser, int rtt) {
     obj_har2->animation_state.enemy = obj_har1;
 
     // clean out any current projectiles/hazards
-    iterator it;
-    vector_iter_begin(&gs->objects, &it);
-    render_obj *robj;
-    while((robj = iter_next(&it)) != NULL) {
-        if(robj->obj->group == GROUP_PROJECTILE) {
-            object_free(robj->obj);
-            omf_free(robj->obj);
-            vector_delete(&gs->objects, &it);
+    object_pool *pool = &gs->objects;
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL && pool->objs[i]->group == GROUP_PROJECTILE) {
+            game_state_remove_at(gs, i);
         }
     }
 
@@ -983,9 +1144,9 @@ int game_state_unserialize(game_state *gs, serial *ser, int rtt) {
     for(int i = 0; i < count; i++) {
         object *obj = omf_calloc(1, sizeof(object));
         int layer = serial_read_int8(ser);
-        object_create(obj, gs, vec2i_create(0, 0), vec2f_create(0, 0));
+        object_create(obj, gs, vec2i_create(0, 0), vec2fx_create(0, 0));
         object_unserialize(obj, ser, gs);
-        DEBUG("newly added object finish status %d", object_finished(obj));
+        TRACE("newly added object finish status %d", object_finished(obj));
 
         game_state_add_object(gs, obj, layer, 0, 0);
     }
@@ -993,8 +1154,24 @@ int game_state_unserialize(game_state *gs, serial *ser, int rtt) {
     chr_score_unserialize(game_player_get_score(game_state_get_player(gs, 0)), ser);
     chr_score_unserialize(game_player_get_score(game_state_get_player(gs, 1)), ser);
 
+    // The restored state should serialize back to exactly what the server sent. If it does not, something
+    // was lost on the way and we are now simulating from a different state than the server is. The checksum
+    // of the server is not part of the state.
+    uint32_t sent = state_hash(STATE_HASH_INIT, ser->data + start, body - start - 5);
+    sent = state_hash(sent, ser->data + body, ser->rpos - body);
+    uint32_t restored = game_state_checksum(gs);
+    if(sent != restored) {
+        if(!gs->desynced) {
+            PERROR("Desync at tick %d: restored state checksum %08x, server sent %08x", gs->tick, restored, sent);
+            game_state_dump(gs);
+            gs->desynced = 1;
+        } else {
+            DEBUG("restored state differs at tick %d", gs->tick);
+        }
+    }
+
     // tick things back to the current time
-    DEBUG("replaying %d ticks", end_tick - gs->tick);
+    TRACE("replaying %d ticks", end_tick - gs->tick);
     DEBUG("adjusting clock from %d to %d (%d)", old_tick, end_tick, ceilf(rtt / 2.0f));
     while(gs->tick <= end_tick) {
         game_state_cleanup(gs);
@@ -32,6 +32,9 @@ int game_state_ms_per_dyntick(game_state *gs);
 ticktimer *game_state_get_ticktimer(game_state *gs);
 int game_state_serialize(game_state *gs, serial *ser);
 int game_state_unserialize(game_state *gs, serial *ser, int rtt);
+uint32_t game_state_checksum(game_state *gs);
+void game_state_add_tick_checksum(game_state *gs, uint32_t checksum);
+void game_state_dump(game_state *gs);
 
 void _setup_keyboard(game_state *gs, int player_id);
 void _setup_ai(game_state *gs, int player_id);
@@ -48,6 +51,7 @@ unsigned int game_state_get_speed(game_state *gs);
 
 int game_state_add_object(game_state *gs, object *obj, int layer, int singleton, int persistent);
 void game_state_del_object(game_state *gs, object *obj);
+object *game_state_get_object(game_state *gs, object_handle handle);
 void game_state_del_animation(game_state *gs, int anim_id);
 void game_state_get_projectiles(game_state *gs, vector *obj_proj);
 void game_state_clear_hazards_projectiles(game_state *gs);
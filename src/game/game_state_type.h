@@ -2,6 +2,8 @@
 #define GAME_STATE_TYPE_H
 
 #include "engine.h"
+#include "game/utils/object_pool.h"
+#include "game/utils/replay_trace.h"
 #include "utils/vector.h"
 
 enum
@@ -21,9 +23,13 @@ enum
 {
     NET_MODE_NONE,
     NET_MODE_CLIENT,
-    NET_MODE_SERVER
+    NET_MODE_SERVER,
+    NET_MODE_SPECTATOR
 };
 
+// Amount of past ticks whose state checksums are kept around, for comparing against the ones of the server
+#define CHECKSUM_HISTORY 128
+
 typedef struct scene_t scene;
 typedef struct game_player_t game_player;
 typedef struct ticktimer_t ticktimer;
@@ -55,10 +61,19 @@ typedef struct game_state_t {
     // For debugging, sets fastest possible mode :)
     int warp_speed;
 
-    int next_requires_refresh; // If next frame requires a texture refresh, this should be set to 1
-    int net_mode;              // NET_MODE_NONE, NET_MODE_CLIENT, NET_MODE_SERVER
+    // Set when the state is found to have diverged. Only the first divergence is worth a state dump.
+    int desynced;
+
+    // Checksums of the state at the start of the last ticks, and the ticks they are for, or -1 if unused
+    uint32_t tick_checksums[CHECKSUM_HISTORY];
+    int checksum_ticks[CHECKSUM_HISTORY];
+
+    // Trace of the playback when verifying a recording, or NULL
+    replay_trace *trace;
+
+    int net_mode; // NET_MODE_NONE, NET_MODE_CLIENT, NET_MODE_SERVER
     scene *sc;
-    vector objects;
+    object_pool objects;
     game_player *players[2];
 } game_state;
 
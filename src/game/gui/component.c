@@ -31,6 +31,7 @@ int component_action(component *c, int action) {
 }
 
 void component_layout(component *c, int x, int y, int w, int h) {
+    component_invalidate(c);
     c->x = x;
     c->y = y;
     c->w = w;
@@ -38,24 +39,34 @@ void component_layout(component *c, int x, int y, int w, int h) {
     if(c->layout) {
         c->layout(c, x, y, w, h);
     }
+    component_invalidate(c);
 }
 
 void component_disable(component *c, int disabled) {
     if(!c->supports_disable)
         return;
-    c->is_disabled = (disabled != 0) ? 1 : 0;
+    char value = (disabled != 0) ? 1 : 0;
+    if(c->is_disabled != value) {
+        c->is_disabled = value;
+        component_invalidate(c);
+    }
 }
 
 void component_select(component *c, int selected) {
     if(!c->supports_select)
         return;
-    c->is_selected = (selected != 0) ? 1 : 0;
+    char value = (selected != 0) ? 1 : 0;
+    if(c->is_selected != value) {
+        c->is_selected = value;
+        component_invalidate(c);
+    }
 }
 
 void component_focus(component *c, int focused) {
     if(!c->supports_focus)
         return;
     c->is_focused = (focused != 0) ? 1 : 0;
+    component_invalidate(c);
     if(c->focus) {
         DEBUG("running component focus cb");
         c->focus(c, c->is_focused == 1);
@@ -81,6 +92,36 @@ bool component_is_selectable(component *c) {
     return true;
 }
 
+/*
+ * Marks the area of the component as needing a redraw. The area is collected on the root component,
+ * where the owning guiframe picks it up on the next render.
+ */
+void component_invalidate(component *c) {
+    SDL_Rect area = {c->x - COMPONENT_DIRTY_MARGIN, c->y - COMPONENT_DIRTY_MARGIN, c->w + COMPONENT_DIRTY_MARGIN * 2,
+                     c->h + COMPONENT_DIRTY_MARGIN * 2};
+    while(c->parent != NULL) {
+        c = c->parent;
+    }
+    if(c->has_dirty) {
+        SDL_UnionRect(&c->dirty, &area, &c->dirty);
+    } else {
+        c->dirty = area;
+        c->has_dirty = 1;
+    }
+}
+
+/*
+ * Gets and clears the dirty area collected on a root component. Returns 1 if there was one.
+ */
+int component_take_dirty(component *c, SDL_Rect *area) {
+    if(!c->has_dirty) {
+        return 0;
+    }
+    *area = c->dirty;
+    c->has_dirty = 0;
+    return 1;
+}
+
 int component_is_focused(const component *c) {
     if(!c->supports_focus)
         return 0;
@@ -24,6 +24,9 @@ enum
     COM_SELECTED = 1,   ///< Component selected. Used in eg. menu sizers.
 };
 
+/// How far outside of its own area a widget may draw (eg. textbutton borders). Used for dirty areas.
+#define COMPONENT_DIRTY_MARGIN 4
+
 typedef struct component_t component;
 
 typedef void (*component_render_cb)(component *c);
@@ -76,6 +79,9 @@ struct component_t {
 
     component
         *parent; ///< Parent component. For widgets, this should be always a sizer. For root sizer it will be NULL.
+
+    SDL_Rect dirty; ///< Area that needs to be redrawn. Only used on the root component.
+    char has_dirty; ///< Whether the dirty area is set.
 };
 
 // Create & free
@@ -98,6 +104,9 @@ int component_is_focused(const component *c);
 
 bool component_is_selectable(component *c);
 
+void component_invalidate(component *c);
+int component_take_dirty(component *c, SDL_Rect *area);
+
 void component_set_size_hints(component *c, int w, int h);
 void component_set_pos_hints(component *c, int x, int y);
 
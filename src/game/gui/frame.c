@@ -7,6 +7,7 @@ guiframe *guiframe_create(int x, int y, int w, int h) {
     frame->y = y;
     frame->w = w;
     frame->h = h;
+    frame->cache = video_cache_create();
     return frame;
 }
 
@@ -18,6 +19,7 @@ void guiframe_set_root(guiframe *frame, component *root_node) {
         component_free(frame->root_node);
     }
     frame->root_node = root_node;
+    video_cache_invalidate(frame->cache);
 }
 
 void guiframe_free(guiframe *frame) {
@@ -27,6 +29,7 @@ void guiframe_free(guiframe *frame) {
     if(frame->root_node) {
         component_free(frame->root_node);
     }
+    video_cache_free(frame->cache);
     omf_free(frame);
 }
 
@@ -47,21 +50,50 @@ void guiframe_tick(guiframe *frame) {
     }
 }
 
+/*
+ * Renders the frame from its cache. Only the areas that components have marked dirty since the last
+ * render are redrawn; if the renderer can't cache, everything is rendered directly every frame.
+ */
 void guiframe_render(guiframe *frame) {
-    if(frame->root_node) {
+    if(!frame->root_node) {
+        return;
+    }
+    SDL_Rect dirty;
+    int has_dirty = component_take_dirty(frame->root_node, &dirty);
+    if(video_cache_is_valid(frame->cache) && !has_dirty) {
+        video_cache_render(frame->cache);
+        return;
+    }
+    if(!video_cache_is_valid(frame->cache)) {
+        dirty.x = 0;
+        dirty.y = 0;
+        dirty.w = NATIVE_W;
+        dirty.h = NATIVE_H;
+    }
+    if(!video_cache_begin(frame->cache, dirty.x, dirty.y, dirty.w, dirty.h)) {
         component_render(frame->root_node);
+        return;
     }
+    component_render(frame->root_node);
+    video_cache_end(frame->cache);
+    video_cache_render(frame->cache);
 }
 
 int guiframe_event(guiframe *frame, SDL_Event *event) {
     if(frame->root_node) {
-        return component_event(frame->root_node, event);
+        int ret = component_event(frame->root_node, event);
+        if(ret == 0) {
+            video_cache_invalidate(frame->cache);
+        }
+        return ret;
     }
     return 1;
 }
 
 int guiframe_action(guiframe *frame, int action) {
     if(frame->root_node) {
+        // Actions can change any part of the menu tree, eg. by switching submenus.
+        video_cache_invalidate(frame->cache);
         return component_action(frame->root_node, action);
     }
     return 1;
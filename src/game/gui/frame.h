@@ -2,6 +2,7 @@
 #define FRAME_H
 
 #include "game/gui/component.h"
+#include "video/video.h"
 
 typedef struct {
     int x;
@@ -9,6 +10,7 @@ typedef struct {
     int w;
     int h;
     component *root_node;
+    video_cache *cache; ///< Last rendered frame contents; only dirty areas are redrawn
 } guiframe;
 
 guiframe *guiframe_create(int x, int y, int w, int h);
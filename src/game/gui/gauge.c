@@ -138,6 +138,7 @@ void gauge_set_lit(component *c, int lit) {
     if(lit != g->lit) {
         g->lit = lit;
         gauge_update(c);
+        component_invalidate(c);
     }
 }
 
@@ -159,6 +160,7 @@ void gauge_set_size(component *c, int size) {
             g->lit = g->size;
         }
         gauge_update(c);
+        component_invalidate(c);
     }
 }
 
@@ -22,9 +22,13 @@ static void label_free(component *c) {
 void label_set_text(component *c, const char *text) {
     label *local = widget_get_obj(c);
     if(local->text) {
+        if(strcmp(local->text, text) == 0) {
+            return;
+        }
         omf_free(local->text);
     }
     local->text = strdup(text);
+    component_invalidate(c);
 }
 
 text_settings *label_get_text_settings(component *c) {
@@ -54,6 +54,7 @@ void menu_set_submenu_done_cb(component *c, menu_submenu_done_cb done_cb) {
 
 void menu_attach(component *c, component *nc) {
     sizer_attach(c, nc);
+    component_invalidate(c);
 }
 
 static void menu_tick(component *c) {
@@ -61,11 +62,17 @@ static void menu_tick(component *c) {
 
     // If submenu is set, we need to tick it
     if(m->submenu != NULL && !menu_is_finished(m->submenu)) {
-        return component_tick(m->submenu);
+        component_tick(m->submenu);
+        // Submenus may finish themselves, eg. on network events
+        if(menu_is_finished(m->submenu)) {
+            component_invalidate(c);
+        }
+        return;
     }
 
     // Check if we need to run submenu done -callback
     if(m->submenu != NULL && menu_is_finished(m->submenu) && !m->prev_submenu_state) {
+        component_invalidate(c);
         if(m->submenu_done) {
             m->submenu_done(c, m->submenu);
         }
@@ -182,6 +189,7 @@ void menu_set_submenu(component *mc, component *submenu) {
     m->prev_submenu_state = 0;
     submenu->parent = mc; // Set correct parent
     component_layout(m->submenu, mc->x, mc->y, mc->w, mc->h);
+    component_invalidate(mc);
 }
 
 void menu_link_menu(component *mc, guiframe *linked_menu) {
@@ -193,6 +201,7 @@ void menu_link_menu(component *mc, guiframe *linked_menu) {
     m->prev_submenu_state = 0;
     linked_menu->root_node->parent = mc; // Set correct parent
     component_layout(m->submenu, linked_menu->x, linked_menu->y, linked_menu->w, linked_menu->h);
+    component_invalidate(mc);
 }
 
 component *menu_get_submenu(const component *c) {
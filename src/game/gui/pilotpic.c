@@ -1,8 +1,6 @@
 #include "game/gui/pilotpic.h"
-#include "formats/error.h"
-#include "formats/pic.h"
 #include "game/gui/widget.h"
-#include "resources/pathmanager.h"
+#include "resources/pic_loader.h"
 #include "resources/sprite.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
@@ -31,31 +29,7 @@ static void pilotpic_free(component *c) {
 }
 
 int pilotpic_load(sd_sprite *sprite, palette *pal, int pic_id, int pilot_id) {
-    const char *filename = pm_get_resource_path(pic_id);
-    if(filename == NULL) {
-        PERROR("Could not find requested PIC file handle.");
-        return SD_FILE_OPEN_ERROR;
-    }
-
-    // Load PIC file and make a surface
-    sd_pic_file pics;
-    sd_pic_create(&pics);
-    int ret = sd_pic_load(&pics, filename);
-    if(ret != SD_SUCCESS) {
-        PERROR("Could not load PIC file %s: %s", filename, sd_get_error(ret));
-        return ret;
-    } else {
-        DEBUG("PIC file %s loaded, selecting picture %d.", get_resource_name(pic_id), pilot_id);
-    }
-
-    // Create new
-    const sd_pic_photo *photo = sd_pic_get(&pics, pilot_id);
-    sd_sprite_copy(sprite, photo->sprite);
-    palette_copy(pal, &photo->pal, 0, 48);
-    // Free pics
-    sd_pic_free(&pics);
-
-    return SD_SUCCESS;
+    return pic_loader_get(pic_id, pilot_id, sprite, pal);
 }
 
 void pilotpic_select(component *c, int pic_id, int pilot_id) {
@@ -80,8 +54,12 @@ void pilotpic_select(component *c, int pic_id, int pilot_id) {
 
     // Save some information
     local->selected = pilot_id;
-    local->max = 4; // TODO pics.photo_count;
+    local->max = pic_loader_photo_count(pic_id);
+    if(local->max < 1) {
+        local->max = 1;
+    }
     local->pic_id = pic_id;
+    component_invalidate(c);
 }
 
 void pilotpic_next(component *c) {
@@ -119,6 +97,7 @@ void pilotpic_set_photo(component *c, sd_sprite *spr) {
 
     sprite_create(local->img, spr, -1);
     component_set_size_hints(c, local->img->data->w, local->img->data->h);
+    component_invalidate(c);
 }
 
 component *pilotpic_create(int pic_id, int pilot_id) {
@@ -55,8 +55,10 @@ typedef struct {
 void progressbar_set_progress(component *c, int percentage) {
     progressbar *bar = widget_get_obj(c);
     int tmp = clamp(percentage, 0, 100);
-    if(!bar->refresh)
-        bar->refresh = (tmp != bar->percentage);
+    if(tmp != bar->percentage) {
+        bar->refresh = 1;
+        component_invalidate(c);
+    }
     bar->percentage = tmp;
 }
 
@@ -65,6 +67,7 @@ void progressbar_set_flashing(component *c, int flashing, int rate) {
     if(flashing != bar->flashing) {
         bar->tick = 0;
         bar->state = 0;
+        component_invalidate(c);
     }
     bar->flashing = clamp(flashing, 0, 1);
     bar->rate = (rate < 0) ? 0 : rate;
@@ -123,6 +126,7 @@ static void progressbar_tick(component *c) {
         if(bar->tick > bar->rate) {
             bar->tick = 0;
             bar->state = !bar->state;
+            component_invalidate(c);
         }
         bar->tick++;
     }
@@ -49,10 +49,13 @@ static void spritebutton_tick(component *c) {
     spritebutton *sb = widget_get_obj(c);
     if(sb->active > 0) {
         sb->active--;
+        component_invalidate(c);
     }
 
+    // Tick callbacks may change the button in any way
     if(sb->tick_cb) {
         sb->tick_cb(c, sb->userdata);
+        component_invalidate(c);
     }
 }
 
@@ -123,4 +126,5 @@ void spritebutton_set_focus_cb(component *c, spritebutton_focus_cb cb) {
 void spritebutton_set_always_display(component *c) {
     spritebutton *sb = widget_get_obj(c);
     sb->active = -1;
+    component_invalidate(c);
 }
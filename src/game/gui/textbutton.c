@@ -31,6 +31,7 @@ void textbutton_set_border(component *c, color col) {
         // destroy the old border first
         surface_free(&tb->border);
     }
+    component_invalidate(c);
 
     // create new border
     int chars = strlen(tb->text);
@@ -43,6 +44,7 @@ void textbutton_set_border(component *c, color col) {
 void textbutton_remove_border(component *c) {
     textbutton *tb = widget_get_obj(c);
     tb->border_enabled = 0;
+    component_invalidate(c);
 }
 
 void textbutton_set_text(component *c, const char *text) {
@@ -51,6 +53,7 @@ void textbutton_set_text(component *c, const char *text) {
         omf_free(tb->text);
     }
     tb->text = strdup(text);
+    component_invalidate(c);
 }
 
 static void textbutton_render(component *c) {
@@ -100,6 +103,10 @@ static void textbutton_tick(component *c) {
     if(tb->ticks == 0) {
         tb->dir = 0;
     }
+    // Selected buttons pulse
+    if(component_is_selected(c)) {
+        component_invalidate(c);
+    }
 }
 
 static void textbutton_free(component *c) {
@@ -123,6 +123,7 @@ void textinput_set_max_chars(component *c, int max_chars) {
 void textinput_enable_background(component *c, int enabled) {
     textinput *tb = widget_get_obj(c);
     tb->bg_enabled = enabled;
+    component_invalidate(c);
 }
 
 component *textinput_create(const text_settings *tconf, const char *text, const char *initialvalue) {
@@ -33,12 +33,14 @@ void textselector_clear_options(component *c) {
 
     // Clear vector
     vector_clear(&tb->options);
+    component_invalidate(c);
 }
 
 void textselector_add_option(component *c, const char *value) {
     textselector *tb = widget_get_obj(c);
     char *new = strdup(value);
     vector_append(&tb->options, &new);
+    component_invalidate(c);
 }
 
 const char *textselector_get_current_text(const component *c) {
@@ -125,6 +127,10 @@ static void textselector_tick(component *c) {
     if(tb->ticks == 0) {
         tb->dir = 0;
     }
+    // Selected selectors pulse
+    if(component_is_selected(c)) {
+        component_invalidate(c);
+    }
 }
 
 int textselector_get_pos(const component *c) {
@@ -135,6 +141,7 @@ int textselector_get_pos(const component *c) {
 void textselector_set_pos(component *c, int pos) {
     textselector *tb = widget_get_obj(c);
     *tb->pos = pos;
+    component_invalidate(c);
 }
 
 static void textselector_free(component *c) {
@@ -12,6 +12,7 @@
 
 void trnmenu_attach(component *c, component *nc) {
     sizer_attach(c, nc);
+    component_invalidate(c);
 }
 
 static void trnmenu_hand_finished(object *hand_obj) {
@@ -58,7 +59,7 @@ void trnmenu_bind_hand(component *c, animation *hand_ani, game_state *gs) {
 
     // Set up new hand object
     m->hand.obj = omf_calloc(1, sizeof(object));
-    object_create(m->hand.obj, gs, vec2i_create(0, 0), vec2f_create(0, 0));
+    object_create(m->hand.obj, gs, vec2i_create(0, 0), vec2fx_create(0, 0));
     object_set_animation(m->hand.obj, hand_ani);
     object_set_userdata(m->hand.obj, &m->hand);
     object_set_finish_cb(m->hand.obj, trnmenu_hand_finished);
@@ -285,6 +286,11 @@ static void trnmenu_tick(component *c) {
     trnmenu *m = sizer_get_obj(c);
     sizer *s = component_get_obj(c);
 
+    // Fades and the hand change the whole menu area
+    if(m->fade || m->hand.move || m->hand.play) {
+        component_invalidate(c);
+    }
+
     // If fade is not ongoing, try to handle submenu. If fade IS ongoing, handle it.
     if(!m->fade) {
         // If submenu is set, we need to tick it
@@ -352,6 +358,10 @@ static void trnmenu_tick(component *c) {
             m->hand.moved += 0.1f;
         }
     }
+
+    if(m->fade || m->hand.move || m->hand.play) {
+        component_invalidate(c);
+    }
 }
 
 int trnmenu_is_fading(const component *c) {
@@ -402,6 +412,7 @@ void trnmenu_set_submenu(component *c, component *submenu) {
 
     m->opacity_step = -OPACITY_STEP;
     m->fade = 1;
+    component_invalidate(c);
 }
 
 component *trnmenu_get_submenu(const component *c) {
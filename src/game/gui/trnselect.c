@@ -9,14 +9,14 @@
 #include "resources/sprite.h"
 #include "resources/trnmanager.h"
 #include "utils/allocator.h"
-#include "utils/list.h"
 #include "utils/log.h"
 #include "video/video.h"
 
 // Local small gauge type
 typedef struct {
     sprite *img;
-    list *tournaments;
+    dirindex tournaments;
+    sd_tournament_file *trn; // Only the selected tournament is loaded
     component *label;
     int max;
     int selected;
@@ -107,9 +107,33 @@ void load_description(component **c, const char *desc) {
     component_layout(*c, x, vmove, width, 130 - vmove);
 }
 
+// Loads the selected tournament, and shows its logo and description.
+static void trnselect_show(trnselect *local) {
+    if(local->trn) {
+        sd_tournament_free(local->trn);
+        omf_free(local->trn);
+    }
+    if(local->max == 0) {
+        return;
+    }
+    local->trn = omf_calloc(1, sizeof(sd_tournament_file));
+    if(trn_load(local->trn, dirindex_get_filename(&local->tournaments, local->selected)) != 0) {
+        return;
+    }
+    sd_sprite *logo = local->trn->locales[0]->logo;
+    video_copy_base_pal_range(&local->trn->pal, 128, 128, 40);
+    load_description(&local->label, local->trn->locales[0]->description);
+    sprite_create(local->img, logo, -1);
+}
+
 static void trnselect_free(component *c) {
     trnselect *g = widget_get_obj(c);
     video_set_base_palette(&g->palette_backup);
+    if(g->trn) {
+        sd_tournament_free(g->trn);
+        omf_free(g->trn);
+    }
+    dirindex_free(&g->tournaments);
     sprite_free(g->img);
     omf_free(g->img);
     omf_free(g);
@@ -121,11 +145,8 @@ void trnselect_next(component *c) {
     if(local->selected >= local->max) {
         local->selected = 0;
     }
-    sd_tournament_file *trn = list_get(local->tournaments, local->selected);
-    sd_sprite *logo = trn->locales[0]->logo;
-    video_copy_base_pal_range(&trn->pal, 128, 128, 40);
-    load_description(&local->label, trn->locales[0]->description);
-    sprite_create(local->img, logo, -1);
+    trnselect_show(local);
+    component_invalidate(c);
 }
 
 void trnselect_prev(component *c) {
@@ -134,16 +155,13 @@ void trnselect_prev(component *c) {
     if(local->selected < 0) {
         local->selected = local->max - 1;
     }
-    sd_tournament_file *trn = list_get(local->tournaments, local->selected);
-    sd_sprite *logo = trn->locales[0]->logo;
-    video_copy_base_pal_range(&trn->pal, 128, 128, 40);
-    load_description(&local->label, trn->locales[0]->description);
-    sprite_create(local->img, logo, -1);
+    trnselect_show(local);
+    component_invalidate(c);
 }
 
 sd_tournament_file *trnselect_selected(component *c) {
     trnselect *local = widget_get_obj(c);
-    return list_get(local->tournaments, local->selected);
+    return local->trn;
 }
 
 component *trnselect_create() {
@@ -155,20 +173,16 @@ component *trnselect_create() {
     // Local information
     trnselect *local = omf_calloc(1, sizeof(trnselect));
     local->selected = 0;
-    local->tournaments = trnlist_init();
-    local->max = list_size(local->tournaments);
+    trn_list(&local->tournaments);
+    local->max = dirindex_size(&local->tournaments);
     local->img = omf_calloc(1, sizeof(sprite));
 
     local->label = NULL;
+    local->trn = NULL;
 
     memcpy(&local->palette_backup, video_get_base_palette(), sizeof(palette));
 
-    sd_tournament_file *trn = list_get(local->tournaments, local->selected);
-    sd_sprite *logo = trn->locales[0]->logo;
-    video_copy_base_pal_range(&trn->pal, 128, 128, 40);
-    load_description(&local->label, trn->locales[0]->description);
-
-    sprite_create(local->img, logo, -1);
+    trnselect_show(local);
 
     // Set callbacks
     widget_set_obj(c, local);
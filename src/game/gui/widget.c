@@ -1,6 +1,7 @@
 #include "game/gui/widget.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
+#include "video/video.h"
 
 void widget_set_obj(component *c, void *obj) {
     widget *local = component_get_obj(c);
@@ -66,6 +67,11 @@ static void widget_tick(component *c) {
 
 static void widget_render(component *c) {
     widget *local = component_get_obj(c);
+    // Skip widgets that are entirely outside of the area being redrawn.
+    if(!video_area_visible(c->x - COMPONENT_DIRTY_MARGIN, c->y - COMPONENT_DIRTY_MARGIN,
+                           c->w + COMPONENT_DIRTY_MARGIN * 2, c->h + COMPONENT_DIRTY_MARGIN * 2)) {
+        return;
+    }
     if(local->render) {
         local->render(c);
     }
@@ -26,7 +26,7 @@
 
 #include "video/video.h"
 
-#define IS_ZERO(n) (n < 0.8 && n > -0.8)
+#define IS_ZERO(n) (n < FIXEDPT(0.8) && n > FIXEDPT(-0.8))
 
 void har_finished(object *obj);
 int har_act(object *obj, int act_type);
@@ -374,7 +374,7 @@ int har_is_invincible(object *obj, af_move *move) {
 }
 
 // Callback for spawning new objects, eg. projectiles
-void cb_har_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g, void *userdata) {
+void cb_har_spawn_object(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g, void *userdata) {
     har *h = userdata;
     vec2i p_pos = object_get_pos(parent);
 
@@ -401,7 +401,7 @@ void cb_har_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t f
         object_set_userdata(obj, h);
         object_set_stl(obj, object_get_stl(parent));
         object_set_animation(obj, &move->ani);
-        object_set_gravity(obj, g / 256.0f);
+        object_set_gravity(obj, fixedpt_from_int(g) / 256);
         object_set_pal_offset(obj, object_get_pal_offset(parent));
         // Set all projectiles to their own layer + har layer
         object_set_layers(obj, LAYER_PROJECTILE | (h->player_id == 0 ? LAYER_HAR2 : LAYER_HAR1));
@@ -441,40 +441,40 @@ void har_floor_landing_effects(object *obj) {
     int amount = rand_int(2) + 1;
     for(int i = 0; i < amount; i++) {
         int variance = rand_int(20) - 10;
-        vec2i coord = vec2i_create(obj->pos.x + variance + i * 10, obj->pos.y);
+        vec2i coord = vec2i_create(object_px(obj) + variance + i * 10, object_py(obj));
         object *dust = omf_calloc(1, sizeof(object));
-        object_create(dust, obj->gs, coord, vec2f_create(0, 0));
+        object_create(dust, obj->gs, coord, vec2fx_create(0, 0));
         object_set_stl(dust, object_get_stl(obj));
         object_set_animation(dust, &bk_get_info(&game_state_get_scene(obj->gs)->bk_data, 26)->ani);
         game_state_add_object(obj->gs, dust, RENDER_LAYER_MIDDLE, 0, 0);
     }
 
     // Landing sound
-    float d = ((float)obj->pos.x) / 640.0f;
+    float d = fixedpt_to_float(obj->pos.x) / 640.0f;
     float pos_pan = d - 0.25f;
     audio_play_sound(56, 0.3f, pos_pan, 2.2f);
 }
 
 void har_move(object *obj) {
-    vec2f vel = object_get_vel(obj);
+    vec2fx vel = object_get_vel(obj);
     obj->pos.x += vel.x;
     obj->pos.y += vel.y;
     har *h = object_get_userdata(obj);
 
     // Check for wall hits
-    if(obj->pos.x <= ARENA_LEFT_WALL || obj->pos.x >= ARENA_RIGHT_WALL) {
+    if(obj->pos.x <= fixedpt_from_int(ARENA_LEFT_WALL) || obj->pos.x >= fixedpt_from_int(ARENA_RIGHT_WALL)) {
         h->is_wallhugging = 1;
     } else {
         h->is_wallhugging = 0;
     }
 
     // Handle floor collisions
-    if(obj->pos.y > ARENA_FLOOR) {
+    if(obj->pos.y > fixedpt_from_int(ARENA_FLOOR)) {
         if(h->state != STATE_FALLEN) {
             // We collided with ground, so set vertical velocity to 0 and
             // make sure object is level with ground
-            obj->pos.y = ARENA_FLOOR;
-            object_set_vel(obj, vec2f_create(vel.x, 0));
+            obj->pos.y = fixedpt_from_int(ARENA_FLOOR);
+            object_set_vel(obj, vec2fx_create(vel.x, 0));
         }
 
         // Change animation from jump to walk or idle,
@@ -507,18 +507,18 @@ void har_move(object *obj) {
             }
             /*}*/
         } else if(h->state == STATE_FALLEN || h->state == STATE_RECOIL) {
-            float dampen = 0.2f;
-            vec2f vel = object_get_vel(obj);
+            fixedpt dampen = FIXEDPT(0.2);
+            vec2fx vel = object_get_vel(obj);
             vec2i pos = object_get_pos(obj);
             if(pos.y > ARENA_FLOOR) {
                 pos.y = ARENA_FLOOR;
-                vel.y = -vel.y * dampen;
-                vel.x = vel.x * dampen;
+                vel.y = fixedpt_mul(-vel.y, dampen);
+                vel.x = fixedpt_mul(vel.x, dampen);
                 har_floor_landing_effects(obj);
             }
 
             if(pos.x <= ARENA_LEFT_WALL || pos.x >= ARENA_RIGHT_WALL) {
-                vel.x = 0.0;
+                vel.x = 0;
             }
 
             object_set_pos(obj, pos);
@@ -548,7 +548,7 @@ void har_move(object *obj) {
             }
         }
     } else {
-        object_set_vel(obj, vec2f_create(vel.x, vel.y + obj->gravity));
+        object_set_vel(obj, vec2fx_create(vel.x, vel.y + obj->gravity));
     }
 }
 
@@ -628,7 +628,7 @@ void har_take_damage(object *obj, const str *string, float damage, float stun) {
 
             if(object_is_airborne(obj)) {
                 // airborne defeat
-                obj->vel.y = -7;
+                obj->vel.y = fixedpt_from_int(-7);
                 object_set_stride(obj, 1);
                 h->state = STATE_FALLEN;
             }
@@ -646,7 +646,7 @@ void har_take_damage(object *obj, const str *string, float damage, float stun) {
             object_set_custom_string(obj, str_c(&n));
             str_free(&n);
 
-            obj->vel.y = -7 * object_get_direction(obj);
+            obj->vel.y = fixedpt_from_int(-7 * object_get_direction(obj));
             h->state = STATE_FALLEN;
             object_set_stride(obj, 1);
         } else {
@@ -659,30 +659,30 @@ void har_take_damage(object *obj, const str *string, float damage, float stun) {
         // we can't do this in player.c because it breaks the jaguar leap, which also uses the 'k' tag.
         const sd_script_frame *frame = sd_script_get_frame(&obj->animation_state.parser, 0);
         if(frame != NULL && sd_script_isset(frame, "k")) {
-            obj->vel.y -= 7;
+            obj->vel.y -= fixedpt_from_int(7);
         }
     }
 }
 
-void har_spawn_oil(object *obj, vec2i pos, int amount, float gravity, int layer) {
+void har_spawn_oil(object *obj, vec2i pos, int amount, fixedpt gravity, int layer) {
     har *h = object_get_userdata(obj);
 
     // burning oil
     for(int i = 0; i < amount; i++) {
         // Calculate velocity etc.
-        float rv = rand_int(100) / 100.0f - 0.5;
-        float velx = (5 * cosf(90 + i - (amount) / 2 + rv)) * object_get_direction(obj);
-        float vely = -12 * sinf(i / amount + rv);
+        fixedpt rv = fixedpt_from_int(rand_int(100)) / 100 - FIXEDPT(0.5);
+        fixedpt velx = (5 * fixedpt_cos(fixedpt_from_int(90 + i - (amount) / 2) + rv)) * object_get_direction(obj);
+        fixedpt vely = -12 * fixedpt_sin(fixedpt_from_int(i / amount) + rv);
 
         // Make sure the oil drops have somekind of velocity
         // (to prevent floating scrap objects)
-        if(vely < 0.1 && vely > -0.1)
-            vely += 0.21;
+        if(vely < FIXEDPT(0.1) && vely > FIXEDPT(-0.1))
+            vely += FIXEDPT(0.21);
 
         // Create the object
         object *scrap = omf_calloc(1, sizeof(object));
         int anim_no = ANIM_BURNING_OIL;
-        object_create(scrap, obj->gs, pos, vec2f_create(velx, vely));
+        object_create(scrap, obj->gs, pos, vec2fx_create(velx, vely));
         object_set_animation(scrap, &af_get_move(h->af_data, anim_no)->ani);
         object_set_stl(scrap, object_get_stl(obj));
         object_set_gravity(scrap, gravity);
@@ -706,7 +706,7 @@ void har_spawn_scrap(object *obj, vec2i pos, int amount) {
     // wild ass guess
     int oil_amount = amount / 3;
     har *h = object_get_userdata(obj);
-    har_spawn_oil(obj, pos, oil_amount, 1, RENDER_LAYER_TOP);
+    har_spawn_oil(obj, pos, oil_amount, FIXEDPT(1), RENDER_LAYER_TOP);
 
     // scrap metal
     // TODO this assumes the default scrap level and does not consider BIG[1-9]
@@ -723,9 +723,10 @@ void har_spawn_scrap(object *obj, vec2i pos, int amount) {
     }
     for(int i = 0; i < scrap_amount; i++) {
         // Calculate velocity etc.
-        float rv = rand_int(100) / 100.0f - 0.5;
-        float velx = (5 * cosf(90 + i - (scrap_amount) / 2 + rv)) * object_get_direction(obj);
-        float vely = -12 * sinf(i / scrap_amount + rv);
+        fixedpt rv = fixedpt_from_int(rand_int(100)) / 100 - FIXEDPT(0.5);
+        fixedpt velx =
+            (5 * fixedpt_cos(fixedpt_from_int(90 + i - (scrap_amount) / 2) + rv)) * object_get_direction(obj);
+        fixedpt vely = -12 * fixedpt_sin(fixedpt_from_int(i / scrap_amount) + rv);
 
         // Make destruction moves look more impressive :P
         if(destr) {
@@ -735,16 +736,16 @@ void har_spawn_scrap(object *obj, vec2i pos, int amount) {
 
         // Make sure scrap has somekind of velocity
         // (to prevent floating scrap objects)
-        if(vely < 0.1 && vely > -0.1)
-            vely += 0.21;
+        if(vely < FIXEDPT(0.1) && vely > FIXEDPT(-0.1))
+            vely += FIXEDPT(0.21);
 
         // Create the object
         object *scrap = omf_calloc(1, sizeof(object));
         int anim_no = rand_int(3) + ANIM_SCRAP_METAL;
-        object_create(scrap, obj->gs, pos, vec2f_create(velx, vely));
+        object_create(scrap, obj->gs, pos, vec2fx_create(velx, vely));
         object_set_animation(scrap, &af_get_move(h->af_data, anim_no)->ani);
         object_set_stl(scrap, object_get_stl(obj));
-        object_set_gravity(scrap, 1);
+        object_set_gravity(scrap, FIXEDPT(1));
         object_set_pal_offset(scrap, object_get_pal_offset(obj));
         object_set_layers(scrap, LAYER_SCRAP);
         object_dynamic_tick(scrap);
@@ -771,7 +772,7 @@ void har_block(object *obj, vec2i hit_coord) {
         return;
     }
     object *scrape = omf_calloc(1, sizeof(object));
-    object_create(scrape, obj->gs, hit_coord, vec2f_create(0, 0));
+    object_create(scrape, obj->gs, hit_coord, vec2fx_create(0, 0));
     object_set_animation(scrape, &af_get_move(h->af_data, ANIM_BLOCKING_SCRAPE)->ani);
     object_set_stl(scrape, object_get_stl(obj));
     object_set_direction(scrape, object_get_direction(obj));
@@ -1016,12 +1017,12 @@ void har_collide_with_har(object *obj_a, object *obj_b, int loop) {
             har_event_block(b, move, false);
             har_block(obj_b, hit_coord);
             if(b->is_wallhugging) {
-                vec2f push = object_get_vel(obj_a);
-                push.x += 2.0f * object_get_direction(obj_b);
+                vec2fx push = object_get_vel(obj_a);
+                push.x += fixedpt_from_int(2 * object_get_direction(obj_b));
                 object_set_vel(obj_a, push);
             } else {
-                vec2f push = object_get_vel(obj_b);
-                push.x += 2.0f * object_get_direction(obj_a);
+                vec2fx push = object_get_vel(obj_b);
+                push.x += fixedpt_from_int(2 * object_get_direction(obj_a));
                 object_set_vel(obj_b, push);
             }
             return;
@@ -1055,18 +1056,18 @@ void har_collide_with_har(object *obj_a, object *obj_b, int loop) {
 
         if(b->state == STATE_RECOIL || b->is_wallhugging) {
             // back the attacker off a little
-            vec2f push = object_get_vel(obj_a);
-            push.x += 2.0f * object_get_direction(obj_b);
+            vec2fx push = object_get_vel(obj_a);
+            push.x += fixedpt_from_int(2 * object_get_direction(obj_b));
             object_set_vel(obj_a, push);
         }
         har_take_damage(obj_b, &move->footer_string, move->damage, move->stun);
         if(b->is_wallhugging) {
-            vec2f push = object_get_vel(obj_a);
-            push.x += 3.0f * object_get_direction(obj_b);
+            vec2fx push = object_get_vel(obj_a);
+            push.x += fixedpt_from_int(3 * object_get_direction(obj_b));
             object_set_vel(obj_a, push);
         } else {
-            vec2f push = object_get_vel(obj_b);
-            push.x += 3.0f * object_get_direction(obj_a);
+            vec2fx push = object_get_vel(obj_b);
+            push.x += fixedpt_from_int(3 * object_get_direction(obj_a));
             object_set_vel(obj_b, push);
         }
 
@@ -1155,8 +1156,8 @@ void har_collide_with_projectile(object *o_har, object *o_pjt) {
         har_spawn_scrap(o_har, hit_coord, move->block_stun);
         h->damage_received = 1;
 
-        vec2f vel = object_get_vel(o_har);
-        vel.x = 0.0f;
+        vec2fx vel = object_get_vel(o_har);
+        vel.x = 0;
         object_set_vel(o_har, vel);
 
         // Exception case for chronos' time freeze
@@ -1298,6 +1299,7 @@ int har_palette_transform(object *obj, screen_palette *pal) {
         pal->data[i][1] = min2(max2(g, 0), 255);
         pal->data[i][2] = min2(max2(b, 0), 255);
     }
+    screen_palette_touch(pal, pal_start, pal_length);
 
     h->p_ticks_left--;
     return 1;
@@ -1388,7 +1390,7 @@ void har_tick(object *obj) {
         if(h->stun_timer % 10 == 0) {
             vec2i pos = object_get_pos(obj);
             pos.y -= 60;
-            har_spawn_oil(obj, pos, 5, 0.5f, RENDER_LAYER_BOTTOM);
+            har_spawn_oil(obj, pos, 5, FIXEDPT(0.5), RENDER_LAYER_BOTTOM);
         }
         if(h->stun_timer > 100) {
             har_stunned_done(obj);
@@ -1400,13 +1402,13 @@ void har_tick(object *obj) {
 
         // af_move *move = af_get_move(h->af_data, obj->cur_animation->id);
         if(h->state == STATE_CROUCHBLOCK) {
-            vec2f vel = object_get_vel(obj);
-            if(vel.x != 0.0f) {
-                vel.x -= 0.2f * -object_get_direction(obj);
+            vec2fx vel = object_get_vel(obj);
+            if(vel.x != 0) {
+                vel.x -= FIXEDPT(0.2) * -object_get_direction(obj);
             }
             object_set_vel(obj, vel);
         } else if(!har_is_walking(h) && h->executing_move == 0) {
-            vec2f vel = object_get_vel(obj);
+            vec2fx vel = object_get_vel(obj);
             vel.x = 0;
             object_set_vel(obj, vel);
         }
@@ -1434,7 +1436,7 @@ void har_tick(object *obj) {
     if(player_frame_isset(obj, "ub") && obj->age % 2 == 0) {
         sprite *nsp = sprite_copy(obj->cur_sprite);
         object *nobj = omf_calloc(1, sizeof(object));
-        object_create(nobj, obj->gs, object_get_pos(obj), vec2f_create(0, 0));
+        object_create(nobj, obj->gs, object_get_pos(obj), vec2fx_create(0, 0));
         object_set_stl(nobj, object_get_stl(obj));
         object_set_animation(nobj, create_animation_from_single(nsp, obj->cur_animation->start_pos));
         object_set_animation_owner(nobj, OWNER_OBJECT);
@@ -1448,7 +1450,7 @@ void har_tick(object *obj) {
     // Network motion replay
     int act_pos = obj->age % OBJECT_EVENT_BUFFER_SIZE;
     if(h->act_buf[act_pos].age == obj->age) {
-        DEBUG("REPLAYING %d inputs", h->act_buf[act_pos].count);
+        TRACE("REPLAYING %d inputs", h->act_buf[act_pos].count);
         for(int i = 0; i < h->act_buf[act_pos].count; i++) {
             har_act(obj, h->act_buf[act_pos].actions[i]);
         }
@@ -1810,14 +1812,14 @@ int har_act(object *obj, int act_type) {
 
         // Move flag is on -- make the HAR move backwards to avoid overlap.
         if(move->collision_opts & 0x20) {
-            obj->pos.x -= object_get_size(obj).x / 2 * object_get_direction(obj);
+            obj->pos.x -= fixedpt_from_int(object_get_size(obj).x / 2 * object_get_direction(obj));
         }
 
         // Stop horizontal movement, when move is done
         // TODO: Make this work better
-        vec2f spd = object_get_vel(obj);
+        vec2fx spd = object_get_vel(obj);
         if(h->state != STATE_JUMPING) {
-            spd.x = 0.0f;
+            spd.x = 0;
         }
         object_set_vel(obj, spd);
 
@@ -1828,8 +1830,8 @@ int har_act(object *obj, int act_type) {
         // If animation is scrap or destruction, then remove our customizations
         // from gravity/fall speed, and just use the HARs native value.
         if(move->category == CAT_SCRAP || move->category == CAT_DESTRUCTION) {
-            obj->horizontal_velocity_modifier = 1.0f;
-            obj->vertical_velocity_modifier = 1.0f;
+            obj->horizontal_velocity_modifier = FIXEDPT(1.0);
+            obj->vertical_velocity_modifier = FIXEDPT(1.0);
             object_set_gravity(obj, h->af_data->fall_speed);
             object_set_gravity(enemy_obj, enemy_har->af_data->fall_speed);
         }
@@ -1862,7 +1864,7 @@ int har_act(object *obj, int act_type) {
 
     // Don't allow new movement while we're still executing a move
     if(h->executing_move) {
-        if(obj->pos.y < ARENA_FLOOR) {
+        if(object_is_airborne(obj)) {
             // XXX I think 'i' is for 'not interruptable'
             if(h->state < STATE_JUMPING && !player_frame_isset(obj, "i")) {
                 DEBUG("standing move led to airborne one");
@@ -1874,7 +1876,7 @@ int har_act(object *obj, int act_type) {
         return 0;
     }
 
-    if(obj->pos.y < ARENA_FLOOR) {
+    if(object_is_airborne(obj)) {
         // airborne
 
         // Send an event if the har tries to turn in the air by pressing either left/right/downleft/downright
@@ -1902,7 +1904,7 @@ int har_act(object *obj, int act_type) {
         return 0;
     }
 
-    float vx, vy;
+    fixedpt vx, vy;
     // no moves matched, do player movement
     int newstate;
     if((newstate = maybe_har_change_state(h->state, direction, act_type))) {
@@ -1910,35 +1912,35 @@ int har_act(object *obj, int act_type) {
         switch(newstate) {
             case STATE_CROUCHBLOCK:
                 har_set_ani(obj, ANIM_CROUCHING, 1);
-                object_set_vel(obj, vec2f_create(0, 0));
+                object_set_vel(obj, vec2fx_create(0, 0));
                 break;
             case STATE_CROUCHING:
                 har_set_ani(obj, ANIM_CROUCHING, 1);
-                object_set_vel(obj, vec2f_create(0, 0));
+                object_set_vel(obj, vec2fx_create(0, 0));
                 break;
             case STATE_STANDING:
                 har_set_ani(obj, ANIM_IDLE, 1);
                 object_set_stride(obj, h->stride);
-                object_set_vel(obj, vec2f_create(0, 0));
+                object_set_vel(obj, vec2fx_create(0, 0));
                 obj->slide_state.vel.x = 0;
                 break;
             case STATE_WALKTO:
                 har_set_ani(obj, ANIM_WALKING, 1);
                 vx = h->fwd_speed * direction;
-                object_set_vel(obj, vec2f_create(vx * (h->hard_close ? 0.5 : 1.0), 0));
+                object_set_vel(obj, vec2fx_create(h->hard_close ? vx / 2 : vx, 0));
                 object_set_stride(obj, h->stride);
                 har_event_walk(h, 1);
                 break;
             case STATE_WALKFROM:
                 har_set_ani(obj, ANIM_WALKING, 1);
                 vx = h->back_speed * direction * -1;
-                object_set_vel(obj, vec2f_create(vx * (h->hard_close ? 0.5 : 1.0), 0));
+                object_set_vel(obj, vec2fx_create(h->hard_close ? vx / 2 : vx, 0));
                 object_set_stride(obj, h->stride);
                 har_event_walk(h, -1);
                 break;
             case STATE_JUMPING:
                 har_set_ani(obj, ANIM_JUMPING, 0);
-                vx = 0.0f;
+                vx = 0;
                 vy = h->jump_speed;
                 int jump_dir = 0;
                 if((act_type == (ACT_UP | ACT_LEFT) && direction == OBJECT_FACE_LEFT) ||
@@ -1966,7 +1968,7 @@ int har_act(object *obj, int act_type) {
                     // jumping frop crouch makes you jump 25% higher
                     vy = h->superjump_speed;
                 }
-                object_set_vel(obj, vec2f_create(vx, vy));
+                object_set_vel(obj, vec2fx_create(vx, vy));
                 har_event_jump(h, jump_dir);
                 break;
         }
@@ -1989,7 +1991,7 @@ int har_act(object *obj, int act_type) {
 void har_finished(object *obj) {
     har *h = object_get_userdata(obj);
     if(h->enqueued) {
-        DEBUG("playing enqueued animation %d", h->enqueued);
+        TRACE("playing enqueued animation %d", h->enqueued);
         har_set_ani(obj, h->enqueued, 0);
         h->enqueued = 0;
         h->executing_move = 1;
@@ -2038,7 +2040,7 @@ void har_finished(object *obj) {
         }
     } else {
         har_set_ani(obj, ANIM_CROUCHING, 1);
-        object_set_vel(obj, vec2f_create(0, 0));
+        object_set_vel(obj, vec2fx_create(0, 0));
     }
     h->executing_move = 0;
     h->flinching = 0;
@@ -2065,9 +2067,21 @@ int har_serialize(object *obj, serial *ser) {
     serial_write_int16(ser, h->health);
     serial_write_float(ser, h->endurance);
     serial_write(ser, h->inputs, 10);
-
-    // ...
-    // TODO: Set the other ser attrs here
+    serial_write_int8(ser, h->enqueued);
+    serial_write_int8(ser, h->is_wallhugging);
+    serial_write_int8(ser, h->is_grabbed);
+    serial_write_float(ser, h->last_damage_value);
+    serial_write_int32(ser, h->in_stasis_ticks);
+    serial_write_int8(ser, h->stride);
+    serial_write_int8(ser, h->stun_timer);
+
+    // Palette effects
+    serial_write_int8(ser, h->p_pal_ref);
+    serial_write_int8(ser, h->p_har_switch);
+    serial_write_int8(ser, h->p_color_ref);
+    serial_write_int32(ser, h->p_ticks_left);
+    serial_write_int32(ser, h->p_ticks_length);
+    serial_write_int8(ser, h->p_color_fn);
 
     // Return success
     return 0;
@@ -2111,6 +2125,21 @@ int har_unserialize(object *obj, serial *ser, int animation_id, game_state *gs)
     h->health = serial_read_int16(ser);
     h->endurance = serial_read_float(ser);
     serial_read(ser, h->inputs, 10);
+    h->enqueued = serial_read_int8(ser);
+    h->is_wallhugging = serial_read_int8(ser);
+    h->is_grabbed = serial_read_int8(ser);
+    h->last_damage_value = serial_read_float(ser);
+    h->in_stasis_ticks = serial_read_int32(ser);
+    h->stride = serial_read_int8(ser);
+    h->stun_timer = serial_read_int8(ser);
+
+    // Palette effects
+    h->p_pal_ref = serial_read_int8(ser);
+    h->p_har_switch = serial_read_int8(ser);
+    h->p_color_ref = serial_read_int8(ser);
+    h->p_ticks_left = serial_read_int32(ser);
+    h->p_ticks_length = serial_read_int32(ser);
+    h->p_color_fn = serial_read_int8(ser);
 
     /*DEBUG("har animation id is %d with state %d with %d", animation_id, h->state, h->executing_move);*/
 
@@ -2189,15 +2218,15 @@ int har_create(object *obj, af *af_data, int dir, int har_id, int pilot_id, int
     // Insanius: I went ahead and changed the formulas to use division instead of multiplication since it's more precise
     // for us Insanius: jump speed = speed up * vertical_agility_modifier * 212 / 256 Insanius: superjump speed = speed
     // up * vertical_agility_modifier * 266 / 256
-    float horizontal_agility_modifier = ((float)local->gp->pilot->agility + 35) / 45;
-    float vertical_agility_modifier = ((float)local->gp->pilot->agility + 20) / 30;
+    fixedpt horizontal_agility_modifier = fixedpt_from_int(local->gp->pilot->agility + 35) / 45;
+    fixedpt vertical_agility_modifier = fixedpt_from_int(local->gp->pilot->agility + 20) / 30;
     obj->horizontal_velocity_modifier = horizontal_agility_modifier;
     obj->vertical_velocity_modifier = vertical_agility_modifier;
-    local->jump_speed = (((float)local->gp->pilot->agility + 35) / 45) * af_data->jump_speed * 216 / 256;
-    local->superjump_speed = (((float)local->gp->pilot->agility + 35) / 45) * af_data->jump_speed * 266 / 256;
-    local->fall_speed = (((float)local->gp->pilot->agility + 20) / 30) * af_data->fall_speed;
-    local->fwd_speed = (((float)local->gp->pilot->agility + 20) / 30) * af_data->forward_speed;
-    local->back_speed = (((float)local->gp->pilot->agility + 20) / 30) * af_data->reverse_speed;
+    local->jump_speed = fixedpt_mul(horizontal_agility_modifier, af_data->jump_speed) * 216 / 256;
+    local->superjump_speed = fixedpt_mul(horizontal_agility_modifier, af_data->jump_speed) * 266 / 256;
+    local->fall_speed = fixedpt_mul(vertical_agility_modifier, af_data->fall_speed);
+    local->fwd_speed = fixedpt_mul(vertical_agility_modifier, af_data->forward_speed);
+    local->back_speed = fixedpt_mul(vertical_agility_modifier, af_data->reverse_speed);
     // TODO calculate a better value here
     local->stride = lrint(1 + (local->gp->pilot->agility / 20));
     DEBUG("setting HAR stride to %d", local->stride);
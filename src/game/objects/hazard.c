@@ -4,11 +4,10 @@
 #include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/miscmath.h"
-#include <math.h>
 
-int orb_almost_there(vec2f a, vec2f b) {
-    vec2f dir = vec2f_sub(a, b);
-    return (dir.x >= -2.0f && dir.x <= 2.0f && dir.y >= -2.0f && dir.y <= 2.0f);
+int orb_almost_there(vec2fx a, vec2fx b) {
+    vec2fx dir = vec2fx_sub(a, b);
+    return (dir.x >= FIXEDPT(-2.0) && dir.x <= FIXEDPT(2.0) && dir.y >= FIXEDPT(-2.0) && dir.y <= FIXEDPT(2.0));
 }
 
 void hazard_tick(object *obj) {
@@ -23,31 +22,35 @@ void hazard_tick(object *obj) {
         }
     }
     if(obj->orbit) {
-        obj->orbit_tick += MATH_PI / 32;
-        if(obj->orbit_tick >= MATH_PI * 2) {
-            obj->orbit_tick -= MATH_PI * 2;
+        obj->orbit_tick += FIXEDPT(MATH_PI / 32);
+        if(obj->orbit_tick >= FIXEDPT(MATH_PI * 2)) {
+            obj->orbit_tick -= FIXEDPT(MATH_PI * 2);
         }
         if(orb_almost_there(obj->orbit_dest, obj->orbit_pos)) {
             // XXX come up with a better equation to randomize the destination
             obj->orbit_pos = obj->pos;
-            obj->orbit_pos_vary = vec2f_create(0, 0);
-            float mag;
+            obj->orbit_pos_vary = vec2fx_create(0, 0);
+            fixedpt mag;
             int limit = 10;
             do {
-                obj->orbit_dest = vec2f_create(rand_float() * 320.0f, rand_float() * 200.0f);
-                obj->orbit_dest_dir = vec2f_sub(obj->orbit_dest, obj->orbit_pos);
-                mag = sqrtf(obj->orbit_dest_dir.x * obj->orbit_dest_dir.x +
-                            obj->orbit_dest_dir.y * obj->orbit_dest_dir.y);
+                obj->orbit_dest = vec2fx_create(rand_fixedpt() * 320, rand_fixedpt() * 200);
+                obj->orbit_dest_dir = vec2fx_sub(obj->orbit_dest, obj->orbit_pos);
+                // Squared distances across the arena do not fit in a 16.16 number, so square smaller ones
+                fixedpt dx = obj->orbit_dest_dir.x / 16;
+                fixedpt dy = obj->orbit_dest_dir.y / 16;
+                mag = fixedpt_sqrt(fixedpt_mul(dx, dx) + fixedpt_mul(dy, dy)) * 16;
                 limit--;
-            } while(mag < 80.0f && limit > 0);
+            } while(mag < fixedpt_from_int(80) && limit > 0);
 
-            obj->orbit_dest_dir.x /= mag;
-            obj->orbit_dest_dir.y /= mag;
+            if(mag > 0) {
+                obj->orbit_dest_dir.x = fixedpt_div(obj->orbit_dest_dir.x, mag);
+                obj->orbit_dest_dir.y = fixedpt_div(obj->orbit_dest_dir.y, mag);
+            }
         }
     }
 }
 
-void hazard_spawn_cb(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g, void *userdata) {
+void hazard_spawn_cb(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g, void *userdata) {
     scene *sc = (scene *)userdata;
 
     // Get next animation
@@ -81,8 +84,8 @@ void hazard_move(object *obj) {
         obj->pos.y = obj->orbit_pos.y + obj->orbit_pos_vary.y;
         obj->orbit_pos.x += 2 * obj->orbit_dest_dir.x;
         obj->orbit_pos.y += 2 * obj->orbit_dest_dir.y;
-        obj->orbit_pos_vary.x += sinf(obj->orbit_tick) * 0.2f;
-        obj->orbit_pos_vary.y += cosf(obj->orbit_tick) * 0.6f;
+        obj->orbit_pos_vary.x += fixedpt_mul(fixedpt_sin(obj->orbit_tick), FIXEDPT(0.2));
+        obj->orbit_pos_vary.y += fixedpt_mul(fixedpt_cos(obj->orbit_tick), FIXEDPT(0.6));
     }
 }
 
@@ -7,7 +7,7 @@
 #include "utils/log.h"
 #include <stdlib.h>
 
-#define IS_ZERO(n) (n < 0.1 && n > -0.1)
+#define IS_ZERO(n) (n < FIXEDPT(0.1) && n > FIXEDPT(-0.1))
 
 typedef struct projectile_local_t {
     object *owner;
@@ -25,7 +25,7 @@ void projectile_tick(object *obj) {
         if(move->successor_id) {
             object_set_animation(obj, &af_get_move(local->af_data, move->successor_id)->ani);
             object_set_repeat(obj, 0);
-            object_set_vel(obj, vec2f_create(0, 0));
+            object_set_vel(obj, vec2fx_create(0, 0));
             obj->animation_state.finished = 0;
         }
     }
@@ -51,36 +51,37 @@ void projectile_move(object *obj) {
     obj->vel.y += obj->gravity;
     obj->pos.y += obj->vel.y;
 
-    float dampen = 0.7f;
+    fixedpt dampen = FIXEDPT(0.7);
 
     // If wall bounce flag is on, bounce the projectile on wall hit
     // Otherwise kill it.
     if(local->wall_bounce) {
-        if(obj->pos.x < ARENA_LEFT_WALL) {
-            obj->pos.x = ARENA_LEFT_WALL;
-            obj->vel.x = -obj->vel.x * dampen;
+        if(obj->pos.x < fixedpt_from_int(ARENA_LEFT_WALL)) {
+            obj->pos.x = fixedpt_from_int(ARENA_LEFT_WALL);
+            obj->vel.x = -fixedpt_mul(obj->vel.x, dampen);
         }
-        if(obj->pos.x > ARENA_RIGHT_WALL) {
-            obj->pos.x = ARENA_RIGHT_WALL;
-            obj->vel.x = -obj->vel.x * dampen;
+        if(obj->pos.x > fixedpt_from_int(ARENA_RIGHT_WALL)) {
+            obj->pos.x = fixedpt_from_int(ARENA_RIGHT_WALL);
+            obj->vel.x = -fixedpt_mul(obj->vel.x, dampen);
         }
     } else if(!local->invincible) {
-        if(obj->pos.x < ARENA_LEFT_WALL) {
-            obj->pos.x = ARENA_LEFT_WALL;
+        if(obj->pos.x < fixedpt_from_int(ARENA_LEFT_WALL)) {
+            obj->pos.x = fixedpt_from_int(ARENA_LEFT_WALL);
             obj->animation_state.finished = 1;
         }
-        if(obj->pos.x > ARENA_RIGHT_WALL) {
-            obj->pos.x = ARENA_RIGHT_WALL;
+        if(obj->pos.x > fixedpt_from_int(ARENA_RIGHT_WALL)) {
+            obj->pos.x = fixedpt_from_int(ARENA_RIGHT_WALL);
             obj->animation_state.finished = 1;
         }
     }
-    if(obj->pos.y > ARENA_FLOOR) {
-        obj->pos.y = ARENA_FLOOR;
-        obj->vel.y = -obj->vel.y * dampen;
-        obj->vel.x = obj->vel.x * dampen;
+    if(obj->pos.y > fixedpt_from_int(ARENA_FLOOR)) {
+        obj->pos.y = fixedpt_from_int(ARENA_FLOOR);
+        obj->vel.y = -fixedpt_mul(obj->vel.y, dampen);
+        obj->vel.x = fixedpt_mul(obj->vel.x, dampen);
     }
-    if(obj->pos.y >= (ARENA_FLOOR - 5) && IS_ZERO(obj->vel.x) && obj->vel.y < obj->gravity * 1.1 &&
-       obj->vel.y > obj->gravity * -1.1 && local->ground_freeze) {
+    if(obj->pos.y >= fixedpt_from_int(ARENA_FLOOR - 5) && IS_ZERO(obj->vel.x) &&
+       obj->vel.y < fixedpt_mul(obj->gravity, FIXEDPT(1.1)) && obj->vel.y > fixedpt_mul(obj->gravity, FIXEDPT(-1.1)) &&
+       local->ground_freeze) {
 
         object_disable_rewind_tag(obj, 1);
     }
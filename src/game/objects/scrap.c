@@ -2,34 +2,34 @@
 #include "game/objects/arena_constraints.h"
 
 #define SCRAP_KEEPALIVE 220
-#define IS_ZERO(n) (n < 0.1 && n > -0.1)
+#define IS_ZERO(n) (n < FIXEDPT(0.1) && n > FIXEDPT(-0.1))
 
 // TODO: This is kind of quick and dirty, think of something better.
 void scrap_move(object *obj) {
-    vec2f vel = object_get_vel(obj);
+    vec2fx vel = object_get_vel(obj);
     vec2i pos = object_get_pos(obj);
     if(object_is_rewind_tag_disabled(obj) > 0) {
         return;
     }
 
-    pos.x += vel.x;
+    pos.x = fixedpt_to_int(fixedpt_from_int(pos.x) + vel.x);
     vel.y += obj->gravity;
-    pos.y += vel.y;
+    pos.y = fixedpt_to_int(fixedpt_from_int(pos.y) + vel.y);
 
-    float dampen = 0.4;
+    fixedpt dampen = FIXEDPT(0.4);
 
     if(pos.x < ARENA_LEFT_WALL) {
         pos.x = ARENA_LEFT_WALL;
-        vel.x = -vel.x * dampen;
+        vel.x = -fixedpt_mul(vel.x, dampen);
     }
     if(pos.x > ARENA_RIGHT_WALL) {
         pos.x = ARENA_RIGHT_WALL;
-        vel.x = -vel.x * dampen;
+        vel.x = -fixedpt_mul(vel.x, dampen);
     }
     if(pos.y > ARENA_FLOOR) {
         pos.y = ARENA_FLOOR;
-        vel.y = -vel.y * dampen;
-        vel.x = vel.x * dampen;
+        vel.y = -fixedpt_mul(vel.y, dampen);
+        vel.x = fixedpt_mul(vel.x, dampen);
     }
     if(IS_ZERO(vel.x))
         vel.x = 0;
@@ -37,7 +37,8 @@ void scrap_move(object *obj) {
     object_set_vel(obj, vel);
 
     // If object is at rest, just halt animation
-    if(pos.y >= (ARENA_FLOOR - 5) && IS_ZERO(vel.x) && vel.y < obj->gravity * 1.1 && vel.y > obj->gravity * -1.1) {
+    if(pos.y >= (ARENA_FLOOR - 5) && IS_ZERO(vel.x) && vel.y < fixedpt_mul(obj->gravity, FIXEDPT(1.1)) &&
+       vel.y > fixedpt_mul(obj->gravity, FIXEDPT(-1.1))) {
         object_disable_rewind_tag(obj, 1);
     }
 }
@@ -19,16 +19,17 @@
  * \param pos Initial position
  * \param vel Initial velocity
  */
-void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel) {
+void object_create(object *obj, game_state *gs, vec2i pos, vec2fx vel) {
     // State
     obj->gs = gs;
+    obj->handle = OBJECT_HANDLE_NONE;
 
     // Position related
-    obj->pos = vec2i_to_f(pos);
+    obj->pos = vec2i_to_fx(pos);
     // remember the place we were spawned, the x= and y= tags are relative to that
-    obj->start = vec2i_to_f(pos);
+    obj->start = vec2i_to_fx(pos);
     obj->vel = vel;
-    obj->horizontal_velocity_modifier = obj->vertical_velocity_modifier = 1.0f;
+    obj->horizontal_velocity_modifier = obj->vertical_velocity_modifier = FIXEDPT(1.0);
     obj->direction = OBJECT_FACE_RIGHT;
     obj->y_percent = 1.0;
     obj->x_percent = 1.0;
@@ -36,7 +37,7 @@ void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel) {
     // Physics
     obj->layers = OBJECT_DEFAULT_LAYER;
     obj->group = OBJECT_NO_GROUP;
-    obj->gravity = 0.0f;
+    obj->gravity = 0;
 
     // Video effect stuff
     obj->video_effects = 0;
@@ -46,10 +47,10 @@ void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel) {
 
     // Fire orb wandering
     obj->orbit = 0;
-    obj->orbit_tick = MATH_PI / 2.0f;
+    obj->orbit_tick = FIXEDPT(MATH_PI / 2.0f);
     obj->orbit_dest = obj->start;
     obj->orbit_pos = obj->start;
-    obj->orbit_pos_vary = vec2f_create(0, 0);
+    obj->orbit_pos_vary = vec2fx_create(0, 0);
 
     // Animation playback related
     obj->cur_animation_own = OWNER_EXTERNAL;
@@ -101,11 +102,11 @@ void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel) {
  * \return 0 on success, 1 on error
  */
 int object_serialize(object *obj, serial *ser) {
-    serial_write_float(ser, obj->pos.x);
-    serial_write_float(ser, obj->pos.y);
-    serial_write_float(ser, obj->vel.x);
-    serial_write_float(ser, obj->vel.y);
-    serial_write_float(ser, obj->gravity);
+    serial_write_fixedpt(ser, obj->pos.x);
+    serial_write_fixedpt(ser, obj->pos.y);
+    serial_write_fixedpt(ser, obj->vel.x);
+    serial_write_fixedpt(ser, obj->vel.y);
+    serial_write_fixedpt(ser, obj->gravity);
     serial_write_int8(ser, obj->direction);
     serial_write_int8(ser, obj->group);
     serial_write_int8(ser, obj->layers);
@@ -157,11 +158,11 @@ int object_serialize(object *obj, serial *ser) {
  * \return 0 on success, 1 on error.
  */
 int object_unserialize(object *obj, serial *ser, game_state *gs) {
-    obj->pos.x = serial_read_float(ser);
-    obj->pos.y = serial_read_float(ser);
-    obj->vel.x = serial_read_float(ser);
-    obj->vel.y = serial_read_float(ser);
-    float gravity = serial_read_float(ser);
+    obj->pos.x = serial_read_fixedpt(ser);
+    obj->pos.y = serial_read_fixedpt(ser);
+    obj->vel.x = serial_read_fixedpt(ser);
+    obj->vel.y = serial_read_fixedpt(ser);
+    fixedpt gravity = serial_read_fixedpt(ser);
     obj->direction = serial_read_int8(ser);
     obj->group = serial_read_int8(ser);
     obj->layers = serial_read_int8(ser);
@@ -364,20 +365,20 @@ void object_render(object *obj) {
 
     // Set Y coord, take into account sprite flipping
     if(rstate->flipmode & FLIP_VERTICAL) {
-        y = obj->pos.y - obj->cur_sprite->pos.y + rstate->o_correction.y - object_get_size(obj).y;
+        y = object_py(obj) - obj->cur_sprite->pos.y + rstate->o_correction.y - object_get_size(obj).y;
 
         if(obj->cur_animation->id == ANIM_JUMPING) {
             y -= 100;
         }
     } else {
-        y = obj->pos.y + obj->cur_sprite->pos.y + rstate->o_correction.y;
+        y = object_py(obj) + obj->cur_sprite->pos.y + rstate->o_correction.y;
     }
 
     // Set X coord, take into account the HAR facing.
     if(object_get_direction(obj) == OBJECT_FACE_LEFT) {
-        x = obj->pos.x - obj->cur_sprite->pos.x + rstate->o_correction.x - object_get_size(obj).x;
+        x = object_px(obj) - obj->cur_sprite->pos.x + rstate->o_correction.x - object_get_size(obj).x;
     } else {
-        x = obj->pos.x + obj->cur_sprite->pos.x + rstate->o_correction.x;
+        x = object_px(obj) + obj->cur_sprite->pos.x + rstate->o_correction.x;
     }
 
     // Flip to face the right direction
@@ -435,9 +436,9 @@ void object_render_shadow(object *obj) {
 
     // Determine X
     int flipmode = obj->sprite_state.flipmode;
-    int x = obj->pos.x + obj->cur_sprite->pos.x + obj->sprite_state.o_correction.x;
+    int x = object_px(obj) + obj->cur_sprite->pos.x + obj->sprite_state.o_correction.x;
     if(object_get_direction(obj) == OBJECT_FACE_LEFT) {
-        x = (obj->pos.x + obj->sprite_state.o_correction.x) - obj->cur_sprite->pos.x - object_get_size(obj).x;
+        x = (object_px(obj) + obj->sprite_state.o_correction.x) - obj->cur_sprite->pos.x - object_get_size(obj).x;
         flipmode ^= FLIP_HORIZONTAL;
     }
 
@@ -463,7 +464,7 @@ int object_act(object *obj, int action) {
 
 void object_move(object *obj) {
     if(obj->sprite_state.disable_gravity) {
-        object_set_vel(obj, vec2f_create(0, 0));
+        object_set_vel(obj, vec2fx_create(0, 0));
     }
     if(obj->move != NULL) {
         obj->move(obj);
@@ -499,13 +500,15 @@ int object_scenewide_palette_transform(object *obj, screen_palette *pal) {
                 pal->data[i][2] = max2(0, min2(255, pal->data[i][2] * (1 - k) + (b.b * k)));
             }
         }
+        screen_palette_touch(pal, rstate->pal_start_index, rstate->pal_entry_count);
         return 1;
     }
     return 0;
 }
 
 // This does palette transformations to the WHOLE screen palette
-// and affects all objects!
+// and affects all objects! Transformations must mark the colors they
+// change with screen_palette_touch().
 int object_palette_transform(object *obj, screen_palette *pal) {
     int transform_done = 0;
     transform_done |= object_scenewide_palette_transform(obj, pal);
@@ -576,7 +579,7 @@ void object_set_animation(object *obj, animation *ani) {
 
     // Debug texts
     if(obj->cur_animation->id == -1) {
-        DEBUG("Custom object set to (x,y) = (%f,%f).", obj->pos.x, obj->pos.y);
+        DEBUG("Custom object set to (x,y) = (%d,%d).", object_px(obj), object_py(obj));
     } else {
         /*DEBUG("Animation object %d set to (x,y) = (%f,%f) with \"%s\".", */
         /*obj->cur_animation->id,*/
@@ -676,11 +679,11 @@ void object_set_layers(object *obj, int layers) {
 void object_set_group(object *obj, int group) {
     obj->group = group;
 }
-void object_set_gravity(object *obj, float gravity) {
+void object_set_gravity(object *obj, fixedpt gravity) {
     obj->gravity = gravity;
 }
 
-float object_get_gravity(const object *obj) {
+fixedpt object_get_gravity(const object *obj) {
     return obj->gravity;
 }
 int object_get_group(const object *obj) {
@@ -744,41 +747,41 @@ int object_h(const object *obj) {
     return object_get_size(obj).y;
 }
 int object_px(const object *obj) {
-    return vec2f_to_i(obj->pos).x;
+    return fixedpt_to_int(obj->pos.x);
 }
 int object_py(const object *obj) {
-    return vec2f_to_i(obj->pos).y;
+    return fixedpt_to_int(obj->pos.y);
 }
-float object_vx(const object *obj) {
+fixedpt object_vx(const object *obj) {
     return obj->vel.x;
 }
-float object_vy(const object *obj) {
+fixedpt object_vy(const object *obj) {
     return obj->vel.y;
 }
 
 void object_set_px(object *obj, int val) {
-    obj->pos.x = val;
+    obj->pos.x = fixedpt_from_int(val);
 }
 void object_set_py(object *obj, int val) {
-    obj->pos.y = val;
+    obj->pos.y = fixedpt_from_int(val);
 }
-void object_set_vx(object *obj, float val) {
+void object_set_vx(object *obj, fixedpt val) {
     obj->vel.x = val;
 }
-void object_set_vy(object *obj, float val) {
+void object_set_vy(object *obj, fixedpt val) {
     obj->vel.y = val;
 }
 
 vec2i object_get_pos(const object *obj) {
-    return vec2f_to_i(obj->pos);
+    return vec2fx_to_i(obj->pos);
 }
-vec2f object_get_vel(const object *obj) {
+vec2fx object_get_vel(const object *obj) {
     return obj->vel;
 }
 void object_set_pos(object *obj, vec2i pos) {
-    obj->pos = vec2i_to_f(pos);
+    obj->pos = vec2i_to_fx(pos);
 }
-void object_set_vel(object *obj, vec2f vel) {
+void object_set_vel(object *obj, vec2fx vel) {
     obj->vel = vel;
 }
 
@@ -812,7 +815,7 @@ void object_set_destroy_cb(object *obj, object_state_del_cb cbf, void *userdata)
 }
 
 int object_is_airborne(const object *obj) {
-    return obj->pos.y < ARENA_FLOOR;
+    return obj->pos.y < fixedpt_from_int(ARENA_FLOOR);
 }
 
 /* Attaches one object to another. Positions are synced to this from the attached. */
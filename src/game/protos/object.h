@@ -2,6 +2,7 @@
 #define OBJECT_H
 
 #include "game/protos/player.h"
+#include "game/utils/object_pool.h"
 #include "game/utils/serial.h"
 #include "resources/animation.h"
 #include "resources/sprite.h"
@@ -59,12 +60,14 @@ typedef int (*object_palette_transform_cb)(object *obj, screen_palette *pal);
 
 struct object_t {
     game_state *gs;
-
-    vec2f start;
-    vec2f pos;
-    vec2f vel;
-    float vertical_velocity_modifier;
-    float horizontal_velocity_modifier;
+    object_handle handle; // Handle in the game state object pool, or OBJECT_HANDLE_NONE
+
+    // Simulation state is fixedpt, so that it plays out the same on every machine
+    vec2fx start;
+    vec2fx pos;
+    vec2fx vel;
+    fixedpt vertical_velocity_modifier;
+    fixedpt horizontal_velocity_modifier;
     int8_t direction;
     int8_t group;
 
@@ -73,17 +76,17 @@ struct object_t {
     int8_t can_hit;
 
     int8_t orbit;
-    float orbit_tick;
-    vec2f orbit_dest;
-    vec2f orbit_dest_dir;
-    vec2f orbit_pos;
-    vec2f orbit_pos_vary;
+    fixedpt orbit_tick;
+    vec2fx orbit_dest;
+    vec2fx orbit_dest_dir;
+    vec2fx orbit_pos;
+    vec2fx orbit_pos_vary;
 
     struct random_t rand_state;
 
     float x_percent;
     float y_percent;
-    float gravity;
+    fixedpt gravity;
 
     // Bitmask for several video effects (shadow, etc.)
     int video_effects;
@@ -132,7 +135,7 @@ struct object_t {
     object_palette_transform_cb pal_transform;
 };
 
-void object_create(object *obj, game_state *gs, vec2i pos, vec2f vel);
+void object_create(object *obj, game_state *gs, vec2i pos, vec2fx vel);
 void object_render(object *obj);
 void object_render_shadow(object *obj);
 void object_debug(object *obj);
@@ -178,7 +181,7 @@ void object_del_effects(object *obj, int effects);
 
 void object_set_layers(object *obj, int layers);
 void object_set_group(object *obj, int group);
-void object_set_gravity(object *obj, float gravity);
+void object_set_gravity(object *obj, fixedpt gravity);
 
 void object_set_userdata(object *obj, void *ptr);
 void *object_get_userdata(const object *obj);
@@ -199,7 +202,7 @@ int object_get_repeat(const object *obj);
 void object_set_direction(object *obj, int dir);
 int object_get_direction(const object *obj);
 
-float object_get_gravity(const object *obj);
+fixedpt object_get_gravity(const object *obj);
 int object_get_group(const object *obj);
 int object_get_layers(const object *obj);
 
@@ -219,22 +222,22 @@ int object_get_pal_offset(const object *obj);
 
 vec2i object_get_size(const object *obj);
 vec2i object_get_pos(const object *obj);
-vec2f object_get_vel(const object *obj);
+vec2fx object_get_vel(const object *obj);
 
 void object_set_pos(object *obj, vec2i pos);
-void object_set_vel(object *obj, vec2f vel);
+void object_set_vel(object *obj, vec2fx vel);
 
 int object_w(const object *obj);
 int object_h(const object *obj);
 int object_px(const object *obj);
 int object_py(const object *obj);
-float object_vx(const object *obj);
-float object_vy(const object *obj);
+fixedpt object_vx(const object *obj);
+fixedpt object_vy(const object *obj);
 
 void object_set_px(object *obj, int val);
 void object_set_py(object *obj, int val);
-void object_set_vx(object *obj, float val);
-void object_set_vy(object *obj, float val);
+void object_set_vx(object *obj, fixedpt val);
+void object_set_vy(object *obj, fixedpt val);
 
 uint32_t object_get_age(object *obj);
 serial *object_get_last_serialization_point(const object *obj);
@@ -99,7 +99,7 @@ void player_create(object *obj) {
     obj->animation_state.enemy = NULL;
     obj->animation_state.shadow_corner_hack = 0;
     obj->slide_state.timer = 0;
-    obj->slide_state.vel = vec2f_create(0, 0);
+    obj->slide_state.vel = vec2fx_create(0, 0);
     sd_script_create(&obj->animation_state.parser);
     player_clear_frame(obj);
 }
@@ -123,7 +123,7 @@ void player_reload_with_str(object *obj, const char *custom_str) {
     player_reset(obj);
     obj->animation_state.reverse = 0;
     obj->slide_state.timer = 0;
-    obj->slide_state.vel = vec2f_create(0, 0);
+    obj->slide_state.vel = vec2fx_create(0, 0);
     obj->enemy_slide_state.timer = 0;
     obj->enemy_slide_state.dest = vec2i_create(0, 0);
     obj->enemy_slide_state.duration = 0;
@@ -210,14 +210,14 @@ void player_describe_frame(const sd_script_frame *frame) {
 
 void player_describe_object(object *obj) {
     DEBUG("Object:");
-    DEBUG("  - Start: %d, %d", obj->start.x, obj->start.y);
-    DEBUG("  - Position: %d, %d", obj->pos.x, obj->pos.y);
-    DEBUG("  - Velocity: %d, %d", obj->vel.x, obj->vel.y);
+    DEBUG("  - Start: %f, %f", fixedpt_to_float(obj->start.x), fixedpt_to_float(obj->start.y));
+    DEBUG("  - Position: %f, %f", fixedpt_to_float(obj->pos.x), fixedpt_to_float(obj->pos.y));
+    DEBUG("  - Velocity: %f, %f", fixedpt_to_float(obj->vel.x), fixedpt_to_float(obj->vel.y));
     if(obj->cur_sprite) {
         DEBUG("  - Pos: %d, %d", obj->cur_sprite->pos.x, obj->cur_sprite->pos.y);
         DEBUG("  - Size: %d, %d", obj->cur_sprite->data->w, obj->cur_sprite->data->h);
         player_sprite_state *rstate = &obj->sprite_state;
-        DEBUG("CURRENT = %d - %d + %d - %d", obj->pos.y, obj->cur_sprite->pos.y, rstate->o_correction.y,
+        DEBUG("CURRENT = %d - %d + %d - %d", object_py(obj), obj->cur_sprite->pos.y, rstate->o_correction.y,
               obj->cur_sprite->data->h);
     }
 }
@@ -306,7 +306,7 @@ void player_run(object *obj) {
             if(object_get_direction(obj) == OBJECT_FACE_RIGHT) {
                 obj->pos.x = 0;
             } else {
-                obj->pos.x = 320;
+                obj->pos.x = fixedpt_from_int(320);
             }
             // flip the HAR's position for this animation
             obj->animation_state.shadow_corner_hack = 1;
@@ -314,7 +314,7 @@ void player_run(object *obj) {
 
         if(sd_script_isset(frame, "ac")) {
             // force the har to face the center of the arena
-            if(obj->pos.x > 160) {
+            if(obj->pos.x > fixedpt_from_int(160)) {
                 object_set_direction(obj, OBJECT_FACE_LEFT);
             } else {
                 object_set_direction(obj, OBJECT_FACE_RIGHT);
@@ -365,13 +365,13 @@ void player_run(object *obj) {
         obj->pos.x = state->enemy->pos.x;
         obj->pos.y = state->enemy->pos.y;
         object_set_direction(obj, object_get_direction(state->enemy) * -1);
-        DEBUG("E: pos.x = %f, pos.y = %f", obj->pos.x, obj->pos.y);
+        DEBUG("E: pos.x = %f, pos.y = %f", fixedpt_to_float(obj->pos.x), fixedpt_to_float(obj->pos.y));
     }
 
     // Set to ground
     if(sd_script_isset(frame, "g")) {
         obj->vel.y = 0;
-        obj->pos.y = ARENA_FLOOR;
+        obj->pos.y = fixedpt_from_int(ARENA_FLOOR);
     }
 
     if(sd_script_isset(frame, "h")) {
@@ -383,9 +383,9 @@ void player_run(object *obj) {
     if(sd_script_isset(frame, "at")) {
         // set the object's X position to be behind the opponent
         if(obj->pos.x > state->enemy->pos.x) { // From right to left
-            obj->pos.x = state->enemy->pos.x - object_get_size(obj).x / 2;
+            obj->pos.x = state->enemy->pos.x - fixedpt_from_int(object_get_size(obj).x / 2);
         } else { // From left to right
-            obj->pos.x = state->enemy->pos.x + object_get_size(state->enemy).x / 2;
+            obj->pos.x = state->enemy->pos.x + fixedpt_from_int(object_get_size(state->enemy).x / 2);
         }
         object_set_direction(obj, object_get_direction(obj) * -1);
     }
@@ -393,12 +393,13 @@ void player_run(object *obj) {
     // Handle vx+/-, vy+/-, x+/-. y+/-
     if(trans_x || trans_y) {
         if(sd_script_isset(frame, "v")) {
-            obj->vel.x = (trans_x * (mp & 0x20 ? -1 : 1)) * obj->horizontal_velocity_modifier;
-            obj->vel.y = trans_y * obj->vertical_velocity_modifier;
+            obj->vel.x =
+                fixedpt_mul(fixedpt_from_int(trans_x * (mp & 0x20 ? -1 : 1)), obj->horizontal_velocity_modifier);
+            obj->vel.y = fixedpt_mul(fixedpt_from_int(trans_y), obj->vertical_velocity_modifier);
             // DEBUG("vel x+%d, y+%d to x=%f, y=%f", trans_x * (mp & 0x20 ? -1 : 1), trans_y, obj->vel.x, obj->vel.y);
         } else {
-            obj->pos.x += trans_x * (mp & 0x20 ? -1 : 1);
-            obj->pos.y += trans_y;
+            obj->pos.x += fixedpt_from_int(trans_x * (mp & 0x20 ? -1 : 1));
+            obj->pos.y += fixedpt_from_int(trans_y);
             // DEBUG("pos x+%d, y+%d to x=%f, y=%f", trans_x * (mp & 0x20 ? -1 : 1), trans_y, obj->pos.x, obj->pos.y);
         }
     }
@@ -413,8 +414,8 @@ void player_run(object *obj) {
     // Handle slide in relation to enemy
     if(obj->enemy_slide_state.timer > 0) {
         obj->enemy_slide_state.duration++;
-        obj->pos.x = state->enemy->pos.x + obj->enemy_slide_state.dest.x;
-        obj->pos.y = state->enemy->pos.y + obj->enemy_slide_state.dest.y;
+        obj->pos.x = state->enemy->pos.x + fixedpt_from_int(obj->enemy_slide_state.dest.x);
+        obj->pos.y = state->enemy->pos.y + fixedpt_from_int(obj->enemy_slide_state.dest.y);
         obj->enemy_slide_state.timer--;
     }
 
@@ -424,12 +425,12 @@ void player_run(object *obj) {
         if(sd_script_isset(frame, "m") && state->spawn != NULL) {
             int mx = 0;
             int my = 0;
-            float vx = 0;
-            float vy = 0;
+            fixedpt vx = 0;
+            fixedpt vy = 0;
 
             if(obj->animation_state.shadow_corner_hack && sd_script_get(frame, "m") == 65) {
-                mx = state->enemy->pos.x;
-                my = state->enemy->pos.y;
+                mx = object_px(state->enemy);
+                my = object_py(state->enemy);
             }
 
             // Staring X coordinate for new animation
@@ -439,7 +440,7 @@ void player_run(object *obj) {
                 mx = random_int(&obj->rand_state, 320 - 2 * mm) + mrx;
                 DEBUG("randomized mx as %d", mx);
             } else if(sd_script_isset(frame, "mx")) {
-                mx = obj->start.x + (sd_script_get(frame, "mx") * object_get_direction(obj));
+                mx = fixedpt_to_int(obj->start.x) + (sd_script_get(frame, "mx") * object_get_direction(obj));
             }
 
             // Staring Y coordinate for new animation
@@ -449,15 +450,15 @@ void player_run(object *obj) {
                 my = random_int(&obj->rand_state, 320 - 2 * mm) + mry;
                 DEBUG("randomized my as %d", my);
             } else if(sd_script_isset(frame, "my")) {
-                my = obj->start.y + sd_script_get(frame, "my");
+                my = fixedpt_to_int(obj->start.y) + sd_script_get(frame, "my");
             }
 
             // Angle/speed for new animation
             if(sd_script_isset(frame, "ma")) {
                 int ma = sd_script_get(frame, "ma");
-                vx = cosf(ma);
-                vy = sinf(ma);
-                DEBUG("MA is set! angle = %d, vx = %f, vy = %f", ma, vx, vy);
+                vx = fixedpt_cos(fixedpt_from_int(ma));
+                vy = fixedpt_sin(fixedpt_from_int(ma));
+                DEBUG("MA is set! angle = %d, vx = %f, vy = %f", ma, fixedpt_to_float(vx), fixedpt_to_float(vy));
             }
 
             // Special positioning for certain desert arena sprites
@@ -466,7 +467,7 @@ void player_run(object *obj) {
             // Gravity for new object
             int mg = sd_script_isset(frame, "mg") ? sd_script_get(frame, "mg") : 0;
 
-            state->spawn(obj, sd_script_get(frame, "m"), vec2i_create(mx, my), vec2f_create(vx, vy), mp, ms, mg,
+            state->spawn(obj, sd_script_get(frame, "m"), vec2i_create(mx, my), vec2fx_create(vx, vy), mp, ms, mg,
                          state->spawn_userdata);
         }
 
@@ -587,11 +588,11 @@ void player_run(object *obj) {
             har_set_ani(obj, new_ani, 0);
         }
 
-        if(sd_script_isset(frame, "bu") && obj->vel.y < 0.0f) {
-            float x_dist = dist(obj->pos.x, 160);
+        if(sd_script_isset(frame, "bu") && obj->vel.y < 0) {
+            fixedpt x_dist = fixedpt_from_int(160) - obj->pos.x;
             // assume that bu is used in conjunction with 'vy-X' and that we want to land in the center of the arena
-            obj->slide_state.vel.x = x_dist / (obj->vel.y * -2);
-            obj->slide_state.timer = obj->vel.y * -2;
+            obj->slide_state.vel.x = fixedpt_div(x_dist, obj->vel.y * -2);
+            obj->slide_state.timer = fixedpt_to_int(obj->vel.y * -2);
         }
 
         // handle scaling on the Y axis
@@ -601,10 +602,10 @@ void player_run(object *obj) {
 
         // Handle slides
         if(sd_script_isset(frame, "x=") || sd_script_isset(frame, "y=")) {
-            obj->slide_state.vel = vec2f_create(0, 0);
+            obj->slide_state.vel = vec2fx_create(0, 0);
         }
         if(sd_script_isset(frame, "x=")) {
-            obj->pos.x = obj->start.x + (sd_script_get(frame, "x=") * object_get_direction(obj));
+            obj->pos.x = obj->start.x + fixedpt_from_int(sd_script_get(frame, "x=") * object_get_direction(obj));
 
             // Find frame ID by tick
             int frame_id = sd_script_next_frame_with_tag(&state->parser, "x=", state->current_tick);
@@ -614,9 +615,9 @@ void player_run(object *obj) {
                 int mr = sd_script_get_tick_pos_at_frame(&state->parser, frame_id);
                 int r = mr - state->current_tick - frame->tick_len;
                 int next_x = sd_script_get(sd_script_get_frame(&state->parser, frame_id), "x=");
-                int slide = obj->start.x + (next_x * object_get_direction(obj));
+                fixedpt slide = obj->start.x + fixedpt_from_int(next_x * object_get_direction(obj));
                 if(slide != obj->pos.x) {
-                    obj->slide_state.vel.x = dist(obj->pos.x, slide) / (float)(frame->tick_len + r);
+                    obj->slide_state.vel.x = (slide - obj->pos.x) / (frame->tick_len + r);
                     obj->slide_state.timer = frame->tick_len + r;
                     /* DEBUG("Slide object %d for X = %f for a total of %d + %d = %d ticks.",
                             obj->cur_animation->id,
@@ -628,7 +629,7 @@ void player_run(object *obj) {
             }
         }
         if(sd_script_isset(frame, "y=")) {
-            obj->pos.y = obj->start.y + sd_script_get(frame, "y=");
+            obj->pos.y = obj->start.y + fixedpt_from_int(sd_script_get(frame, "y="));
 
             // Find frame ID by tick
             int frame_id = sd_script_next_frame_with_tag(&state->parser, "y=", state->current_tick);
@@ -638,9 +639,9 @@ void player_run(object *obj) {
                 int mr = sd_script_get_tick_pos_at_frame(&state->parser, frame_id);
                 int r = mr - state->current_tick - frame->tick_len;
                 int next_y = sd_script_get(sd_script_get_frame(&state->parser, frame_id), "y=");
-                int slide = next_y + obj->start.y;
+                fixedpt slide = fixedpt_from_int(next_y) + obj->start.y;
                 if(slide != obj->pos.y) {
-                    obj->slide_state.vel.y = dist(obj->pos.y, slide) / (float)(frame->tick_len + r);
+                    obj->slide_state.vel.y = (slide - obj->pos.y) / (frame->tick_len + r);
                     obj->slide_state.timer = frame->tick_len + r;
                     /* DEBUG("Slide object %d for Y = %f for a total of %d + %d = %d ticks.",
                             obj->cur_animation->id,
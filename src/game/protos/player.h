@@ -7,7 +7,7 @@
 
 typedef struct object_t object;
 
-typedef void (*object_state_add_cb)(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g,
+typedef void (*object_state_add_cb)(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g,
                                     void *userdata);
 typedef void (*object_state_del_cb)(object *parent, int id, void *userdata);
 
@@ -35,7 +35,7 @@ typedef struct player_sprite_state_t {
 } player_sprite_state;
 
 typedef struct player_slide_op_t {
-    vec2f vel;
+    vec2fx vel;
     int timer;
 } player_slide_state;
 
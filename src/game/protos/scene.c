@@ -13,7 +13,7 @@
 #include <stdlib.h>
 
 // Some internal functions
-void cb_scene_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g, void *userdata);
+void cb_scene_spawn_object(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g, void *userdata);
 void cb_scene_destroy_object(object *parent, int id, void *userdata);
 
 // Loads BK file etc.
@@ -98,10 +98,9 @@ void scene_init(scene *scene) {
 
     // Bootstrap animations
     iterator it;
-    hashmap_iter_begin(&scene->bk_data.infos, &it);
-    hashmap_pair *pair = NULL;
-    while((pair = iter_next(&it)) != NULL) {
-        bk_info *info = (bk_info *)pair->val;
+    flatmap_iter_begin(&scene->bk_data.infos, &it);
+    bk_info *info = NULL;
+    while((info = iter_next(&it)) != NULL) {
 
         // Ask scene if this animation should be played on start
         scene_startup(scene, info->ani.id, &m_load, &m_repeat);
@@ -109,7 +108,7 @@ void scene_init(scene *scene) {
         // Start up animations
         if(m_load) {
             object *obj = omf_calloc(1, sizeof(object));
-            object_create(obj, scene->gs, info->ani.start_pos, vec2f_create(0, 0));
+            object_create(obj, scene->gs, info->ani.start_pos, vec2fx_create(0, 0));
             object_set_stl(obj, scene->bk_data.sound_translation_table);
             object_set_animation(obj, &info->ani);
             object_set_repeat(obj, m_repeat);
@@ -271,7 +270,7 @@ void scene_set_input_poll_cb(scene *scene, scene_input_poll_cb cbfunc) {
     scene->input_poll = cbfunc;
 }
 
-void cb_scene_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g, void *userdata) {
+void cb_scene_spawn_object(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g, void *userdata) {
     scene *sc = (scene *)userdata;
 
     // Get next animation
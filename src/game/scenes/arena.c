@@ -6,6 +6,7 @@
 #include "audio/audio.h"
 #include "controller/controller.h"
 #include "controller/net_controller.h"
+#include "controller/rec_controller.h"
 #include "formats/error.h"
 #include "formats/rec.h"
 #include "game/game_player.h"
@@ -28,6 +29,7 @@
 #include "game/utils/score.h"
 #include "game/utils/settings.h"
 #include "game/utils/ticktimer.h"
+#include "net/relay_publisher.h"
 #include "resources/languages.h"
 #include "utils/allocator.h"
 #include "utils/log.h"
@@ -65,10 +67,14 @@ typedef struct arena_local_t {
 
     sd_rec_file *rec;
     int rec_last[2];
+
+    int publishing;       // Match is published to a relay for spectators
+    controller *lockstep; // Network controller of a match played in lockstep, or NULL
 } arena_local;
 
 void arena_maybe_sync(scene *scene, int need_sync);
 void write_rec_move(scene *scene, game_player *player, int action);
+void arena_publish_action(scene *scene, game_player *player, int action);
 
 // -------- Local callbacks --------
 
@@ -92,8 +98,10 @@ void game_menu_return(component *c, void *userdata) {
     game_player *player1 = game_state_get_player(((scene *)userdata)->gs, 0);
     controller_set_repeat(game_player_get_ctrl(player1), 1);
     local->menu_visible = 0;
-    game_state_set_paused(((scene *)userdata)->gs, 0);
-    arena_maybe_sync(userdata, 1);
+    if(local->lockstep == NULL) {
+        game_state_set_paused(((scene *)userdata)->gs, 0);
+        arena_maybe_sync(userdata, 1);
+    }
 }
 
 void arena_music_slide(component *c, void *userdata, int pos) {
@@ -128,7 +136,7 @@ void scene_fight_anim_start(void *userdata) {
     scene *scene = game_state_get_scene(gs);
     animation *fight_ani = &bk_get_info(&scene->bk_data, 10)->ani;
     object *fight = omf_calloc(1, sizeof(object));
-    object_create(fight, gs, fight_ani->start_pos, vec2f_create(0, 0));
+    object_create(fight, gs, fight_ani->start_pos, vec2fx_create(0, 0));
     object_set_stl(fight, bk_get_stl(&scene->bk_data));
     object_set_animation(fight, fight_ani);
     // object_set_finish_cb(fight, scene_fight_anim_done);
@@ -157,7 +165,7 @@ void scene_youwin_anim_start(void *userdata) {
     scene *scene = game_state_get_scene(gs);
     animation *youwin_ani = &bk_get_info(&scene->bk_data, 9)->ani;
     object *youwin = omf_calloc(1, sizeof(object));
-    object_create(youwin, gs, youwin_ani->start_pos, vec2f_create(0, 0));
+    object_create(youwin, gs, youwin_ani->start_pos, vec2fx_create(0, 0));
     object_set_stl(youwin, bk_get_stl(&scene->bk_data));
     object_set_animation(youwin, youwin_ani);
     object_set_finish_cb(youwin, scene_youwin_anim_done);
@@ -179,7 +187,7 @@ void scene_youlose_anim_start(void *userdata) {
     scene *scene = game_state_get_scene(gs);
     animation *youlose_ani = &bk_get_info(&scene->bk_data, 8)->ani;
     object *youlose = omf_calloc(1, sizeof(object));
-    object_create(youlose, gs, youlose_ani->start_pos, vec2f_create(0, 0));
+    object_create(youlose, gs, youlose_ani->start_pos, vec2fx_create(0, 0));
     object_set_stl(youlose, bk_get_stl(&scene->bk_data));
     object_set_animation(youlose, youlose_ani);
     object_set_finish_cb(youlose, scene_youlose_anim_done);
@@ -203,6 +211,20 @@ int is_netplay(scene *scene) {
     return 0;
 }
 
+// Tells whether this end follows the state synced by the server, instead of playing the match on its own.
+// Both ends play lockstep matches on their own, from the same inputs.
+int is_netplay_follower(scene *scene) {
+    arena_local *local = scene_get_userdata(scene);
+    return is_netplay(scene) && scene->gs->role == ROLE_CLIENT && local->lockstep == NULL;
+}
+
+int is_spectating(scene *scene) {
+    if(game_state_get_player(scene->gs, 0)->ctrl->type == CTRL_TYPE_SPECTATOR) {
+        return 1;
+    }
+    return 0;
+}
+
 int is_singleplayer(scene *scene) {
     if(game_state_get_player(scene->gs, 1)->ctrl->type == CTRL_TYPE_AI) {
         return 1;
@@ -256,6 +278,8 @@ void arena_end(scene *sc) {
             next_id = rand_arena();
         } while(next_id == sc->id);
         game_state_set_next(gs, next_id);
+    } else if(is_spectating(sc)) {
+        game_state_set_next(gs, SCENE_NONE);
     } else if(is_singleplayer(sc) || is_tournament(sc)) {
         game_state_set_next(gs, SCENE_NEWSROOM);
     } else if(is_twoplayer(sc)) {
@@ -286,7 +310,7 @@ void arena_reset(scene *sc) {
         object *har_obj = game_player_get_har(player);
         har_reset(har_obj);
         object_set_pos(har_obj, pos[i]);
-        object_set_vel(har_obj, vec2f_create(0, 0));
+        object_set_vel(har_obj, vec2fx_create(0, 0));
         object_set_direction(har_obj, dir[i]);
         chr_score_clear_done(&player->score);
     }
@@ -295,7 +319,7 @@ void arena_reset(scene *sc) {
     // ROUND animation
     animation *round_ani = &bk_get_info(&sc->bk_data, 6)->ani;
     object *round = omf_calloc(1, sizeof(object));
-    object_create(round, sc->gs, round_ani->start_pos, vec2f_create(0, 0));
+    object_create(round, sc->gs, round_ani->start_pos, vec2fx_create(0, 0));
     object_set_stl(round, sc->bk_data.sound_translation_table);
     object_set_animation(round, round_ani);
     object_set_finish_cb(round, scene_ready_anim_done);
@@ -304,7 +328,7 @@ void arena_reset(scene *sc) {
     // Round number
     animation *number_ani = &bk_get_info(&sc->bk_data, 7)->ani;
     object *number = omf_calloc(1, sizeof(object));
-    object_create(number, sc->gs, number_ani->start_pos, vec2f_create(0, 0));
+    object_create(number, sc->gs, number_ani->start_pos, vec2fx_create(0, 0));
     object_set_stl(number, sc->bk_data.sound_translation_table);
     object_set_animation(number, number_ani);
     object_select_sprite(number, local->round);
@@ -313,35 +337,51 @@ void arena_reset(scene *sc) {
 }
 
 void arena_maybe_sync(scene *scene, int need_sync) {
+    arena_local *local = scene_get_userdata(scene);
     game_state *gs = scene->gs;
     game_player *player1 = game_state_get_player(gs, 0);
     game_player *player2 = game_state_get_player(gs, 1);
+    // Lockstep matches are played from the inputs alone on both ends
+    int sync_peer = gs->role == ROLE_SERVER && (local == NULL || local->lockstep == NULL) &&
+                    (player1->ctrl->type == CTRL_TYPE_NETWORK || player2->ctrl->type == CTRL_TYPE_NETWORK);
+    int publishing = local != NULL && local->publishing;
 
-    if(need_sync && gs->role == ROLE_SERVER &&
-       (player1->ctrl->type == CTRL_TYPE_NETWORK || player2->ctrl->type == CTRL_TYPE_NETWORK)) {
+    if(need_sync && (sync_peer || publishing)) {
 
-        // some of the moves did something interesting and we should synchronize the peer
+        // some of the moves did something interesting and we should synchronize the peer and spectators
         serial ser;
         serial_create(&ser);
         game_state_serialize(scene->gs, &ser);
-        if(player1->ctrl->type == CTRL_TYPE_NETWORK) {
+        if(sync_peer && player1->ctrl->type == CTRL_TYPE_NETWORK) {
             controller_update(player1->ctrl, &ser);
         }
-        if(player2->ctrl->type == CTRL_TYPE_NETWORK) {
+        if(sync_peer && player2->ctrl->type == CTRL_TYPE_NETWORK) {
             controller_update(player2->ctrl, &ser);
         }
+        if(publishing) {
+            relay_publisher_snapshot(&ser, gs->tick);
+        }
         serial_free(&ser);
     }
 }
 
+// Passes a handled action on to the relay, so that spectators can replay it
+void arena_publish_action(scene *scene, game_player *player, int action) {
+    arena_local *local = scene_get_userdata(scene);
+    if(local->publishing) {
+        int player_id = (player == game_state_get_player(scene->gs, 1)) ? 1 : 0;
+        relay_publisher_action(scene->gs->tick, player_id, action);
+    }
+}
+
 void arena_har_take_hit_hook(int hittee, af_move *move, scene *scene) {
     chr_score *score;
     chr_score *otherscore;
     object *hit_har;
     har *h;
 
-    if(is_netplay(scene) && scene->gs->role == ROLE_CLIENT) {
-        return; // netplay clients do not keep score
+    if(is_netplay_follower(scene) || is_spectating(scene)) {
+        return; // netplay clients and spectators do not keep score
     }
 
     if(hittee == 1) {
@@ -366,8 +406,8 @@ void arena_har_recover_hook(int player_id, scene *scene) {
     chr_score *score;
     object *o_har;
 
-    if(is_netplay(scene) && scene->gs->role == ROLE_CLIENT) {
-        return; // netplay clients do not keep score
+    if(is_netplay_follower(scene) || is_spectating(scene)) {
+        return; // netplay clients and spectators do not keep score
     }
 
     if(player_id == 0) {
@@ -389,7 +429,7 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
     DEBUG("Player %d hit wall %d", player_id, wall);
 
     // HAR must be in the air to be get faceplanted to a wall.
-    if(o_har->pos.y >= ARENA_FLOOR - 10) {
+    if(o_har->pos.y >= fixedpt_from_int(ARENA_FLOOR - 10)) {
         return;
     }
 
@@ -415,7 +455,7 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
         // Spawn wall animation
         bk_info *info = bk_get_info(&scene->bk_data, 20 + wall);
         object *obj = omf_calloc(1, sizeof(object));
-        object_create(obj, scene->gs, info->ani.start_pos, vec2f_create(0, 0));
+        object_create(obj, scene->gs, info->ani.start_pos, vec2fx_create(0, 0));
         object_set_stl(obj, scene->bk_data.sound_translation_table);
         object_set_animation(obj, &info->ani);
         if(game_state_add_object(scene->gs, obj, RENDER_LAYER_BOTTOM, 1, 0) == 0) {
@@ -424,7 +464,7 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
             // TODO this doesn't track the har's position well...
             info = bk_get_info(&scene->bk_data, 22);
             object *obj2 = omf_calloc(1, sizeof(object));
-            object_create(obj2, scene->gs, vec2i_create(o_har->pos.x, o_har->pos.y), vec2f_create(0, 0));
+            object_create(obj2, scene->gs, vec2i_create(object_px(o_har), object_py(o_har)), vec2fx_create(0, 0));
             object_set_stl(obj2, scene->bk_data.sound_translation_table);
             object_set_animation(obj2, &info->ani);
             object_attach_to(obj2, o_har);
@@ -447,7 +487,7 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
         // desert always shows the 'hit' animation when you touch the wall
         bk_info *info = bk_get_info(&scene->bk_data, 20 + wall);
         object *obj = omf_calloc(1, sizeof(object));
-        object_create(obj, scene->gs, info->ani.start_pos, vec2f_create(0, 0));
+        object_create(obj, scene->gs, info->ani.start_pos, vec2fx_create(0, 0));
         object_set_stl(obj, scene->bk_data.sound_translation_table);
         object_set_animation(obj, &info->ani);
         object_set_custom_string(obj, "brwA1-brwB1-brwD1-brwE0-brwD4-brwC2-brwB2-brwA2");
@@ -470,17 +510,17 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
             int variance = rand_int(20) - 10;
             int anim_no = rand_int(2) + 24;
             DEBUG("XXX anim = %d, variance = %d", anim_no, variance);
-            int pos_y = o_har->pos.y - object_get_size(o_har).y + variance + i * 25;
-            vec2i coord = vec2i_create(o_har->pos.x, pos_y);
+            int pos_y = object_py(o_har) - object_get_size(o_har).y + variance + i * 25;
+            vec2i coord = vec2i_create(object_px(o_har), pos_y);
             object *dust = omf_calloc(1, sizeof(object));
-            object_create(dust, scene->gs, coord, vec2f_create(0, 0));
+            object_create(dust, scene->gs, coord, vec2fx_create(0, 0));
             object_set_stl(dust, scene->bk_data.sound_translation_table);
             object_set_animation(dust, &bk_get_info(&scene->bk_data, anim_no)->ani);
             game_state_add_object(scene->gs, dust, RENDER_LAYER_MIDDLE, 0, 0);
         }
 
         // Wallhit sound
-        float d = ((float)o_har->pos.x) / 640.0f;
+        float d = fixedpt_to_float(o_har->pos.x) / 640.0f;
         float pos_pan = d - 0.25f;
         audio_play_sound(68, 1.0f, pos_pan, 2.0f);
     }
@@ -492,21 +532,21 @@ void arena_har_hit_wall_hook(int player_id, int wall, scene *scene) {
         // Set hit animation
         object_set_animation(o_har, &af_get_move(h->af_data, ANIM_DAMAGE)->ani);
         object_set_repeat(o_har, 0);
-        scene->gs->screen_shake_horizontal = 3 * fabsf(o_har->vel.x);
+        scene->gs->screen_shake_horizontal = fixedpt_to_int(fixedpt_abs(o_har->vel.x) * 3);
         // from MASTER.DAT
         if(wall == 1) {
             object_set_custom_string(o_har, "hQ10-x-3Q5-x-2L5-x-2M900");
-            o_har->vel.x = -2;
+            o_har->vel.x = fixedpt_from_int(-2);
         } else {
             object_set_custom_string(o_har, "hQ10-x3Q5-x2L5-x2M900");
-            o_har->vel.x = 2;
+            o_har->vel.x = fixedpt_from_int(2);
         }
 
         if(wall == 1) {
-            o_har->pos.x = ARENA_RIGHT_WALL - 2;
+            o_har->pos.x = fixedpt_from_int(ARENA_RIGHT_WALL - 2);
             object_set_direction(o_har, OBJECT_FACE_RIGHT);
         } else {
-            o_har->pos.x = ARENA_LEFT_WALL + 2;
+            o_har->pos.x = fixedpt_from_int(ARENA_LEFT_WALL + 2);
             object_set_direction(o_har, OBJECT_FACE_LEFT);
         }
     }
@@ -567,8 +607,8 @@ void arena_har_defeat_hook(int player_id, scene *scene) {
         winner_har->state = STATE_DONE;
     }
     winner_har->executing_move = 1;
-    object_set_vel(loser, vec2f_create(0, 0));
-    object_set_vel(winner, vec2f_create(0, 0));
+    object_set_vel(loser, vec2fx_create(0, 0));
+    object_set_vel(winner, vec2fx_create(0, 0));
     // object_set_gravity(loser, 0);
     arena_maybe_sync(scene, chr_score_interrupt(score, object_get_pos(winner)));
 }
@@ -677,7 +717,9 @@ void maybe_install_har_hooks(scene *scene) {
     har1 = obj_har1->userdata;
     har2 = obj_har2->userdata;
 
-    if(scene->gs->role == ROLE_CLIENT) {
+    // In lockstep, the inputs are passed to the server before they are played, not the actions of the HAR
+    arena_local *local = scene_get_userdata(scene);
+    if(scene->gs->role == ROLE_CLIENT && local->lockstep == NULL) {
         game_player *_player[2];
         for(int i = 0; i < 2; i++) {
             _player[i] = game_state_get_player(scene->gs, i);
@@ -701,6 +743,14 @@ void arena_free(scene *scene) {
 
     game_state_set_paused(scene->gs, 0);
 
+    if(local->publishing) {
+        relay_publisher_end();
+    }
+
+    if(local->lockstep) {
+        net_controller_lockstep_stop(local->lockstep);
+    }
+
     if(local->rec) {
         write_rec_move(scene, game_state_get_player(scene->gs, 0), ACT_STOP);
         sd_rec_save(local->rec, scene->gs->init_flags->rec_file);
@@ -791,6 +841,65 @@ void write_rec_move(scene *scene, game_player *player, int action) {
     }
 }
 
+/*
+ * Records the state checksum of this tick when recording with checksums, or compares it against the recorded one
+ * when playing back. Only the first divergent tick is reported; everything after it differs anyway. When verifying
+ * a playback, every checksum also goes to the trace. In netplay, both ends keep the checksums of the last ticks,
+ * so that the server can send its own with a sync, and the client can compare it against the one it had.
+ */
+void arena_checksum_tick(scene *scene) {
+    arena_local *local = scene_get_userdata(scene);
+    game_state *gs = scene->gs;
+    if(is_netplay(scene) && local->lockstep == NULL) {
+        game_state_add_tick_checksum(gs, game_state_checksum(gs));
+    }
+    if(local->rec) {
+        if(gs->init_flags->rec_checksums) {
+            sd_rec_move move;
+            memset(&move, 0, sizeof(move));
+            move.tick = gs->tick;
+            move.lookup_id = SD_REC_CHECKSUM;
+            move.checksum = game_state_checksum(gs);
+            sd_rec_insert_action(local->rec, local->rec->move_count, &move);
+        }
+        return;
+    }
+
+    controller *ctrl = game_player_get_ctrl(game_state_get_player(gs, 0));
+    uint32_t recorded;
+    int check = !gs->desynced && ctrl != NULL && ctrl->type == CTRL_TYPE_REC &&
+                rec_controller_get_checksum(ctrl, gs->tick, &recorded) == 0;
+    if(!check && gs->trace == NULL) {
+        return;
+    }
+    uint32_t checksum = game_state_checksum(gs);
+    if(gs->trace != NULL) {
+        replay_trace_add(gs->trace, gs->tick, checksum);
+    }
+    if(check && checksum != recorded) {
+        PERROR("Desync at tick %d: state checksum %08x, recorded %08x", gs->tick, checksum, recorded);
+        game_state_dump(gs);
+        gs->desynced = 1;
+    }
+}
+
+// Stores how the match ended in the trace of a verified playback
+static void arena_trace_outcome(scene *scene) {
+    replay_outcome *outcome = &scene->gs->trace->outcome;
+    chr_score *scores[2];
+    for(int i = 0; i < 2; i++) {
+        game_player *player = game_state_get_player(scene->gs, i);
+        har *h = object_get_userdata(game_player_get_har(player));
+        scores[i] = game_player_get_score(player);
+        outcome->health[i] = h->health;
+        outcome->score[i] = scores[i]->score;
+    }
+    outcome->winner = -1;
+    if(scores[0]->rounds != scores[1]->rounds) {
+        outcome->winner = scores[0]->rounds > scores[1]->rounds ? 0 : 1;
+    }
+}
+
 int arena_handle_events(scene *scene, game_player *player, ctrl_event *i) {
     int need_sync = 0;
     arena_local *local = scene_get_userdata(scene);
@@ -800,8 +909,11 @@ int arena_handle_events(scene *scene, game_player *player, ctrl_event *i) {
                player == game_state_get_player(scene->gs, 0)) {
                 // toggle menu
                 local->menu_visible = !local->menu_visible;
-                game_state_set_paused(scene->gs, local->menu_visible);
-                need_sync = 1;
+                if(local->lockstep == NULL) {
+                    // Lockstep matches go on behind the menu, since the peer keeps playing
+                    game_state_set_paused(scene->gs, local->menu_visible);
+                    need_sync = 1;
+                }
                 controller_set_repeat(game_player_get_ctrl(player), !local->menu_visible);
                 controller_set_repeat(game_player_get_ctrl(game_state_get_player(scene->gs, 1)), !local->menu_visible);
                 DEBUG("local menu %d, controller repeat %d", local->menu_visible, game_player_get_ctrl(player)->repeat);
@@ -813,10 +925,11 @@ int arena_handle_events(scene *scene, game_player *player, ctrl_event *i) {
                 // menu events
                 guiframe_action(local->game_menu, i->event_data.action);
             } else if(i->type == EVENT_TYPE_ACTION) {
-                if(player->ctrl->type == CTRL_TYPE_NETWORK) {
+                if(player->ctrl->type == CTRL_TYPE_NETWORK && local->lockstep == NULL) {
                     do {
                         object_act(game_player_get_har(player), i->event_data.action);
                         write_rec_move(scene, player, i->event_data.action);
+                        arena_publish_action(scene, player, i->event_data.action);
                         // Rewritten this way, we possible skipped some events
                         // before. We check if there is a next event, then
                         // check if it is EVENT_TYPE_ACTION and only then we
@@ -832,13 +945,17 @@ int arena_handle_events(scene *scene, game_player *player, ctrl_event *i) {
                 } else {
                     need_sync += object_act(game_player_get_har(player), i->event_data.action);
                     write_rec_move(scene, player, i->event_data.action);
+                    arena_publish_action(scene, player, i->event_data.action);
                 }
-            } else if(i->type == EVENT_TYPE_SYNC) {
+            } else if(i->type == EVENT_TYPE_SYNC && local->lockstep == NULL) {
                 DEBUG("sync");
                 game_state_unserialize(scene->gs, i->event_data.ser, player->ctrl->rtt);
                 maybe_install_har_hooks(scene);
             } else if(i->type == EVENT_TYPE_CLOSE) {
-                if(player->ctrl->type == CTRL_TYPE_REC) {
+                if(player->ctrl->type == CTRL_TYPE_REC || player->ctrl->type == CTRL_TYPE_SPECTATOR) {
+                    if(scene->gs->trace != NULL) {
+                        arena_trace_outcome(scene);
+                    }
                     game_state_set_next(scene->gs, SCENE_NONE);
                 } else {
                     game_state_set_next(scene->gs, SCENE_MENU);
@@ -852,23 +969,22 @@ int arena_handle_events(scene *scene, game_player *player, ctrl_event *i) {
 
 void arena_spawn_hazard(scene *scene) {
     iterator it;
-    hashmap_iter_begin(&scene->bk_data.infos, &it);
-    hashmap_pair *pair = NULL;
+    flatmap_iter_begin(&scene->bk_data.infos, &it);
+    bk_info *info = NULL;
 
-    if(is_netplay(scene) && scene->gs->role == ROLE_CLIENT) {
+    if(is_netplay_follower(scene) || is_spectating(scene)) {
         // only the server spawns hazards
         return;
     }
 
     int changed = 0;
 
-    while((pair = iter_next(&it)) != NULL) {
-        bk_info *info = (bk_info *)pair->val;
+    while((info = iter_next(&it)) != NULL) {
         if(info->probability > 1) {
             if(rand_int(info->probability) == 1) {
                 // TODO don't spawn it if we already have this animation running
                 object *obj = omf_calloc(1, sizeof(object));
-                object_create(obj, scene->gs, info->ani.start_pos, vec2f_create(0, 0));
+                object_create(obj, scene->gs, info->ani.start_pos, vec2fx_create(0, 0));
                 object_set_stl(obj, scene->bk_data.sound_translation_table);
                 object_set_animation(obj, &info->ani);
                 if(scene->id == SCENE_ARENA3 && info->ani.id == 0) {
@@ -917,7 +1033,13 @@ void arena_dynamic_tick(scene *scene, int paused) {
     game_player *player1 = game_state_get_player(gs, 0);
     game_player *player2 = game_state_get_player(gs, 1);
 
+    if(local->publishing) {
+        relay_publisher_tick(gs);
+    }
+
     if(!paused) {
+        arena_checksum_tick(scene);
+
         object *obj_har[2];
         har *hars[2];
         for(int i = 0; i < 2; i++) {
@@ -940,9 +1062,11 @@ void arena_dynamic_tick(scene *scene, int paused) {
             component_tick(local->endurance_bars[i]);
         }
 
-        // RTT stuff
-        hars[0]->delay = ceilf(player2->ctrl->rtt / 2.0f);
-        hars[1]->delay = ceilf(player1->ctrl->rtt / 2.0f);
+        // RTT stuff. In lockstep, the input delay already covers for it on both ends.
+        if(local->lockstep == NULL) {
+            hars[0]->delay = ceilf(player2->ctrl->rtt / 2.0f);
+            hars[1]->delay = ceilf(player1->ctrl->rtt / 2.0f);
+        }
 
         // Endings and beginnings
         if(local->state != ARENA_STATE_ENDING && local->state != ARENA_STATE_STARTING) {
@@ -979,21 +1103,21 @@ void arena_dynamic_tick(scene *scene, int paused) {
                     object *h_obj = game_state_get_player(gs, harnum)->har;
                     har *h = object_get_userdata(h_obj);
                     // Calculate velocity etc.
-                    float rv = rand_float() - 0.5f;
-                    float velx = rv;
-                    float vely = -12 * sinf(0 / 2 + rv);
+                    fixedpt rv = rand_fixedpt() - FIXEDPT(0.5);
+                    fixedpt velx = rv;
+                    fixedpt vely = -12 * fixedpt_sin(rv);
 
                     // Make sure scrap has somekind of velocity
                     // (to prevent floating scrap objects)
-                    if(vely < 0.1 && vely > -0.1)
-                        vely += 0.21;
+                    if(vely < FIXEDPT(0.1) && vely > FIXEDPT(-0.1))
+                        vely += FIXEDPT(0.21);
 
                     // Create the object
                     object *scrap = omf_calloc(1, sizeof(object));
                     int anim_no = rand_int(3) + ANIM_SCRAP_METAL;
-                    object_create(scrap, gs, pos, vec2f_create(velx, vely));
+                    object_create(scrap, gs, pos, vec2fx_create(velx, vely));
                     object_set_animation(scrap, &af_get_move(h->af_data, anim_no)->ani);
-                    object_set_gravity(scrap, 0.4f);
+                    object_set_gravity(scrap, FIXEDPT(0.4));
                     object_set_pal_offset(scrap, object_get_pal_offset(h_obj));
                     object_set_layers(scrap, LAYER_SCRAP);
                     object_set_shadow(scrap, 1);
@@ -1017,7 +1141,45 @@ void arena_static_tick(scene *scene, int paused) {
     guiframe_tick(local->game_menu);
 }
 
+/*
+ * Plays a frame of a lockstep match. The local inputs are queued, and played after the input delay, at the
+ * same time as the peer plays them. Only the menu of player 1 reacts to the keys right away, since it is not
+ * part of the match. Returns the amount of actions that need a sync.
+ */
+static int arena_lockstep_input(scene *scene, ctrl_event *p1, ctrl_event *p2) {
+    arena_local *local = scene_get_userdata(scene);
+    game_player *player[2] = {game_state_get_player(scene->gs, 0), game_state_get_player(scene->gs, 1)};
+    int remote = (player[0]->ctrl == local->lockstep) ? 0 : 1;
+    controller *local_ctrl = game_player_get_ctrl(player[1 - remote]);
+    ctrl_event *polled = (remote == 0) ? p2 : p1;
+    ctrl_event *menu = NULL;
+    int need_sync = 0;
+
+    for(ctrl_event *i = polled; i != NULL; i = i->next) {
+        if(i->type != EVENT_TYPE_ACTION) {
+            continue;
+        }
+        if((i->event_data.action == ACT_ESC && remote == 1) || local->menu_visible) {
+            controller_cmd(local_ctrl, i->event_data.action, &menu);
+        } else {
+            net_controller_lockstep_add(local->lockstep, i->event_data.action);
+        }
+    }
+    need_sync += arena_handle_events(scene, player[1 - remote], menu);
+    controller_free_chain(menu);
+
+    // Both ends play the due inputs in player order, so that they come to the same result
+    ctrl_event *due[2] = {NULL, NULL};
+    net_controller_lockstep_advance(local->lockstep, &due[1 - remote], &due[remote]);
+    for(int i = 0; i < 2; i++) {
+        need_sync += arena_handle_events(scene, player[i], due[i]);
+        controller_free_chain(due[i]);
+    }
+    return need_sync;
+}
+
 void arena_input_tick(scene *scene) {
+    arena_local *local = scene_get_userdata(scene);
     game_player *player1 = game_state_get_player(scene->gs, 0);
     game_player *player2 = game_state_get_player(scene->gs, 1);
 
@@ -1026,8 +1188,12 @@ void arena_input_tick(scene *scene) {
     controller_poll(player2->ctrl, &p2);
 
     int need_sync = 0;
-    need_sync += arena_handle_events(scene, player1, p1);
-    need_sync += arena_handle_events(scene, player2, p2);
+    if(local->lockstep != NULL) {
+        need_sync += arena_lockstep_input(scene, p1, p2);
+    } else {
+        need_sync += arena_handle_events(scene, player1, p1);
+        need_sync += arena_handle_events(scene, player2, p2);
+    }
     controller_free_chain(p1);
     controller_free_chain(p2);
     arena_maybe_sync(scene, need_sync);
@@ -1226,6 +1392,16 @@ int arena_create(scene *scene) {
     local->tournament = false;
     local->over = 0;
 
+    // Play the match in lockstep, if the server asked for it. Both ends seed the match the same way before
+    // anything random is set up, since its state is not synced.
+    for(int i = 0; i < 2; i++) {
+        controller *ctrl = game_player_get_ctrl(game_state_get_player(scene->gs, i));
+        if(ctrl->type == CTRL_TYPE_NETWORK && net_controller_lockstep_start(ctrl)) {
+            local->lockstep = ctrl;
+            rand_seed(net_controller_lockstep_seed(ctrl));
+        }
+    }
+
     // Initial har data
     vec2i pos[2];
     int dir[2] = {OBJECT_FACE_RIGHT, OBJECT_FACE_LEFT};
@@ -1257,7 +1433,7 @@ int arena_create(scene *scene) {
             return 1;
         }
 
-        object_create(obj, scene->gs, pos[i], vec2f_create(0, 0));
+        object_create(obj, scene->gs, pos[i], vec2fx_create(0, 0));
         if(har_create(obj, scene->af_data[i], dir[i], player->pilot->har_id, player->pilot->pilot_id, i)) {
             return 1;
         }
@@ -1273,7 +1449,7 @@ int arena_create(scene *scene) {
             // render pilot portraits
             object *portrait = omf_calloc(1, sizeof(object));
             if(i == 0) {
-                object_create(portrait, scene->gs, vec2i_create(105, 0), vec2f_create(0, 0));
+                object_create(portrait, scene->gs, vec2i_create(105, 0), vec2fx_create(0, 0));
                 portrait->cur_sprite = omf_calloc(1, sizeof(sprite));
                 portrait->x_percent = 0.70f;
                 portrait->y_percent = 0.70f;
@@ -1281,7 +1457,7 @@ int arena_create(scene *scene) {
                 sprite_create(portrait->cur_sprite, player->pilot->photo, -1);
                 local->player1_portrait = portrait;
             } else {
-                object_create(portrait, scene->gs, vec2i_create(235, 0), vec2f_create(0, 0));
+                object_create(portrait, scene->gs, vec2i_create(235, 0), vec2fx_create(0, 0));
                 portrait->cur_sprite = omf_calloc(1, sizeof(sprite));
                 portrait->x_percent = 0.70f;
                 portrait->y_percent = 0.70f;
@@ -1301,7 +1477,7 @@ int arena_create(scene *scene) {
                         xoff = 210 - 9 * j - 3 - j;
                     }
                     animation *ani = &bk_get_info(&scene->bk_data, 27)->ani;
-                    object_create(local->player_rounds[i][j], scene->gs, vec2i_create(xoff, 9), vec2f_create(0, 0));
+                    object_create(local->player_rounds[i][j], scene->gs, vec2i_create(xoff, 9), vec2fx_create(0, 0));
                     object_set_animation(local->player_rounds[i][j], ani);
                     object_select_sprite(local->player_rounds[i][j], 1);
                 } else {
@@ -1416,7 +1592,7 @@ int arena_create(scene *scene) {
         // Start READY animation
         animation *ready_ani = &bk_get_info(&scene->bk_data, 11)->ani;
         object *ready = omf_calloc(1, sizeof(object));
-        object_create(ready, scene->gs, ready_ani->start_pos, vec2f_create(0, 0));
+        object_create(ready, scene->gs, ready_ani->start_pos, vec2fx_create(0, 0));
         object_set_stl(ready, scene->bk_data.sound_translation_table);
         object_set_animation(ready, ready_ani);
         object_set_finish_cb(ready, scene_ready_anim_done);
@@ -1425,7 +1601,7 @@ int arena_create(scene *scene) {
         // ROUND
         animation *round_ani = &bk_get_info(&scene->bk_data, 6)->ani;
         object *round = omf_calloc(1, sizeof(object));
-        object_create(round, scene->gs, round_ani->start_pos, vec2f_create(0, 0));
+        object_create(round, scene->gs, round_ani->start_pos, vec2fx_create(0, 0));
         object_set_stl(round, scene->bk_data.sound_translation_table);
         object_set_animation(round, round_ani);
         object_set_finish_cb(round, scene_ready_anim_done);
@@ -1434,7 +1610,7 @@ int arena_create(scene *scene) {
         // Number
         animation *number_ani = &bk_get_info(&scene->bk_data, 7)->ani;
         object *number = omf_calloc(1, sizeof(object));
-        object_create(number, scene->gs, number_ani->start_pos, vec2f_create(0, 0));
+        object_create(number, scene->gs, number_ani->start_pos, vec2fx_create(0, 0));
         object_set_stl(number, scene->bk_data.sound_translation_table);
         object_set_animation(number, number_ani);
         object_select_sprite(number, local->round);
@@ -1470,6 +1646,13 @@ int arena_create(scene *scene) {
         local->rec = NULL;
     }
 
+    // Publish the match to the relay, unless someone else decides how it goes
+    local->publishing = relay_publisher_is_open() && !is_demoplay(scene) && !is_spectating(scene) &&
+                        !(is_netplay(scene) && scene->gs->role == ROLE_CLIENT);
+    if(local->publishing) {
+        relay_publisher_match(scene->gs, scene->id - SCENE_ARENA0);
+    }
+
     // Don't render background on its own layer
     // Fix for some additive blending tricks.
     video_render_bg_separately(false);
@@ -45,11 +45,12 @@ void menu_connect_start(component *c, void *userdata) {
     settings_get()->net.net_connect_ip = strdup(addr);
 
     // Set up enet host
-    local->host = enet_host_create(NULL, 1, 2, 0, 0);
+    local->host = enet_host_create(NULL, 1, 3, 0, 0);
     if(local->host == NULL) {
         DEBUG("Failed to initialize ENet client");
         return;
     }
+    enet_host_compress_with_range_coder(local->host);
 
     // Disable connect button and address input field
     component_disable(local->connect_button, 1);
@@ -60,7 +61,7 @@ void menu_connect_start(component *c, void *userdata) {
     enet_address_set_host(&address, addr);
     address.port = settings_get()->net.net_connect_port;
 
-    ENetPeer *peer = enet_host_connect(local->host, &address, 2, 0);
+    ENetPeer *peer = enet_host_connect(local->host, &address, 3, 0);
     if(peer == NULL) {
         DEBUG("Unable to connect to %s", addr);
         enet_host_destroy(local->host);
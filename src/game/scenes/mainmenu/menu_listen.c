@@ -82,6 +82,9 @@ void menu_listen_tick(component *c) {
 
             // Player 2 controller -- Network
             net_controller_create(player2_ctrl, local->host, event.peer, ROLE_SERVER);
+            if(settings_get()->net.net_lockstep) {
+                net_controller_set_lockstep(player2_ctrl, settings_get()->net.net_input_delay);
+            }
             game_player_set_ctrl(p2, player2_ctrl);
             game_player_set_selectable(p2, 1);
 
@@ -127,7 +130,7 @@ component *menu_listen_create(scene *s) {
 
     // Set up host
     local->controllers_created = 0;
-    local->host = enet_host_create(&address, 1, 2, 0, 0);
+    local->host = enet_host_create(&address, 1, 3, 0, 0);
     if(local->host == NULL) {
         DEBUG("Failed to initialize ENet server");
         omf_free(local);
@@ -135,6 +138,9 @@ component *menu_listen_create(scene *s) {
     }
     enet_socket_set_option(local->host->socket, ENET_SOCKOPT_REUSEADDR, 1);
 
+    // State syncs are mostly masks and small deltas. Both ends must compress, or packets get dropped.
+    enet_host_compress_with_range_coder(local->host);
+
     // Text config
     text_settings tconf;
     text_defaults(&tconf);
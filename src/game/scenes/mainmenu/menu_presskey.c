@@ -66,6 +66,7 @@ void menu_presskey_tick(component *c) {
             for(int i = 0; i < 2; i++) {
                 text_settings *tconf = label_get_text_settings(local->text[i]);
                 tconf->cforeground = color_create(0, 121, 0, 255);
+                component_invalidate(local->text[i]);
             }
         }
     }
@@ -91,6 +92,7 @@ void menu_presskey_tick(component *c) {
                 for(int m = 0; m < 2; m++) {
                     text_settings *tconf = label_get_text_settings(local->text[m]);
                     tconf->cforeground = color_create(121, 0, 0, 255);
+                    component_invalidate(local->text[m]);
                 }
                 local->warn_timeout = 50;
                 return;
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 
 #include "game/gui/gauge.h"
 #include "game/gui/label.h"
@@ -47,16 +48,56 @@ void lab_dash_main_photo_right(component *c, void *userdata) {
     video_force_pal_refresh();
 }
 
+// Loads the savegame at the given index position, and shows it on the dashboard.
+static void lab_dash_main_chr_show(dashboard_widgets *dw, int index) {
+    char tmp[DIRINDEX_NAME_MAX];
+    game_player *p1 = game_state_get_player(dw->scene->gs, 0);
+    if(dw->savegame) {
+        sd_chr_free(dw->savegame);
+        omf_free(dw->savegame);
+    }
+    dw->index = index;
+    snprintf(tmp, sizeof(tmp), "%s", dirindex_get_filename(dw->savegames, index));
+    char *ext = strrchr(tmp, '.');
+    if(ext) {
+        ext[0] = 0;
+    }
+    dw->savegame = omf_calloc(1, sizeof(sd_chr_file));
+    sg_load(dw->savegame, tmp);
+    p1->pilot = &dw->savegame->pilot;
+    mechlab_update(dw->scene);
+}
+
+// Steps to the next or previous savegame, skipping the one that is currently in use.
+static void lab_dash_main_chr_step(dashboard_widgets *dw, int step) {
+    game_player *p1 = game_state_get_player(dw->scene->gs, 0);
+    int size = dirindex_size(dw->savegames);
+    int index = dw->index;
+    for(int i = 0; i < size; i++) {
+        index = (index + step + size) % size;
+        const sg_info *info = dirindex_get_info(dw->savegames, index);
+        if(!p1->chr || strcmp(p1->chr->pilot.name, info->name) != 0) {
+            lab_dash_main_chr_show(dw, index);
+            return;
+        }
+    }
+}
+
 void lab_dash_main_chr_load(component *c, void *userdata) {
     dashboard_widgets *dw = userdata;
     game_player *p1 = game_state_get_player(dw->scene->gs, 0);
+    if(dw->savegame == NULL) {
+        trnmenu_finish(c);
+        return;
+    }
     if(p1->chr) {
         sd_chr_free(p1->chr);
         omf_free(p1->chr);
         p1->chr = NULL;
     }
-    p1->chr = omf_calloc(1, sizeof(sd_chr_file));
-    memcpy(p1->chr, ((sd_chr_file *)list_get(dw->savegames, dw->index)), sizeof(sd_chr_file));
+    // The browsed savegame is handed over to the player as is.
+    p1->chr = dw->savegame;
+    dw->savegame = NULL;
     p1->pilot = &p1->chr->pilot;
     strncpy(settings_get()->tournament.last_name, p1->pilot->name, 17);
     settings_save();
@@ -73,49 +114,26 @@ void lab_dash_main_chr_delete(component *c, void *userdata) {
 void lab_dash_main_chr_left(component *c, void *userdata) {
     DEBUG("CHAR LEFT");
     dashboard_widgets *dw = userdata;
-    dw->index--;
-    if(dw->index < 0) {
-        dw->index = list_size(dw->savegames) - 1;
-    }
-    game_player *p1 = game_state_get_player(dw->scene->gs, 0);
-    p1->pilot = &((sd_chr_file *)list_get(dw->savegames, dw->index))->pilot;
-    mechlab_update(dw->scene);
+    lab_dash_main_chr_step(dw, -1);
 }
 
 void lab_dash_main_chr_right(component *c, void *userdata) {
     DEBUG("CHAR RIGHT");
     dashboard_widgets *dw = userdata;
-    dw->index++;
-    if(dw->index >= list_size(dw->savegames)) {
-        dw->index = 0;
-    }
-    game_player *p1 = game_state_get_player(dw->scene->gs, 0);
-    p1->pilot = &((sd_chr_file *)list_get(dw->savegames, dw->index))->pilot;
-    mechlab_update(dw->scene);
+    lab_dash_main_chr_step(dw, 1);
 }
 
 void lab_dash_main_chr_init(component *menu, component *submenu) {
     DEBUG("init chr select submenu");
     dashboard_widgets *dw = trnmenu_get_userdata(submenu);
-    dw->savegames = sg_load_all();
-    game_player *p1 = game_state_get_player(dw->scene->gs, 0);
-    // find the current character, if any, and exclude them
-    // and set the first pilot in the list to be the loaded one
+    // Only the savegame index is read here; a savegame is fully loaded when it is browsed to.
+    dw->savegames = omf_calloc(1, sizeof(dirindex));
+    sg_list(dw->savegames);
+    dw->savegame = NULL;
+    // find the first savegame that is not the current character, if any,
     // and call mechlab_update to draw it
-    iterator it;
-    list_iter_begin(dw->savegames, &it);
-
-    sd_chr_file *chr = NULL;
-    while((chr = (sd_chr_file *)list_iter_next(&it))) {
-        if(p1->chr && strcmp(p1->chr->pilot.name, chr->pilot.name) == 0) {
-            sd_chr_free(chr);
-            list_delete(dw->savegames, &it);
-        }
-    }
-    dw->index = 0;
-    chr = list_get(dw->savegames, 0);
-    p1->pilot = &chr->pilot;
-    mechlab_update(dw->scene);
+    dw->index = -1;
+    lab_dash_main_chr_step(dw, 1);
 }
 void lab_dash_main_chr_done(component *menu, component *submenu) {
     DEBUG("end chr select submenu");
@@ -123,14 +141,9 @@ void lab_dash_main_chr_done(component *menu, component *submenu) {
     // We can get here either when the user backs out of the menu
     // or when they select something. In either case we want to makes
     // sure that if there's a player->chr set, the player->pilot matches
-    // that CHR, that we do not free that CHR from the savegame list
-    // and if there's no CHR we null out the pilot as well.
-    iterator it;
-    list_iter_begin(dw->savegames, &it);
+    // that CHR, and if there's no CHR we null out the pilot as well.
     game_player *p1 = game_state_get_player(dw->scene->gs, 0);
 
-    sd_chr_file *chr = NULL;
-
     if(p1->chr) {
         // character is loaded, revert the pilot to it
         p1->pilot = &p1->chr->pilot;
@@ -139,15 +152,12 @@ void lab_dash_main_chr_done(component *menu, component *submenu) {
         p1->pilot = NULL;
     }
 
-    while((chr = (sd_chr_file *)list_iter_next(&it))) {
-        if(p1->chr && strcmp(p1->chr->pilot.name, chr->pilot.name) != 0) {
-            sd_chr_free(chr);
-        }
+    if(dw->savegame) {
+        sd_chr_free(dw->savegame);
+        omf_free(dw->savegame);
     }
-
-    list_free(dw->savegames);
+    dirindex_free(dw->savegames);
     omf_free(dw->savegames);
-    dw->savegames = NULL;
 
     mechlab_update(dw->scene);
 }
@@ -160,6 +170,7 @@ component *lab_dash_main_create(scene *s, dashboard_widgets *dw) {
     dw->pilot = p1->pilot;
 
     dw->savegames = NULL;
+    dw->savegame = NULL;
     dw->index = 0;
 
     text_settings tconf_dark;
@@ -4,12 +4,14 @@
 #include "formats/pilot.h"
 #include "game/gui/component.h"
 #include "game/protos/scene.h"
+#include "resources/dirindex.h"
 
 // For easy access to components
 typedef struct {
     scene *scene;
     sd_pilot *pilot;
-    list *savegames;
+    dirindex *savegames;
+    sd_chr_file *savegame; // Currently browsed savegame, loaded when it is selected
     int16_t index;
     component *photo;
     component *power;
@@ -603,12 +603,12 @@ int melee_create(scene *scene) {
     sprite *spr;
     for(int i = 0; i < 10; i++) {
         ani = &bk_get_info(&scene->bk_data, 3)->ani;
-        object_create(&local->pilots[i], scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+        object_create(&local->pilots[i], scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
         object_set_animation(&local->pilots[i], ani);
         object_select_sprite(&local->pilots[i], i);
 
         ani = &bk_get_info(&scene->bk_data, 18 + i)->ani;
-        object_create(&local->har_player1[i], scene->gs, vec2i_create(110, 95), vec2f_create(0, 0));
+        object_create(&local->har_player1[i], scene->gs, vec2i_create(110, 95), vec2fx_create(0, 0));
         object_set_animation(&local->har_player1[i], ani);
         object_select_sprite(&local->har_player1[i], 0);
         object_set_repeat(&local->har_player1[i], 1);
@@ -618,7 +618,7 @@ int melee_create(scene *scene) {
         spr = sprite_copy(animation_get_sprite(&bk_get_info(&scene->bk_data, 1)->ani, 0));
         mask_sprite(spr->data, 62 * col, 42 * row, 51, 36);
         ani = create_animation_from_single(spr, spr->pos);
-        object_create(&local->harportraits_player1[i], scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+        object_create(&local->harportraits_player1[i], scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
         object_set_animation(&local->harportraits_player1[i], ani);
         object_select_sprite(&local->harportraits_player1[i], 0);
         object_set_animation_owner(&local->harportraits_player1[i], OWNER_OBJECT);
@@ -626,14 +626,14 @@ int melee_create(scene *scene) {
             spr = sprite_copy(animation_get_sprite(&bk_get_info(&scene->bk_data, 1)->ani, 0));
             mask_sprite(spr->data, 62 * col, 42 * row, 51, 36);
             ani = create_animation_from_single(spr, spr->pos);
-            object_create(&local->harportraits_player2[i], scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+            object_create(&local->harportraits_player2[i], scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
             object_set_animation(&local->harportraits_player2[i], ani);
             object_select_sprite(&local->harportraits_player2[i], 0);
             object_set_animation_owner(&local->harportraits_player2[i], OWNER_OBJECT);
             object_set_pal_offset(&local->harportraits_player2[i], 48);
 
             ani = &bk_get_info(&scene->bk_data, 18 + i)->ani;
-            object_create(&local->har_player2[i], scene->gs, vec2i_create(210, 95), vec2f_create(0, 0));
+            object_create(&local->har_player2[i], scene->gs, vec2i_create(210, 95), vec2fx_create(0, 0));
             object_set_animation(&local->har_player2[i], ani);
             object_select_sprite(&local->har_player2[i], 0);
             object_set_repeat(&local->har_player2[i], 1);
@@ -643,19 +643,19 @@ int melee_create(scene *scene) {
     }
 
     ani = &bk_get_info(&scene->bk_data, 4)->ani;
-    object_create(&local->bigportrait1, scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+    object_create(&local->bigportrait1, scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
     object_set_animation(&local->bigportrait1, ani);
     object_select_sprite(&local->bigportrait1, 0);
 
     if(player2->selectable) {
-        object_create(&local->bigportrait2, scene->gs, vec2i_create(320, 0), vec2f_create(0, 0));
+        object_create(&local->bigportrait2, scene->gs, vec2i_create(320, 0), vec2fx_create(0, 0));
         object_set_animation(&local->bigportrait2, ani);
         object_select_sprite(&local->bigportrait2, 4);
         object_set_direction(&local->bigportrait2, OBJECT_FACE_LEFT);
     }
 
     ani = &bk_get_info(&scene->bk_data, 5)->ani;
-    object_create(&local->player2_placeholder, scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+    object_create(&local->player2_placeholder, scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
     object_set_animation(&local->player2_placeholder, ani);
     if(player2->selectable) {
         object_select_sprite(&local->player2_placeholder, 0);
@@ -666,7 +666,7 @@ int melee_create(scene *scene) {
     spr = sprite_copy(animation_get_sprite(&bk_get_info(&scene->bk_data, 1)->ani, 0));
     surface_convert_to_rgba(spr->data, video_get_pal_ref(), 0);
     ani = create_animation_from_single(spr, spr->pos);
-    object_create(&local->unselected_har_portraits, scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+    object_create(&local->unselected_har_portraits, scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
     object_set_animation(&local->unselected_har_portraits, ani);
     object_select_sprite(&local->unselected_har_portraits, 0);
     object_set_animation_owner(&local->unselected_har_portraits, OWNER_OBJECT);
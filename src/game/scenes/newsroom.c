@@ -24,6 +24,9 @@ typedef struct newsroom_local_t {
     int screen;
     surface news_bg;
     str news_str;
+    unsigned int news_str_id; // Translation the current news_str was formatted from, 0 if none
+    video_cache *text_cache;  // News box with the text, as of text_cache_id
+    unsigned int text_cache_id;
     str pilot1, pilot2;
     str har1, har2;
     int sex1, sex2;
@@ -70,6 +73,11 @@ void newsroom_fixup_str(newsroom_local *local) {
         translation_id = NEWSROOM_TEXT + local->news_id + min2(local->screen, 1);
     }
 
+    // Names stay the same for the whole scene, so the text only needs formatting when the translation changes.
+    if(translation_id == local->news_str_id) {
+        return;
+    }
+
     str tmp;
     str_from_c(&tmp, lang_get(translation_id));
     str_replace(&tmp, "~11", subject_pronoun(local->sex2), -1);
@@ -87,6 +95,7 @@ void newsroom_fixup_str(newsroom_local *local) {
     str_free(&local->news_str);
     str_from(&local->news_str, &tmp);
     str_free(&tmp);
+    local->news_str_id = translation_id;
 }
 
 void newsroom_set_names(newsroom_local *local, const char *pilot1, const char *pilot2, const char *har1,
@@ -98,6 +107,8 @@ void newsroom_set_names(newsroom_local *local, const char *pilot1, const char *p
     str_from_c(&local->har2, har2);
     local->sex1 = sex1;
     local->sex2 = sex2;
+    local->news_str_id = 0;
+    video_cache_invalidate(local->text_cache);
 
     // Remove the whitespace at the end of pilots name
     str_rstrip(&local->pilot1);
@@ -108,6 +119,7 @@ void newsroom_set_names(newsroom_local *local, const char *pilot1, const char *p
 void newsroom_free(scene *scene) {
     newsroom_local *local = scene_get_userdata(scene);
     surface_free(&local->news_bg);
+    video_cache_free(local->text_cache);
     str_free(&local->news_str);
     str_free(&local->pilot1);
     str_free(&local->pilot2);
@@ -123,6 +135,11 @@ void newsroom_static_tick(scene *scene, int paused) {
     dialog_tick(&local->continue_dialog);
 }
 
+static void newsroom_render_text(newsroom_local *local) {
+    video_render_sprite(&local->news_bg, 20, 140, BLEND_ALPHA, 0);
+    font_render_wrapped(&font_small, str_c(&local->news_str), 30, 150, 250, COLOR_YELLOW);
+}
+
 void newsroom_overlay_render(scene *scene) {
     newsroom_local *local = scene_get_userdata(scene);
 
@@ -137,9 +154,18 @@ void newsroom_overlay_render(scene *scene) {
     }
 
     // Render text
+    // The text only changes between screens, so it is kept in a cache instead of being drawn glyph by glyph.
     if(str_size(&local->news_str) > 0) {
-        video_render_sprite(&local->news_bg, 20, 140, BLEND_ALPHA, 0);
-        font_render_wrapped(&font_small, str_c(&local->news_str), 30, 150, 250, COLOR_YELLOW);
+        if(video_cache_is_valid(local->text_cache) && local->text_cache_id == local->news_str_id) {
+            video_cache_render(local->text_cache);
+        } else if(video_cache_begin(local->text_cache, 20, 140, 280, 50)) {
+            newsroom_render_text(local);
+            video_cache_end(local->text_cache);
+            video_cache_render(local->text_cache);
+            local->text_cache_id = local->news_str_id;
+        } else {
+            newsroom_render_text(local);
+        }
     }
 
     // Dialog
@@ -277,6 +303,7 @@ int newsroom_create(scene *scene) {
     local->screen = 0;
     local->champion = false;
     menu_background_create(&local->news_bg, 280, 50);
+    local->text_cache = video_cache_create();
     str_create(&local->news_str);
     str_create(&local->pilot1);
     str_create(&local->pilot2);
@@ -17,7 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-void cb_vs_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g, void *userdata);
+void cb_vs_spawn_object(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g, void *userdata);
 void cb_vs_destroy_object(object *parent, int id, void *userdata);
 
 typedef struct vs_local_t {
@@ -105,14 +105,14 @@ vec2i spawn_position(int index, int scientist) {
     return vec2i_create(160, 200);
 }
 
-void cb_vs_spawn_object(object *parent, int id, vec2i pos, vec2f vel, uint8_t flags, int s, int g, void *userdata) {
+void cb_vs_spawn_object(object *parent, int id, vec2i pos, vec2fx vel, uint8_t flags, int s, int g, void *userdata) {
     scene *sc = (scene *)userdata;
 
     // Get next animation
     bk_info *info = bk_get_info(&sc->bk_data, id);
     if(info != NULL) {
         object *obj = omf_calloc(1, sizeof(object));
-        object_create(obj, parent->gs, vec2i_add(pos, vec2f_to_i(parent->pos)), vel);
+        object_create(obj, parent->gs, vec2i_add(pos, vec2fx_to_i(parent->pos)), vel);
         object_set_stl(obj, object_get_stl(parent));
         object_set_animation(obj, &info->ani);
         object_set_spawn_cb(obj, cb_vs_spawn_object, userdata);
@@ -382,19 +382,19 @@ int vs_create(scene *scene) {
 
     // HAR
     ani = &bk_get_info(&scene->bk_data, 5)->ani;
-    object_create(&local->player1_har, scene->gs, vec2i_create(160, 0), vec2f_create(0, 0));
+    object_create(&local->player1_har, scene->gs, vec2i_create(160, 0), vec2fx_create(0, 0));
     object_set_animation(&local->player1_har, ani);
     object_select_sprite(&local->player1_har, player1->pilot->har_id);
 
     if(player2->pilot) {
-        object_create(&local->player2_har, scene->gs, vec2i_create(160, 0), vec2f_create(0, 0));
+        object_create(&local->player2_har, scene->gs, vec2i_create(160, 0), vec2fx_create(0, 0));
         object_set_animation(&local->player2_har, ani);
         object_select_sprite(&local->player2_har, player2->pilot->har_id);
         object_set_direction(&local->player2_har, OBJECT_FACE_LEFT);
         object_set_pal_offset(&local->player2_har, 48);
 
         // PLAYER
-        object_create(&local->player1_portrait, scene->gs, vec2i_create(-10, 150), vec2f_create(0, 0));
+        object_create(&local->player1_portrait, scene->gs, vec2i_create(-10, 150), vec2fx_create(0, 0));
         ani = &bk_get_info(&scene->bk_data, 4)->ani;
         if(player1->chr) {
             object_set_sprite_override(&local->player1_portrait, 1);
@@ -405,7 +405,7 @@ int vs_create(scene *scene) {
             object_select_sprite(&local->player1_portrait, player1->pilot->pilot_id);
         }
 
-        object_create(&local->player2_portrait, scene->gs, vec2i_create(330, 150), vec2f_create(0, 0));
+        object_create(&local->player2_portrait, scene->gs, vec2i_create(330, 150), vec2fx_create(0, 0));
         if(player1->chr) {
             object_set_sprite_override(&local->player2_portrait, 1);
             local->player2_portrait.cur_sprite = omf_calloc(1, sizeof(sprite));
@@ -418,7 +418,7 @@ int vs_create(scene *scene) {
     } else {
 
         // plug is player 1 now
-        object_create(&local->player1_portrait, scene->gs, vec2i_create(-10, 150), vec2f_create(0, 0));
+        object_create(&local->player1_portrait, scene->gs, vec2i_create(-10, 150), vec2fx_create(0, 0));
         ani = &bk_get_info(&scene->bk_data, 2)->ani;
         object_set_animation(&local->player1_portrait, ani);
         object_select_sprite(&local->player1_portrait, 0);
@@ -449,7 +449,7 @@ int vs_create(scene *scene) {
     // Arena
     if(player2->selectable) {
         ani = &bk_get_info(&scene->bk_data, 3)->ani;
-        object_create(&local->arena_select, scene->gs, vec2i_create(59, 155), vec2f_create(0, 0));
+        object_create(&local->arena_select, scene->gs, vec2i_create(59, 155), vec2fx_create(0, 0));
         object_set_animation(&local->arena_select, ani);
         object_select_sprite(&local->arena_select, local->arena);
     }
@@ -470,7 +470,7 @@ int vs_create(scene *scene) {
     }
     object *o_scientist = omf_calloc(1, sizeof(object));
     ani = &bk_get_info(&scene->bk_data, 8)->ani;
-    object_create(o_scientist, scene->gs, scientistcoord, vec2f_create(0, 0));
+    object_create(o_scientist, scene->gs, scientistcoord, vec2fx_create(0, 0));
     object_set_animation(o_scientist, ani);
     object_select_sprite(o_scientist, 0);
     object_set_direction(o_scientist, scientistpos % 2 ? OBJECT_FACE_LEFT : OBJECT_FACE_RIGHT);
@@ -491,7 +491,7 @@ int vs_create(scene *scene) {
     }
     object *o_welder = omf_calloc(1, sizeof(object));
     ani = &bk_get_info(&scene->bk_data, 7)->ani;
-    object_create(o_welder, scene->gs, spawn_position(welderpos, 0), vec2f_create(0, 0));
+    object_create(o_welder, scene->gs, spawn_position(welderpos, 0), vec2fx_create(0, 0));
     object_set_animation(o_welder, ani);
     object_select_sprite(o_welder, 0);
     object_set_spawn_cb(o_welder, cb_vs_spawn_object, (void *)scene);
@@ -502,14 +502,14 @@ int vs_create(scene *scene) {
     // GANTRIES
     object *o_gantry_a = omf_calloc(1, sizeof(object));
     ani = &bk_get_info(&scene->bk_data, 11)->ani;
-    object_create(o_gantry_a, scene->gs, vec2i_create(0, 0), vec2f_create(0, 0));
+    object_create(o_gantry_a, scene->gs, vec2i_create(0, 0), vec2fx_create(0, 0));
     object_set_animation(o_gantry_a, ani);
     object_select_sprite(o_gantry_a, 0);
     game_state_add_object(scene->gs, o_gantry_a, RENDER_LAYER_TOP, 0, 0);
 
     if(player2->pilot) {
         object *o_gantry_b = omf_calloc(1, sizeof(object));
-        object_create(o_gantry_b, scene->gs, vec2i_create(320, 0), vec2f_create(0, 0));
+        object_create(o_gantry_b, scene->gs, vec2i_create(320, 0), vec2fx_create(0, 0));
         object_set_animation(o_gantry_b, ani);
         object_select_sprite(o_gantry_b, 0);
         object_set_direction(o_gantry_b, OBJECT_FACE_LEFT);
@@ -0,0 +1,199 @@
+#include "game/utils/object_pool.h"
+#include "game/protos/object.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include <stdlib.h>
+
+#define INITIAL_CAPACITY 64
+#define MAX_SLOTS 0xFFFF
+
+#define HANDLE_INDEX(h) ((h)&0xFFFF)
+#define HANDLE_GEN(h) ((h) >> 16)
+#define MAKE_HANDLE(gen, index) (((uint32_t)(gen) << 16) | (uint32_t)(index))
+
+static void object_pool_grow_dense(object_pool *pool) {
+    unsigned int cap = pool->capacity * 2;
+    pool->objs = omf_realloc(pool->objs, cap * sizeof(object *));
+    pool->handles = omf_realloc(pool->handles, cap * sizeof(object_handle));
+    pool->render_layer = omf_realloc(pool->render_layer, cap * sizeof(uint8_t));
+    pool->flags = omf_realloc(pool->flags, cap * sizeof(uint8_t));
+    pool->group = omf_realloc(pool->group, cap * sizeof(int8_t));
+    pool->layers = omf_realloc(pool->layers, cap * sizeof(uint8_t));
+    pool->capacity = cap;
+}
+
+static void object_pool_grow_slots(object_pool *pool) {
+    unsigned int cap = pool->slot_capacity * 2;
+    pool->slot_dense = omf_realloc(pool->slot_dense, cap * sizeof(uint32_t));
+    pool->slot_gen = omf_realloc(pool->slot_gen, cap * sizeof(uint16_t));
+    pool->free_slots = omf_realloc(pool->free_slots, cap * sizeof(uint16_t));
+    pool->slot_capacity = cap;
+}
+
+void object_pool_create(object_pool *pool) {
+    pool->capacity = INITIAL_CAPACITY;
+    pool->objs = omf_calloc(pool->capacity, sizeof(object *));
+    pool->handles = omf_calloc(pool->capacity, sizeof(object_handle));
+    pool->render_layer = omf_calloc(pool->capacity, sizeof(uint8_t));
+    pool->flags = omf_calloc(pool->capacity, sizeof(uint8_t));
+    pool->group = omf_calloc(pool->capacity, sizeof(int8_t));
+    pool->layers = omf_calloc(pool->capacity, sizeof(uint8_t));
+    pool->count = 0;
+    pool->removed = 0;
+
+    pool->slot_capacity = INITIAL_CAPACITY;
+    pool->slot_dense = omf_calloc(pool->slot_capacity, sizeof(uint32_t));
+    pool->slot_gen = omf_calloc(pool->slot_capacity, sizeof(uint16_t));
+    pool->free_slots = omf_calloc(pool->slot_capacity, sizeof(uint16_t));
+    pool->slot_count = 0;
+    pool->free_count = 0;
+}
+
+/*
+ * Frees the pool storage. Note that objects themselves are owned by the caller, and are not freed!
+ */
+void object_pool_free(object_pool *pool) {
+    omf_free(pool->objs);
+    omf_free(pool->handles);
+    omf_free(pool->render_layer);
+    omf_free(pool->flags);
+    omf_free(pool->group);
+    omf_free(pool->layers);
+    omf_free(pool->slot_dense);
+    omf_free(pool->slot_gen);
+    omf_free(pool->free_slots);
+    pool->count = 0;
+    pool->capacity = 0;
+    pool->removed = 0;
+    pool->slot_count = 0;
+    pool->slot_capacity = 0;
+    pool->free_count = 0;
+}
+
+/*
+ * Appends an object to the end of the pool. Handle is also written to obj->handle.
+ * Returns OBJECT_HANDLE_NONE if the pool is full.
+ */
+object_handle object_pool_add(object_pool *pool, object *obj, int render_layer, int flags) {
+    unsigned int slot;
+    if(pool->free_count > 0) {
+        slot = pool->free_slots[--pool->free_count];
+    } else {
+        if(pool->slot_count >= MAX_SLOTS) {
+            PERROR("Object pool is full!");
+            return OBJECT_HANDLE_NONE;
+        }
+        if(pool->slot_count >= pool->slot_capacity) {
+            object_pool_grow_slots(pool);
+        }
+        slot = pool->slot_count++;
+        pool->slot_gen[slot] = 1;
+    }
+    if(pool->count >= pool->capacity) {
+        object_pool_grow_dense(pool);
+    }
+
+    unsigned int index = pool->count++;
+    object_handle handle = MAKE_HANDLE(pool->slot_gen[slot], slot);
+    pool->slot_dense[slot] = index;
+    pool->objs[index] = obj;
+    pool->handles[index] = handle;
+    pool->render_layer[index] = render_layer;
+    pool->flags[index] = flags;
+    pool->group[index] = obj->group;
+    pool->layers[index] = obj->layers;
+    obj->handle = handle;
+    return handle;
+}
+
+// Returns dense index for handle, or -1 if the handle is stale or invalid.
+static int object_pool_index(const object_pool *pool, object_handle handle) {
+    unsigned int slot = HANDLE_INDEX(handle);
+    if(handle == OBJECT_HANDLE_NONE || slot >= pool->slot_count || pool->slot_gen[slot] != HANDLE_GEN(handle)) {
+        return -1;
+    }
+    unsigned int index = pool->slot_dense[slot];
+    if(pool->objs[index] == NULL) {
+        return -1;
+    }
+    return index;
+}
+
+/*
+ * Resolves a handle to an object. Returns NULL if the object has been removed.
+ */
+object *object_pool_get(const object_pool *pool, object_handle handle) {
+    int index = object_pool_index(pool, handle);
+    return (index < 0) ? NULL : pool->objs[index];
+}
+
+/*
+ * Removes an object from the pool. The dense entry is only marked as removed, and
+ * the actual storage is reclaimed on the next object_pool_compact() call.
+ * Returns 0 on success, 1 if the handle was stale.
+ */
+int object_pool_remove(object_pool *pool, object_handle handle) {
+    int index = object_pool_index(pool, handle);
+    if(index < 0) {
+        return 1;
+    }
+    unsigned int slot = HANDLE_INDEX(handle);
+    pool->objs[index]->handle = OBJECT_HANDLE_NONE;
+    pool->objs[index] = NULL;
+    pool->removed++;
+
+    // Bump the generation so that old handles stop resolving. Zero is never used.
+    pool->slot_gen[slot]++;
+    if(pool->slot_gen[slot] == 0) {
+        pool->slot_gen[slot] = 1;
+    }
+    pool->free_slots[pool->free_count++] = slot;
+    return 0;
+}
+
+/*
+ * Drops all removed entries from the dense arrays. Order of the remaining entries
+ * is preserved, since rendering and tick order depends on it.
+ */
+void object_pool_compact(object_pool *pool) {
+    if(pool->removed == 0) {
+        return;
+    }
+    unsigned int w = 0;
+    for(unsigned int r = 0; r < pool->count; r++) {
+        if(pool->objs[r] == NULL) {
+            continue;
+        }
+        if(w != r) {
+            pool->objs[w] = pool->objs[r];
+            pool->handles[w] = pool->handles[r];
+            pool->render_layer[w] = pool->render_layer[r];
+            pool->flags[w] = pool->flags[r];
+            pool->group[w] = pool->group[r];
+            pool->layers[w] = pool->layers[r];
+            pool->slot_dense[HANDLE_INDEX(pool->handles[w])] = w;
+        }
+        w++;
+    }
+    pool->count = w;
+    pool->removed = 0;
+}
+
+/*
+ * Refreshes the mirrored hot fields from the objects.
+ */
+void object_pool_sync(object_pool *pool) {
+    for(unsigned int i = 0; i < pool->count; i++) {
+        if(pool->objs[i] != NULL) {
+            pool->group[i] = pool->objs[i]->group;
+            pool->layers[i] = pool->objs[i]->layers;
+        }
+    }
+}
+
+/*
+ * Returns the amount of live objects in the pool.
+ */
+unsigned int object_pool_size(const object_pool *pool) {
+    return pool->count - pool->removed;
+}
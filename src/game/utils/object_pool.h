@@ -0,0 +1,60 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <stdint.h>
+
+typedef struct object_t object;
+
+// Handle to an object in the pool. Upper 16 bits are the slot generation, lower 16 bits the slot index.
+typedef uint32_t object_handle;
+
+#define OBJECT_HANDLE_NONE 0
+
+enum
+{
+    OBJECT_POOL_PERSISTENT = 0x1, ///< Object should keep alive across scene boundaries
+    OBJECT_POOL_SINGLETON = 0x2,  ///< Object should be the only representative of its animation ID
+};
+
+/**
+ * @brief Dense, insertion ordered storage for the objects of a game state.
+ * @details Entries are kept in structure-of-arrays form, so passes that only need the render
+ *          layer or collision group/layers never touch the object structs themselves. Removed
+ *          entries are only marked as such (objs[i] == NULL), and are dropped by
+ *          object_pool_compact(). This makes removal safe while iterating, and keeps the
+ *          iteration order stable.
+ *
+ *          Objects can be referred to by a generation checked handle, which resolves to NULL
+ *          once the object has been removed, even if its slot has been reused.
+ */
+typedef struct object_pool_t {
+    // Dense arrays; index is the iteration order. Entries in [0, count) may be NULL.
+    object **objs;
+    object_handle *handles;
+    uint8_t *render_layer;
+    uint8_t *flags;
+    int8_t *group;   ///< Mirror of object->group, see object_pool_sync()
+    uint8_t *layers; ///< Mirror of object->layers, see object_pool_sync()
+    unsigned int count;
+    unsigned int capacity;
+    unsigned int removed;
+
+    // Sparse slot table; maps handles to dense indexes.
+    uint32_t *slot_dense;
+    uint16_t *slot_gen;
+    uint16_t *free_slots;
+    unsigned int slot_count;
+    unsigned int free_count;
+    unsigned int slot_capacity;
+} object_pool;
+
+void object_pool_create(object_pool *pool);
+void object_pool_free(object_pool *pool);
+object_handle object_pool_add(object_pool *pool, object *obj, int render_layer, int flags);
+object *object_pool_get(const object_pool *pool, object_handle handle);
+int object_pool_remove(object_pool *pool, object_handle handle);
+void object_pool_compact(object_pool *pool);
+void object_pool_sync(object_pool *pool);
+unsigned int object_pool_size(const object_pool *pool);
+
+#endif // OBJECT_POOL_H
@@ -0,0 +1,104 @@
+#include "game/utils/replay_trace.h"
+#include "utils/log.h"
+#include <stdio.h>
+#include <string.h>
+
+// First line of a trace file; bump the number if the format or the checksummed state changes
+#define REPLAY_TRACE_HEADER "openomf-trace 1"
+
+void replay_trace_create(replay_trace *trace) {
+    vector_create(&trace->ticks, sizeof(replay_tick));
+    trace->outcome.winner = -1;
+    for(int i = 0; i < 2; i++) {
+        trace->outcome.health[i] = 0;
+        trace->outcome.score[i] = 0;
+    }
+}
+
+void replay_trace_free(replay_trace *trace) {
+    vector_free(&trace->ticks);
+}
+
+void replay_trace_add(replay_trace *trace, unsigned int tick, uint32_t checksum) {
+    replay_tick t;
+    t.tick = tick;
+    t.checksum = checksum;
+    vector_append(&trace->ticks, &t);
+}
+
+// Writes the trace to a file. Returns 1 if the file can't be written.
+int replay_trace_save(const replay_trace *trace, const char *filename) {
+    FILE *f = fopen(filename, "w");
+    if(f == NULL) {
+        PERROR("Unable to write trace %s", filename);
+        return 1;
+    }
+    const replay_outcome *o = &trace->outcome;
+    fprintf(f, "%s\n", REPLAY_TRACE_HEADER);
+    fprintf(f, "outcome %d %d %d %d %d\n", o->winner, o->health[0], o->health[1], o->score[0], o->score[1]);
+    for(unsigned int i = 0; i < vector_size(&trace->ticks); i++) {
+        const replay_tick *t = vector_get(&trace->ticks, i);
+        fprintf(f, "%u %08x\n", t->tick, t->checksum);
+    }
+    int ret = ferror(f) ? 1 : 0;
+    fclose(f);
+    return ret;
+}
+
+// Reads a trace written by replay_trace_save() into a created trace. Returns 1 if the file is missing or broken.
+int replay_trace_load(replay_trace *trace, const char *filename) {
+    char line[64];
+    FILE *f = fopen(filename, "r");
+    if(f == NULL) {
+        return 1;
+    }
+    replay_outcome *o = &trace->outcome;
+    if(fgets(line, sizeof(line), f) == NULL || strncmp(line, REPLAY_TRACE_HEADER, strlen(REPLAY_TRACE_HEADER)) ||
+       fscanf(f, "outcome %d %d %d %d %d\n", &o->winner, &o->health[0], &o->health[1], &o->score[0],
+              &o->score[1]) != 5) {
+        PERROR("Trace %s is not in a known format", filename);
+        fclose(f);
+        return 1;
+    }
+    unsigned int tick;
+    uint32_t checksum;
+    while(fscanf(f, "%u %x\n", &tick, &checksum) == 2) {
+        replay_trace_add(trace, tick, checksum);
+    }
+    int ret = feof(f) ? 0 : 1;
+    if(ret) {
+        PERROR("Trace %s is broken after %u ticks", filename, vector_size(&trace->ticks));
+    }
+    fclose(f);
+    return ret;
+}
+
+/*
+ * Compares a trace against a golden one. If the ticks differ, the first tick that differs is stored
+ * in tick. Returns one of the REPLAY_TRACE_* values.
+ */
+int replay_trace_compare(const replay_trace *golden, const replay_trace *trace, unsigned int *tick) {
+    unsigned int golden_size = vector_size(&golden->ticks);
+    unsigned int size = vector_size(&trace->ticks);
+    for(unsigned int i = 0; i < golden_size && i < size; i++) {
+        const replay_tick *a = vector_get(&golden->ticks, i);
+        const replay_tick *b = vector_get(&trace->ticks, i);
+        if(a->tick != b->tick || a->checksum != b->checksum) {
+            *tick = a->tick;
+            return REPLAY_TRACE_DIVERGED;
+        }
+    }
+    if(golden_size != size) {
+        const replay_trace *longer = golden_size > size ? golden : trace;
+        unsigned int common = golden_size < size ? golden_size : size;
+        *tick = ((const replay_tick *)vector_get(&longer->ticks, common))->tick;
+        return REPLAY_TRACE_LENGTH;
+    }
+    const replay_outcome *a = &golden->outcome;
+    const replay_outcome *b = &trace->outcome;
+    if(a->winner != b->winner || a->health[0] != b->health[0] || a->health[1] != b->health[1] ||
+       a->score[0] != b->score[0] || a->score[1] != b->score[1]) {
+        return REPLAY_TRACE_OUTCOME;
+    }
+    return REPLAY_TRACE_MATCH;
+}
@@ -0,0 +1,44 @@
+#ifndef REPLAY_TRACE_H
+#define REPLAY_TRACE_H
+
+#include "utils/vector.h"
+#include <stdint.h>
+
+/*
+ * Trace of a played back recording: the state checksum of every tick, and how the match ended. Traces
+ * are saved next to the recordings as golden files, and a later playback must produce the same trace.
+ * The files are text, one tick per line, so that a changed trace can be looked at with diff.
+ */
+
+enum
+{
+    REPLAY_TRACE_MATCH,    // Traces are the same
+    REPLAY_TRACE_DIVERGED, // A tick has a different checksum
+    REPLAY_TRACE_LENGTH,   // One trace has ticks the other one does not
+    REPLAY_TRACE_OUTCOME   // Ticks are the same, but the match ended differently
+};
+
+typedef struct {
+    int winner;    // Player who won the match, or -1 if nobody did
+    int health[2]; // HAR health of both players at the end
+    int score[2];  // Score of both players at the end
+} replay_outcome;
+
+typedef struct {
+    vector ticks; // replay_tick entries, in the order they were played
+    replay_outcome outcome;
+} replay_trace;
+
+typedef struct {
+    unsigned int tick;
+    uint32_t checksum;
+} replay_tick;
+
+void replay_trace_create(replay_trace *trace);
+void replay_trace_free(replay_trace *trace);
+void replay_trace_add(replay_trace *trace, unsigned int tick, uint32_t checksum);
+int replay_trace_save(const replay_trace *trace, const char *filename);
+int replay_trace_load(replay_trace *trace, const char *filename);
+int replay_trace_compare(const replay_trace *golden, const replay_trace *trace, unsigned int *tick);
+
+#endif // REPLAY_TRACE_H
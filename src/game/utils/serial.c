@@ -58,6 +58,15 @@ serial *serial_calloc_copy(const serial *src) {
     return dst;
 }
 
+// Makes room for len more bytes, so that writing them doesn't reallocate.
+void serial_reserve(serial *s, size_t len) {
+    if(s->len < (s->wpos + len)) {
+        size_t new_len = s->wpos + len + SERIAL_BUF_RESIZE_INC;
+        s->data = omf_realloc(s->data, new_len);
+        s->len = new_len;
+    }
+}
+
 void serial_write(serial *s, const char *buf, size_t len) {
     if(s->len < (s->wpos + len)) {
         size_t new_len = s->len + len + SERIAL_BUF_RESIZE_INC;
@@ -88,6 +97,15 @@ void serial_write_float(serial *s, float v) {
     serial_write(s, (char *)&t, sizeof(t));
 }
 
+// Writes a fixedpt as it is stored, so that the reader gets exactly the same value back
+void serial_write_fixedpt(serial *s, fixedpt v) {
+#ifdef FIXED_POINT_PHYSICS
+    serial_write_int32(s, v);
+#else
+    serial_write_float(s, v);
+#endif
+}
+
 void serial_free(serial *s) {
     omf_free(s->data);
     s->len = 0;
@@ -134,3 +152,11 @@ float serial_read_float(serial *s) {
     serial_read(s, (char *)&v, sizeof(v));
     return ntohf(v);
 }
+
+fixedpt serial_read_fixedpt(serial *s) {
+#ifdef FIXED_POINT_PHYSICS
+    return serial_read_int32(s);
+#else
+    return serial_read_float(s);
+#endif
+}
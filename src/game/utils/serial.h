@@ -1,6 +1,7 @@
 #ifndef SERIAL_H
 #define SERIAL_H
 
+#include "utils/fixedpt.h"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -13,11 +14,13 @@ typedef struct serial_t {
 
 void serial_create(serial *s);
 void serial_create_from(serial *s, const char *buf, size_t len);
+void serial_reserve(serial *s, size_t len);
 void serial_write(serial *s, const char *buf, size_t len);
 void serial_write_int8(serial *s, int8_t v);
 void serial_write_int16(serial *s, int16_t v);
 void serial_write_int32(serial *s, int32_t v);
 void serial_write_float(serial *s, float v);
+void serial_write_fixedpt(serial *s, fixedpt v);
 size_t serial_len(serial *s);
 void serial_read(serial *s, char *buf, size_t len);
 void serial_free(serial *s);
@@ -27,6 +30,7 @@ int16_t serial_read_int16(serial *s);
 int32_t serial_read_int32(serial *s);
 long serial_read_long(serial *s);
 float serial_read_float(serial *s);
+fixedpt serial_read_fixedpt(serial *s);
 void serial_copy(serial *dst, const serial *src);
 serial *serial_calloc_copy(const serial *src);
 
@@ -53,11 +53,12 @@ typedef struct {
 } struct_to_field;
 
 const field f_video[] = {
-    F_INT(settings_video, screen_w, 640),    F_INT(settings_video, screen_h, 400),
-    F_BOOL(settings_video, vsync, 0),        F_BOOL(settings_video, fullscreen, 0),
-    F_INT(settings_video, scaling, 0),       F_BOOL(settings_video, instant_console, 0),
-    F_BOOL(settings_video, crossfade_on, 1), F_STRING(settings_video, scaler, "Nearest"),
-    F_INT(settings_video, scale_factor, 1),
+    F_INT(settings_video, screen_w, 640),     F_INT(settings_video, screen_h, 400),
+    F_BOOL(settings_video, vsync, 0),         F_BOOL(settings_video, fullscreen, 0),
+    F_INT(settings_video, scaling, 0),        F_BOOL(settings_video, instant_console, 0),
+    F_BOOL(settings_video, crossfade_on, 1),  F_STRING(settings_video, scaler, "Nearest"),
+    F_INT(settings_video, scale_factor, 1),   F_INT(settings_video, frame_cap, 0),
+    F_BOOL(settings_video, render_thread, 0), F_BOOL(settings_video, software_render, 0),
 };
 
 const field f_sound[] = {F_BOOL(settings_sound, music_mono, 0), F_INT(settings_sound, sound_vol, 5),
@@ -104,7 +105,8 @@ const field f_keyboard[] = {
     F_STRING(settings_keyboard, key2_punch, "Left Ctrl"), F_STRING(settings_keyboard, key2_escape, "Escape")};
 
 const field f_net[] = {F_STRING(settings_network, net_connect_ip, "localhost"),
-                       F_INT(settings_network, net_connect_port, 2097), F_INT(settings_network, net_listen_port, 2097)};
+                       F_INT(settings_network, net_connect_port, 2097), F_INT(settings_network, net_listen_port, 2097),
+                       F_BOOL(settings_network, net_lockstep, 0), F_INT(settings_network, net_input_delay, 3)};
 
 // Map struct to field
 const struct_to_field struct_to_fields[] = {S_2_F(&_settings.video, f_video),
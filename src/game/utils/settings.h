@@ -44,6 +44,9 @@ typedef struct {
     int crossfade_on;
     char *scaler;
     int scale_factor;
+    int frame_cap;
+    int render_thread;
+    int software_render;
 } settings_video;
 
 typedef struct {
@@ -109,6 +112,8 @@ typedef struct {
     char *net_connect_ip;
     int net_connect_port;
     int net_listen_port;
+    int net_lockstep;
+    int net_input_delay;
 } settings_network;
 
 typedef struct {
@@ -0,0 +1,171 @@
+#include "game/utils/sync_delta.h"
+#include <stdint.h>
+#include <string.h>
+
+// Runs of unchanged bytes shorter than this are cheaper to pack along with the changed ones
+#define MIN_SKIP 16
+
+static void write_varint(serial *out, size_t v) {
+    while(v >= 0x80) {
+        serial_write_int8(out, (int8_t)(0x80 | (v & 0x7F)));
+        v >>= 7;
+    }
+    serial_write_int8(out, (int8_t)v);
+}
+
+static int read_varint(serial *in, size_t *v) {
+    *v = 0;
+    for(int shift = 0; shift < 35; shift += 7) {
+        if(in->rpos >= in->wpos) {
+            return 1;
+        }
+        uint8_t b = in->data[in->rpos++];
+        *v |= (size_t)(b & 0x7F) << shift;
+        if(!(b & 0x80)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Byte of the base state, or zero past its end
+static inline uint8_t base_at(const serial *base, size_t pos) {
+    return (base != NULL && pos < base->wpos) ? (uint8_t)base->data[pos] : 0;
+}
+
+// Bits that changed since the base state
+static inline uint8_t delta_at(const serial *base, const serial *state, size_t pos) {
+    return (uint8_t)state->data[pos] ^ base_at(base, pos);
+}
+
+// Writes the deltas in groups of eight bytes, each led by a mask of the bytes that changed
+static void write_packed(serial *out, const serial *base, const serial *state, size_t start, size_t end) {
+    for(size_t group = start; group < end; group += 8) {
+        size_t group_end = (group + 8 < end) ? group + 8 : end;
+        uint8_t mask = 0;
+        for(size_t i = group; i < group_end; i++) {
+            if(delta_at(base, state, i)) {
+                mask |= 1 << (i - group);
+            }
+        }
+        serial_write_int8(out, (int8_t)mask);
+        for(size_t i = group; i < group_end; i++) {
+            if(mask & (1 << (i - group))) {
+                serial_write_int8(out, (int8_t)delta_at(base, state, i));
+            }
+        }
+    }
+}
+
+static int read_packed(serial *out, const serial *base, size_t pos, size_t count, serial *in) {
+    for(size_t group = 0; group < count; group += 8) {
+        size_t group_len = (count - group < 8) ? count - group : 8;
+        if(in->rpos >= in->wpos) {
+            return 1;
+        }
+        uint8_t mask = in->data[in->rpos++];
+        if(mask >> group_len) {
+            return 1;
+        }
+        for(size_t i = 0; i < group_len; i++) {
+            uint8_t delta = 0;
+            if(mask & (1 << i)) {
+                if(in->rpos >= in->wpos) {
+                    return 1;
+                }
+                delta = in->data[in->rpos++];
+            }
+            serial_write_int8(out, (int8_t)(base_at(base, pos + group + i) ^ delta));
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief Writes the state as a difference to the base state.
+ *
+ * \param out Serial to append the encoded state to
+ * \param base Earlier state known to the receiver, or NULL
+ * \param state State to encode
+ */
+void sync_delta_encode(serial *out, const serial *base, const serial *state) {
+    size_t len = state->wpos;
+    write_varint(out, len);
+
+    size_t pos = 0;
+    while(pos < len) {
+        size_t skip = 0;
+        while(pos + skip < len && delta_at(base, state, pos + skip) == 0) {
+            skip++;
+        }
+        if(pos + skip == len) {
+            // Rest is unchanged; the decoder knows the length.
+            write_varint(out, skip);
+            write_varint(out, 0);
+            break;
+        }
+
+        // Changed bytes, up to the next run of unchanged ones that is worth skipping
+        size_t start = pos + skip;
+        size_t end = start;
+        size_t same = 0;
+        while(end + same < len && same < MIN_SKIP) {
+            if(delta_at(base, state, end + same) == 0) {
+                same++;
+            } else {
+                end += same + 1;
+                same = 0;
+            }
+        }
+        if(end + same == len && same < MIN_SKIP) {
+            end = len;
+        }
+        write_varint(out, skip);
+        write_varint(out, end - start);
+        write_packed(out, base, state, start, end);
+        pos = end;
+    }
+}
+
+/**
+ * \brief Reads a state written by sync_delta_encode().
+ *
+ * \param out Serial to write the decoded state to
+ * \param base Same base state the encoder used, or NULL
+ * \param in Encoded state, read from the current read position
+ * \return 0 on success, 1 if the data is broken
+ */
+int sync_delta_decode(serial *out, const serial *base, serial *in) {
+    size_t len;
+    if(read_varint(in, &len) || len > SYNC_DELTA_MAX_STATE) {
+        return 1;
+    }
+    serial_reserve(out, len);
+    size_t pos = 0;
+    while(pos < len) {
+        size_t skip, count;
+        if(read_varint(in, &skip) || read_varint(in, &count)) {
+            return 1;
+        }
+        if(skip > len - pos || count > len - pos - skip || (count + 7) / 8 > in->wpos - in->rpos) {
+            return 1;
+        }
+        // Unchanged bytes come from the base, and are zeroes past its end
+        size_t from_base = 0;
+        if(base != NULL && pos < base->wpos) {
+            from_base = (skip < base->wpos - pos) ? skip : base->wpos - pos;
+            serial_write(out, base->data + pos, from_base);
+        }
+        memset(out->data + out->wpos, 0, skip - from_base);
+        out->wpos += skip - from_base;
+        pos += skip;
+        if(read_packed(out, base, pos, count, in)) {
+            return 1;
+        }
+        pos += count;
+        if(skip == 0 && count == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
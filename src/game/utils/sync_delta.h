@@ -0,0 +1,21 @@
+#ifndef SYNC_DELTA_H
+#define SYNC_DELTA_H
+
+#include "game/utils/serial.h"
+
+/*
+ * Encodes serialized game states as the difference to an earlier state. Bytes that are the same as in
+ * the base are skipped in runs. The rest is stored as the bits that changed, packed in groups of eight
+ * bytes behind a mask of the bytes that changed at all; a counter that ticked or a flag that flipped
+ * takes a bit for each of its unchanged bytes. Run lengths are written as variable length integers, so a
+ * state that barely changed takes only a few bytes.
+ */
+
+// Largest state the decoder accepts. Serialized game states are a few kilobytes; this keeps a broken or
+// hostile packet from declaring a state that doesn't fit in memory.
+#define SYNC_DELTA_MAX_STATE (64 * 1024)
+
+void sync_delta_encode(serial *out, const serial *base, const serial *state);
+int sync_delta_decode(serial *out, const serial *base, serial *in);
+
+#endif // SYNC_DELTA_H
@@ -2,6 +2,7 @@
 #include "engine.h"
 #include "game/game_state.h"
 #include "game/utils/settings.h"
+#include "net/relay_publisher.h"
 #include "plugins/plugins.h"
 #include "resources/ids.h"
 #include "resources/pathmanager.h"
@@ -20,6 +21,15 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(_WIN32) || defined(WIN32)
+#include <process.h>
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
 #ifndef SHA1_HASH
 static const char *git_sha1_hash = "";
 #else
@@ -52,6 +62,86 @@ void scan_game_controllers() {
     }
 }
 
+void main_alloc_report_line(const char *line, void *userdata) {
+    INFO("%s", line);
+}
+
+/*
+ * Renders or verifies each recording in a process of its own, with at most jobs processes running at a time.
+ * SDL and the engine are single instance, so this is the only way to use more than one core. mode holds the
+ * arguments that select what is done, terminated by NULL. self is found the same way the shell found it, and
+ * the children get our environment. Returns the amount of recordings that failed.
+ */
+int play_batch(const char *self, const char **mode, const char **files, int count, int jobs) {
+    int running = 0;
+    int failed = 0;
+    int next = 0;
+#if defined(_WIN32) || defined(WIN32)
+    // Processes are waited on by their handles, and only so many of them at a time
+    HANDLE procs[MAXIMUM_WAIT_OBJECTS];
+    if(jobs > MAXIMUM_WAIT_OBJECTS) {
+        jobs = MAXIMUM_WAIT_OBJECTS;
+    }
+#endif
+    while(next < count || running > 0) {
+        if(next < count && running < jobs) {
+            const char *args[8];
+            int n = 0;
+            args[n++] = self;
+            for(int i = 0; mode[i] != NULL && i < 4; i++) {
+                args[n++] = mode[i];
+            }
+            args[n++] = "--play";
+            args[n++] = files[next];
+            args[n] = NULL;
+            INFO("Playing %s", files[next]);
+#if defined(_WIN32) || defined(WIN32)
+            intptr_t proc = _spawnvp(_P_NOWAIT, self, args);
+            if(proc == -1) {
+#else
+            pid_t pid;
+            if(posix_spawnp(&pid, self, NULL, NULL, (char *const *)args, environ) != 0) {
+#endif
+                PERROR("Unable to start playing %s", files[next]);
+                failed++;
+            } else {
+#if defined(_WIN32) || defined(WIN32)
+                procs[running] = (HANDLE)proc;
+#endif
+                running++;
+            }
+            next++;
+            continue;
+        }
+
+        // Wait for any of them to finish
+        int status = 0;
+#if defined(_WIN32) || defined(WIN32)
+        DWORD done = WaitForMultipleObjects(running, procs, FALSE, INFINITE);
+        if(done >= WAIT_OBJECT_0 + running) {
+            break;
+        }
+        HANDLE finished = procs[done - WAIT_OBJECT_0];
+        procs[done - WAIT_OBJECT_0] = procs[running - 1];
+        DWORD code = 1;
+        GetExitCodeProcess(finished, &code);
+        CloseHandle(finished);
+        status = (int)code;
+#else
+        if(wait(&status) == -1) {
+            break;
+        }
+        status = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+#endif
+        if(status != 0) {
+            failed++;
+        }
+        running--;
+    }
+    INFO("Played %d recordings, %d failed", count - failed, failed);
+    return failed;
+}
+
 int main(int argc, char *argv[]) {
     // Set up initial state for misc things
     char *ip = NULL;
@@ -60,7 +150,12 @@ int main(int argc, char *argv[]) {
     engine_init_flags init_flags;
     init_flags.net_mode = NET_MODE_NONE;
     init_flags.record = 0;
+    init_flags.rec_checksums = 0;
+    init_flags.render = 0;
+    init_flags.verify = 0;
+    init_flags.bless = 0;
     memset(init_flags.rec_file, 0, 255);
+    memset(init_flags.relay_addr, 0, 255);
     int ret = 0;
 
     // Path manager
@@ -75,10 +170,21 @@ int main(int argc, char *argv[]) {
     struct arg_lit *listen = arg_lit0("l", "listen", "Start a network game server");
     struct arg_str *connect = arg_str0("c", "connect", "<host>", "Connect to a remote game");
     struct arg_int *port = arg_int0("p", "port", "<port>", "Port to connect or listen (default: 2097)");
-    struct arg_file *play = arg_file0("P", "play", "<file>", "Play an existing recfile");
+    struct arg_file *play = arg_filen("P", "play", "<file>", 0, 1024, "Play an existing recfile");
     struct arg_file *rec = arg_file0("R", "rec", "<file>", "Record a new recfile");
+    struct arg_lit *checksums =
+        arg_lit0(NULL, "checksums", "Embed state checksums in the recfile, for finding where replays go out of sync");
+    struct arg_lit *render =
+        arg_lit0(NULL, "render", "Render played recfiles to <recfile>.rgba and <recfile>.wav, without a display");
+    struct arg_lit *verify = arg_lit0(NULL, "verify",
+                                      "Play recfiles without a display, and check them against <recfile>.trace");
+    struct arg_lit *bless = arg_lit0(NULL, "bless", "With --verify, write <recfile>.trace instead of checking it");
+    struct arg_str *relay = arg_str0(NULL, "relay", "<host>", "Publish hosted matches to a relay for spectators");
+    struct arg_str *spectate = arg_str0(NULL, "spectate", "<host>", "Watch a match through a relay");
+    struct arg_int *jobs = arg_int0("j", "jobs", "<n>", "Maximum amount of parallel plays (default: CPU count)");
     struct arg_end *end = arg_end(30);
-    void *argtable[] = {help, vers, listen, connect, port, play, rec, end};
+    void *argtable[] = {help,      vers,   listen, connect, port,  play,     rec,
+                        checksums, render, verify, bless,   relay, spectate, jobs, end};
     const char *progname = "openomf";
 
     // Make sure everything got allocated
@@ -112,6 +218,16 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Try '%s --help' for more information.\n", progname);
         goto exit_0;
     }
+    if(render->count > 0 && play->count == 0) {
+        fprintf(stderr, "Nothing to render; give the recfiles with --play.\n");
+        ret = 1;
+        goto exit_0;
+    }
+    if(verify->count > 0 && play->count == 0) {
+        fprintf(stderr, "Nothing to verify; give the recfiles with --play.\n");
+        ret = 1;
+        goto exit_0;
+    }
 
     // Check other flags
     if(connect->count > 0) {
@@ -127,14 +243,21 @@ int main(int argc, char *argv[]) {
         if(port->count > 0) {
             listen_port = port->ival[0] & 0xFFFF;
         }
+    } else if(spectate->count > 0) {
+        init_flags.net_mode = NET_MODE_SPECTATOR;
+        strncpy(init_flags.relay_addr, spectate->sval[0], 254);
     } else if(play->count > 0) {
         strncpy(init_flags.rec_file, play->filename[0], 254);
+        init_flags.render = (render->count > 0);
+        init_flags.verify = (verify->count > 0);
+        init_flags.bless = (bless->count > 0);
     } else if(rec->count > 0) {
         init_flags.record = 1;
+        init_flags.rec_checksums = (checksums->count > 0);
         strncpy(init_flags.rec_file, rec->filename[0], 254);
     }
 
-    // Init log
+    // Init log. Renders and verifications are run from the command line, so they log to stdout.
 #if defined(DEBUGMODE)
     if(log_init(0)) {
         err_msgbox("Error while initializing log!");
@@ -142,7 +265,7 @@ int main(int argc, char *argv[]) {
         goto exit_0;
     }
 #else
-    if(log_init(pm_get_local_path(LOG_PATH))) {
+    if((init_flags.render || init_flags.verify) ? log_init(0) : log_init(pm_get_local_path(LOG_PATH))) {
         err_msgbox("Error while initializing log '%s'!", pm_get_local_path(LOG_PATH));
         printf("Error while initializing log '%s'!", pm_get_local_path(LOG_PATH));
         goto exit_0;
@@ -158,8 +281,18 @@ int main(int argc, char *argv[]) {
     // Dump path manager log
     pm_log();
 
-    // Random seed
-    rand_seed(time(NULL));
+    // Multiple recordings to render or verify; hand each one to a separate process.
+    if((init_flags.render || init_flags.verify) && play->count > 1) {
+        const char *render_mode[] = {"--render", NULL};
+        const char *verify_mode[] = {"--verify", init_flags.bless ? "--bless" : NULL, NULL};
+        int max_jobs = (jobs->count > 0 && jobs->ival[0] > 0) ? jobs->ival[0] : SDL_GetCPUCount();
+        const char **mode = init_flags.verify ? verify_mode : render_mode;
+        ret = play_batch(argv[0], mode, play->filename, play->count, max_jobs) ? 1 : 0;
+        goto exit_1;
+    }
+
+    // Random seed. Verified playbacks must come out the same on every run.
+    rand_seed(init_flags.verify ? 0 : time(NULL));
 
     // Init config
     if(settings_init(pm_get_local_path(CONFIG_PATH))) {
@@ -190,6 +323,12 @@ int main(int argc, char *argv[]) {
         settings_get()->net.net_listen_port = listen_port;
     }
 
+    // Offline renders and verifications use the software renderer without a window system.
+    if(init_flags.render || init_flags.verify) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    }
+
     // Init SDL2
     if(SDL_Init(SDL_INIT_TIMER | SDL_INIT_VIDEO)) {
         err_msgbox("SDL2 Initialization failed: %s", SDL_GetError());
@@ -216,18 +355,25 @@ int main(int argc, char *argv[]) {
         goto exit_3;
     }
 
+    // Relay addresses are host[:port]
+    if(relay->count > 0 && relay_publisher_open(relay->sval[0])) {
+        err_msgbox("Unable to connect to relay %s", relay->sval[0]);
+        goto exit_4;
+    }
+
     // Initialize engine
-    if(engine_init()) {
+    if(engine_init(&init_flags)) {
         err_msgbox("Failed to initialize game engine.");
         goto exit_4;
     }
 
     // Run
-    engine_run(&init_flags);
+    ret = engine_run(&init_flags);
 
     // Close everything
     engine_close();
 exit_4:
+    relay_publisher_close();
     enet_deinitialize();
 exit_3:
     SDL_Quit();
@@ -235,6 +381,7 @@ exit_2:
     settings_save();
     settings_free();
 exit_1:
+    omf_alloc_report(main_alloc_report_line, NULL, 0);
     INFO("Exit.");
     log_close();
 exit_0:
@@ -244,5 +391,6 @@ exit_0:
     plugins_close();
     arg_freetable(argtable, sizeof(argtable) / sizeof(argtable[0]));
     pm_free();
+    omf_arenas_close();
     return ret;
 }
@@ -0,0 +1,142 @@
+#include "net/lockstep.h"
+#include "utils/log.h"
+
+// Bytes a message needs before its inputs: done flag, acknowledged frame, first frame and frame count
+#define LOCKSTEP_HEADER 10
+
+static size_t remaining(const serial *ser) {
+    return ser->wpos - ser->rpos;
+}
+
+static void input_reset(lockstep_input *input, int frame) {
+    input->frame = frame;
+    input->count = 0;
+}
+
+void lockstep_create(lockstep *ls, int delay) {
+    if(delay < 0) {
+        delay = 0;
+    } else if(delay > LOCKSTEP_MAX_DELAY) {
+        delay = LOCKSTEP_MAX_DELAY;
+    }
+    ls->delay = delay;
+    ls->frame = 0;
+    ls->peer_done = 0;
+    for(int i = 0; i < LOCKSTEP_WINDOW; i++) {
+        input_reset(&ls->local[i], -1);
+        input_reset(&ls->remote[i], -1);
+    }
+
+    // Nobody can have given inputs for the frames before the delay, so they are known to be empty
+    for(int i = 0; i < delay; i++) {
+        input_reset(&ls->local[i], i);
+        input_reset(&ls->remote[i], i);
+    }
+    ls->local_last = delay - 1;
+    ls->remote_last = delay - 1;
+    ls->acked = delay - 1;
+    input_reset(&ls->local[delay], delay);
+}
+
+// Adds an action to the local inputs of the current frame. It takes effect after the delay.
+void lockstep_add_local(lockstep *ls, int action) {
+    lockstep_input *input = &ls->local[(ls->frame + ls->delay) % LOCKSTEP_WINDOW];
+    if(input->count >= LOCKSTEP_MAX_ACTIONS) {
+        DEBUG("lockstep: dropping action %d on frame %d", action, ls->frame);
+        return;
+    }
+    input->actions[input->count++] = action;
+}
+
+// Tells whether the inputs of both players for the current frame are in
+int lockstep_ready(const lockstep *ls) {
+    return ls->peer_done || ls->remote_last >= ls->frame;
+}
+
+/*
+ * Closes the local inputs of the current frame, and moves on to the next frame. The inputs of both players
+ * for the frame that was current are handed out. The remote ones are NULL if the peer has left the match.
+ * Only call this when lockstep_ready() says so.
+ */
+void lockstep_advance(lockstep *ls, const lockstep_input **local, const lockstep_input **remote) {
+    ls->local_last = ls->frame + ls->delay;
+
+    const lockstep_input *r = &ls->remote[ls->frame % LOCKSTEP_WINDOW];
+    *local = &ls->local[ls->frame % LOCKSTEP_WINDOW];
+    *remote = (r->frame == ls->frame) ? r : NULL;
+
+    ls->frame++;
+    input_reset(&ls->local[(ls->frame + ls->delay) % LOCKSTEP_WINDOW], ls->frame + ls->delay);
+}
+
+/*
+ * Writes the local inputs the peer has not acknowledged, and acknowledges the remote inputs we have.
+ * If done is set, the peer is told that no more inputs are coming from here.
+ */
+void lockstep_write(const lockstep *ls, serial *ser, int done) {
+    int first = ls->acked + 1;
+    if(first < ls->local_last - LOCKSTEP_WINDOW + 1) {
+        first = ls->local_last - LOCKSTEP_WINDOW + 1;
+    }
+    int count = ls->local_last - first + 1;
+
+    serial_write_int8(ser, done);
+    serial_write_int32(ser, ls->remote_last);
+    serial_write_int32(ser, first);
+    serial_write_int8(ser, count);
+    for(int frame = first; frame <= ls->local_last; frame++) {
+        const lockstep_input *input = &ls->local[frame % LOCKSTEP_WINDOW];
+        serial_write_int8(ser, input->count);
+        for(int i = 0; i < input->count; i++) {
+            serial_write_int16(ser, input->actions[i]);
+        }
+    }
+}
+
+/*
+ * Reads a message from the peer. Inputs that are already known, or that do not follow the ones we have,
+ * are skipped. Returns 1 if the message is broken.
+ */
+int lockstep_read(lockstep *ls, serial *ser) {
+    if(remaining(ser) < LOCKSTEP_HEADER) {
+        return 1;
+    }
+    int done = serial_read_int8(ser);
+    int ack = serial_read_int32(ser);
+    int first = serial_read_int32(ser);
+    int count = (uint8_t)serial_read_int8(ser);
+
+    if(ack > ls->acked && ack <= ls->local_last) {
+        ls->acked = ack;
+    }
+    for(int i = 0; i < count; i++) {
+        if(remaining(ser) < 1) {
+            return 1;
+        }
+        int actions = serial_read_int8(ser);
+        if(actions < 0 || actions > LOCKSTEP_MAX_ACTIONS || remaining(ser) < (size_t)actions * 2) {
+            return 1;
+        }
+
+        // Only take the frame if it is the next one, and its slot is no longer needed
+        int frame = first + i;
+        int take = frame == ls->remote_last + 1 && frame - ls->frame < LOCKSTEP_WINDOW;
+        lockstep_input *input = &ls->remote[frame % LOCKSTEP_WINDOW];
+        if(take) {
+            input_reset(input, frame);
+        }
+        for(int k = 0; k < actions; k++) {
+            uint16_t action = serial_read_int16(ser);
+            if(take) {
+                input->actions[input->count++] = action;
+            }
+        }
+        if(take) {
+            ls->remote_last = frame;
+        }
+    }
+    if(done) {
+        ls->peer_done = 1;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "game/utils/serial.h"
+#include <stdint.h>
+
+/*
+ * Input queue of a lockstep network match. Inputs are given for the current frame, and take effect
+ * `delay` frames later on both ends. A frame can be played only once the inputs of both players for it
+ * are in.
+ *
+ * Every outgoing message carries all of the local inputs that the peer has not acknowledged yet, so a
+ * lost message does not need to be resent on its own; the next one covers for it.
+ */
+
+// Amount of frames of inputs kept around, on both sides
+#define LOCKSTEP_WINDOW 64
+
+// The longest allowed input delay, in frames
+#define LOCKSTEP_MAX_DELAY 20
+
+// Actions a player can give on a single frame. Further ones are dropped.
+#define LOCKSTEP_MAX_ACTIONS 4
+
+typedef struct {
+    int frame; // Frame this input is for, or -1 if unused
+    uint8_t count;
+    uint16_t actions[LOCKSTEP_MAX_ACTIONS];
+} lockstep_input;
+
+typedef struct {
+    int delay;                              // Frames between giving an input and it taking effect
+    int frame;                              // The next frame to play
+    int local_last;                         // Last frame the local inputs are complete for
+    int remote_last;                        // Last frame the remote inputs are complete for
+    int acked;                              // Last frame of local inputs the peer has acknowledged
+    int peer_done;                          // The peer has left the match, and will send no more inputs
+    lockstep_input local[LOCKSTEP_WINDOW];  // Local inputs, by frame
+    lockstep_input remote[LOCKSTEP_WINDOW]; // Remote inputs, by frame
+} lockstep;
+
+void lockstep_create(lockstep *ls, int delay);
+void lockstep_add_local(lockstep *ls, int action);
+int lockstep_ready(const lockstep *ls);
+void lockstep_advance(lockstep *ls, const lockstep_input **local, const lockstep_input **remote);
+void lockstep_write(const lockstep *ls, serial *ser, int done);
+int lockstep_read(lockstep *ls, serial *ser);
+
+#endif // LOCKSTEP_H
@@ -0,0 +1,196 @@
+#include "net/netsim.h"
+#include "game/utils/serial.h"
+#include "utils/log.h"
+#include <string.h>
+
+// Largest datagram ENet sends
+#define NETSIM_MAX_DATAGRAM ENET_PROTOCOL_MAXIMUM_MTU
+
+typedef struct {
+    unsigned int due; // When the datagram arrives
+    unsigned int seq; // Order of arrival for datagrams that are due at the same time
+    serial data;
+} netsim_pending;
+
+typedef struct {
+    ENetSocket socket;
+    const ENetAddress *to;
+} netsim_dest;
+
+// The low bits of the generator repeat quickly, so the high ones are used
+static int chance(netsim_link *link, int percent) {
+    return (int)((random_intmax(&link->rand) >> 16) % 100) < percent;
+}
+
+static int jitter(netsim_link *link) {
+    if(link->cond.jitter <= 0) {
+        return 0;
+    }
+    return (int)((random_intmax(&link->rand) >> 16) % (2 * link->cond.jitter + 1)) - link->cond.jitter;
+}
+
+void netsim_link_create(netsim_link *link, const netsim_conditions *cond, uint32_t seed) {
+    link->cond = *cond;
+    random_seed(&link->rand, seed);
+    list_create(&link->pending);
+    link->seq = 0;
+    memset(&link->stats, 0, sizeof(netsim_stats));
+}
+
+void netsim_link_free(netsim_link *link) {
+    iterator it;
+    netsim_pending *p;
+    list_iter_begin(&link->pending, &it);
+    while((p = iter_next(&it)) != NULL) {
+        serial_free(&p->data);
+    }
+    list_free(&link->pending);
+}
+
+// Sends a datagram down the link; now is the current time in milliseconds.
+void netsim_link_push(netsim_link *link, const char *data, size_t len, unsigned int now) {
+    link->stats.datagrams++;
+    if(chance(link, link->cond.loss)) {
+        link->stats.lost++;
+        return;
+    }
+    int copies = 1;
+    if(chance(link, link->cond.duplicate)) {
+        link->stats.duplicated++;
+        copies = 2;
+    }
+    for(int i = 0; i < copies; i++) {
+        int delay = link->cond.delay + jitter(link);
+        if(i == 0 && chance(link, link->cond.reorder)) {
+            // Long enough for anything sent right after to get there first
+            int hold = link->cond.delay + 2 * link->cond.jitter;
+            delay += hold > 10 ? hold : 10;
+            link->stats.reordered++;
+        }
+        netsim_pending p;
+        p.due = now + (delay > 0 ? delay : 0);
+        p.seq = link->seq++;
+        serial_create_from(&p.data, data, len);
+        list_append(&link->pending, &p, sizeof(netsim_pending));
+    }
+}
+
+// Hands out the datagrams that have arrived by now, in the order they arrived.
+void netsim_link_release(netsim_link *link, unsigned int now, netsim_cb cb, void *userdata) {
+    iterator it;
+    netsim_pending *p;
+    while(1) {
+        netsim_pending *first = NULL;
+        list_iter_begin(&link->pending, &it);
+        while((p = iter_next(&it)) != NULL) {
+            if((int)(now - p->due) < 0) {
+                continue;
+            }
+            if(first == NULL || (int)(p->due - first->due) < 0 || (p->due == first->due && p->seq < first->seq)) {
+                first = p;
+            }
+        }
+        if(first == NULL) {
+            return;
+        }
+        link->stats.delivered++;
+        link->stats.bytes += first->data.wpos;
+        cb(first->data.data, first->data.wpos, userdata);
+
+        list_iter_begin(&link->pending, &it);
+        while((p = iter_next(&it)) != NULL) {
+            if(p == first) {
+                serial_free(&p->data);
+                list_delete(&link->pending, &it);
+                break;
+            }
+        }
+    }
+}
+
+static void netsim_send(const char *data, size_t len, void *userdata) {
+    netsim_dest *dest = userdata;
+    ENetBuffer buffer;
+    buffer.data = (void *)data;
+    buffer.dataLength = len;
+    enet_socket_send(dest->socket, dest->to, &buffer, 1);
+}
+
+static ENetSocket netsim_socket(int port) {
+    ENetSocket socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+    if(socket == ENET_SOCKET_NULL) {
+        return ENET_SOCKET_NULL;
+    }
+    ENetAddress address;
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = port;
+    if(enet_socket_bind(socket, &address) < 0 || enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1) < 0) {
+        enet_socket_destroy(socket);
+        return ENET_SOCKET_NULL;
+    }
+    return socket;
+}
+
+/*
+ * Listens on the loopback port (0 for any free one), and forwards everything that comes in to the target
+ * through a link. The replies go back to whoever sent the last datagram, through another link. The
+ * address to connect to is left in proxy->address. Returns 1 if the sockets can't be set up.
+ */
+int netsim_proxy_create(netsim_proxy *proxy, int port, const ENetAddress *target, const netsim_conditions *cond,
+                        uint32_t seed) {
+    proxy->outer = netsim_socket(port);
+    if(proxy->outer == ENET_SOCKET_NULL || enet_socket_get_address(proxy->outer, &proxy->address) < 0) {
+        PERROR("netsim: unable to listen on port %d", port);
+        if(proxy->outer != ENET_SOCKET_NULL) {
+            enet_socket_destroy(proxy->outer);
+        }
+        return 1;
+    }
+    proxy->inner = netsim_socket(0);
+    if(proxy->inner == ENET_SOCKET_NULL) {
+        PERROR("netsim: unable to create a socket");
+        enet_socket_destroy(proxy->outer);
+        return 1;
+    }
+    proxy->target = *target;
+    proxy->has_client = 0;
+    netsim_link_create(&proxy->up, cond, seed);
+    netsim_link_create(&proxy->down, cond, seed ^ 0x5bd1e995);
+    return 0;
+}
+
+// Takes in the datagrams waiting on both sockets, and sends out the ones that are due. Never blocks.
+void netsim_proxy_service(netsim_proxy *proxy) {
+    char data[NETSIM_MAX_DATAGRAM];
+    ENetBuffer buffer;
+    ENetAddress from;
+    unsigned int now = enet_time_get();
+    int len;
+
+    buffer.data = data;
+    buffer.dataLength = sizeof(data);
+    while((len = enet_socket_receive(proxy->outer, &from, &buffer, 1)) > 0) {
+        proxy->client = from;
+        proxy->has_client = 1;
+        netsim_link_push(&proxy->up, data, len, now);
+    }
+    while((len = enet_socket_receive(proxy->inner, &from, &buffer, 1)) > 0) {
+        if(from.host == proxy->target.host && from.port == proxy->target.port) {
+            netsim_link_push(&proxy->down, data, len, now);
+        }
+    }
+
+    netsim_dest up = {proxy->inner, &proxy->target};
+    netsim_link_release(&proxy->up, now, netsim_send, &up);
+    if(proxy->has_client) {
+        netsim_dest down = {proxy->outer, &proxy->client};
+        netsim_link_release(&proxy->down, now, netsim_send, &down);
+    }
+}
+
+void netsim_proxy_free(netsim_proxy *proxy) {
+    enet_socket_destroy(proxy->outer);
+    enet_socket_destroy(proxy->inner);
+    netsim_link_free(&proxy->up);
+    netsim_link_free(&proxy->down);
+}
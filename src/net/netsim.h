@@ -0,0 +1,62 @@
+#ifndef NETSIM_H
+#define NETSIM_H
+
+#include "utils/list.h"
+#include "utils/random.h"
+#include <enet/enet.h>
+
+/*
+ * Network condition simulator. A link holds datagrams back for a delay, and can lose, duplicate and
+ * reorder them on the way. A proxy puts a link in each direction between a local UDP port and a target
+ * address, so that two ENet hosts talking through it see a bad network without knowing about it.
+ */
+
+typedef void (*netsim_cb)(const char *data, size_t len, void *userdata);
+
+typedef struct {
+    int delay;     // Milliseconds a datagram takes to arrive
+    int jitter;    // Milliseconds the delay varies by, in both directions
+    int loss;      // Chance of a datagram getting lost, in percents
+    int duplicate; // Chance of a datagram arriving twice, in percents
+    int reorder;   // Chance of a datagram being held back for long enough that the next ones pass it, in percents
+} netsim_conditions;
+
+typedef struct {
+    unsigned int datagrams;  // Datagrams that went in
+    unsigned int delivered;  // Datagrams that came out, duplicates included
+    unsigned int lost;       // Datagrams that were dropped
+    unsigned int duplicated; // Datagrams that were sent twice
+    unsigned int reordered;  // Datagrams that were held back
+    unsigned int bytes;      // Bytes that came out
+} netsim_stats;
+
+typedef struct {
+    netsim_conditions cond;
+    struct random_t rand;
+    list pending; // Datagrams on their way
+    unsigned int seq;
+    netsim_stats stats;
+} netsim_link;
+
+void netsim_link_create(netsim_link *link, const netsim_conditions *cond, uint32_t seed);
+void netsim_link_free(netsim_link *link);
+void netsim_link_push(netsim_link *link, const char *data, size_t len, unsigned int now);
+void netsim_link_release(netsim_link *link, unsigned int now, netsim_cb cb, void *userdata);
+
+typedef struct {
+    ENetSocket outer;    // Listens for the proxied end
+    ENetSocket inner;    // Talks to the target
+    ENetAddress address; // Where outer is bound; the proxied end connects here
+    ENetAddress target;  // Address the datagrams are proxied to
+    ENetAddress client;  // Address of the proxied end, once it has sent something
+    int has_client;      // The client address is known
+    netsim_link up;      // From the proxied end to the target
+    netsim_link down;    // From the target to the proxied end
+} netsim_proxy;
+
+int netsim_proxy_create(netsim_proxy *proxy, int port, const ENetAddress *target, const netsim_conditions *cond,
+                        uint32_t seed);
+void netsim_proxy_service(netsim_proxy *proxy);
+void netsim_proxy_free(netsim_proxy *proxy);
+
+#endif // NETSIM_H
@@ -0,0 +1,74 @@
+#include "net/relay.h"
+#include "utils/log.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Parses "host" or "host:port". Returns 0 on success.
+int relay_parse_address(ENetAddress *address, const char *str) {
+    char host[256];
+    strncpy(host, str, sizeof(host) - 1);
+    host[sizeof(host) - 1] = 0;
+
+    address->port = RELAY_DEFAULT_PORT;
+    char *colon = strrchr(host, ':');
+    if(colon != NULL) {
+        int port = atoi(colon + 1);
+        if(port <= 0 || port > 0xFFFF) {
+            return 1;
+        }
+        address->port = port;
+        *colon = 0;
+    }
+    return enet_address_set_host(address, host) != 0;
+}
+
+// Connects to a relay, waiting at most timeout milliseconds for it to answer. Returns NULL on failure.
+ENetPeer *relay_connect(ENetHost *host, const char *str, int timeout) {
+    ENetAddress address;
+    if(relay_parse_address(&address, str)) {
+        PERROR("Invalid relay address %s", str);
+        return NULL;
+    }
+    ENetPeer *peer = enet_host_connect(host, &address, RELAY_CHANNELS, 0);
+    if(peer == NULL) {
+        PERROR("Unable to connect to relay %s", str);
+        return NULL;
+    }
+    ENetEvent event;
+    if(enet_host_service(host, &event, timeout) > 0 && event.type == ENET_EVENT_TYPE_CONNECT) {
+        DEBUG("connected to relay %s", str);
+        return peer;
+    }
+    enet_peer_reset(peer);
+    PERROR("Relay %s did not answer", str);
+    return NULL;
+}
+
+void relay_match_write(serial *ser, const relay_match *match) {
+    serial_write_int8(ser, RELAY_MATCH);
+    serial_write_int8(ser, match->arena_id);
+    for(int i = 0; i < 2; i++) {
+        serial_write_int8(ser, match->pilots[i].har_id);
+        serial_write_int8(ser, match->pilots[i].pilot_id);
+        serial_write_int8(ser, match->pilots[i].color_1);
+        serial_write_int8(ser, match->pilots[i].color_2);
+        serial_write_int8(ser, match->pilots[i].color_3);
+    }
+}
+
+// Reads the match information. The message type should already be read.
+void relay_match_read(serial *ser, relay_match *match) {
+    match->arena_id = serial_read_int8(ser);
+    for(int i = 0; i < 2; i++) {
+        match->pilots[i].har_id = serial_read_int8(ser);
+        match->pilots[i].pilot_id = serial_read_int8(ser);
+        match->pilots[i].color_1 = serial_read_int8(ser);
+        match->pilots[i].color_2 = serial_read_int8(ser);
+        match->pilots[i].color_3 = serial_read_int8(ser);
+    }
+}
+
+void relay_send(ENetPeer *peer, const serial *ser) {
+    ENetPacket *packet = enet_packet_create(ser->data, ser->wpos, ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(peer, 0, packet);
+}
@@ -0,0 +1,48 @@
+#ifndef RELAY_H
+#define RELAY_H
+
+#include "game/utils/serial.h"
+#include <enet/enet.h>
+#include <stdint.h>
+
+/*
+ * Relay protocol. The hosting player publishes the match to a relay server, which fans it out to any
+ * amount of spectators. Everything goes through a single reliable channel, so that the spectators see
+ * the messages in the order they were published. Each message starts with its type as int8.
+ */
+
+#define RELAY_DEFAULT_PORT 2098
+#define RELAY_CHANNELS 1
+
+// How often the publisher sends a snapshot even if nothing interesting happened, in ticks
+#define RELAY_SNAPSHOT_INTERVAL 100
+
+enum
+{
+    RELAY_WATCH = 1, // Spectator wants the match; no payload
+    RELAY_MATCH,     // Arena and pilots of a new match; see relay_match
+    RELAY_SNAPSHOT,  // Game state, as written by game_state_serialize()
+    RELAY_ACTION,    // int32 tick, int8 player, int16 action
+    RELAY_END,       // The match is over; no payload
+};
+
+typedef struct {
+    uint8_t har_id;
+    uint8_t pilot_id;
+    uint8_t color_1;
+    uint8_t color_2;
+    uint8_t color_3;
+} relay_pilot;
+
+typedef struct {
+    uint8_t arena_id;
+    relay_pilot pilots[2];
+} relay_match;
+
+int relay_parse_address(ENetAddress *address, const char *str);
+ENetPeer *relay_connect(ENetHost *host, const char *str, int timeout);
+void relay_match_write(serial *ser, const relay_match *match);
+void relay_match_read(serial *ser, relay_match *match);
+void relay_send(ENetPeer *peer, const serial *ser);
+
+#endif // RELAY_H
@@ -0,0 +1,137 @@
+#include "net/relay_publisher.h"
+#include "game/game_player.h"
+#include "net/relay.h"
+#include "utils/log.h"
+#include <enet/enet.h>
+
+/*
+ * Publishes the matches of this game to a relay server. The relay gets everything the game decides on:
+ * the actions as they were handled, and snapshots of the state whenever something interesting happens.
+ */
+
+static ENetHost *host = NULL;
+static ENetPeer *peer = NULL;
+static unsigned int last_snapshot = 0;
+
+int relay_publisher_open(const char *address) {
+    host = enet_host_create(NULL, 1, RELAY_CHANNELS, 0, 0);
+    if(host == NULL) {
+        PERROR("Failed to initialize ENet client");
+        return 1;
+    }
+    peer = relay_connect(host, address, 5000);
+    if(peer == NULL) {
+        enet_host_destroy(host);
+        host = NULL;
+        return 1;
+    }
+    INFO("Publishing matches to relay %s", address);
+    return 0;
+}
+
+void relay_publisher_close() {
+    if(peer) {
+        // Give the queued messages a moment to get through
+        ENetEvent event;
+        enet_peer_disconnect_later(peer, 0);
+        while(enet_host_service(host, &event, 1000) > 0 && event.type != ENET_EVENT_TYPE_DISCONNECT) {
+            if(event.type == ENET_EVENT_TYPE_RECEIVE) {
+                enet_packet_destroy(event.packet);
+            }
+        }
+        peer = NULL;
+    }
+    if(host) {
+        enet_host_destroy(host);
+        host = NULL;
+    }
+}
+
+int relay_publisher_is_open() {
+    return peer != NULL;
+}
+
+static void relay_publisher_send(const serial *msg) {
+    if(peer) {
+        relay_send(peer, msg);
+    }
+}
+
+void relay_publisher_match(game_state *gs, int arena_id) {
+    relay_match match;
+    match.arena_id = arena_id;
+    for(int i = 0; i < 2; i++) {
+        sd_pilot *pilot = game_state_get_player(gs, i)->pilot;
+        match.pilots[i].har_id = pilot->har_id;
+        match.pilots[i].pilot_id = pilot->pilot_id;
+        match.pilots[i].color_1 = pilot->color_1;
+        match.pilots[i].color_2 = pilot->color_2;
+        match.pilots[i].color_3 = pilot->color_3;
+    }
+    serial ser;
+    serial_create(&ser);
+    relay_match_write(&ser, &match);
+    relay_publisher_send(&ser);
+    serial_free(&ser);
+    last_snapshot = game_state_get_tick(gs);
+}
+
+void relay_publisher_snapshot(const serial *state, unsigned int tick) {
+    serial ser;
+    serial_create(&ser);
+    serial_write_int8(&ser, RELAY_SNAPSHOT);
+    serial_write(&ser, state->data, state->wpos);
+    relay_publisher_send(&ser);
+    serial_free(&ser);
+    last_snapshot = tick;
+}
+
+void relay_publisher_action(unsigned int tick, int player, int action) {
+    serial ser;
+    serial_create(&ser);
+    serial_write_int8(&ser, RELAY_ACTION);
+    serial_write_int32(&ser, tick);
+    serial_write_int8(&ser, player);
+    serial_write_int16(&ser, action);
+    relay_publisher_send(&ser);
+    serial_free(&ser);
+}
+
+void relay_publisher_end() {
+    serial ser;
+    serial_create(&ser);
+    serial_write_int8(&ser, RELAY_END);
+    relay_publisher_send(&ser);
+    serial_free(&ser);
+    if(host) {
+        enet_host_flush(host);
+    }
+}
+
+/*
+ * Keeps the connection going, and sends a snapshot every now and then, so that spectators joining late
+ * do not have to replay a long time of actions.
+ */
+void relay_publisher_tick(game_state *gs) {
+    if(peer == NULL) {
+        return;
+    }
+    ENetEvent event;
+    while(enet_host_service(host, &event, 0) > 0) {
+        if(event.type == ENET_EVENT_TYPE_RECEIVE) {
+            enet_packet_destroy(event.packet);
+        } else if(event.type == ENET_EVENT_TYPE_DISCONNECT) {
+            PERROR("Lost connection to the relay");
+            peer = NULL;
+            return;
+        }
+    }
+    if(game_state_get_tick(gs) - last_snapshot >= RELAY_SNAPSHOT_INTERVAL) {
+        serial ser;
+        serial_create(&ser);
+        game_state_serialize(gs, &ser);
+        relay_publisher_snapshot(&ser, game_state_get_tick(gs));
+        serial_free(&ser);
+    }
+    enet_host_flush(host);
+}
@@ -0,0 +1,16 @@
+#ifndef RELAY_PUBLISHER_H
+#define RELAY_PUBLISHER_H
+
+#include "game/game_state.h"
+#include "game/utils/serial.h"
+
+int relay_publisher_open(const char *address);
+void relay_publisher_close();
+int relay_publisher_is_open();
+void relay_publisher_match(game_state *gs, int arena_id);
+void relay_publisher_snapshot(const serial *state, unsigned int tick);
+void relay_publisher_action(unsigned int tick, int player, int action);
+void relay_publisher_end();
+void relay_publisher_tick(game_state *gs);
+
+#endif // RELAY_PUBLISHER_H
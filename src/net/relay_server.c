@@ -0,0 +1,105 @@
+#include "net/relay_server.h"
+#include "net/relay.h"
+#include "utils/log.h"
+
+// Spectator peers point to this; peers that have not asked for the match have NULL
+static int watching;
+
+static void relay_server_send(const serial *msg, void *userdata) {
+    relay_send(userdata, msg);
+}
+
+// Sends a released message to all spectators. They all share the same packet.
+static void relay_server_forward(const serial *msg, void *userdata) {
+    relay_server *relay = userdata;
+    ENetPacket *packet = enet_packet_create(msg->data, msg->wpos, ENET_PACKET_FLAG_RELIABLE);
+    int sent = 0;
+    for(size_t i = 0; i < relay->host->peerCount; i++) {
+        ENetPeer *peer = &relay->host->peers[i];
+        if(peer->state == ENET_PEER_STATE_CONNECTED && peer->data == &watching) {
+            if(enet_peer_send(peer, 0, packet) == 0) {
+                sent++;
+            }
+        }
+    }
+    if(sent == 0) {
+        enet_packet_destroy(packet);
+    }
+}
+
+static void relay_server_receive(relay_server *relay, ENetPeer *peer, ENetPacket *packet) {
+    if(packet->dataLength == 0) {
+        return;
+    }
+    int type = packet->data[0];
+    if(type == RELAY_WATCH) {
+        if(peer->data != &watching) {
+            INFO("Spectator joined");
+            peer->data = &watching;
+            relay_stream_catch_up(&relay->stream, relay_server_send, peer);
+        }
+        return;
+    }
+    if(type == RELAY_MATCH && relay->publisher == NULL) {
+        INFO("Match started");
+        relay->publisher = peer;
+    }
+    if(peer != relay->publisher) {
+        DEBUG("ignoring message %d from a peer that is not publishing", type);
+        return;
+    }
+    relay_stream_push(&relay->stream, (const char *)packet->data, packet->dataLength, enet_time_get());
+}
+
+int relay_server_create(relay_server *relay, int port, int max_spectators, unsigned int delay) {
+    ENetAddress address;
+    address.host = ENET_HOST_ANY;
+    address.port = port;
+    relay->host = enet_host_create(&address, max_spectators + 1, RELAY_CHANNELS, 0, 0);
+    if(relay->host == NULL) {
+        return 1;
+    }
+    relay->publisher = NULL;
+    relay_stream_create(&relay->stream, delay);
+    return 0;
+}
+
+// Handles network events, waiting at most timeout milliseconds for them, and sends out the due messages.
+void relay_server_service(relay_server *relay, int timeout) {
+    ENetEvent event;
+    while(enet_host_service(relay->host, &event, timeout) > 0) {
+        timeout = 0;
+        switch(event.type) {
+            case ENET_EVENT_TYPE_CONNECT:
+                DEBUG("peer connected");
+                event.peer->data = NULL;
+                break;
+            case ENET_EVENT_TYPE_RECEIVE:
+                relay_server_receive(relay, event.peer, event.packet);
+                enet_packet_destroy(event.packet);
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT:
+                if(event.peer == relay->publisher) {
+                    // The spectators should not wait for a match that is not going on anymore
+                    INFO("Publisher left");
+                    char end = RELAY_END;
+                    relay_stream_push(&relay->stream, &end, 1, enet_time_get());
+                    relay->publisher = NULL;
+                } else if(event.peer->data == &watching) {
+                    INFO("Spectator left");
+                }
+                event.peer->data = NULL;
+                break;
+            default:
+                break;
+        }
+    }
+    relay_stream_release(&relay->stream, enet_time_get(), relay_server_forward, relay);
+    enet_host_flush(relay->host);
+}
+
+void relay_server_free(relay_server *relay) {
+    relay_stream_free(&relay->stream);
+    enet_host_destroy(relay->host);
+    relay->host = NULL;
+}
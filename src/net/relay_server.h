@@ -0,0 +1,17 @@
+#ifndef RELAY_SERVER_H
+#define RELAY_SERVER_H
+
+#include "net/relay_stream.h"
+#include <enet/enet.h>
+
+typedef struct {
+    ENetHost *host;
+    ENetPeer *publisher;
+    relay_stream stream;
+} relay_server;
+
+int relay_server_create(relay_server *relay, int port, int max_spectators, unsigned int delay);
+void relay_server_service(relay_server *relay, int timeout);
+void relay_server_free(relay_server *relay);
+
+#endif // RELAY_SERVER_H
@@ -0,0 +1,117 @@
+#include "net/relay_stream.h"
+#include "net/relay.h"
+
+typedef struct {
+    unsigned int time; // When the message was published
+    serial msg;
+} relay_pending;
+
+static void store(serial *dst, const serial *src) {
+    dst->wpos = 0;
+    dst->rpos = 0;
+    serial_write(dst, src->data, src->wpos);
+}
+
+static void clear(serial *ser) {
+    ser->wpos = 0;
+    ser->rpos = 0;
+}
+
+static void backlog_clear(list *backlog) {
+    iterator it;
+    serial *msg;
+    list_iter_begin(backlog, &it);
+    while((msg = iter_next(&it)) != NULL) {
+        serial_free(msg);
+    }
+    list_free(backlog);
+    list_create(backlog);
+}
+
+void relay_stream_create(relay_stream *stream, unsigned int delay) {
+    stream->delay = delay;
+    list_create(&stream->pending);
+    list_create(&stream->backlog);
+    serial_create(&stream->match);
+    serial_create(&stream->snapshot);
+}
+
+void relay_stream_free(relay_stream *stream) {
+    iterator it;
+    relay_pending *p;
+    list_iter_begin(&stream->pending, &it);
+    while((p = iter_next(&it)) != NULL) {
+        serial_free(&p->msg);
+    }
+    list_free(&stream->pending);
+    backlog_clear(&stream->backlog);
+    serial_free(&stream->match);
+    serial_free(&stream->snapshot);
+}
+
+// Queues a published message; now is the current time in milliseconds.
+void relay_stream_push(relay_stream *stream, const char *data, size_t len, unsigned int now) {
+    relay_pending p;
+    p.time = now;
+    serial_create_from(&p.msg, data, len);
+    list_append(&stream->pending, &p, sizeof(relay_pending));
+}
+
+// Releases the messages whose delay has passed, in the order they were published.
+void relay_stream_release(relay_stream *stream, unsigned int now, relay_stream_cb cb, void *userdata) {
+    iterator it;
+    relay_pending *p;
+    list_iter_begin(&stream->pending, &it);
+    while((p = iter_next(&it)) != NULL) {
+        if(now - p->time < stream->delay) {
+            break;
+        }
+        int forward = 1;
+        switch(p->msg.wpos > 0 ? p->msg.data[0] : 0) {
+            case RELAY_MATCH:
+                store(&stream->match, &p->msg);
+                clear(&stream->snapshot);
+                backlog_clear(&stream->backlog);
+                break;
+            case RELAY_SNAPSHOT:
+                store(&stream->snapshot, &p->msg);
+                backlog_clear(&stream->backlog);
+                break;
+            case RELAY_ACTION: {
+                serial copy;
+                serial_copy(&copy, &p->msg);
+                list_append(&stream->backlog, &copy, sizeof(serial));
+            } break;
+            case RELAY_END:
+                clear(&stream->match);
+                clear(&stream->snapshot);
+                backlog_clear(&stream->backlog);
+                break;
+            default:
+                forward = 0;
+                break;
+        }
+        if(forward) {
+            cb(&p->msg, userdata);
+        }
+        serial_free(&p->msg);
+        list_delete(&stream->pending, &it);
+    }
+}
+
+// Passes the messages a spectator needs to join the match that is going on, if any.
+void relay_stream_catch_up(const relay_stream *stream, relay_stream_cb cb, void *userdata) {
+    if(stream->match.wpos == 0) {
+        return;
+    }
+    cb(&stream->match, userdata);
+    if(stream->snapshot.wpos > 0) {
+        cb(&stream->snapshot, userdata);
+    }
+    iterator it;
+    serial *msg;
+    list_iter_begin(&stream->backlog, &it);
+    while((msg = iter_next(&it)) != NULL) {
+        cb(msg, userdata);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef RELAY_STREAM_H
+#define RELAY_STREAM_H
+
+#include "game/utils/serial.h"
+#include "utils/list.h"
+
+/*
+ * The message stream of a relay. Published messages are held back for the delay, and then released
+ * to the spectators. The stream remembers the current match, its latest snapshot and the actions after
+ * it, so that spectators joining late can start from the snapshot instead of the beginning.
+ */
+
+typedef void (*relay_stream_cb)(const serial *msg, void *userdata);
+
+typedef struct {
+    unsigned int delay; // How long messages are held back, in milliseconds
+    list pending;       // Messages waiting for the delay to pass
+    serial match;       // The released RELAY_MATCH message, or empty if there is no match
+    serial snapshot;    // The latest released RELAY_SNAPSHOT of the match, or empty
+    list backlog;       // RELAY_ACTION messages released after the snapshot
+} relay_stream;
+
+void relay_stream_create(relay_stream *stream, unsigned int delay);
+void relay_stream_free(relay_stream *stream);
+void relay_stream_push(relay_stream *stream, const char *data, size_t len, unsigned int now);
+void relay_stream_release(relay_stream *stream, unsigned int now, relay_stream_cb cb, void *userdata);
+void relay_stream_catch_up(const relay_stream *stream, relay_stream_cb cb, void *userdata);
+
+#endif // RELAY_STREAM_H
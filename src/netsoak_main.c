@@ -0,0 +1,466 @@
+/*
+ * Netplay soak test. Runs a server and a client network controller in one process, connects them through
+ * a network condition simulator on localhost, and has both play random inputs for a given amount of ticks.
+ * Reports the round trip times, state syncs, bandwidth and any desyncs between the two ends. Exits with 1
+ * if the ends went out of sync, a state sync got through during lockstep, or the connection was lost, so
+ * that this can be run as a regression test.
+ *
+ * For example, a bad connection with lockstep inputs:
+ *   openomf_netsoak --ticks 6000 --delay 60 --jitter 20 --loss 5 --reorder 2 --lockstep 6
+ */
+
+#include "controller/controller.h"
+#include "controller/net_controller.h"
+#include "game/game_state_type.h"
+#include "net/netsim.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "utils/random.h"
+#include <SDL.h>
+#include <argtable2.h>
+#include <enet/enet.h>
+#include <stdio.h>
+
+// Hashes of the inputs are kept this far back, for comparing the two ends
+#define SOAK_HISTORY 4096
+
+// Server state syncs go out at least this often, in ticks
+#define SOAK_SYNC_INTERVAL 60
+
+// Size of the made up game state that is synced, in 32 bit words
+#define SOAK_STATE_WORDS 64
+
+typedef struct {
+    const char *name;
+    controller ctrl;
+    ENetHost *host;
+    struct random_t rand;
+    int last_input;                       // Last action given, to not repeat ACT_STOP
+    unsigned int sent;                    // Actions sent to the peer
+    unsigned int received;                // Actions received from the peer
+    uint32_t sent_hash[SOAK_HISTORY];     // Hash of all sent actions, by the amount of them
+    uint32_t received_hash[SOAK_HISTORY]; // Hash of all received actions, by the amount of them
+    int frames;                           // Lockstep frames played
+    uint32_t frame_hash[SOAK_HISTORY];    // Hash of all inputs played, by lockstep frame
+    int stalls;                           // Ticks spent waiting for the inputs of the peer
+    unsigned int syncs;                   // State syncs sent or received
+    int closed;                           // The connection was lost
+} soak_end;
+
+// Random inputs, in about the mix a player would give them
+static const int soak_actions[] = {ACT_STOP,
+                                   ACT_STOP,
+                                   ACT_LEFT,
+                                   ACT_RIGHT,
+                                   ACT_UP,
+                                   ACT_DOWN,
+                                   ACT_DOWN | ACT_LEFT,
+                                   ACT_DOWN | ACT_RIGHT,
+                                   ACT_UP | ACT_LEFT,
+                                   ACT_UP | ACT_RIGHT,
+                                   ACT_PUNCH,
+                                   ACT_KICK};
+
+static uint32_t hash_int(uint32_t hash, int value) {
+    for(int i = 0; i < 4; i++) {
+        hash ^= ((uint32_t)value >> (i * 8)) & 0xFF;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Appends an action to a hash chain that is kept by the amount of actions in it
+static void hash_chain(uint32_t *chain, unsigned int *count, int action) {
+    uint32_t prev = *count ? chain[(*count - 1) % SOAK_HISTORY] : 2166136261u;
+    chain[*count % SOAK_HISTORY] = hash_int(prev, action);
+    (*count)++;
+}
+
+// Gives an input on about every eighth tick. Returns 0 if there is none.
+static int soak_input(soak_end *end) {
+    if(random_int(&end->rand, 8) != 0) {
+        return 0;
+    }
+    int count = sizeof(soak_actions) / sizeof(soak_actions[0]);
+    int action = soak_actions[(random_intmax(&end->rand) >> 16) % count];
+    if(action == ACT_STOP && end->last_input == ACT_STOP) {
+        return 0;
+    }
+    end->last_input = action;
+    return action;
+}
+
+// Sends the server's view of the match to the client. It changes with the actions of both players.
+static void soak_sync(soak_end *server, int tick) {
+    serial state;
+    serial_create(&state);
+    serial_write_int32(&state, tick);
+    uint32_t seed = server->frames ? server->frame_hash[(server->frames - 1) % SOAK_HISTORY] : server->received;
+    for(int i = 0; i < SOAK_STATE_WORDS; i++) {
+        serial_write_int32(&state, (i % 8 == 0) ? (int)hash_int(seed, i) : i);
+    }
+    // Lockstep matches are not synced, so nothing goes out then
+    if(controller_update(&server->ctrl, &state) == 0) {
+        server->syncs++;
+    }
+    serial_free(&state);
+}
+
+// Plays the inputs of both players for the next lockstep frame, if they are in
+static void soak_lockstep_frame(soak_end *end, int is_server) {
+    if(!net_controller_lockstep_ready(&end->ctrl)) {
+        end->stalls++;
+        return;
+    }
+    ctrl_event *local = NULL;
+    ctrl_event *remote = NULL;
+    net_controller_lockstep_advance(&end->ctrl, &local, &remote);
+
+    // Server is the first player on both ends
+    uint32_t hash = end->frames ? end->frame_hash[(end->frames - 1) % SOAK_HISTORY] : 2166136261u;
+    hash = hash_int(hash, end->frames);
+    for(ctrl_event *ev = is_server ? local : remote; ev != NULL; ev = ev->next) {
+        hash = hash_int(hash, ev->event_data.action);
+    }
+    hash = hash_int(hash, -1);
+    for(ctrl_event *ev = is_server ? remote : local; ev != NULL; ev = ev->next) {
+        hash = hash_int(hash, ev->event_data.action);
+    }
+    end->frame_hash[end->frames % SOAK_HISTORY] = hash;
+    end->frames++;
+}
+
+// Runs the network controller for a tick, and handles what came in. Returns 1 if a sync is due.
+static int soak_tick(soak_end *end, int tick) {
+    ctrl_event *ev = NULL;
+    int resync = 0;
+    controller_tick(&end->ctrl, tick, &ev);
+    for(ctrl_event *i = ev; i != NULL; i = i->next) {
+        switch(i->type) {
+            case EVENT_TYPE_ACTION:
+                hash_chain(end->received_hash, &end->received, i->event_data.action);
+                resync = 1;
+                break;
+            case EVENT_TYPE_SYNC:
+                end->syncs++;
+                break;
+            case EVENT_TYPE_CLOSE:
+                end->closed = 1;
+                break;
+        }
+    }
+    controller_free_chain(ev);
+    return resync;
+}
+
+static void soak_give_input(soak_end *end, int lockstep) {
+    int action = soak_input(end);
+    if(action == 0) {
+        return;
+    }
+    if(lockstep) {
+        net_controller_lockstep_add(&end->ctrl, action);
+    } else {
+        net_controller_har_hook(action, &end->ctrl);
+        hash_chain(end->sent_hash, &end->sent, action);
+    }
+}
+
+/*
+ * Compares what one end sent against what the other received. Both are hash chains over the same
+ * actions, since the actions are sent reliably and in order. Returns 1 on a mismatch.
+ */
+static int soak_compare_actions(const soak_end *from, const soak_end *to) {
+    unsigned int n = to->received;
+    if(n == 0) {
+        return 0;
+    }
+    if(n > from->sent || from->sent - n >= SOAK_HISTORY) {
+        return 1;
+    }
+    return from->sent_hash[(n - 1) % SOAK_HISTORY] != to->received_hash[(n - 1) % SOAK_HISTORY];
+}
+
+// Waits for the next tick, and keeps the simulator moving in the meanwhile
+static void soak_wait(netsim_proxy *proxy, unsigned int until) {
+    do {
+        netsim_proxy_service(proxy);
+        if(enet_time_get() < until) {
+            SDL_Delay(1);
+        }
+    } while(enet_time_get() < until);
+}
+
+static void soak_report_link(const char *name, const netsim_stats *s) {
+    printf("  %-18s %u datagrams, %u delivered, %u lost, %u duplicated, %u reordered\n", name, s->datagrams,
+           s->delivered, s->lost, s->duplicated, s->reordered);
+}
+
+static void soak_report_end(soak_end *end, int tick_ms, float seconds) {
+    printf("%s:\n", end->name);
+    printf("  %-18s %d ticks (%d ms)\n", "round trip", end->ctrl.rtt, end->ctrl.rtt * tick_ms);
+    printf("  %-18s %d ticks\n", "tick offset", net_controller_tick_offset(&end->ctrl));
+    printf("  %-18s %u sent, %u received\n", "actions", end->sent, end->received);
+    printf("  %-18s %u\n", "state syncs", end->syncs);
+    if(end->frames > 0) {
+        printf("  %-18s %d played, %d ticks stalled\n", "lockstep frames", end->frames, end->stalls);
+    }
+    printf("  %-18s %u bytes out (%.1f kB/s), %u bytes in (%.1f kB/s)\n", "bandwidth", end->host->totalSentData,
+           end->host->totalSentData / seconds / 1024.0f, end->host->totalReceivedData,
+           end->host->totalReceivedData / seconds / 1024.0f);
+}
+
+int main(int argc, char *argv[]) {
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_int *ticks = arg_int0("t", "ticks", "<n>", "Ticks to play (default: 3000)");
+    struct arg_int *tick_ms = arg_int0(NULL, "tick-ms", "<ms>", "Length of a tick (default: 10)");
+    struct arg_int *delay = arg_int0("d", "delay", "<ms>", "One way network delay (default: 30)");
+    struct arg_int *jitter = arg_int0("j", "jitter", "<ms>", "Variation of the delay (default: 5)");
+    struct arg_int *loss = arg_int0("l", "loss", "<percent>", "Chance of losing a datagram (default: 0)");
+    struct arg_int *duplicate =
+        arg_int0(NULL, "duplicate", "<percent>", "Chance of a duplicate datagram (default: 0)");
+    struct arg_int *reorder = arg_int0(NULL, "reorder", "<percent>", "Chance of a late datagram (default: 0)");
+    struct arg_int *lockstep = arg_int0(NULL, "lockstep", "<frames>", "Play in lockstep with this input delay");
+    struct arg_int *seed = arg_int0("s", "seed", "<n>", "Seed for the inputs and the network (default: 1)");
+    struct arg_int *port =
+        arg_int0("p", "port", "<port>", "Loopback port of the server (default: any free one)");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, ticks, tick_ms, delay, jitter, loss, duplicate, reorder, lockstep, seed, port, end};
+    const char *progname = "openomf_netsoak";
+    int ret = 1;
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        fprintf(stderr, "Error: insufficient memory\n");
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        printf("Usage: %s", progname);
+        arg_print_syntax(stdout, argtable, "\n");
+        printf("\nArguments:\n");
+        arg_print_glossary(stdout, argtable, "%-25s %s\n");
+        ret = 0;
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stderr, end, progname);
+        fprintf(stderr, "Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    int max_ticks = ticks->count > 0 && ticks->ival[0] > 0 ? ticks->ival[0] : 3000;
+    int ms = tick_ms->count > 0 && tick_ms->ival[0] > 0 ? tick_ms->ival[0] : 10;
+    int input_delay = lockstep->count > 0 ? lockstep->ival[0] : -1;
+    uint32_t rand_seed = seed->count > 0 ? seed->ival[0] : 1;
+    int server_port = port->count > 0 ? port->ival[0] & 0xFFFF : 0;
+    netsim_conditions cond;
+    cond.delay = delay->count > 0 ? delay->ival[0] : 30;
+    cond.jitter = jitter->count > 0 ? jitter->ival[0] : 5;
+    cond.loss = loss->count > 0 ? loss->ival[0] : 0;
+    cond.duplicate = duplicate->count > 0 ? duplicate->ival[0] : 0;
+    cond.reorder = reorder->count > 0 ? reorder->ival[0] : 0;
+
+    if(log_init(0)) {
+        fprintf(stderr, "Error while initializing log!\n");
+        goto exit_0;
+    }
+    if(enet_initialize() != 0) {
+        PERROR("Failed to initialize enet");
+        goto exit_1;
+    }
+
+    // Server listens on loopback, and the client connects to the simulator in front of it. Both take any
+    // free port unless told otherwise, so that runs in parallel don't get in each other's way.
+    soak_end server = {.name = "server", .last_input = -1};
+    soak_end client = {.name = "client", .last_input = -1};
+    random_seed(&server.rand, rand_seed);
+    random_seed(&client.rand, rand_seed * 2654435761u + 1);
+    ENetAddress address;
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = server_port;
+    server.host = enet_host_create(&address, 1, 3, 0, 0);
+    if(server.host == NULL) {
+        PERROR("Unable to listen on port %d", server_port);
+        goto exit_2;
+    }
+    if(enet_socket_get_address(server.host->socket, &address) < 0) {
+        PERROR("Unable to find out the server port");
+        goto exit_3;
+    }
+    enet_host_compress_with_range_coder(server.host);
+    netsim_proxy proxy;
+    if(netsim_proxy_create(&proxy, 0, &address, &cond, rand_seed)) {
+        goto exit_3;
+    }
+    client.host = enet_host_create(NULL, 1, 3, 0, 0);
+    if(client.host == NULL) {
+        PERROR("Unable to create the client host");
+        goto exit_4;
+    }
+    enet_host_compress_with_range_coder(client.host);
+    enet_host_connect(client.host, &proxy.address, 3, 0);
+
+    // Connect, the same way the listen and connect menus do
+    ENetPeer *server_peer = NULL;
+    ENetPeer *client_peer = NULL;
+    ENetEvent event;
+    unsigned int deadline = enet_time_get() + 10000;
+    while((server_peer == NULL || client_peer == NULL) && enet_time_get() < deadline) {
+        netsim_proxy_service(&proxy);
+        if(enet_host_service(server.host, &event, 0) > 0 && event.type == ENET_EVENT_TYPE_CONNECT) {
+            server_peer = event.peer;
+        }
+        if(enet_host_service(client.host, &event, 0) > 0 && event.type == ENET_EVENT_TYPE_CONNECT) {
+            client_peer = event.peer;
+        }
+        SDL_Delay(1);
+    }
+    if(server_peer == NULL || client_peer == NULL) {
+        PERROR("Unable to connect through the simulator");
+        goto exit_5;
+    }
+    controller_init(&server.ctrl);
+    controller_init(&client.ctrl);
+    net_controller_create(&server.ctrl, server.host, server_peer, ROLE_SERVER);
+    net_controller_create(&client.ctrl, client.host, client_peer, ROLE_CLIENT);
+    if(input_delay >= 0) {
+        net_controller_set_lockstep(&server.ctrl, input_delay);
+    }
+
+    // Measure the round trip time before starting, like the game does before a match
+    int tick = 0;
+    unsigned int next = enet_time_get();
+    deadline = next + 30000;
+    while(!net_controller_ready(&server.ctrl) || !net_controller_ready(&client.ctrl)) {
+        soak_tick(&server, tick);
+        soak_tick(&client, tick);
+        omf_arena_reset(OMF_ARENA_TICK);
+        if(server.closed || client.closed || enet_time_get() > deadline) {
+            PERROR("Peers did not get ready");
+            goto exit_6;
+        }
+        tick++;
+        next += ms;
+        soak_wait(&proxy, next);
+    }
+
+    // Leave a state sync on the way when the match starts. A lockstep client has to drop it, along with
+    // the ones the server tries to send during the match.
+    soak_sync(&server, tick);
+    unsigned int syncs_before = client.syncs;
+    if(input_delay >= 0 &&
+       (!net_controller_lockstep_start(&server.ctrl) || !net_controller_lockstep_start(&client.ctrl))) {
+        PERROR("Client did not switch to lockstep");
+        goto exit_6;
+    }
+    if(input_delay >= 0 && net_controller_lockstep_seed(&server.ctrl) != net_controller_lockstep_seed(&client.ctrl)) {
+        PERROR("Ends did not agree on the seed of the match");
+        goto exit_6;
+    }
+
+    printf("Playing %d ticks of %d ms, %d ms delay, %d ms jitter, %d%% loss, %d%% duplicates, %d%% reordered",
+           max_ticks, ms, cond.delay, cond.jitter, cond.loss, cond.duplicate, cond.reorder);
+    if(input_delay >= 0) {
+        printf(", lockstep with %d frames of input delay", input_delay);
+    }
+    printf("\n");
+
+    int desyncs = 0;
+    int first_desync = -1;
+    int checked = 0;
+    unsigned int start = enet_time_get();
+    for(int i = 0; i < max_ticks && !server.closed && !client.closed; i++, tick++) {
+        int resync = soak_tick(&server, tick);
+        soak_tick(&client, tick);
+        soak_give_input(&server, input_delay >= 0);
+        soak_give_input(&client, input_delay >= 0);
+        if(input_delay >= 0) {
+            soak_lockstep_frame(&server, 1);
+            soak_lockstep_frame(&client, 0);
+        } else {
+            net_controller_har_hook(ACT_FLUSH, &server.ctrl);
+            net_controller_har_hook(ACT_FLUSH, &client.ctrl);
+        }
+
+        // The server resyncs after remote actions, and now and then in any case
+        if(resync || i % SOAK_SYNC_INTERVAL == 0) {
+            soak_sync(&server, tick);
+        }
+        omf_arena_reset(OMF_ARENA_TICK);
+
+        // Both ends are in this process, so they can be compared directly
+        int common = server.frames < client.frames ? server.frames : client.frames;
+        for(; checked < common; checked++) {
+            if(server.frame_hash[checked % SOAK_HISTORY] != client.frame_hash[checked % SOAK_HISTORY]) {
+                if(first_desync < 0) {
+                    first_desync = checked;
+                }
+                desyncs++;
+            }
+        }
+        if(soak_compare_actions(&server, &client) || soak_compare_actions(&client, &server)) {
+            if(first_desync < 0) {
+                first_desync = tick;
+            }
+            desyncs++;
+        }
+
+        next += ms;
+        soak_wait(&proxy, next);
+    }
+    float seconds = (enet_time_get() - start) / 1000.0f;
+
+    // A sync would undo lockstep frames the client has already played
+    int lockstep_syncs = input_delay >= 0 ? (int)(client.syncs - syncs_before) : 0;
+
+    soak_report_end(&server, ms, seconds);
+    soak_report_end(&client, ms, seconds);
+    printf("simulator:\n");
+    soak_report_link("client to server", &proxy.up.stats);
+    soak_report_link("server to client", &proxy.down.stats);
+    if(desyncs > 0) {
+        printf("%d desyncs, the first one on %s %d\n", desyncs, input_delay >= 0 ? "frame" : "tick", first_desync);
+    } else {
+        printf("no desyncs\n");
+    }
+    if(lockstep_syncs > 0) {
+        printf("%d state syncs were applied during lockstep\n", lockstep_syncs);
+    }
+    if(server.closed || client.closed) {
+        printf("connection was lost\n");
+    }
+    ret = (desyncs > 0 || lockstep_syncs > 0 || server.closed || client.closed) ? 1 : 0;
+
+    net_controller_lockstep_stop(&server.ctrl);
+    net_controller_lockstep_stop(&client.ctrl);
+exit_6:
+    // The controllers own the hosts from here on
+    server.ctrl.free_fun(&server.ctrl);
+    client.ctrl.free_fun(&client.ctrl);
+    server.host = NULL;
+    client.host = NULL;
+exit_5:
+    if(client.host) {
+        enet_host_destroy(client.host);
+    }
+exit_4:
+    netsim_proxy_free(&proxy);
+exit_3:
+    if(server.host) {
+        enet_host_destroy(server.host);
+    }
+exit_2:
+    enet_deinitialize();
+exit_1:
+    log_close();
+exit_0:
+    arg_freetable(argtable, sizeof(argtable) / sizeof(argtable[0]));
+    return ret;
+}
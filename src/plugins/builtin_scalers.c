@@ -0,0 +1,168 @@
+#include "plugins/builtin_scalers.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Scalers that come with the game. These work on rows of the image, so that the frame can be split in bands
+ * and scaled by several threads at once. Pixels outside the image are taken from the nearest edge.
+ */
+
+static int scale2x_factors[] = {2, 3};
+
+static const char *scale2x_get_name() {
+    return "Scale2x";
+}
+
+static const char *builtin_get_author() {
+    return "OpenOMF project";
+}
+
+static const char *builtin_get_license() {
+    return "MIT";
+}
+
+static const char *builtin_get_type() {
+    return "scaler";
+}
+
+static const char *builtin_get_version() {
+    return "1.0";
+}
+
+static int scale2x_is_factor_available(int factor) {
+    return factor == 2 || factor == 3;
+}
+
+static int scale2x_get_factors_list(int **factors) {
+    *factors = scale2x_factors;
+    return sizeof(scale2x_factors) / sizeof(int);
+}
+
+static int builtin_get_color_format() {
+    return 0;
+}
+
+static inline void scale2x_pixel(const uint32_t *up, const uint32_t *row, const uint32_t *down, uint32_t *out0,
+                                 uint32_t *out1, int x, int w) {
+    uint32_t b = up[x];
+    uint32_t d = row[(x > 0) ? x - 1 : x];
+    uint32_t e = row[x];
+    uint32_t f = row[(x < w - 1) ? x + 1 : x];
+    uint32_t h = down[x];
+    out0[x * 2 + 0] = (d == b && b != f && d != h) ? d : e;
+    out0[x * 2 + 1] = (b == f && b != d && f != h) ? f : e;
+    out1[x * 2 + 0] = (d == h && d != b && h != f) ? d : e;
+    out1[x * 2 + 1] = (h == f && d != h && b != f) ? f : e;
+}
+
+static void scale2x_row(const uint32_t *up, const uint32_t *row, const uint32_t *down, uint32_t *out0, uint32_t *out1,
+                        int w) {
+    int x = 0;
+#ifdef __SSE2__
+    // Four pixels at a time. Edge pixels are left to the scalar code, so that D and F can be loaded straight
+    // from the row.
+    scale2x_pixel(up, row, down, out0, out1, x++, w);
+    for(; x + 4 < w; x += 4) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(up + x));
+        __m128i d = _mm_loadu_si128((const __m128i *)(row + x - 1));
+        __m128i e = _mm_loadu_si128((const __m128i *)(row + x));
+        __m128i f = _mm_loadu_si128((const __m128i *)(row + x + 1));
+        __m128i h = _mm_loadu_si128((const __m128i *)(down + x));
+        __m128i db = _mm_cmpeq_epi32(d, b);
+        __m128i bf = _mm_cmpeq_epi32(b, f);
+        __m128i dh = _mm_cmpeq_epi32(d, h);
+        __m128i hf = _mm_cmpeq_epi32(h, f);
+        __m128i m0 = _mm_andnot_si128(_mm_or_si128(bf, dh), db);
+        __m128i m1 = _mm_andnot_si128(_mm_or_si128(db, hf), bf);
+        __m128i m2 = _mm_andnot_si128(_mm_or_si128(db, hf), dh);
+        __m128i m3 = _mm_andnot_si128(_mm_or_si128(dh, bf), hf);
+        __m128i e0 = _mm_or_si128(_mm_and_si128(m0, d), _mm_andnot_si128(m0, e));
+        __m128i e1 = _mm_or_si128(_mm_and_si128(m1, f), _mm_andnot_si128(m1, e));
+        __m128i e2 = _mm_or_si128(_mm_and_si128(m2, d), _mm_andnot_si128(m2, e));
+        __m128i e3 = _mm_or_si128(_mm_and_si128(m3, f), _mm_andnot_si128(m3, e));
+        _mm_storeu_si128((__m128i *)(out0 + x * 2), _mm_unpacklo_epi32(e0, e1));
+        _mm_storeu_si128((__m128i *)(out0 + x * 2 + 4), _mm_unpackhi_epi32(e0, e1));
+        _mm_storeu_si128((__m128i *)(out1 + x * 2), _mm_unpacklo_epi32(e2, e3));
+        _mm_storeu_si128((__m128i *)(out1 + x * 2 + 4), _mm_unpackhi_epi32(e2, e3));
+    }
+#endif
+    for(; x < w; x++) {
+        scale2x_pixel(up, row, down, out0, out1, x, w);
+    }
+}
+
+static void scale3x_row(const uint32_t *up, const uint32_t *row, const uint32_t *down, uint32_t *out0, uint32_t *out1,
+                        uint32_t *out2, int w) {
+    for(int x = 0; x < w; x++) {
+        int l = (x > 0) ? x - 1 : x;
+        int r = (x < w - 1) ? x + 1 : x;
+        uint32_t a = up[l], b = up[x], c = up[r];
+        uint32_t d = row[l], e = row[x], f = row[r];
+        uint32_t g = down[l], h = down[x], i = down[r];
+        int db = (d == b && b != f && d != h);
+        int bf = (b == f && b != d && f != h);
+        int dh = (d == h && d != b && h != f);
+        int hf = (h == f && d != h && b != f);
+        out0[x * 3 + 0] = db ? d : e;
+        out0[x * 3 + 1] = ((db && e != c) || (bf && e != a)) ? b : e;
+        out0[x * 3 + 2] = bf ? f : e;
+        out1[x * 3 + 0] = ((db && e != g) || (dh && e != a)) ? d : e;
+        out1[x * 3 + 1] = e;
+        out1[x * 3 + 2] = ((bf && e != i) || (hf && e != c)) ? f : e;
+        out2[x * 3 + 0] = dh ? d : e;
+        out2[x * 3 + 1] = ((dh && e != i) || (hf && e != g)) ? h : e;
+        out2[x * 3 + 2] = hf ? f : e;
+    }
+}
+
+static int scale2x_scale_rows(const char *in, char *out, int w, int h, int factor, int y0, int y1) {
+    const uint32_t *src = (const uint32_t *)in;
+    uint32_t *dst = (uint32_t *)out;
+    int ow = w * factor;
+    for(int y = y0; y < y1; y++) {
+        const uint32_t *up = src + ((y > 0) ? y - 1 : y) * w;
+        const uint32_t *row = src + y * w;
+        const uint32_t *down = src + ((y < h - 1) ? y + 1 : y) * w;
+        uint32_t *o = dst + (size_t)y * factor * ow;
+        if(factor == 2) {
+            scale2x_row(up, row, down, o, o + ow, w);
+        } else if(factor == 3) {
+            scale3x_row(up, row, down, o, o + ow, o + ow * 2, w);
+        } else {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int scale2x_scale(const char *in, char *out, int w, int h, int factor) {
+    return scale2x_scale_rows(in, out, w, h, factor, 0, h);
+}
+
+static base_plugin scale2x_base = {
+    NULL, scale2x_get_name, builtin_get_author, builtin_get_license, builtin_get_type, builtin_get_version,
+};
+
+int builtin_scalers_get(scaler_plugin *scaler, const char *name) {
+    if(strcmp(name, scale2x_get_name()) != 0) {
+        return 1;
+    }
+    scaler->base = &scale2x_base;
+    scaler->is_factor_available = scale2x_is_factor_available;
+    scaler->get_factors_list = scale2x_get_factors_list;
+    scaler->get_color_format = builtin_get_color_format;
+    scaler->scale = scale2x_scale;
+    scaler->scale_rows = scale2x_scale_rows;
+    return 0;
+}
+
+// Appends the built-in scalers to the list, as base_plugin pointers
+int builtin_scalers_get_list(list *tlist) {
+    void *ptr = &scale2x_base;
+    list_append(tlist, &ptr, sizeof(base_plugin *));
+    return 1;
+}
@@ -0,0 +1,10 @@
+#ifndef BUILTIN_SCALERS_H
+#define BUILTIN_SCALERS_H
+
+#include "plugins/scaler_plugin.h"
+#include "utils/list.h"
+
+int builtin_scalers_get(scaler_plugin *scaler, const char *name);
+int builtin_scalers_get_list(list *tlist);
+
+#endif // BUILTIN_SCALERS_H
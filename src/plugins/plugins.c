@@ -1,4 +1,5 @@
 #include "plugins/plugins.h"
+#include "plugins/builtin_scalers.h"
 #include "resources/pathmanager.h"
 #include "utils/allocator.h"
 #include "utils/list.h"
@@ -114,6 +115,10 @@ void plugins_init() {
 }
 
 int plugins_get_scaler(scaler_plugin *scaler, const char *name) {
+    if(builtin_scalers_get(scaler, name) == 0) {
+        return 0;
+    }
+
     // Search for a scaler with given name
     for(int i = 0; i < PLUGIN_MAX_COUNT; i++) {
         if(_plugins[i].handle != NULL && strcmp(_plugins[i].get_name(), name) == 0 &&
@@ -123,6 +128,7 @@ int plugins_get_scaler(scaler_plugin *scaler, const char *name) {
             scaler->get_factors_list = SDL_LoadFunction(scaler->base->handle, "scaler_get_factors_list");
             scaler->get_color_format = SDL_LoadFunction(scaler->base->handle, "scaler_get_color_format");
             scaler->scale = SDL_LoadFunction(scaler->base->handle, "scaler_handle");
+            scaler->scale_rows = NULL;
             return 0;
         }
     }
@@ -130,8 +136,13 @@ int plugins_get_scaler(scaler_plugin *scaler, const char *name) {
 }
 
 int plugins_get_list_by_type(list *tlist, const char *type) {
-    // Search for a scaler with given type
+    // Built-in scalers come first
     int count = 0;
+    if(strcmp(type, "scaler") == 0) {
+        count += builtin_scalers_get_list(tlist);
+    }
+
+    // Search for plugins with given type
     for(int i = 0; i < PLUGIN_MAX_COUNT; i++) {
         if(_plugins[i].handle != NULL && strcmp(_plugins[i].get_type(), type) == 0) {
             void *ptr = &_plugins[i];
@@ -7,6 +7,7 @@ void scaler_init(scaler_plugin *scaler) {
     scaler->get_factors_list = NULL;
     scaler->get_color_format = NULL;
     scaler->scale = NULL;
+    scaler->scale_rows = NULL;
 }
 
 int scaler_is_factor_available(scaler_plugin *scaler, int factor) {
@@ -9,6 +9,8 @@ typedef struct {
     int (*get_factors_list)(int **factors);
     int (*get_color_format)();
     int (*scale)(const char *in, char *out, int w, int h, int factor);
+    // Scales only rows y0..y1-1 of the image, so that bands can be scaled in parallel. Optional.
+    int (*scale_rows)(const char *in, char *out, int w, int h, int factor, int y0, int y1);
 } scaler_plugin;
 
 void scaler_init(scaler_plugin *scaler);
@@ -0,0 +1,97 @@
+/*
+ * Relay server for spectating network matches. The hosting game publishes its match here with --relay,
+ * and any amount of spectators can then watch it with --spectate, without adding load to the players.
+ *
+ * For example, on a single machine:
+ *   openomf_relay --delay 2000
+ *   openomf --listen --relay localhost
+ *   openomf --connect localhost
+ *   openomf --spectate localhost
+ */
+
+#include "net/relay.h"
+#include "net/relay_server.h"
+#include "utils/log.h"
+#include <argtable2.h>
+#include <enet/enet.h>
+#include <signal.h>
+#include <stdio.h>
+
+static volatile sig_atomic_t running = 1;
+
+static void relay_stop(int sig) {
+    running = 0;
+}
+
+int main(int argc, char *argv[]) {
+    struct arg_lit *help = arg_lit0("h", "help", "print this help and exit");
+    struct arg_int *port = arg_int0("p", "port", "<port>", "Port to listen (default: 2098)");
+    struct arg_int *delay = arg_int0("d", "delay", "<ms>", "Delay before spectators see the match (default: 0)");
+    struct arg_int *spectators = arg_int0("s", "spectators", "<n>", "Maximum amount of spectators (default: 32)");
+    struct arg_end *end = arg_end(20);
+    void *argtable[] = {help, port, delay, spectators, end};
+    const char *progname = "openomf_relay";
+    int ret = 1;
+
+    // Make sure everything got allocated
+    if(arg_nullcheck(argtable) != 0) {
+        fprintf(stderr, "Error: insufficient memory\n");
+        goto exit_0;
+    }
+
+    // Parse arguments
+    int nerrors = arg_parse(argc, argv, argtable);
+
+    // Handle help
+    if(help->count > 0) {
+        printf("Usage: %s", progname);
+        arg_print_syntax(stdout, argtable, "\n");
+        printf("\nArguments:\n");
+        arg_print_glossary(stdout, argtable, "%-25s %s\n");
+        ret = 0;
+        goto exit_0;
+    }
+
+    // Handle errors
+    if(nerrors > 0) {
+        arg_print_errors(stderr, end, progname);
+        fprintf(stderr, "Try '%s --help' for more information.\n", progname);
+        goto exit_0;
+    }
+
+    int listen_port = port->count > 0 ? port->ival[0] & 0xFFFF : RELAY_DEFAULT_PORT;
+    int delay_ms = delay->count > 0 && delay->ival[0] > 0 ? delay->ival[0] : 0;
+    int max_spectators = spectators->count > 0 && spectators->ival[0] > 0 ? spectators->ival[0] : 32;
+
+    if(log_init(0)) {
+        fprintf(stderr, "Error while initializing log!\n");
+        goto exit_0;
+    }
+    if(enet_initialize() != 0) {
+        PERROR("Failed to initialize enet");
+        goto exit_1;
+    }
+
+    relay_server relay;
+    if(relay_server_create(&relay, listen_port, max_spectators, delay_ms)) {
+        PERROR("Unable to listen on port %d", listen_port);
+        goto exit_2;
+    }
+    INFO("Relay listening on port %d, %d ms delay, %d spectators at most", listen_port, delay_ms, max_spectators);
+
+    signal(SIGINT, relay_stop);
+    signal(SIGTERM, relay_stop);
+    while(running) {
+        relay_server_service(&relay, 10);
+    }
+    relay_server_free(&relay);
+    ret = 0;
+
+exit_2:
+    enet_deinitialize();
+exit_1:
+    log_close();
+exit_0:
+    arg_freetable(argtable, sizeof(argtable) / sizeof(argtable[0]));
+    return ret;
+}
@@ -9,10 +9,11 @@ void af_create(af *a, void *src) {
     a->id = sdaf->file_id;
     a->endurance = sdaf->endurance;
     a->health = sdaf->health;
-    a->forward_speed = sdaf->forward_speed;
-    a->reverse_speed = sdaf->reverse_speed;
-    a->jump_speed = sdaf->jump_speed;
-    a->fall_speed = sdaf->fall_speed;
+    // Speeds are stored in 1/256ths, so these convert exactly
+    a->forward_speed = fixedpt_from_float(sdaf->forward_speed);
+    a->reverse_speed = fixedpt_from_float(sdaf->reverse_speed);
+    a->jump_speed = fixedpt_from_float(sdaf->jump_speed);
+    a->fall_speed = fixedpt_from_float(sdaf->fall_speed);
 
     // Sound translation table
     memcpy(a->sound_translation_table, sdaf->soundtable, 30);
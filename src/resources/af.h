@@ -2,15 +2,16 @@
 #define AF_H
 
 #include "resources/af_move.h"
+#include "utils/fixedpt.h"
 
 typedef struct af_t {
     unsigned int id;
     float endurance;
     unsigned int health;
-    float forward_speed;
-    float reverse_speed;
-    float jump_speed;
-    float fall_speed;
+    fixedpt forward_speed;
+    fixedpt reverse_speed;
+    fixedpt jump_speed;
+    fixedpt fall_speed;
     af_move moves[70];
     char sound_translation_table[30];
 } af;
@@ -31,11 +31,12 @@ void animation_create(animation *ani, void *src, int id) {
         // inside it, which vector_append does not copy
     }
 
-    // Handle sprites
+    // Handle sprites. Animations are only loaded as a part of the scene resources (BK and AF files),
+    // so the sprite data can be kept in the scene arena.
     vector_create(&ani->sprites, sizeof(sprite));
     sprite tmp_sprite;
     for(int i = 0; i < sdani->sprite_count; i++) {
-        sprite_create(&tmp_sprite, (void *)sdani->sprites[i], i);
+        sprite_create_in_arena(&tmp_sprite, (void *)sdani->sprites[i], i, OMF_ARENA_SCENE);
         vector_append(&ani->sprites, &tmp_sprite);
     }
 }
@@ -22,23 +22,18 @@ void bk_create(bk *b, void *src) {
     }
 
     // Copy info structs
-    hashmap_create(&b->infos, 7);
+    flatmap_create(&b->infos, sizeof(unsigned int), sizeof(bk_info), 7);
     bk_info tmp_bk_info;
     for(int i = 0; i < 50; i++) {
         if(sdbk->anims[i] != NULL) {
             bk_info_create(&tmp_bk_info, (void *)sdbk->anims[i], i);
-            hashmap_iput(&b->infos, i, &tmp_bk_info, sizeof(bk_info));
+            flatmap_iput(&b->infos, i, &tmp_bk_info);
         }
     }
 }
 
 bk_info *bk_get_info(bk *b, int id) {
-    bk_info *val;
-    unsigned int tmp;
-    if(hashmap_iget(&b->infos, id, (void **)&val, &tmp) == 1) {
-        return NULL;
-    }
-    return val;
+    return flatmap_iget(&b->infos, id);
 }
 
 palette *bk_get_palette(bk *b, int id) {
@@ -55,10 +50,10 @@ void bk_free(bk *b) {
 
     // Free info structs
     iterator it;
-    hashmap_iter_begin(&b->infos, &it);
-    hashmap_pair *pair = NULL;
-    while((pair = iter_next(&it)) != NULL) {
-        bk_info_free((bk_info *)pair->val);
+    flatmap_iter_begin(&b->infos, &it);
+    bk_info *info = NULL;
+    while((info = iter_next(&it)) != NULL) {
+        bk_info_free(info);
     }
-    hashmap_free(&b->infos);
+    flatmap_free(&b->infos);
 }
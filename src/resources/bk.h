@@ -2,13 +2,13 @@
 #define BK_H
 
 #include "resources/bk_info.h"
-#include "utils/hashmap.h"
+#include "utils/flatmap.h"
 #include "utils/vector.h"
 
 typedef struct bk_t {
     int file_id;
     surface background;
-    hashmap infos;
+    flatmap infos;
     vector palettes;
     char sound_translation_table[30];
 } bk;
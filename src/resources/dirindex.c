@@ -0,0 +1,220 @@
+#include "resources/dirindex.h"
+#include "utils/allocator.h"
+#include "utils/list.h"
+#include "utils/log.h"
+#include "utils/scandir.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define DIRINDEX_VERSION 2
+
+typedef struct {
+    int64_t mtime;
+    int64_t size;
+    uint32_t hash;
+    char filename[DIRINDEX_NAME_MAX];
+} dirindex_file;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t count;
+    int64_t scanned; // Time the directory was scanned at
+} dirindex_header;
+
+static unsigned int dirindex_record_size(const dirindex *index) {
+    return sizeof(dirindex_file) + index->info_size;
+}
+
+static int dirindex_compare(const void *a, const void *b) {
+    return strcmp(((const dirindex_file *)a)->filename, ((const dirindex_file *)b)->filename);
+}
+
+// FNV-1a over the whole file. Used to spot files that were touched, but not changed.
+static int dirindex_hash_file(const char *path, uint32_t *hash) {
+    FILE *fp = fopen(path, "rb");
+    if(fp == NULL) {
+        return 1;
+    }
+    unsigned char buf[4096];
+    size_t len;
+    uint32_t h = 2166136261u;
+    while((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        for(size_t i = 0; i < len; i++) {
+            h ^= buf[i];
+            h *= 0x01000193u;
+        }
+    }
+    fclose(fp);
+    *hash = h;
+    return 0;
+}
+
+/*
+ * Reads a previously written cache file, and the time it was scanned at. A missing or mismatching cache just
+ * results in an empty vector.
+ */
+static void dirindex_load_cache(const dirindex *index, vector *cached, int64_t *scanned, const char *cache_file) {
+    FILE *fp = fopen(cache_file, "rb");
+    if(fp == NULL) {
+        return;
+    }
+    dirindex_header header;
+    if(fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, "OIDX", 4) != 0 ||
+       header.version != DIRINDEX_VERSION || header.record_size != dirindex_record_size(index)) {
+        DEBUG("Ignoring stale index file %s", cache_file);
+        fclose(fp);
+        return;
+    }
+    *scanned = header.scanned;
+    char *record = omf_calloc(1, dirindex_record_size(index));
+    for(uint32_t i = 0; i < header.count; i++) {
+        if(fread(record, dirindex_record_size(index), 1, fp) != 1) {
+            break;
+        }
+        ((dirindex_file *)record)->filename[DIRINDEX_NAME_MAX - 1] = 0;
+        vector_append(cached, record);
+    }
+    omf_free(record);
+    fclose(fp);
+}
+
+static void dirindex_save_cache(const dirindex *index, int64_t scanned, const char *cache_file) {
+    FILE *fp = fopen(cache_file, "wb");
+    if(fp == NULL) {
+        DEBUG("Unable to write index file %s", cache_file);
+        return;
+    }
+    dirindex_header header;
+    memcpy(header.magic, "OIDX", 4);
+    header.version = DIRINDEX_VERSION;
+    header.record_size = dirindex_record_size(index);
+    header.count = vector_size(&index->entries);
+    header.scanned = scanned;
+    fwrite(&header, sizeof(header), 1, fp);
+    for(unsigned int i = 0; i < header.count; i++) {
+        fwrite(vector_get(&index->entries, i), header.record_size, 1, fp);
+    }
+    fclose(fp);
+}
+
+void dirindex_create(dirindex *index, unsigned int info_size) {
+    index->info_size = info_size;
+    vector_create(&index->entries, dirindex_record_size(index));
+}
+
+void dirindex_free(dirindex *index) {
+    vector_free(&index->entries);
+}
+
+/*
+ * Scans the directory for files with the given suffix, and refreshes the index from them.
+ * Files with the same name, size and modification time as in the cache file are not opened at all,
+ * unless they were modified during or after the scan that cached them. Timestamps only go by the
+ * second or so, and such a file may have been written again without its timestamp changing; those
+ * are hashed to tell. The cache file is rewritten if anything changed. Returns 0 on success, 1 if
+ * the directory could not be read.
+ */
+int dirindex_scan(dirindex *index, const char *dirname, const char *suffix, const char *cache_file,
+                  dirindex_read_fn read_fn) {
+    list dirlist;
+    list_create(&dirlist);
+    if(scan_directory_suffix(&dirlist, dirname, suffix) != 0) {
+        list_free(&dirlist);
+        return 1;
+    }
+
+    // Taken before looking at any of the files, so that files written during the scan are never trusted
+    int64_t scanned = time(NULL);
+    int64_t cache_scanned = 0;
+    vector cached;
+    vector_create(&cached, dirindex_record_size(index));
+    dirindex_load_cache(index, &cached, &cache_scanned, cache_file);
+    vector_sort(&cached, dirindex_compare);
+
+    vector_clear(&index->entries);
+    char *record = omf_calloc(1, dirindex_record_size(index));
+    dirindex_file *file = (dirindex_file *)record;
+    int changed = 0;
+    unsigned int parsed = 0;
+    char path[1024];
+    struct stat st;
+
+    iterator it;
+    list_iter_begin(&dirlist, &it);
+    const char *filename;
+    while((filename = list_iter_next(&it)) != NULL) {
+        if(strlen(filename) >= DIRINDEX_NAME_MAX) {
+            PERROR("File name %s is too long to index", filename);
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s%s", dirname, filename);
+        if(stat(path, &st) != 0) {
+            continue;
+        }
+
+        memset(record, 0, dirindex_record_size(index));
+        strncpy(file->filename, filename, DIRINDEX_NAME_MAX - 1);
+        const dirindex_file *old = NULL;
+        if(vector_size(&cached) > 0) {
+            old = bsearch(record, vector_get(&cached, 0), vector_size(&cached), dirindex_record_size(index),
+                          dirindex_compare);
+        }
+
+        if(old != NULL && old->mtime == (int64_t)st.st_mtime && old->size == (int64_t)st.st_size &&
+           old->mtime < cache_scanned) {
+            vector_append(&index->entries, old);
+            continue;
+        }
+
+        changed = 1;
+        file->mtime = st.st_mtime;
+        file->size = st.st_size;
+        if(dirindex_hash_file(path, &file->hash) != 0) {
+            continue;
+        }
+        if(old != NULL && old->hash == file->hash && old->size == file->size) {
+            // Only the timestamp changed; keep the old info.
+            memcpy(record + sizeof(dirindex_file), (const char *)old + sizeof(dirindex_file), index->info_size);
+        } else if(read_fn(path, record + sizeof(dirindex_file)) != 0) {
+            PERROR("Could not index file %s", path);
+            continue;
+        } else {
+            parsed++;
+        }
+        vector_append(&index->entries, record);
+    }
+
+    if(vector_size(&index->entries) != vector_size(&cached)) {
+        changed = 1;
+    }
+    vector_sort(&index->entries, dirindex_compare);
+    if(changed) {
+        dirindex_save_cache(index, scanned, cache_file);
+    }
+    DEBUG("Indexed %u files in %s, %u parsed.", vector_size(&index->entries), dirname, parsed);
+
+    omf_free(record);
+    vector_free(&cached);
+    list_free(&dirlist);
+    return 0;
+}
+
+unsigned int dirindex_size(const dirindex *index) {
+    return vector_size(&index->entries);
+}
+
+const char *dirindex_get_filename(const dirindex *index, unsigned int n) {
+    const dirindex_file *file = vector_get(&index->entries, n);
+    return (file != NULL) ? file->filename : NULL;
+}
+
+const void *dirindex_get_info(const dirindex *index, unsigned int n) {
+    const char *record = vector_get(&index->entries, n);
+    return (record != NULL) ? record + sizeof(dirindex_file) : NULL;
+}
@@ -0,0 +1,35 @@
+#ifndef DIRINDEX_H
+#define DIRINDEX_H
+
+#include "utils/vector.h"
+
+/*
+ * Metadata index for a directory of game files (savegames, tournaments).
+ * Each file is described by a small caller defined info block, which is kept in a cache file
+ * between runs. On every scan, only files whose modification time or size changed get parsed again.
+ */
+
+// Longest file name that can be indexed, including the terminating zero.
+#define DIRINDEX_NAME_MAX 116
+
+/*
+ * Fills in the info block of a single file. Return 0 on success, or
+ * anything else to leave the file out of the index.
+ */
+typedef int (*dirindex_read_fn)(const char *path, void *info);
+
+typedef struct {
+    vector entries;
+    unsigned int info_size;
+} dirindex;
+
+void dirindex_create(dirindex *index, unsigned int info_size);
+void dirindex_free(dirindex *index);
+int dirindex_scan(dirindex *index, const char *dirname, const char *suffix, const char *cache_file,
+                  dirindex_read_fn read_fn);
+
+unsigned int dirindex_size(const dirindex *index);
+const char *dirindex_get_filename(const dirindex *index, unsigned int n);
+const void *dirindex_get_info(const dirindex *index, unsigned int n);
+
+#endif // DIRINDEX_H
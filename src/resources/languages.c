@@ -3,48 +3,52 @@
 #include "formats/language.h"
 #include "resources/pathmanager.h"
 #include "utils/allocator.h"
-#include "utils/array.h"
 #include "utils/log.h"
 
-static array language_strings;
-static sd_language *language;
+// Only string offsets are read at startup. Strings are decoded on first use and kept until lang_close().
+static sd_language_index language_index;
+static char **language_strings = NULL;
+static const char *language_filename = NULL;
 
 int lang_init() {
     // Get filename
     const char *filename = pm_get_resource_path(DAT_ENGLISH);
 
-    // Load up language file
-    language = omf_calloc(1, sizeof(sd_language));
-    if(sd_language_create(language) != SD_SUCCESS) {
-        goto error_0;
-    }
-    if(sd_language_load(language, filename)) {
-        PERROR("Unable to load language file '%s'!", filename);
-        goto error_1;
-    }
-
-    // Load language strings
-    array_create(&language_strings);
-    for(int i = 0; i < language->count; i++) {
-        array_set(&language_strings, i, language->strings[i].data);
+    // Load up language file index
+    int ret = sd_language_load_index(&language_index, filename);
+    if(ret != SD_SUCCESS) {
+        PERROR("Unable to load language file '%s': %s", filename, sd_get_error(ret));
+        return 1;
     }
+    language_strings = omf_calloc(language_index.count, sizeof(char *));
+    language_filename = filename;
 
-    INFO("Loaded language file '%s'.", filename);
+    INFO("Loaded language file '%s' (%u strings).", filename, language_index.count);
     return 0;
-
-error_1:
-    sd_language_free(language);
-error_0:
-    omf_free(language);
-    return 1;
 }
 
 void lang_close() {
-    array_free(&language_strings);
-    sd_language_free(language);
-    omf_free(language);
+    if(language_strings != NULL) {
+        for(unsigned int i = 0; i < language_index.count; i++) {
+            omf_free(language_strings[i]);
+        }
+        omf_free(language_strings);
+    }
+    sd_language_index_free(&language_index);
+    language_filename = NULL;
 }
 
 const char *lang_get(unsigned int id) {
-    return (const char *)array_get(&language_strings, id);
+    if(language_strings == NULL || id >= language_index.count) {
+        return NULL;
+    }
+    if(language_strings[id] == NULL) {
+        int ret = sd_language_load_string(&language_strings[id], &language_index, language_filename, id);
+        if(ret != SD_SUCCESS) {
+            // Remember the failure as an empty string, so the file is not retried every frame.
+            PERROR("Unable to read language string %u: %s", id, sd_get_error(ret));
+            language_strings[id] = omf_calloc(1, 1);
+        }
+    }
+    return language_strings[id];
 }
@@ -0,0 +1,117 @@
+#include "resources/pic_loader.h"
+#include "formats/error.h"
+#include "formats/pic.h"
+#include "resources/ids.h"
+#include "resources/pathmanager.h"
+#include "utils/allocator.h"
+#include "utils/flatmap.h"
+#include "utils/iterator.h"
+#include "utils/log.h"
+
+#define PIC_FILE_COUNT (PIC_PLAYERS - PIC_NORTHAM + 1)
+
+typedef struct {
+    sd_sprite *sprite;
+    palette pal;
+} pic_cache_entry;
+
+// Photo offsets for each PIC file, loaded when the file is first needed.
+static sd_pic_index *indexes[PIC_FILE_COUNT];
+
+// Loaded photos, keyed by pic_id * MAX_PIC_PHOTOS + pilot_id.
+static flatmap photos;
+static int photos_created = 0;
+
+static const sd_pic_index *pic_loader_get_index(int pic_id, const char *filename) {
+    int slot = pic_id - PIC_NORTHAM;
+    if(indexes[slot] == NULL) {
+        sd_pic_index *index = omf_calloc(1, sizeof(sd_pic_index));
+        int ret = sd_pic_load_index(index, filename);
+        if(ret != SD_SUCCESS) {
+            PERROR("Could not load PIC file %s: %s", filename, sd_get_error(ret));
+            omf_free(index);
+            return NULL;
+        }
+        indexes[slot] = index;
+    }
+    return indexes[slot];
+}
+
+/*
+ * Copies a PIC photo sprite and its palette to the given structures. The sprite must be freed by the caller.
+ * Each photo is only read from the disk once, and kept in memory until pic_loader_close().
+ */
+int pic_loader_get(int pic_id, int pilot_id, sd_sprite *sprite, palette *pal) {
+    if(!is_pic(pic_id)) {
+        PERROR("Requested resource %d is not a PIC file.", pic_id);
+        return SD_INVALID_INPUT;
+    }
+    if(!photos_created) {
+        flatmap_create(&photos, sizeof(unsigned int), sizeof(pic_cache_entry), 6);
+        photos_created = 1;
+    }
+
+    unsigned int key = pic_id * MAX_PIC_PHOTOS + pilot_id;
+    pic_cache_entry *entry = flatmap_iget(&photos, key);
+    if(entry == NULL) {
+        const char *filename = pm_get_resource_path(pic_id);
+        if(filename == NULL) {
+            PERROR("Could not find requested PIC file handle.");
+            return SD_FILE_OPEN_ERROR;
+        }
+        const sd_pic_index *index = pic_loader_get_index(pic_id, filename);
+        if(index == NULL) {
+            return SD_FILE_PARSE_ERROR;
+        }
+
+        sd_pic_photo photo;
+        int ret = sd_pic_load_photo(&photo, index, filename, pilot_id);
+        if(ret != SD_SUCCESS) {
+            PERROR("Could not load photo %d from PIC file %s: %s", pilot_id, filename, sd_get_error(ret));
+            return ret;
+        }
+        DEBUG("PIC file %s: loaded picture %d.", get_resource_name(pic_id), pilot_id);
+
+        pic_cache_entry new_entry;
+        new_entry.sprite = photo.sprite;
+        palette_create(&new_entry.pal);
+        palette_copy(&new_entry.pal, &photo.pal, 0, 48);
+        entry = flatmap_iput(&photos, key, &new_entry);
+    }
+
+    sd_sprite_copy(sprite, entry->sprite);
+    palette_copy(pal, &entry->pal, 0, 48);
+    return SD_SUCCESS;
+}
+
+/*
+ * Returns the amount of photos in a PIC file, or 0 if the file could not be read.
+ */
+int pic_loader_photo_count(int pic_id) {
+    if(!is_pic(pic_id)) {
+        return 0;
+    }
+    const char *filename = pm_get_resource_path(pic_id);
+    if(filename == NULL) {
+        return 0;
+    }
+    const sd_pic_index *index = pic_loader_get_index(pic_id, filename);
+    return (index != NULL) ? index->photo_count : 0;
+}
+
+void pic_loader_close() {
+    if(photos_created) {
+        iterator it;
+        pic_cache_entry *entry;
+        flatmap_iter_begin(&photos, &it);
+        while((entry = iter_next(&it)) != NULL) {
+            sd_sprite_free(entry->sprite);
+            omf_free(entry->sprite);
+        }
+        flatmap_free(&photos);
+        photos_created = 0;
+    }
+    for(int i = 0; i < PIC_FILE_COUNT; i++) {
+        omf_free(indexes[i]);
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef PIC_LOADER_H
+#define PIC_LOADER_H
+
+#include "formats/palette.h"
+#include "formats/sprite.h"
+
+int pic_loader_get(int pic_id, int pilot_id, sd_sprite *sprite, palette *pal);
+int pic_loader_photo_count(int pic_id);
+void pic_loader_close();
+
+#endif // PIC_LOADER_H
@@ -2,7 +2,6 @@
 #include "formats/chr.h"
 #include "formats/error.h"
 #include "resources/pathmanager.h"
-#include "utils/allocator.h"
 #include "utils/log.h"
 #include "utils/scandir.h"
 #include <stdio.h>
@@ -46,73 +45,50 @@ error_0:
     return 1;
 }
 
-int sg_count() {
-    if(sg_init()) {
-        return 0;
+static int sg_read_info(const char *path, void *data) {
+    sg_info *info = data;
+    sd_chr_file chr;
+    sd_chr_create(&chr);
+    int ret = sd_chr_load(&chr, path);
+    if(ret == SD_SUCCESS) {
+        memcpy(info->name, chr.pilot.name, sizeof(info->name));
+        info->name[sizeof(info->name) - 1] = 0;
+        info->har_id = chr.pilot.har_id;
+        info->rank = chr.pilot.rank;
+        info->money = chr.pilot.money;
     }
-    const char *dirname = pm_get_local_path(SAVE_PATH);
-    list dirlist;
-    // Seek all files
-    list_create(&dirlist);
-    scan_directory(&dirlist, dirname);
-
-    iterator it;
-    char *filename = NULL;
-    char *ext = NULL;
-
-    list_iter_begin(&dirlist, &it);
-    while((filename = (char *)list_iter_next(&it))) {
-        if((ext = strrchr(filename, '.')) && strcmp(".CHR", ext) == 0) {
-            continue;
-        }
-        DEBUG("ignoring file %s", filename);
-        // not a CHR file, get lost
-        list_delete(&dirlist, &it);
-    }
-
-    DEBUG("Found %d savegames.", list_size(&dirlist));
-    int size = list_size(&dirlist);
-
-    list_free(&dirlist);
-
-    return size;
+    sd_chr_free(&chr);
+    return ret;
 }
 
-list *sg_load_all() {
-
+/*
+ * Fills the index with all savegames. Index entries are sg_info structs. Only savegames that have
+ * changed since the last call are actually parsed. The index must be freed with dirindex_free(),
+ * even on error. Returns 0 on success, 1 on error.
+ */
+int sg_list(dirindex *index) {
+    char tmp[1024];
+    dirindex_create(index, sizeof(sg_info));
     if(sg_init()) {
-        return NULL;
+        return 1;
     }
-
     const char *dirname = pm_get_local_path(SAVE_PATH);
-    list dirlist;
-    // Seek all files
-    list_create(&dirlist);
-    scan_directory(&dirlist, dirname);
-
-    DEBUG("Found %d savegames.", list_size(&dirlist) - 2);
-
-    list *chrlist = omf_calloc(1, sizeof(list));
-
-    iterator it;
-    list_iter_begin(&dirlist, &it);
-    char *chrfile;
-    char *ext;
-    while((chrfile = (char *)list_iter_next(&it))) {
-        if(strcmp(".", chrfile) == 0 || strcmp("..", chrfile) == 0) {
-            continue;
-        }
-        if((ext = strrchr(chrfile, '.')) && strcmp(".CHR", ext) == 0) {
-            sd_chr_file *chr = omf_calloc(1, sizeof(sd_chr_file));
-            ext[0] = 0;
-            DEBUG("%s", chrfile);
-            sg_load(chr, chrfile);
-            list_append(chrlist, chr, sizeof(sd_chr_file));
-        }
+    snprintf(tmp, 1024, "%sSAVEGAME.IDX", dirname);
+    if(dirindex_scan(index, dirname, ".CHR", tmp, sg_read_info) != 0) {
+        return 1;
     }
+    DEBUG("Found %d savegames.", dirindex_size(index));
+    return 0;
+}
 
-    list_free(&dirlist);
-    return chrlist;
+int sg_count() {
+    dirindex index;
+    int size = 0;
+    if(sg_list(&index) == 0) {
+        size = dirindex_size(&index);
+    }
+    dirindex_free(&index);
+    return size;
 }
 
 int sg_load(sd_chr_file *chr, const char *pilotname) {
@@ -2,11 +2,19 @@
 #define SGMANAGER_H
 
 #include "formats/chr.h"
-#include "utils/list.h"
+#include "resources/dirindex.h"
+
+// Savegame details kept in the savegame index, so that menus can be filled without loading every CHR file.
+typedef struct {
+    char name[18];
+    uint8_t har_id;
+    uint8_t rank;
+    uint32_t money;
+} sg_info;
 
 int sg_init();
 int sg_count();
-list *sg_load_all();
+int sg_list(dirindex *index);
 int sg_load(sd_chr_file *chr, const char *pilotname);
 int sd_save(const sd_pilot *pilot, const char *pilotname);
 
@@ -24,7 +24,29 @@ void sprite_create(sprite *sp, void *src, int id) {
     sd_vga_image_free(&raw);
 }
 
+// Same as sprite_create, but the surface and its pixel data are allocated from an allocator arena.
+// This is meant for resources that live exactly as long as the arena does (eg. BK and AF sprites).
+void sprite_create_in_arena(sprite *sp, void *src, int id, int arena_id) {
+    sd_sprite *sdsprite = (sd_sprite *)src;
+    sp->id = id;
+    sp->pos = vec2i_create(sdsprite->pos_x, sdsprite->pos_y);
+    sp->data = omf_arena_alloc(arena_id, sizeof(surface));
+
+    // Load data
+    sd_vga_image raw;
+    sd_sprite_vga_decode(&raw, sdsprite);
+    surface_create_in_arena(sp->data, arena_id, SURFACE_TYPE_PALETTE, raw.w, raw.h);
+    memcpy(sp->data->data, raw.data, raw.w * raw.h);
+    memcpy(sp->data->stencil, raw.stencil, raw.w * raw.h);
+    sd_vga_image_free(&raw);
+}
+
 void sprite_free(sprite *sp) {
+    if(sp->data != NULL && sp->data->in_arena) {
+        // Surface and its data are released along with the arena
+        sp->data = NULL;
+        return;
+    }
     surface_free(sp->data);
     omf_free(sp->data);
 }
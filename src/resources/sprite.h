@@ -11,6 +11,7 @@ typedef struct sprite_t {
 } sprite;
 
 void sprite_create(sprite *sp, void *src, int id);
+void sprite_create_in_arena(sprite *sp, void *src, int id, int arena_id);
 void sprite_create_custom(sprite *sp, vec2i pos, surface *sur);
 void sprite_free(sprite *sp);
 
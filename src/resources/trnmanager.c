@@ -2,60 +2,50 @@
 #include "formats/error.h"
 #include "formats/tournament.h"
 #include "resources/pathmanager.h"
-#include "utils/allocator.h"
-#include "utils/list.h"
 #include "utils/log.h"
-#include "utils/scandir.h"
 #include <stdio.h>
 #include <string.h>
 
-list *trnlist_init() {
-    int ret;
-    list dirlist;
+static int trn_read_info(const char *path, void *data) {
+    trn_info *info = data;
+    sd_tournament_file trn;
+    sd_tournament_create(&trn);
+    int ret = sd_tournament_load(&trn, path);
+    if(ret == SD_SUCCESS) {
+        memset(info, 0, sizeof(trn_info));
+        if(trn.locales[0] != NULL && trn.locales[0]->title != NULL) {
+            strncpy(info->title, trn.locales[0]->title, sizeof(info->title) - 1);
+        }
+        info->registration_fee = trn.registration_fee;
+        info->tournament_id = trn.tournament_id;
+    }
+    sd_tournament_free(&trn);
+    return ret;
+}
+
+/*
+ * Fills the index with all tournaments. Index entries are trn_info structs. The index is cached in the
+ * save directory, since the resource directory may not be writable. The index must be freed with
+ * dirindex_free(), even on error. Returns 0 on success, 1 on error.
+ */
+int trn_list(dirindex *index) {
+    char tmp[1024];
+    dirindex_create(index, sizeof(trn_info));
 
-    // Find path to savegame directory
+    // Find path to tournament directory
     const char *dirname = pm_get_local_path(RESOURCE_PATH);
-    if(dirname == NULL) {
+    const char *savedir = pm_get_local_path(SAVE_PATH);
+    if(dirname == NULL || savedir == NULL) {
         PERROR("Could not find resources path! Something is wrong with tournament manager!");
-        return NULL;
-    }
-
-    // Seek all files
-    list_create(&dirlist);
-    ret = scan_directory_suffix(&dirlist, dirname, ".TRN");
-    if(ret != 0) {
-        goto error_0;
+        return 1;
     }
 
-    DEBUG("Found %d tournaments.", list_size(&dirlist));
-
-    list *trnlist = omf_calloc(1, sizeof(list));
-    list_create(trnlist);
-
-    iterator it;
-    list_iter_begin(&dirlist, &it);
-    char *trn_file;
-    char tmp[1024];
-    while((trn_file = iter_next(&it)) != NULL) {
-        sd_tournament_file trn;
-        sd_tournament_create(&trn);
-        snprintf(tmp, 1024, "%s/%s", dirname, trn_file);
-        if(SD_SUCCESS == sd_tournament_load(&trn, tmp)) {
-            list_append(trnlist, &trn, sizeof(sd_tournament_file));
-        } else {
-            PERROR("Could not load tournament %s", trn_file);
-        }
+    snprintf(tmp, 1024, "%sTOURNAMENT.IDX", savedir);
+    if(dirindex_scan(index, dirname, ".TRN", tmp, trn_read_info) != 0) {
+        return 1;
     }
-    list_iter_end(&dirlist, &it);
-
-    DEBUG("Loaded %d tournaments", list_size(trnlist));
-
-    list_free(&dirlist);
-    return trnlist;
-
-error_0:
-    list_free(&dirlist);
-    return NULL;
+    DEBUG("Found %d tournaments.", dirindex_size(index));
+    return 0;
 }
 
 int trn_load(sd_tournament_file *trn, const char *trnname) {
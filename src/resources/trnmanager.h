@@ -2,9 +2,16 @@
 #define TRNMANAGER_H
 
 #include "formats/tournament.h"
-#include "utils/list.h"
+#include "resources/dirindex.h"
 
-list *trnlist_init();
+// Tournament details kept in the tournament index, so that the list can be shown without loading every TRN file.
+typedef struct {
+    char title[32];
+    int32_t registration_fee;
+    int32_t tournament_id;
+} trn_info;
+
+int trn_list(dirindex *index);
 int trn_load(sd_tournament_file *trn, const char *trnname);
 
 #endif // TRNMANAGER_H
@@ -1,19 +1,396 @@
 #include "utils/allocator.h"
+#include "utils/log.h"
+#include <SDL.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+// Initial block sizes for the global arenas. These are grown as necessary.
+static const size_t arena_block_sizes[OMF_ARENA_COUNT] = {
+    16 * 1024,  // OMF_ARENA_TICK
+    512 * 1024, // OMF_ARENA_SCENE
+};
+
+static memarena arenas[OMF_ARENA_COUNT];
+static int arenas_ready = 0;
+
+static memarena *omf_arena_get(int arena_id) {
+    if(!arenas_ready) {
+        for(int i = 0; i < OMF_ARENA_COUNT; i++) {
+            memarena_create(&arenas[i], arena_block_sizes[i]);
+        }
+        arenas_ready = 1;
+    }
+    return &arenas[arena_id];
+}
+
+#ifdef ALLOC_TRACKING
+
+// Per call site allocation statistics
+typedef struct alloc_site {
+    const char *file;
+    int line;
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t total_bytes;
+    unsigned int live_count;
+    unsigned int total_count;
+} alloc_site;
+
+// Pointer -> size mapping for live allocations
+typedef struct alloc_entry {
+    void *ptr;
+    size_t size;
+    unsigned int site;
+} alloc_entry;
+
+#define ALLOC_TOMBSTONE ((void *)1)
+
+static alloc_site *sites = NULL;
+static unsigned int site_num = 0;
+static unsigned int site_cap = 0;
+static unsigned int *site_index = NULL; // Site number + 1, or 0 if the slot is empty
+static unsigned int site_index_cap = 0;
+
+static alloc_entry *entries = NULL;
+static size_t entry_num = 0;
+static size_t entry_tombs = 0;
+static size_t entry_cap = 0;
+
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+static unsigned int tick_allocs = 0;
+static size_t tick_bytes = 0;
+static int tick_log = 0;
+
+// Render, log and capture threads allocate too. Everything above is only touched while holding this.
+static SDL_SpinLock tracker_lock = 0;
+
+// The tracker must not recurse into the tracked allocator, so use plain calloc here.
+static void *tracker_calloc(size_t nmemb, size_t size) {
+    void *ret = calloc(nmemb, size);
+    if(ret == NULL) {
+        fprintf(stderr, "Allocation tracker ran out of memory\n");
+        abort();
+    }
+    return ret;
+}
+
+static inline size_t hash_ptr(const void *ptr) {
+    uintptr_t x = (uintptr_t)ptr;
+    x ^= x >> 17;
+    x *= 0xed5ad4bbU;
+    x ^= x >> 11;
+    return (size_t)x;
+}
+
+static inline unsigned int hash_site(const char *file, int line) {
+    return (unsigned int)hash_ptr(file) ^ ((unsigned int)line * 2654435761U);
+}
+
+static void site_index_grow() {
+    unsigned int new_cap = site_index_cap ? site_index_cap * 2 : 256;
+    unsigned int *new_index = tracker_calloc(new_cap, sizeof(unsigned int));
+    for(unsigned int i = 0; i < site_num; i++) {
+        unsigned int slot = hash_site(sites[i].file, sites[i].line) & (new_cap - 1);
+        while(new_index[slot] != 0) {
+            slot = (slot + 1) & (new_cap - 1);
+        }
+        new_index[slot] = i + 1;
+    }
+    free(site_index);
+    site_index = new_index;
+    site_index_cap = new_cap;
+}
+
+static unsigned int site_find(const char *file, int line) {
+    if((site_num + 1) * 2 > site_index_cap) {
+        site_index_grow();
+    }
+    unsigned int slot = hash_site(file, line) & (site_index_cap - 1);
+    while(site_index[slot] != 0) {
+        alloc_site *site = &sites[site_index[slot] - 1];
+        if(site->line == line && site->file == file) {
+            return site_index[slot] - 1;
+        }
+        slot = (slot + 1) & (site_index_cap - 1);
+    }
+
+    // Not found, create a new site.
+    if(site_num >= site_cap) {
+        site_cap = site_cap ? site_cap * 2 : 128;
+        alloc_site *new_sites = realloc(sites, site_cap * sizeof(alloc_site));
+        if(new_sites == NULL) {
+            fprintf(stderr, "Allocation tracker ran out of memory\n");
+            abort();
+        }
+        sites = new_sites;
+    }
+    memset(&sites[site_num], 0, sizeof(alloc_site));
+    sites[site_num].file = file;
+    sites[site_num].line = line;
+    site_index[slot] = site_num + 1;
+    return site_num++;
+}
+
+static void entries_rehash(size_t new_cap) {
+    alloc_entry *old = entries;
+    size_t old_cap = entry_cap;
+    entries = tracker_calloc(new_cap, sizeof(alloc_entry));
+    entry_cap = new_cap;
+    entry_tombs = 0;
+    for(size_t i = 0; i < old_cap; i++) {
+        if(old[i].ptr == NULL || old[i].ptr == ALLOC_TOMBSTONE)
+            continue;
+        size_t slot = hash_ptr(old[i].ptr) & (new_cap - 1);
+        while(entries[slot].ptr != NULL) {
+            slot = (slot + 1) & (new_cap - 1);
+        }
+        entries[slot] = old[i];
+    }
+    free(old);
+}
+
+static void untrack_locked(void *ptr) {
+    if(ptr == NULL || entry_cap == 0)
+        return;
+    size_t slot = hash_ptr(ptr) & (entry_cap - 1);
+    while(entries[slot].ptr != NULL) {
+        if(entries[slot].ptr == ptr) {
+            alloc_site *site = &sites[entries[slot].site];
+            site->live_bytes -= entries[slot].size;
+            site->live_count--;
+            live_bytes -= entries[slot].size;
+            entries[slot].ptr = ALLOC_TOMBSTONE;
+            entry_num--;
+            entry_tombs++;
+            return;
+        }
+        slot = (slot + 1) & (entry_cap - 1);
+    }
+    // Pointer was not allocated through us (eg. strdup); nothing to do.
+}
+
+static void untrack(void *ptr) {
+    if(ptr == NULL)
+        return;
+    SDL_AtomicLock(&tracker_lock);
+    untrack_locked(ptr);
+    SDL_AtomicUnlock(&tracker_lock);
+}
+
+static void track(void *ptr, size_t size, const char *file, int line) {
+    SDL_AtomicLock(&tracker_lock);
+
+    // If the pointer is already known, the previous block was released with plain free().
+    untrack_locked(ptr);
+
+    if((entry_num + entry_tombs + 1) * 10 > entry_cap * 7) {
+        size_t new_cap = entry_cap ? entry_cap : 1024;
+        while((entry_num + 1) * 2 > new_cap) {
+            new_cap *= 2;
+        }
+        entries_rehash(new_cap);
+    }
+    size_t slot = hash_ptr(ptr) & (entry_cap - 1);
+    while(entries[slot].ptr != NULL && entries[slot].ptr != ALLOC_TOMBSTONE) {
+        slot = (slot + 1) & (entry_cap - 1);
+    }
+    if(entries[slot].ptr == ALLOC_TOMBSTONE) {
+        entry_tombs--;
+    }
+    unsigned int site_id = site_find(file, line);
+    entries[slot].ptr = ptr;
+    entries[slot].size = size;
+    entries[slot].site = site_id;
+    entry_num++;
+
+    alloc_site *site = &sites[site_id];
+    site->live_bytes += size;
+    site->live_count++;
+    site->total_bytes += size;
+    site->total_count++;
+    if(site->live_bytes > site->peak_bytes) {
+        site->peak_bytes = site->live_bytes;
+    }
+    live_bytes += size;
+    if(live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    tick_allocs++;
+    tick_bytes += size;
+    SDL_AtomicUnlock(&tracker_lock);
+}
+
+static int site_cmp(const void *a, const void *b) {
+    const alloc_site *sa = *(const alloc_site *const *)a;
+    const alloc_site *sb = *(const alloc_site *const *)b;
+    if(sa->live_bytes != sb->live_bytes)
+        return (sa->live_bytes < sb->live_bytes) ? 1 : -1;
+    if(sa->peak_bytes != sb->peak_bytes)
+        return (sa->peak_bytes < sb->peak_bytes) ? 1 : -1;
+    return (sa->total_count < sb->total_count) ? 1 : (sa->total_count > sb->total_count) ? -1 : 0;
+}
+
+// Strip the path down to the last two components, eg. "video/tcache.c"
+static const char *short_path(const char *file) {
+    const char *last = NULL;
+    const char *prev = NULL;
+    for(const char *c = file; *c; c++) {
+        if(*c == '/' || *c == '\\') {
+            prev = last;
+            last = c;
+        }
+    }
+    return prev ? prev + 1 : file;
+}
+
+int omf_alloc_tracking_enabled() {
+    return 1;
+}
+
+void omf_alloc_report(omf_alloc_report_fn fn, void *userdata, unsigned int max_rows) {
+    char buf[128];
+
+    // The callback may allocate, so the report is made from a copy of the statistics
+    SDL_AtomicLock(&tracker_lock);
+    snprintf(buf, sizeof(buf), "Heap: %zu live, %zu peak bytes, %zu blocks", live_bytes, peak_bytes, entry_num);
+    unsigned int num = site_num;
+    alloc_site *copy = num ? tracker_calloc(num, sizeof(alloc_site)) : NULL;
+    if(num) {
+        memcpy(copy, sites, num * sizeof(alloc_site));
+    }
+    SDL_AtomicUnlock(&tracker_lock);
+
+    fn(buf, userdata);
+    if(num == 0)
+        return;
+
+    alloc_site **sorted = tracker_calloc(num, sizeof(alloc_site *));
+    for(unsigned int i = 0; i < num; i++) {
+        sorted[i] = &copy[i];
+    }
+    qsort(sorted, num, sizeof(alloc_site *), site_cmp);
+
+    fn("site: live/peak bytes, live/total allocs", userdata);
+    unsigned int rows = (max_rows == 0 || max_rows > num) ? num : max_rows;
+    for(unsigned int i = 0; i < rows; i++) {
+        snprintf(buf, sizeof(buf), "%s:%d: %zu/%zu, %u/%u", short_path(sorted[i]->file), sorted[i]->line,
+                 sorted[i]->live_bytes, sorted[i]->peak_bytes, sorted[i]->live_count, sorted[i]->total_count);
+        fn(buf, userdata);
+    }
+    free(sorted);
+    free(copy);
+}
+
+void omf_alloc_set_tick_log(int enabled) {
+    tick_log = enabled;
+}
+
+int omf_alloc_get_tick_log() {
+    return tick_log;
+}
+
+void omf_alloc_tick_end(unsigned int tick) {
+    SDL_AtomicLock(&tracker_lock);
+    unsigned int allocs = tick_allocs;
+    size_t bytes = tick_bytes;
+    size_t live = live_bytes;
+    tick_allocs = 0;
+    tick_bytes = 0;
+    SDL_AtomicUnlock(&tracker_lock);
+    if(tick_log) {
+        INFO("Tick %u: %u allocations, %zu bytes; %zu bytes live", tick, allocs, bytes, live);
+    }
+}
+
+void omf_free_real(void *ptr, const char *file, int line) {
+    untrack(ptr);
+    free(ptr);
+}
+
+#else // ALLOC_TRACKING
+
+#define track(ptr, size, file, line)
+#define untrack(ptr)
+
+int omf_alloc_tracking_enabled() {
+    return 0;
+}
+
+void omf_alloc_report(omf_alloc_report_fn fn, void *userdata, unsigned int max_rows) {
+}
+
+void omf_alloc_set_tick_log(int enabled) {
+}
+
+int omf_alloc_get_tick_log() {
+    return 0;
+}
+
+void omf_alloc_tick_end(unsigned int tick) {
+}
+
+#endif // ALLOC_TRACKING
 
 void *omf_calloc_real(size_t nmemb, size_t size, const char *file, int line) {
     void *ret = calloc(nmemb, size);
-    if(ret != NULL)
+    if(ret != NULL) {
+        track(ret, nmemb * size, file, line);
         return ret;
+    }
     fprintf(stderr, "calloc(%zu, %zu) failed on %s:%d\n", nmemb, size, file, line);
     abort();
 }
 
 void *omf_realloc_real(void *ptr, size_t size, const char *file, int line) {
+    untrack(ptr); // Failure aborts, so the old block can be forgotten already.
     void *ret = realloc(ptr, size);
-    if(ret != NULL)
+    if(ret != NULL) {
+        track(ret, size, file, line);
         return ret;
+    }
     fprintf(stderr, "realloc(%p, %zu) failed on %s:%d\n", ptr, size, file, line);
     abort();
 }
+
+void *omf_arena_alloc_real(int arena_id, size_t size, const char *file, int line) {
+    if(arena_id < 0 || arena_id >= OMF_ARENA_COUNT) {
+        fprintf(stderr, "arena_alloc(%d, %zu) to an invalid arena on %s:%d\n", arena_id, size, file, line);
+        abort();
+    }
+    return memarena_alloc(omf_arena_get(arena_id), size);
+}
+
+void *omf_arena_calloc_real(int arena_id, size_t nmemb, size_t size, const char *file, int line) {
+    if(size != 0 && nmemb > SIZE_MAX / size) {
+        fprintf(stderr, "arena_calloc(%d, %zu, %zu) overflows on %s:%d\n", arena_id, nmemb, size, file, line);
+        abort();
+    }
+    void *ret = omf_arena_alloc_real(arena_id, nmemb * size, file, line);
+    memset(ret, 0, nmemb * size);
+    return ret;
+}
+
+memarena_mark omf_arena_mark(int arena_id) {
+    return memarena_get_mark(omf_arena_get(arena_id));
+}
+
+void omf_arena_rewind(int arena_id, memarena_mark mark) {
+    memarena_rewind(omf_arena_get(arena_id), mark);
+}
+
+void omf_arena_reset(int arena_id) {
+    memarena_reset(omf_arena_get(arena_id));
+}
+
+void omf_arenas_close() {
+    if(!arenas_ready) {
+        return;
+    }
+    for(int i = 0; i < OMF_ARENA_COUNT; i++) {
+        memarena_free(&arenas[i]);
+    }
+    arenas_ready = 0;
+}
@@ -3,16 +3,55 @@
 
 #include <stddef.h>
 
+#include "utils/memarena.h"
+
+// Global arenas for allocations that share a common lifetime.
+enum
+{
+    OMF_ARENA_TICK = 0, // Released at the end of each dynamic game tick
+    OMF_ARENA_SCENE,    // Released when the scene is switched
+    OMF_ARENA_COUNT
+};
+
 #define omf_calloc(nmemb, size) omf_calloc_real((nmemb), (size), __FILE__, __LINE__)
 void *omf_calloc_real(size_t nmemb, size_t size, const char *file, int line);
 
 #define omf_realloc(ptr, size) omf_realloc_real((ptr), (size), __FILE__, __LINE__)
 void *omf_realloc_real(void *ptr, size_t size, const char *file, int line);
 
+#ifdef ALLOC_TRACKING
+#define omf_free(ptr)                                                                                                  \
+    do {                                                                                                               \
+        omf_free_real((ptr), __FILE__, __LINE__);                                                                      \
+        (ptr) = NULL;                                                                                                  \
+    } while(0)
+void omf_free_real(void *ptr, const char *file, int line);
+#else
 #define omf_free(ptr)                                                                                                  \
     do {                                                                                                               \
         free(ptr);                                                                                                     \
         (ptr) = NULL;                                                                                                  \
     } while(0)
+#endif
+
+#define omf_arena_calloc(arena_id, nmemb, size) omf_arena_calloc_real((arena_id), (nmemb), (size), __FILE__, __LINE__)
+void *omf_arena_calloc_real(int arena_id, size_t nmemb, size_t size, const char *file, int line);
+
+#define omf_arena_alloc(arena_id, size) omf_arena_alloc_real((arena_id), (size), __FILE__, __LINE__)
+void *omf_arena_alloc_real(int arena_id, size_t size, const char *file, int line);
+
+memarena_mark omf_arena_mark(int arena_id);
+void omf_arena_rewind(int arena_id, memarena_mark mark);
+void omf_arena_reset(int arena_id);
+void omf_arenas_close();
+
+// Allocation tracking. Only records anything when built with USE_ALLOC_TRACKING,
+// otherwise these are no-ops.
+typedef void (*omf_alloc_report_fn)(const char *line, void *userdata);
+int omf_alloc_tracking_enabled();
+void omf_alloc_report(omf_alloc_report_fn fn, void *userdata, unsigned int max_rows);
+void omf_alloc_set_tick_log(int enabled);
+int omf_alloc_get_tick_log();
+void omf_alloc_tick_end(unsigned int tick);
 
 #endif // ALLOCATOR_H
@@ -0,0 +1,79 @@
+#include "utils/fixedpt.h"
+#include <math.h>
+
+#ifdef FIXED_POINT_PHYSICS
+
+#define FIXEDPT_PI FIXEDPT(3.14159265358979)
+#define FIXEDPT_HALF_PI FIXEDPT(1.57079632679490)
+#define FIXEDPT_TWO_PI FIXEDPT(6.28318530717959)
+
+fixedpt fixedpt_sqrt(fixedpt v) {
+    if(v <= 0) {
+        return 0;
+    }
+
+    // Integer square root of v * FIXEDPT_ONE, one result bit at a time
+    uint64_t num = (uint64_t)v << FIXEDPT_BITS;
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while(bit > num) {
+        bit >>= 2;
+    }
+    while(bit != 0) {
+        if(num >= res + bit) {
+            num -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (fixedpt)res;
+}
+
+fixedpt fixedpt_sin(fixedpt rad) {
+    // Bring the angle to -pi .. pi, and then to -pi/2 .. pi/2 where the series converges quickly
+    rad %= FIXEDPT_TWO_PI;
+    if(rad > FIXEDPT_PI) {
+        rad -= FIXEDPT_TWO_PI;
+    } else if(rad < -FIXEDPT_PI) {
+        rad += FIXEDPT_TWO_PI;
+    }
+    if(rad > FIXEDPT_HALF_PI) {
+        rad = FIXEDPT_PI - rad;
+    } else if(rad < -FIXEDPT_HALF_PI) {
+        rad = -FIXEDPT_PI - rad;
+    }
+
+    // x - x^3/3! + x^5/5! - x^7/7!
+    fixedpt x2 = fixedpt_mul(rad, rad);
+    fixedpt term = rad;
+    fixedpt res = rad;
+    term = fixedpt_mul(term, x2) / 6;
+    res -= term;
+    term = fixedpt_mul(term, x2) / 20;
+    res += term;
+    term = fixedpt_mul(term, x2) / 42;
+    res -= term;
+    return res;
+}
+
+fixedpt fixedpt_cos(fixedpt rad) {
+    return fixedpt_sin(rad % FIXEDPT_TWO_PI + FIXEDPT_HALF_PI);
+}
+
+#else
+
+fixedpt fixedpt_sqrt(fixedpt v) {
+    return sqrtf(v);
+}
+
+fixedpt fixedpt_sin(fixedpt rad) {
+    return sinf(rad);
+}
+
+fixedpt fixedpt_cos(fixedpt rad) {
+    return cosf(rad);
+}
+
+#endif // FIXED_POINT_PHYSICS
@@ -0,0 +1,108 @@
+#ifndef FIXEDPT_H
+#define FIXEDPT_H
+
+#include <stdint.h>
+
+/*
+ * Number type of the simulation state: object positions and velocities, gravity and the HAR speeds.
+ * Netplay and recordings need every machine to come up with exactly the same numbers, and floats do not
+ * promise that between compilers, optimization levels and FPUs. Built with FIXED_POINT_PHYSICS, fixedpt
+ * is a 16.16 fixed point number and all of the physics is integer math. Otherwise it is a float.
+ *
+ * Use the usual operators to add, subtract and compare fixedpt values, and to multiply or divide them by
+ * an integer. Everything else, including mixing them with integers, goes through the functions below.
+ * Only turn fixedpt into floats for rendering and sound.
+ */
+
+#ifdef FIXED_POINT_PHYSICS
+
+typedef int32_t fixedpt;
+
+#define FIXEDPT_BITS 16
+#define FIXEDPT_ONE (1 << FIXEDPT_BITS)
+
+// Constant conversion. The compiler folds these, so they do not depend on the FPU either.
+#define FIXEDPT(x) ((fixedpt)((x) * FIXEDPT_ONE))
+
+static inline fixedpt fixedpt_from_int(int v) {
+    return (fixedpt)v * FIXEDPT_ONE;
+}
+
+// Truncates towards zero, like casting a float.
+static inline int fixedpt_to_int(fixedpt v) {
+    return v / FIXEDPT_ONE;
+}
+
+static inline fixedpt fixedpt_from_float(float v) {
+    return (fixedpt)(v * FIXEDPT_ONE);
+}
+
+static inline float fixedpt_to_float(fixedpt v) {
+    return v / (float)FIXEDPT_ONE;
+}
+
+// Results that do not fit are clamped, so that an overflow can not flip the sign of a position or a speed
+static inline fixedpt fixedpt_clamp(int64_t v) {
+    if(v > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if(v < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (fixedpt)v;
+}
+
+// Rounds towards zero, and clamps on overflow.
+static inline fixedpt fixedpt_mul(fixedpt a, fixedpt b) {
+    return fixedpt_clamp((int64_t)a * b / FIXEDPT_ONE);
+}
+
+// Rounds towards zero, and clamps on overflow. Dividing by zero gives the largest value of the sign of a.
+static inline fixedpt fixedpt_div(fixedpt a, fixedpt b) {
+    if(b == 0) {
+        return a > 0 ? INT32_MAX : (a < 0 ? INT32_MIN : 0);
+    }
+    return fixedpt_clamp((int64_t)a * FIXEDPT_ONE / b);
+}
+
+#else
+
+typedef float fixedpt;
+
+#define FIXEDPT(x) ((fixedpt)(x))
+
+static inline fixedpt fixedpt_from_int(int v) {
+    return v;
+}
+
+static inline int fixedpt_to_int(fixedpt v) {
+    return v;
+}
+
+static inline fixedpt fixedpt_from_float(float v) {
+    return v;
+}
+
+static inline float fixedpt_to_float(fixedpt v) {
+    return v;
+}
+
+static inline fixedpt fixedpt_mul(fixedpt a, fixedpt b) {
+    return a * b;
+}
+
+static inline fixedpt fixedpt_div(fixedpt a, fixedpt b) {
+    return a / b;
+}
+
+#endif // FIXED_POINT_PHYSICS
+
+static inline fixedpt fixedpt_abs(fixedpt v) {
+    return v < 0 ? -v : v;
+}
+
+fixedpt fixedpt_sqrt(fixedpt v);
+fixedpt fixedpt_sin(fixedpt rad);
+fixedpt fixedpt_cos(fixedpt rad);
+
+#endif // FIXEDPT_H
@@ -0,0 +1,330 @@
+#include "utils/flatmap.h"
+#include "utils/allocator.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALIGN8(x) (((x) + 7U) & ~7U)
+#define MAX_LOAD_NUM 7
+#define MAX_LOAD_DEN 8
+
+#define SLOT(fm, i) ((fm)->slots + (size_t)(i) * (fm)->slot_size)
+#define PROBE_DIST(fm, i, h) (((i) - (h)) & ((fm)->capacity - 1))
+
+/**
+ * Word-at-a-time multiply/xorshift hash. Zero is reserved for empty slots,
+ * so it is never returned.
+ */
+static uint32_t flatmap_hash(const void *key, unsigned int len) {
+    const unsigned char *p = key;
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    uint64_t w;
+    while(len >= 8) {
+        memcpy(&w, p, 8);
+        h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+        p += 8;
+        len -= 8;
+    }
+    if(len > 0) {
+        w = 0;
+        memcpy(&w, p, len);
+        h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 31;
+    }
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 32;
+    uint32_t ret = (uint32_t)h;
+    return ret != 0 ? ret : 1;
+}
+
+static void flatmap_alloc(flatmap *fm, unsigned int capacity) {
+    fm->capacity = capacity;
+    fm->hashes = omf_calloc(capacity, sizeof(uint32_t));
+    fm->slots = omf_calloc(capacity, fm->slot_size);
+    fm->reserved = 0;
+}
+
+// Returns slot index of the key, or -1 if it does not exist.
+static int flatmap_find(const flatmap *fm, const void *key, uint32_t hash) {
+    unsigned int mask = fm->capacity - 1;
+    unsigned int pos = hash & mask;
+    unsigned int dist = 0;
+    while(1) {
+        uint32_t h = fm->hashes[pos];
+        // Robin hood invariant: if our probe distance exceeds the distance of the entry in the
+        // slot, the key can not be further along.
+        if(h == 0 || PROBE_DIST(fm, pos, h) < dist) {
+            return -1;
+        }
+        if(h == hash && memcmp(SLOT(fm, pos), key, fm->key_size) == 0) {
+            return pos;
+        }
+        pos = (pos + 1) & mask;
+        dist++;
+    }
+}
+
+// Inserts an entry that is known not to exist in the map. Returns the slot index the entry landed in.
+static unsigned int flatmap_insert(flatmap *fm, uint32_t hash, char *entry) {
+    unsigned int mask = fm->capacity - 1;
+    unsigned int pos = hash & mask;
+    unsigned int dist = 0;
+    unsigned int result = UINT32_MAX;
+    char *tmp = fm->scratch + fm->slot_size;
+    while(1) {
+        uint32_t h = fm->hashes[pos];
+        if(h == 0) {
+            fm->hashes[pos] = hash;
+            memcpy(SLOT(fm, pos), entry, fm->slot_size);
+            fm->reserved++;
+            return (result == UINT32_MAX) ? pos : result;
+        }
+        unsigned int h_dist = PROBE_DIST(fm, pos, h);
+        if(h_dist < dist) {
+            // Steal the slot from the richer entry, and carry that one forward instead.
+            fm->hashes[pos] = hash;
+            hash = h;
+            memcpy(tmp, SLOT(fm, pos), fm->slot_size);
+            memcpy(SLOT(fm, pos), entry, fm->slot_size);
+            memcpy(entry, tmp, fm->slot_size);
+            if(result == UINT32_MAX) {
+                result = pos;
+            }
+            dist = h_dist;
+        }
+        pos = (pos + 1) & mask;
+        dist++;
+    }
+}
+
+// Removes the entry in the given slot, and shifts the following entries back by one.
+static void flatmap_remove_at(flatmap *fm, unsigned int pos) {
+    unsigned int mask = fm->capacity - 1;
+    unsigned int next = (pos + 1) & mask;
+    while(fm->hashes[next] != 0 && PROBE_DIST(fm, next, fm->hashes[next]) != 0) {
+        fm->hashes[pos] = fm->hashes[next];
+        memcpy(SLOT(fm, pos), SLOT(fm, next), fm->slot_size);
+        pos = next;
+        next = (next + 1) & mask;
+    }
+    fm->hashes[pos] = 0;
+    fm->reserved--;
+}
+
+static void flatmap_grow(flatmap *fm) {
+    uint32_t *old_hashes = fm->hashes;
+    char *old_slots = fm->slots;
+    unsigned int old_capacity = fm->capacity;
+    flatmap_alloc(fm, old_capacity * 2);
+    for(unsigned int i = 0; i < old_capacity; i++) {
+        if(old_hashes[i] != 0) {
+            memcpy(fm->scratch, old_slots + (size_t)i * fm->slot_size, fm->slot_size);
+            flatmap_insert(fm, old_hashes[i], fm->scratch);
+        }
+    }
+    omf_free(old_hashes);
+    omf_free(old_slots);
+}
+
+/** \brief Creates a new flatmap
+ *
+ * Creates a new flatmap with given key and value sizes. All keys and values put
+ * to the map must be of exactly this size. The map will grow automatically when
+ * it is 7/8 full, but it is never shrunk.
+ *
+ * \param fm Allocated flatmap pointer
+ * \param key_size Size of the key memory block
+ * \param val_size Size of the value memory block
+ * \param n_size Initial size of the map. Final size will be 2^n_size slots
+ */
+void flatmap_create(flatmap *fm, unsigned int key_size, unsigned int val_size, int n_size) {
+    assert(key_size > 0);
+    assert(n_size >= 1 && n_size < 31);
+    fm->key_size = key_size;
+    fm->val_size = val_size;
+    fm->val_offset = ALIGN8(key_size);
+    fm->slot_size = ALIGN8(fm->val_offset + val_size);
+    fm->scratch = omf_calloc(2, fm->slot_size);
+    flatmap_alloc(fm, 1U << n_size);
+}
+
+/** \brief Free flatmap
+ *
+ * Frees all memory owned by the flatmap. Any use of the map after this will lead to
+ * undefined behaviour.
+ *
+ * \param fm Flatmap to free
+ */
+void flatmap_free(flatmap *fm) {
+    omf_free(fm->hashes);
+    omf_free(fm->slots);
+    omf_free(fm->scratch);
+    fm->capacity = 0;
+    fm->reserved = 0;
+}
+
+/** \brief Clears flatmap entries
+ *
+ * Removes all entries from the flatmap. The amount of slots is not changed.
+ *
+ * \param fm Flatmap to clear
+ */
+void flatmap_clear(flatmap *fm) {
+    memset(fm->hashes, 0, fm->capacity * sizeof(uint32_t));
+    fm->reserved = 0;
+}
+
+/** \brief Gets flatmap size
+ *
+ * \param fm Flatmap
+ * \return Amount of slots in the flatmap
+ */
+unsigned int flatmap_size(const flatmap *fm) {
+    return fm->capacity;
+}
+
+/** \brief Gets the amount of entries in the flatmap
+ *
+ * \param fm Flatmap
+ * \return Amount of entries in the flatmap
+ */
+unsigned int flatmap_reserved(const flatmap *fm) {
+    return fm->reserved;
+}
+
+/** \brief Puts an item to the flatmap
+ *
+ * Puts a new item to the flatmap, or replaces the value of an existing key.
+ * Both key and value memory blocks are copied into the map.
+ *
+ * \param fm Flatmap
+ * \param key Pointer to key memory block of key_size bytes
+ * \param val Pointer to value memory block of val_size bytes
+ * \return Pointer to the value inside the map. Only valid until the map is modified.
+ */
+void *flatmap_put(flatmap *fm, const void *key, const void *val) {
+    uint32_t hash = flatmap_hash(key, fm->key_size);
+    int pos = flatmap_find(fm, key, hash);
+    if(pos >= 0) {
+        memcpy(SLOT(fm, pos) + fm->val_offset, val, fm->val_size);
+        return SLOT(fm, pos) + fm->val_offset;
+    }
+
+    if((fm->reserved + 1) * MAX_LOAD_DEN > fm->capacity * MAX_LOAD_NUM) {
+        flatmap_grow(fm);
+    }
+    memset(fm->scratch, 0, fm->slot_size);
+    memcpy(fm->scratch, key, fm->key_size);
+    memcpy(fm->scratch + fm->val_offset, val, fm->val_size);
+    unsigned int slot = flatmap_insert(fm, hash, fm->scratch);
+    return SLOT(fm, slot) + fm->val_offset;
+}
+
+/** \brief Gets an item from the flatmap
+ *
+ * \param fm Flatmap
+ * \param key Pointer to key memory block of key_size bytes
+ * \return Pointer to the value inside the map, or NULL if key was not found.
+ */
+void *flatmap_get(const flatmap *fm, const void *key) {
+    int pos = flatmap_find(fm, key, flatmap_hash(key, fm->key_size));
+    if(pos < 0) {
+        return NULL;
+    }
+    return SLOT(fm, pos) + fm->val_offset;
+}
+
+/** \brief Deletes an item from the flatmap
+ *
+ * Note: Do not use this inside an iterator loop; use flatmap_delete instead.
+ *
+ * \param fm Flatmap
+ * \param key Pointer to key memory block of key_size bytes
+ * \return Returns 0 on success, 1 on error (not found).
+ */
+int flatmap_del(flatmap *fm, const void *key) {
+    int pos = flatmap_find(fm, key, flatmap_hash(key, fm->key_size));
+    if(pos < 0) {
+        return 1;
+    }
+    flatmap_remove_at(fm, pos);
+    return 0;
+}
+
+void *flatmap_iput(flatmap *fm, unsigned int key, const void *val) {
+    assert(fm->key_size == sizeof(unsigned int));
+    return flatmap_put(fm, &key, val);
+}
+
+void *flatmap_iget(const flatmap *fm, unsigned int key) {
+    assert(fm->key_size == sizeof(unsigned int));
+    return flatmap_get(fm, &key);
+}
+
+int flatmap_idel(flatmap *fm, unsigned int key) {
+    assert(fm->key_size == sizeof(unsigned int));
+    return flatmap_del(fm, &key);
+}
+
+// Iteration starts from an empty slot, so that no probe sequence wraps around the start point.
+// This way entries shifted back by flatmap_delete are never visited twice. iter->vnow points to
+// the starting hash slot, and iter->inow is the linear position of the next slot to visit.
+static void *flatmap_iter_next(iterator *iter) {
+    const flatmap *fm = iter->data;
+    unsigned int start = (const uint32_t *)iter->vnow - fm->hashes;
+    unsigned int mask = fm->capacity - 1;
+    while((unsigned int)iter->inow < start + fm->capacity) {
+        unsigned int pos = iter->inow & mask;
+        iter->inow++;
+        if(fm->hashes[pos] != 0) {
+            return SLOT(fm, pos) + fm->val_offset;
+        }
+    }
+    iter->ended = 1;
+    return NULL;
+}
+
+/** \brief Begins iteration over flatmap values
+ *
+ * iter_next() will return pointers to the values in the map. Order of the values
+ * is not defined.
+ *
+ * \param fm Flatmap
+ * \param iter Iterator to initialize
+ */
+void flatmap_iter_begin(const flatmap *fm, iterator *iter) {
+    unsigned int start = 0;
+    if(fm->reserved > 0) {
+        while(fm->hashes[start] != 0) {
+            start++;
+        }
+    }
+    iter->data = fm;
+    iter->vnow = &fm->hashes[start];
+    iter->inow = start + 1;
+    iter->next = flatmap_iter_next;
+    iter->prev = NULL;
+    iter->ended = (fm->reserved == 0);
+}
+
+/** \brief Deletes the last item returned by an iterator
+ *
+ * \param fm Flatmap
+ * \param iter Iterator
+ * \return Returns 0 on success, 1 on error (not found).
+ */
+int flatmap_delete(flatmap *fm, iterator *iter) {
+    if(iter->ended) {
+        return 1;
+    }
+    unsigned int pos = (iter->inow - 1) & (fm->capacity - 1);
+    if(fm->hashes[pos] == 0) {
+        return 1;
+    }
+    flatmap_remove_at(fm, pos);
+
+    // Following entry may have been shifted to this slot; revisit it.
+    iter->inow--;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include "utils/iterator.h"
+#include <stdint.h>
+
+/**
+ * @brief Open addressing hashmap with fixed size keys and values.
+ * @details Keys and values are stored inline in a single flat slot array, and collisions are
+ *          handled with robin hood linear probing. Lookups never chase pointers, and there are
+ *          no per-entry allocations.
+ *
+ *          Note that entries get moved around on insert and delete, so pointers returned by
+ *          flatmap_put() and flatmap_get() are only valid until the next modification.
+ */
+typedef struct flatmap_t {
+    uint32_t *hashes; ///< Hash for each slot; 0 means the slot is empty
+    char *slots;      ///< Slot data. Each slot holds the key, followed by the value
+    char *scratch;    ///< Temporary storage for two slots, used when swapping entries
+    unsigned int key_size;
+    unsigned int val_size;
+    unsigned int val_offset;
+    unsigned int slot_size;
+    unsigned int capacity; ///< Amount of slots; always a power of two
+    unsigned int reserved; ///< Amount of entries in the map
+} flatmap;
+
+void flatmap_create(flatmap *fm, unsigned int key_size, unsigned int val_size, int n_size); // capacity 2^n_size
+void flatmap_free(flatmap *fm);
+void flatmap_clear(flatmap *fm);
+unsigned int flatmap_size(const flatmap *fm);
+unsigned int flatmap_reserved(const flatmap *fm);
+void *flatmap_put(flatmap *fm, const void *key, const void *val);
+void *flatmap_get(const flatmap *fm, const void *key);
+int flatmap_del(flatmap *fm, const void *key);
+void *flatmap_iput(flatmap *fm, unsigned int key, const void *val);
+void *flatmap_iget(const flatmap *fm, unsigned int key);
+int flatmap_idel(flatmap *fm, unsigned int key);
+void flatmap_iter_begin(const flatmap *fm, iterator *iter);
+int flatmap_delete(flatmap *fm, iterator *iter);
+
+#endif // FLATMAP_H
@@ -0,0 +1,169 @@
+#include "utils/framepacer.h"
+#include <SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Amount of frame times kept for the statistics
+#define PACER_WINDOW 240
+
+// Bounds for the expected oversleep, in microseconds. The upper one limits how long we may spin.
+#define PACER_MIN_OVERSLEEP 200
+#define PACER_MAX_OVERSLEEP 2000
+
+static uint64_t freq = 1;
+static uint64_t start = 0;
+
+// How much longer than requested SDL_Delay() has recently slept, in microseconds.
+// The last stretch before a deadline is spun instead of slept. Shared by all sleeping threads.
+static SDL_atomic_t oversleep;
+
+// Frame cap may be changed from the game thread, while frames are presented on another one.
+static SDL_atomic_t cap;
+static uint64_t last_frame = 0;
+
+static SDL_SpinLock stats_lock = 0;
+static uint32_t frame_times[PACER_WINDOW];
+static unsigned int frame_pos = 0;
+static unsigned int frame_count = 0;
+
+void framepacer_init() {
+    freq = SDL_GetPerformanceFrequency();
+    start = SDL_GetPerformanceCounter();
+    SDL_AtomicSet(&oversleep, 1000);
+    last_frame = 0;
+    framepacer_reset_stats();
+}
+
+/*
+ * Returns time since framepacer_init(), in microseconds.
+ */
+uint64_t framepacer_now() {
+    uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    // Split to avoid overflowing with fast counters
+    return (ticks / freq) * 1000000 + (ticks % freq) * 1000000 / freq;
+}
+
+/*
+ * Waits until the given time (from framepacer_now()). Sleeps for as much of the wait as it can,
+ * and spins the last fraction of a millisecond that sleeping can't be trusted with.
+ */
+void framepacer_sleep_until(uint64_t deadline) {
+    uint64_t now = framepacer_now();
+    uint64_t expected = SDL_AtomicGet(&oversleep);
+    while(now + expected + 1000 <= deadline) {
+        uint32_t ms = (deadline - now - expected) / 1000;
+        SDL_Delay(ms);
+        uint64_t after = framepacer_now();
+        uint64_t slept = after - now;
+        uint64_t over = (slept > ms * 1000) ? slept - ms * 1000 : 0;
+
+        // Jump up on a long sleep, recover slowly on short ones
+        if(over > expected) {
+            expected = over;
+        } else {
+            expected = (expected * 15 + over) / 16;
+        }
+        if(expected < PACER_MIN_OVERSLEEP) {
+            expected = PACER_MIN_OVERSLEEP;
+        } else if(expected > PACER_MAX_OVERSLEEP) {
+            expected = PACER_MAX_OVERSLEEP;
+        }
+        SDL_AtomicSet(&oversleep, expected);
+        now = after;
+    }
+    while(now < deadline) {
+        now = framepacer_now();
+    }
+}
+
+/*
+ * Limits presented frames to the given rate. 0 disables the limit.
+ */
+void framepacer_set_cap(int fps) {
+    SDL_AtomicSet(&cap, (fps > 0) ? fps : 0);
+}
+
+int framepacer_get_cap() {
+    return SDL_AtomicGet(&cap);
+}
+
+/*
+ * Returns the earliest time the next frame may be presented at. This is now, if there is no cap.
+ */
+uint64_t framepacer_next_frame(uint64_t now) {
+    int fps = SDL_AtomicGet(&cap);
+    if(fps == 0 || last_frame == 0) {
+        return now;
+    }
+    uint64_t next = last_frame + 1000000 / fps;
+    return (next > now) ? next : now;
+}
+
+void framepacer_frame_done(uint64_t now) {
+    if(last_frame != 0) {
+        uint64_t dt = now - last_frame;
+        SDL_AtomicLock(&stats_lock);
+        frame_times[frame_pos] = (dt > UINT32_MAX) ? UINT32_MAX : dt;
+        frame_pos = (frame_pos + 1) % PACER_WINDOW;
+        if(frame_count < PACER_WINDOW) {
+            frame_count++;
+        }
+        SDL_AtomicUnlock(&stats_lock);
+    }
+    last_frame = now;
+}
+
+void framepacer_get_stats(framepacer_stats *stats) {
+    uint32_t times[PACER_WINDOW];
+    SDL_AtomicLock(&stats_lock);
+    unsigned int count = frame_count;
+    memcpy(times, frame_times, count * sizeof(uint32_t));
+    SDL_AtomicUnlock(&stats_lock);
+
+    memset(stats, 0, sizeof(framepacer_stats));
+    if(count == 0) {
+        return;
+    }
+    double sum = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    for(unsigned int i = 0; i < count; i++) {
+        sum += times[i];
+        min = (times[i] < min) ? times[i] : min;
+        max = (times[i] > max) ? times[i] : max;
+    }
+    double mean = sum / count;
+    double var = 0;
+    for(unsigned int i = 0; i < count; i++) {
+        double d = times[i] - mean;
+        var += d * d;
+    }
+    var /= count;
+
+    stats->fps = (mean > 0) ? 1000000.0 / mean : 0;
+    stats->mean = mean / 1000.0;
+    stats->stddev = sqrt(var) / 1000.0;
+    stats->min = min / 1000.0f;
+    stats->max = max / 1000.0f;
+    stats->samples = count;
+}
+
+void framepacer_reset_stats() {
+    SDL_AtomicLock(&stats_lock);
+    frame_pos = 0;
+    frame_count = 0;
+    SDL_AtomicUnlock(&stats_lock);
+}
+
+void framepacer_report(framepacer_line_fn fn, void *userdata) {
+    char buf[64];
+    framepacer_stats st;
+    framepacer_get_stats(&st);
+    snprintf(buf, sizeof(buf), "%.1f fps, cap %d", st.fps, framepacer_get_cap());
+    fn(buf, userdata);
+    snprintf(buf, sizeof(buf), "frame time: %.2f ms +- %.2f", st.mean, st.stddev);
+    fn(buf, userdata);
+    snprintf(buf, sizeof(buf), "min/max: %.2f/%.2f ms (%u frames)", st.min, st.max, st.samples);
+    fn(buf, userdata);
+}
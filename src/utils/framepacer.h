@@ -0,0 +1,31 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <stdint.h>
+
+typedef struct framepacer_stats_t {
+    float fps;    ///< Presented frames per second
+    float mean;   ///< Mean frame time, in milliseconds
+    float stddev; ///< Standard deviation of frame times, in milliseconds
+    float min;    ///< Shortest frame time in the window, in milliseconds
+    float max;    ///< Longest frame time in the window, in milliseconds
+    unsigned int samples;
+} framepacer_stats;
+
+typedef void (*framepacer_line_fn)(const char *line, void *userdata);
+
+void framepacer_init();
+
+uint64_t framepacer_now();
+void framepacer_sleep_until(uint64_t deadline);
+
+void framepacer_set_cap(int fps);
+int framepacer_get_cap();
+uint64_t framepacer_next_frame(uint64_t now);
+void framepacer_frame_done(uint64_t now);
+
+void framepacer_get_stats(framepacer_stats *stats);
+void framepacer_reset_stats();
+void framepacer_report(framepacer_line_fn fn, void *userdata);
+
+#endif // FRAMEPACER_H
@@ -1,6 +1,5 @@
 #include "utils/hashmap.h"
 #include "utils/allocator.h"
-#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,7 +7,7 @@
 #define FNV_32_PRIME ((uint32_t)0x01000193)
 #define FNV1_32_INIT ((uint32_t)2166136261)
 #define TINY_MASK(x) (((uint32_t)1 << (x)) - 1)
-#define BUCKETS_SIZE(x) (pow(2, (x)))
+#define BUCKETS_SIZE(x) ((unsigned int)1 << (x))
 
 #define AUTO_INC_CHECK()                                                                                               \
     if(hm->flags & HASHMAP_AUTO_INC && hm->buckets_x < hm->buckets_x_max &&                                            \
@@ -1,9 +1,193 @@
 #include "utils/log.h"
+#include <SDL.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+
+// Size of each per-thread ring buffer. Must be a power of two.
+#define LOG_RING_SIZE (1 << 16)
+
+// Longest single log line; longer messages are truncated.
+#define LOG_MAX_LINE 1024
+
+// How often the writer thread wakes up even if nobody signals it, in milliseconds.
+#define LOG_WRITER_INTERVAL 10
+
+enum
+{
+    LOG_REC_TEXT = 0, ///< Payload is a preformatted, zero terminated string
+    LOG_REC_DEFERRED, ///< Payload is a log_deferred record, formatted by the writer
+    LOG_REC_PAD,      ///< Filler up to the end of the ring buffer
+};
+
+typedef struct {
+    uint16_t len; ///< Total record length, including this header. Always aligned.
+    uint8_t kind;
+    char mode;
+    unsigned int tick;
+    const char *fn;
+} log_rec;
+
+typedef struct {
+    const char *fmt;
+    int args[LOG_TRACE_ARGS];
+} log_deferred;
+
+#define LOG_ALIGN(x) (((x) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+#define LOG_REC_MAX LOG_ALIGN(sizeof(log_rec) + LOG_MAX_LINE)
+
+/**
+ * Single producer, single consumer ring. The owning thread only ever moves head,
+ * and the writer thread only ever moves tail. Both are free-running counters.
+ */
+typedef struct log_ring_t {
+    atomic_size_t head;
+    atomic_size_t tail;
+    struct log_ring_t *next;
+    char buf[LOG_RING_SIZE];
+} log_ring;
+
+static FILE *handle = 0;
+static SDL_Thread *writer = NULL;
+static SDL_sem *writer_sem = NULL;
+static SDL_mutex *rings_lock = NULL;
+static log_ring *rings = NULL;
+static atomic_int writer_running;
+static unsigned int ring_generation = 0;
+
+static _Thread_local log_ring *local_ring = NULL;
+static _Thread_local unsigned int local_generation = 0;
 
-FILE *handle = 0;
 unsigned int _log_tick = 0;
+int _log_level = LOG_LEVEL_DEBUG;
+
+static void log_write_line(FILE *fp, char mode, const char *fn, unsigned int tick, const char *text) {
+    if(fn != NULL) {
+        fprintf(fp, "[%7u][%c] %s(): %s\n", tick, mode, fn, text);
+    } else {
+        fprintf(fp, "[%7u][%c] %s\n", tick, mode, text);
+    }
+}
+
+static void log_format_deferred(char *out, size_t len, const log_deferred *d) {
+    snprintf(out, len, d->fmt, d->args[0], d->args[1], d->args[2], d->args[3]);
+}
+
+// Writes out everything currently in the ring. Writer thread only.
+static int log_ring_drain(log_ring *ring) {
+    char line[LOG_MAX_LINE];
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    int written = 0;
+    while(tail != head) {
+        size_t off = tail & (LOG_RING_SIZE - 1);
+        if(LOG_RING_SIZE - off < sizeof(log_rec)) {
+            tail += LOG_RING_SIZE - off;
+            continue;
+        }
+        const log_rec *rec = (const log_rec *)&ring->buf[off];
+        if(rec->kind == LOG_REC_TEXT) {
+            log_write_line(handle, rec->mode, rec->fn, rec->tick, (const char *)(rec + 1));
+            written++;
+        } else if(rec->kind == LOG_REC_DEFERRED) {
+            log_format_deferred(line, sizeof(line), (const log_deferred *)(rec + 1));
+            log_write_line(handle, rec->mode, rec->fn, rec->tick, line);
+            written++;
+        }
+        tail += rec->len;
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    return written;
+}
+
+static int log_drain_all() {
+    int written = 0;
+    SDL_LockMutex(rings_lock);
+    for(log_ring *r = rings; r != NULL; r = r->next) {
+        written += log_ring_drain(r);
+    }
+    SDL_UnlockMutex(rings_lock);
+    return written;
+}
+
+static int log_writer_thread(void *userdata) {
+    while(atomic_load(&writer_running)) {
+        SDL_SemWaitTimeout(writer_sem, LOG_WRITER_INTERVAL);
+        if(log_drain_all() > 0) {
+            fflush(handle);
+        }
+    }
+    log_drain_all();
+    fflush(handle);
+    return 0;
+}
+
+static log_ring *log_get_ring() {
+    if(local_ring != NULL && local_generation == ring_generation) {
+        return local_ring;
+    }
+    log_ring *ring = calloc(1, sizeof(log_ring));
+    if(ring == NULL) {
+        return NULL;
+    }
+    SDL_LockMutex(rings_lock);
+    ring->next = rings;
+    rings = ring;
+    SDL_UnlockMutex(rings_lock);
+    local_ring = ring;
+    local_generation = ring_generation;
+    return ring;
+}
+
+/*
+ * Reserves a contiguous record of at most max_len bytes from the ring of the calling thread.
+ * Blocks while the writer thread catches up if the ring is full. Returns NULL if there is no ring.
+ */
+static log_rec *log_reserve(log_ring **out_ring, size_t max_len) {
+    log_ring *ring = log_get_ring();
+    if(ring == NULL) {
+        return NULL;
+    }
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t off = head & (LOG_RING_SIZE - 1);
+    size_t skip = (LOG_RING_SIZE - off < max_len) ? LOG_RING_SIZE - off : 0;
+    while(head + skip + max_len - atomic_load_explicit(&ring->tail, memory_order_acquire) > LOG_RING_SIZE) {
+        SDL_SemPost(writer_sem);
+        SDL_Delay(1);
+    }
+    if(skip > 0) {
+        // Not enough room before the end of the buffer; pad it out and wrap around.
+        if(skip >= sizeof(log_rec)) {
+            log_rec *pad = (log_rec *)&ring->buf[off];
+            pad->len = skip;
+            pad->kind = LOG_REC_PAD;
+        }
+        head += skip;
+        atomic_store_explicit(&ring->head, head, memory_order_release);
+        off = 0;
+    }
+    *out_ring = ring;
+    return (log_rec *)&ring->buf[off];
+}
+
+static void log_commit(log_ring *ring, log_rec *rec, char mode, const char *fn, uint8_t kind, size_t len) {
+    rec->len = LOG_ALIGN(len);
+    rec->kind = kind;
+    rec->mode = mode;
+    rec->tick = _log_tick;
+    rec->fn = fn;
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t used = head - atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + rec->len, memory_order_release);
+
+    // Errors are written out right away, other messages when the ring starts filling up.
+    if(mode == 'E' || (used < LOG_RING_SIZE / 2 && used + rec->len >= LOG_RING_SIZE / 2)) {
+        SDL_SemPost(writer_sem);
+    }
+}
 
 int log_init(const char *filename) {
     if(handle)
@@ -17,30 +201,122 @@ int log_init(const char *filename) {
             return 1;
         }
     }
+
+    // Start the writer thread. If any of this fails, we just keep logging synchronously.
+    rings_lock = SDL_CreateMutex();
+    writer_sem = SDL_CreateSemaphore(0);
+    if(rings_lock != NULL && writer_sem != NULL) {
+        ring_generation++;
+        atomic_store(&writer_running, 1);
+        writer = SDL_CreateThread(log_writer_thread, "log writer", NULL);
+    }
+    if(writer == NULL) {
+        atomic_store(&writer_running, 0);
+    }
     return 0;
 }
 
 void log_close() {
+    if(writer != NULL) {
+        atomic_store(&writer_running, 0);
+        SDL_SemPost(writer_sem);
+        SDL_WaitThread(writer, NULL);
+        writer = NULL;
+    }
+    while(rings != NULL) {
+        log_ring *next = rings->next;
+        free(rings);
+        rings = next;
+    }
+    if(writer_sem != NULL) {
+        SDL_DestroySemaphore(writer_sem);
+        writer_sem = NULL;
+    }
+    if(rings_lock != NULL) {
+        SDL_DestroyMutex(rings_lock);
+        rings_lock = NULL;
+    }
     if(handle != stdout && handle != 0) {
         fclose(handle);
     }
+    handle = 0;
 }
 
-void log_hide(char mode, const char *fn, const char *fmt, ...) {
-} // Do nothing here. This is a no-op logger.
+void log_set_level(log_level level) {
+    _log_level = level;
+}
+
+log_level log_get_level() {
+    return _log_level;
+}
+
+/*
+ * Blocks until everything logged so far by the calling thread has been written out.
+ */
+void log_flush() {
+    if(writer == NULL) {
+        if(handle != 0)
+            fflush(handle);
+        return;
+    }
+    log_ring *ring = local_ring;
+    if(ring == NULL || local_generation != ring_generation) {
+        return;
+    }
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while(atomic_load_explicit(&ring->tail, memory_order_acquire) != head) {
+        SDL_SemPost(writer_sem);
+        SDL_Delay(1);
+    }
+}
 
 void log_print(char mode, const char *fn, const char *fmt, ...) {
     if(handle == 0)
         return;
-    if(fn != NULL) {
-        fprintf(handle, "[%7u][%c] %s(): ", _log_tick, mode, fn);
-    } else {
-        fprintf(handle, "[%7u][%c] ", _log_tick, mode);
-    }
     va_list args;
     va_start(args, fmt);
-    vfprintf(handle, fmt, args);
+    if(writer == NULL) {
+        char line[LOG_MAX_LINE];
+        vsnprintf(line, sizeof(line), fmt, args);
+        log_write_line(handle, mode, fn, _log_tick, line);
+        fflush(handle);
+    } else {
+        log_ring *ring;
+        log_rec *rec = log_reserve(&ring, LOG_REC_MAX);
+        if(rec != NULL) {
+            char *text = (char *)(rec + 1);
+            int len = vsnprintf(text, LOG_MAX_LINE, fmt, args);
+            if(len < 0) {
+                len = 0;
+                text[0] = 0;
+            } else if(len >= LOG_MAX_LINE) {
+                len = LOG_MAX_LINE - 1;
+            }
+            log_commit(ring, rec, mode, fn, LOG_REC_TEXT, sizeof(log_rec) + len + 1);
+        }
+    }
     va_end(args);
-    fprintf(handle, "\n");
-    fflush(handle);
+}
+
+void log_print_deferred(char mode, const char *fn, const char *fmt, const int *args) {
+    if(handle == 0)
+        return;
+    if(writer == NULL) {
+        char line[LOG_MAX_LINE];
+        log_deferred d;
+        d.fmt = fmt;
+        memcpy(d.args, args, sizeof(d.args));
+        log_format_deferred(line, sizeof(line), &d);
+        log_write_line(handle, mode, fn, _log_tick, line);
+        fflush(handle);
+        return;
+    }
+    log_ring *ring;
+    log_rec *rec = log_reserve(&ring, LOG_ALIGN(sizeof(log_rec) + sizeof(log_deferred)));
+    if(rec != NULL) {
+        log_deferred *d = (log_deferred *)(rec + 1);
+        d->fmt = fmt;
+        memcpy(d->args, args, sizeof(d->args));
+        log_commit(ring, rec, mode, fn, LOG_REC_DEFERRED, sizeof(log_rec) + sizeof(log_deferred));
+    }
 }
@@ -3,21 +3,71 @@
 
 #include <stdlib.h>
 
+typedef enum
+{
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_NONE
+} log_level;
+
+// Messages below this level are compiled out entirely. Can be overridden with a compile definition.
+#ifndef LOG_COMPILE_LEVEL
+#ifdef DEBUGMODE
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#else
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+
 #ifdef DEBUGMODE
-#define DEBUG(...) log_print('D', __FUNCTION__, __VA_ARGS__)
-#define PERROR(...) log_print('E', __FUNCTION__, __VA_ARGS__)
-#define INFO(...) log_print('I', __FUNCTION__, __VA_ARGS__)
+#define LOG_FUNCTION __FUNCTION__
 #else
-#define DEBUG(...) log_hide('D', NULL, __VA_ARGS__)
-#define PERROR(...) log_print('E', NULL, __VA_ARGS__)
-#define INFO(...) log_print('I', NULL, __VA_ARGS__)
+#define LOG_FUNCTION NULL
 #endif
 
+extern int _log_level;
+
+// Arguments are not evaluated (and nothing is formatted) when the level is disabled.
+#define LOG_ENABLED(level) ((level) >= LOG_COMPILE_LEVEL && (level) >= _log_level)
+#define LOG_AT(level, mode, ...)                                                                                       \
+    do {                                                                                                               \
+        if(LOG_ENABLED(level))                                                                                         \
+            log_print(mode, LOG_FUNCTION, __VA_ARGS__);                                                                \
+    } while(0)
+
+#define DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, 'D', __VA_ARGS__)
+#define INFO(...) LOG_AT(LOG_LEVEL_INFO, 'I', __VA_ARGS__)
+#define PERROR(...) LOG_AT(LOG_LEVEL_ERROR, 'E', __VA_ARGS__)
+
+// Deferred format debug log for high frequency trace points. Only the format pointer and 1 to
+// LOG_TRACE_ARGS int arguments are stored, and the string is formatted on the log writer thread.
+// The format must therefore be a string literal, and only contain int conversions (%d, %x, %c...).
+// Use DEBUG() for messages without arguments.
+#define LOG_TRACE_ARGS 4
+#define LOG_NARGS(...) LOG_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define LOG_TRACE_FMT(...) LOG_TRACE_FMT_(__VA_ARGS__, 0)
+#define LOG_TRACE_FMT_(fmt, ...) fmt
+#define LOG_TRACE_VALUES(fmt, ...) __VA_ARGS__
+#define TRACE(...)                                                                                                     \
+    do {                                                                                                               \
+        _Static_assert(LOG_NARGS(__VA_ARGS__) >= 2 && LOG_NARGS(__VA_ARGS__) <= LOG_TRACE_ARGS + 1,                    \
+                       "TRACE takes a format and 1 to 4 int arguments");                                               \
+        if(LOG_ENABLED(LOG_LEVEL_DEBUG)) {                                                                             \
+            const int _log_args[LOG_TRACE_ARGS] = {LOG_TRACE_VALUES(__VA_ARGS__)};                                     \
+            log_print_deferred('D', LOG_FUNCTION, "" LOG_TRACE_FMT(__VA_ARGS__), _log_args);                           \
+        }                                                                                                              \
+    } while(0)
+
 #define LOGTICK(x) _log_tick = x;
 extern unsigned int _log_tick;
 
-void log_hide(char mode, const char *fn, const char *fmt, ...); // no-op
 void log_print(char mode, const char *fn, const char *fmt, ...);
+void log_print_deferred(char mode, const char *fn, const char *fmt, const int *args);
+void log_set_level(log_level level);
+log_level log_get_level();
+void log_flush();
 int log_init(const char *filename);
 void log_close();
 
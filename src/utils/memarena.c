@@ -0,0 +1,96 @@
+#include "utils/memarena.h"
+#include "utils/allocator.h"
+#include <stdalign.h>
+#include <stdlib.h>
+
+#define ARENA_ALIGN (alignof(max_align_t))
+#define ALIGN_UP(x) (((x) + (ARENA_ALIGN - 1)) & ~(ARENA_ALIGN - 1))
+
+struct memarena_block_t {
+    memarena_block *prev;
+    size_t size;
+    size_t pos;
+    alignas(max_align_t) char data[];
+};
+
+static memarena_block *memarena_block_create(size_t size, memarena_block *prev) {
+    memarena_block *block = omf_calloc(1, sizeof(memarena_block) + size);
+    block->prev = prev;
+    block->size = size;
+    block->pos = 0;
+    return block;
+}
+
+// Frees all blocks newer than the given block. Stop block itself is kept.
+static void memarena_free_blocks_until(memarena *a, memarena_block *stop) {
+    memarena_block *tmp;
+    while(a->head != stop) {
+        tmp = a->head;
+        a->head = tmp->prev;
+        omf_free(tmp);
+        a->block_num--;
+    }
+}
+
+void memarena_create(memarena *a, size_t block_size) {
+    a->head = NULL;
+    a->block_size = ALIGN_UP(block_size);
+    a->used = 0;
+    a->peak = 0;
+    a->allocs = 0;
+    a->block_num = 0;
+}
+
+void memarena_free(memarena *a) {
+    memarena_free_blocks_until(a, NULL);
+    a->used = 0;
+    a->allocs = 0;
+}
+
+void *memarena_alloc(memarena *a, size_t size) {
+    size = ALIGN_UP(size > 0 ? size : 1);
+    if(a->head == NULL || a->head->pos + size > a->head->size) {
+        size_t new_size = (size > a->block_size) ? size : a->block_size;
+        a->head = memarena_block_create(new_size, a->head);
+        a->block_num++;
+    }
+    void *ret = a->head->data + a->head->pos;
+    a->head->pos += size;
+    a->used += size;
+    a->allocs++;
+    if(a->used > a->peak) {
+        a->peak = a->used;
+    }
+    return ret;
+}
+
+void memarena_reset(memarena *a) {
+    if(a->block_num > 1 || (a->head != NULL && a->head->size < a->peak)) {
+        // We had to grow; Replace everything with one block that is large enough
+        // to hold the whole peak usage of the arena.
+        memarena_free_blocks_until(a, NULL);
+        a->head = memarena_block_create(ALIGN_UP(a->peak), NULL);
+        a->block_num = 1;
+    }
+    if(a->head != NULL) {
+        a->head->pos = 0;
+    }
+    a->used = 0;
+    a->allocs = 0;
+}
+
+memarena_mark memarena_get_mark(const memarena *a) {
+    memarena_mark mark;
+    mark.block = a->head;
+    mark.pos = (a->head != NULL) ? a->head->pos : 0;
+    mark.used = a->used;
+    return mark;
+}
+
+void memarena_rewind(memarena *a, memarena_mark mark) {
+    memarena_free_blocks_until(a, mark.block);
+    if(a->head != NULL) {
+        a->head->pos = mark.pos;
+    }
+    a->used = mark.used;
+}
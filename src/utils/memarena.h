@@ -0,0 +1,76 @@
+#ifndef MEMARENA_H
+#define MEMARENA_H
+
+#include <stddef.h>
+
+typedef struct memarena_block_t memarena_block;
+
+/**
+ * @brief Bump allocator for memory that shares a single lifetime.
+ * @details Allocations are carved linearly out of large blocks, and are never freed
+ *          individually. The whole arena is released at once with memarena_reset(), which
+ *          makes teardown O(1) regardless of the amount of allocations made.
+ */
+typedef struct memarena_t {
+    memarena_block *head;   ///< Block we are currently allocating from (newest block)
+    size_t block_size;      ///< Minimum size for newly allocated blocks
+    size_t used;            ///< Bytes handed out since the last reset
+    size_t peak;            ///< Largest amount of bytes handed out between resets
+    unsigned int allocs;    ///< Amount of allocations made since the last reset
+    unsigned int block_num; ///< Amount of blocks currently owned by the arena
+} memarena;
+
+/**
+ * @brief Position inside an arena.
+ * @details Can be used to release everything allocated after the mark was taken,
+ *          see memarena_rewind().
+ */
+typedef struct memarena_mark_t {
+    memarena_block *block;
+    size_t pos;
+    size_t used;
+} memarena_mark;
+
+/**
+ * @brief Create an empty arena.
+ * @details No memory is reserved until the first allocation is made.
+ * @param a Arena to initialize
+ * @param block_size Minimum size for memory blocks requested from the system
+ */
+void memarena_create(memarena *a, size_t block_size);
+
+/**
+ * @brief Free all memory owned by the arena.
+ * @details After this, the arena can be reused as if it had just been created.
+ */
+void memarena_free(memarena *a);
+
+/**
+ * @brief Allocate a block of memory from the arena.
+ * @details Returned memory is aligned for any type, and is NOT zeroed.
+ * @param a Arena to allocate from
+ * @param size Amount of bytes to allocate
+ * @return Pointer to the allocated memory. Never NULL.
+ */
+void *memarena_alloc(memarena *a, size_t size);
+
+/**
+ * @brief Release everything allocated from the arena.
+ * @details If the arena had to grow during its last lifetime, the blocks are merged into
+ *          one large block, so that the next lifetime can be served without extra system calls.
+ */
+void memarena_reset(memarena *a);
+
+/**
+ * @brief Get the current allocation position of the arena.
+ */
+memarena_mark memarena_get_mark(const memarena *a);
+
+/**
+ * @brief Release all allocations made after the given mark was taken.
+ * @details Marks must be rewound in LIFO order, and the arena must not have been reset
+ *          after the mark was taken.
+ */
+void memarena_rewind(memarena *a, memarena_mark mark);
+
+#endif // MEMARENA_H
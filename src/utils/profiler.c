@@ -0,0 +1,252 @@
+#include "utils/profiler.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Amount of samples kept for percentile calculation, per zone and counter
+#define PROF_WINDOW 512
+
+// Maximum amount of events in a single trace capture
+#define PROF_TRACE_MAX_EVENTS (1 << 18)
+
+typedef struct {
+    uint32_t samples[PROF_WINDOW];
+    unsigned int pos;
+    unsigned int count;
+} prof_ring;
+
+typedef struct {
+    uint64_t start;
+    uint64_t value; // Duration in performance counter ticks for zones, plain value for counters
+    uint16_t id;    // Zone ID, or PROF_ZONE_COUNT + counter ID
+} prof_trace_event;
+
+static const char *zone_names[PROF_ZONE_COUNT] = {
+    "frame",
+    "static tick",
+    "dynamic tick",
+    "dyn controllers",
+    "dyn scene",
+    "dyn cleanup",
+    "dyn move",
+    "dyn collide",
+    "dyn objects",
+    "render",
+    "render palette",
+    "render objects",
+    "render finish",
+};
+
+static const char *counter_names[PROF_COUNTER_COUNT] = {
+    "tcache misses",
+    "draw calls",
+};
+
+int _profiler_enabled = 0;
+
+static prof_ring zones[PROF_ZONE_COUNT];
+static prof_ring counters[PROF_COUNTER_COUNT];
+static unsigned int counter_frame[PROF_COUNTER_COUNT];
+static uint64_t freq = 1;
+
+static prof_trace_event *trace_events = NULL;
+static unsigned int trace_count = 0;
+static uint64_t trace_start = 0;
+static int trace_overflow = 0;
+
+static void ring_push(prof_ring *ring, uint32_t value) {
+    ring->samples[ring->pos] = value;
+    ring->pos = (ring->pos + 1) % PROF_WINDOW;
+    if(ring->count < PROF_WINDOW) {
+        ring->count++;
+    }
+}
+
+static void trace_push(uint16_t id, uint64_t start, uint64_t value) {
+    if(trace_events == NULL) {
+        return;
+    }
+    if(trace_count >= PROF_TRACE_MAX_EVENTS) {
+        if(!trace_overflow) {
+            PERROR("Profiler trace buffer is full; further events are dropped.");
+            trace_overflow = 1;
+        }
+        return;
+    }
+    trace_events[trace_count].start = start;
+    trace_events[trace_count].value = value;
+    trace_events[trace_count].id = id;
+    trace_count++;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t ua = *(const uint32_t *)a;
+    uint32_t ub = *(const uint32_t *)b;
+    return (ua > ub) - (ua < ub);
+}
+
+static void ring_stats(const prof_ring *ring, float scale, profiler_stats *stats) {
+    uint32_t sorted[PROF_WINDOW];
+    memset(stats, 0, sizeof(profiler_stats));
+    if(ring->count == 0) {
+        return;
+    }
+    memcpy(sorted, ring->samples, ring->count * sizeof(uint32_t));
+    qsort(sorted, ring->count, sizeof(uint32_t), cmp_u32);
+    stats->p50 = sorted[(ring->count - 1) / 2] * scale;
+    stats->p99 = sorted[(ring->count - 1) * 99 / 100] * scale;
+    stats->max = sorted[ring->count - 1] * scale;
+    stats->samples = ring->count;
+}
+
+void profiler_init() {
+    freq = SDL_GetPerformanceFrequency();
+    profiler_reset();
+}
+
+void profiler_close() {
+    omf_free(trace_events);
+    trace_count = 0;
+    _profiler_enabled = 0;
+}
+
+void profiler_set_enabled(int enabled) {
+    _profiler_enabled = enabled;
+}
+
+void profiler_reset() {
+    memset(zones, 0, sizeof(zones));
+    memset(counters, 0, sizeof(counters));
+    memset(counter_frame, 0, sizeof(counter_frame));
+}
+
+uint64_t profiler_begin() {
+    if(!_profiler_enabled) {
+        return 0;
+    }
+    return SDL_GetPerformanceCounter();
+}
+
+void profiler_end(profiler_zone zone, uint64_t start) {
+    if(!_profiler_enabled || start == 0) {
+        return;
+    }
+    uint64_t dur = SDL_GetPerformanceCounter() - start;
+    uint64_t us = dur * 1000000 / freq;
+    ring_push(&zones[zone], us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    trace_push(zone, start, dur);
+}
+
+void profiler_count(profiler_counter counter, unsigned int amount) {
+    counter_frame[counter] += amount;
+}
+
+void profiler_frame_end() {
+    if(!_profiler_enabled) {
+        memset(counter_frame, 0, sizeof(counter_frame));
+        return;
+    }
+    uint64_t now = SDL_GetPerformanceCounter();
+    for(int i = 0; i < PROF_COUNTER_COUNT; i++) {
+        ring_push(&counters[i], counter_frame[i]);
+        trace_push(PROF_ZONE_COUNT + i, now, counter_frame[i]);
+        counter_frame[i] = 0;
+    }
+}
+
+void profiler_get_zone_stats(profiler_zone zone, profiler_stats *stats) {
+    ring_stats(&zones[zone], 0.001f, stats);
+}
+
+void profiler_get_counter_stats(profiler_counter counter, profiler_stats *stats) {
+    ring_stats(&counters[counter], 1.0f, stats);
+}
+
+const char *profiler_zone_name(profiler_zone zone) {
+    return zone_names[zone];
+}
+
+const char *profiler_counter_name(profiler_counter counter) {
+    return counter_names[counter];
+}
+
+/*
+ * Formats the current statistics as text lines, one zone or counter per line.
+ */
+void profiler_report(profiler_line_fn fn, void *userdata) {
+    char buf[64];
+    profiler_stats st;
+    fn("zone: p50/p99/max ms", userdata);
+    for(int i = 0; i < PROF_ZONE_COUNT; i++) {
+        profiler_get_zone_stats(i, &st);
+        snprintf(buf, sizeof(buf), "%s: %.2f/%.2f/%.2f", zone_names[i], st.p50, st.p99, st.max);
+        fn(buf, userdata);
+    }
+    for(int i = 0; i < PROF_COUNTER_COUNT; i++) {
+        profiler_get_counter_stats(i, &st);
+        snprintf(buf, sizeof(buf), "%s: %.0f/%.0f/%.0f", counter_names[i], st.p50, st.p99, st.max);
+        fn(buf, userdata);
+    }
+}
+
+/*
+ * Starts recording all timed zones into a trace buffer. Also enables the profiler.
+ * Returns 0 on success, 1 if a trace is already running.
+ */
+int profiler_trace_start() {
+    if(trace_events != NULL) {
+        return 1;
+    }
+    trace_events = omf_calloc(PROF_TRACE_MAX_EVENTS, sizeof(prof_trace_event));
+    trace_count = 0;
+    trace_overflow = 0;
+    trace_start = SDL_GetPerformanceCounter();
+    _profiler_enabled = 1;
+    return 0;
+}
+
+int profiler_trace_is_running() {
+    return trace_events != NULL;
+}
+
+/*
+ * Stops trace recording, and writes the events in Chrome trace event format
+ * (load in chrome://tracing or Perfetto). Returns 0 on success, 1 on error.
+ */
+int profiler_trace_stop(const char *filename) {
+    if(trace_events == NULL) {
+        return 1;
+    }
+    int ret = 0;
+    FILE *fp = fopen(filename, "w");
+    if(fp == NULL) {
+        PERROR("Unable to open trace file %s for writing", filename);
+        ret = 1;
+        goto exit_0;
+    }
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for(unsigned int i = 0; i < trace_count; i++) {
+        const prof_trace_event *ev = &trace_events[i];
+        double ts = (double)(ev->start - trace_start) * 1000000.0 / freq;
+        const char *sep = (i + 1 < trace_count) ? "," : "";
+        if(ev->id < PROF_ZONE_COUNT) {
+            double dur = (double)ev->value * 1000000.0 / freq;
+            fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                    zone_names[ev->id], ts, dur, sep);
+        } else {
+            fprintf(fp, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{\"value\":%u}}%s\n",
+                    counter_names[ev->id - PROF_ZONE_COUNT], ts, (unsigned int)ev->value, sep);
+        }
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(fp);
+    INFO("Wrote %u profiler trace events to %s", trace_count, filename);
+
+exit_0:
+    omf_free(trace_events);
+    trace_count = 0;
+    return ret;
+}
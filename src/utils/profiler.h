@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+// Timed zones. Keep in sync with zone names in profiler.c
+typedef enum
+{
+    PROF_FRAME = 0,
+    PROF_STATIC_TICK,
+    PROF_DYNAMIC_TICK,
+    PROF_DYN_CONTROLLERS,
+    PROF_DYN_SCENE,
+    PROF_DYN_CLEANUP,
+    PROF_DYN_MOVE,
+    PROF_DYN_COLLIDE,
+    PROF_DYN_OBJECTS,
+    PROF_RENDER,
+    PROF_RENDER_PALETTE,
+    PROF_RENDER_OBJECTS,
+    PROF_RENDER_FINISH,
+    PROF_ZONE_COUNT
+} profiler_zone;
+
+// Per-frame counters. Keep in sync with counter names in profiler.c
+typedef enum
+{
+    PROF_TCACHE_MISSES = 0,
+    PROF_DRAW_CALLS,
+    PROF_COUNTER_COUNT
+} profiler_counter;
+
+typedef struct profiler_stats_t {
+    float p50; ///< Median, in milliseconds (or counts, for counters)
+    float p99; ///< 99th percentile, in milliseconds (or counts, for counters)
+    float max; ///< Largest sample in the window
+    unsigned int samples;
+} profiler_stats;
+
+typedef void (*profiler_line_fn)(const char *line, void *userdata);
+
+// Scoped timers. BEGIN and END for the same zone must be in the same block.
+#define PROFILE_BEGIN(zone) uint64_t _prof_start_##zone = profiler_begin()
+#define PROFILE_END(zone) profiler_end((zone), _prof_start_##zone)
+
+extern int _profiler_enabled;
+
+static inline int profiler_is_enabled() {
+    return _profiler_enabled;
+}
+
+void profiler_init();
+void profiler_close();
+void profiler_set_enabled(int enabled);
+void profiler_reset();
+
+uint64_t profiler_begin();
+void profiler_end(profiler_zone zone, uint64_t start);
+void profiler_count(profiler_counter counter, unsigned int amount);
+void profiler_frame_end();
+
+void profiler_get_zone_stats(profiler_zone zone, profiler_stats *stats);
+void profiler_get_counter_stats(profiler_counter counter, profiler_stats *stats);
+const char *profiler_zone_name(profiler_zone zone);
+const char *profiler_counter_name(profiler_counter counter);
+void profiler_report(profiler_line_fn fn, void *userdata);
+
+int profiler_trace_start();
+int profiler_trace_stop(const char *filename);
+int profiler_trace_is_running();
+
+#endif // PROFILER_H
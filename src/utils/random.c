@@ -26,6 +26,14 @@ float random_float(struct random_t *r) {
     return (float)random_intmax(r) / (float)UINT_MAX;
 }
 
+fixedpt random_fixedpt(struct random_t *r) {
+#ifdef FIXED_POINT_PHYSICS
+    return random_intmax(r) >> (32 - FIXEDPT_BITS);
+#else
+    return random_float(r);
+#endif
+}
+
 void rand_seed(uint32_t seed) {
     random_seed(&rand_state, seed);
 }
@@ -41,3 +49,6 @@ uint32_t rand_intmax(void) {
 float rand_float(void) {
     return random_float(&rand_state);
 }
+fixedpt rand_fixedpt(void) {
+    return random_fixedpt(&rand_state);
+}
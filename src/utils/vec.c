@@ -37,6 +37,18 @@ vec2f vec2f_mult(vec2f a, vec2f b) {
     return a;
 }
 
+vec2fx vec2fx_add(vec2fx a, vec2fx b) {
+    a.x += b.x;
+    a.y += b.y;
+    return a;
+}
+
+vec2fx vec2fx_sub(vec2fx a, vec2fx b) {
+    a.x -= b.x;
+    a.y -= b.y;
+    return a;
+}
+
 vec2i vec2f_to_i(vec2f f) {
     vec2i i;
     i.x = f.x;
@@ -51,6 +63,20 @@ vec2f vec2i_to_f(vec2i i) {
     return f;
 }
 
+vec2i vec2fx_to_i(vec2fx f) {
+    vec2i i;
+    i.x = fixedpt_to_int(f.x);
+    i.y = fixedpt_to_int(f.y);
+    return i;
+}
+
+vec2fx vec2i_to_fx(vec2i i) {
+    vec2fx f;
+    f.x = fixedpt_from_int(i.x);
+    f.y = fixedpt_from_int(i.y);
+    return f;
+}
+
 vec2f vec2f_norm(vec2f a) {
     float mag = vec2f_mag(a);
     a.x /= mag;
@@ -79,3 +105,10 @@ vec2f vec2f_create(float x, float y) {
     v.y = y;
     return v;
 }
+
+vec2fx vec2fx_create(fixedpt x, fixedpt y) {
+    vec2fx v;
+    v.x = x;
+    v.y = y;
+    return v;
+}
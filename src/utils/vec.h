@@ -1,11 +1,18 @@
 #ifndef VEC_H
 #define VEC_H
 
+#include "utils/fixedpt.h"
+
 typedef struct vec2f_t {
     float x;
     float y;
 } vec2f;
 
+typedef struct vec2fx_t {
+    fixedpt x;
+    fixedpt y;
+} vec2fx;
+
 typedef struct vec2i_t {
     int x;
     int y;
@@ -19,14 +26,20 @@ vec2f vec2f_add(vec2f a, vec2f b);
 vec2f vec2f_sub(vec2f a, vec2f b);
 vec2f vec2f_mult(vec2f a, vec2f b);
 
+vec2fx vec2fx_add(vec2fx a, vec2fx b);
+vec2fx vec2fx_sub(vec2fx a, vec2fx b);
+
 vec2f vec2f_norm(vec2f a);
 float vec2f_mag(vec2f a);
 float vec2f_dist(vec2f a, vec2f b);
 
 vec2i vec2f_to_i(vec2f f);
 vec2f vec2i_to_f(vec2i i);
+vec2i vec2fx_to_i(vec2fx f);
+vec2fx vec2i_to_fx(vec2i i);
 
 vec2i vec2i_create(int x, int y);
 vec2f vec2f_create(float x, float y);
+vec2fx vec2fx_create(fixedpt x, fixedpt y);
 
 #endif // VEC_H
@@ -0,0 +1,390 @@
+#include "video/capture.h"
+#include "utils/allocator.h"
+#include "utils/log.h"
+#include "video/image.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+
+// Amount of frame buffers in flight. If the worker falls this far behind, capture frames are dropped.
+#define CAPTURE_BUFFERS 4
+
+// Length of the job queue. Holds all frame buffers, plus stream close requests.
+#define CAPTURE_QUEUE_SIZE 16
+
+enum
+{
+    CAPTURE_JOB_SCREENSHOT = 0,
+    CAPTURE_JOB_STREAM,
+    CAPTURE_JOB_STREAM_CLOSE,
+};
+
+struct capture_frame_t {
+    int w;
+    int h;
+    size_t size;
+    char *data;
+    int busy;
+};
+
+typedef struct {
+    int type;
+    int repeat;
+    capture_frame *frame;
+    FILE *stream;
+    char filename[128];
+} capture_job;
+
+static SDL_Thread *worker = NULL;
+static SDL_mutex *lock = NULL;
+static SDL_cond *cond = NULL;
+static int worker_running = 0;
+
+static capture_frame frames[CAPTURE_BUFFERS];
+static capture_job queue[CAPTURE_QUEUE_SIZE];
+static unsigned int queue_head = 0;
+static unsigned int queue_tail = 0;
+
+static char screenshot_filename[128];
+static int screenshot_pending = 0;
+
+static FILE *stream = NULL;
+static char stream_filename[128];
+static unsigned int stream_start_ticks = 0;
+static unsigned int stream_frames = 0;
+static unsigned int stream_dropped = 0;
+static int stream_fixed_step = 0;
+
+static FILE *audio_stream = NULL;
+static uint32_t audio_bytes = 0;
+
+static void capture_run_job(const capture_job *job) {
+    if(job->type == CAPTURE_JOB_SCREENSHOT) {
+        image img;
+        img.w = job->frame->w;
+        img.h = job->frame->h;
+        img.data = job->frame->data;
+        if(image_write_png(&img, job->filename)) {
+            PERROR("Screenshot write operation failed (%s)", job->filename);
+        } else {
+            DEBUG("Got a screenshot: %s", job->filename);
+        }
+    } else if(job->type == CAPTURE_JOB_STREAM) {
+        size_t len = (size_t)job->frame->w * job->frame->h * 4;
+        for(int i = 0; i < job->repeat; i++) {
+            if(fwrite(job->frame->data, 1, len, job->stream) != len) {
+                PERROR("Capture stream write failed");
+                break;
+            }
+        }
+    } else if(job->type == CAPTURE_JOB_STREAM_CLOSE) {
+        fclose(job->stream);
+    }
+}
+
+static int capture_worker(void *userdata) {
+    capture_job job;
+    SDL_LockMutex(lock);
+    while(1) {
+        while(queue_head == queue_tail && worker_running) {
+            SDL_CondWait(cond, lock);
+        }
+        if(queue_head == queue_tail) {
+            break;
+        }
+        job = queue[queue_tail];
+        queue_tail = (queue_tail + 1) % CAPTURE_QUEUE_SIZE;
+
+        // Encoding and disk I/O happen without the lock, so the renderer never waits on them.
+        SDL_UnlockMutex(lock);
+        capture_run_job(&job);
+        SDL_LockMutex(lock);
+
+        if(job.frame != NULL) {
+            job.frame->busy = 0;
+        }
+    }
+    SDL_UnlockMutex(lock);
+    return 0;
+}
+
+// Hands a job to the worker thread, or runs it right away if there is no worker.
+static void capture_run(const capture_job *job) {
+    if(worker == NULL) {
+        capture_run_job(job);
+        if(job->frame != NULL) {
+            job->frame->busy = 0;
+        }
+        return;
+    }
+    SDL_LockMutex(lock);
+    while((queue_head + 1) % CAPTURE_QUEUE_SIZE == queue_tail) {
+        // Only reachable by toggling the stream faster than the worker closes files.
+        SDL_UnlockMutex(lock);
+        SDL_Delay(1);
+        SDL_LockMutex(lock);
+    }
+    queue[queue_head] = *job;
+    queue_head = (queue_head + 1) % CAPTURE_QUEUE_SIZE;
+    SDL_CondSignal(cond);
+    SDL_UnlockMutex(lock);
+}
+
+int capture_init() {
+    memset(frames, 0, sizeof(frames));
+    queue_head = queue_tail = 0;
+    lock = SDL_CreateMutex();
+    cond = SDL_CreateCond();
+    if(lock == NULL || cond == NULL) {
+        PERROR("Unable to create capture worker lock: %s", SDL_GetError());
+        return 1;
+    }
+    worker_running = 1;
+    worker = SDL_CreateThread(capture_worker, "capture", NULL);
+    if(worker == NULL) {
+        // Still usable, but frames will be encoded on the calling thread.
+        PERROR("Unable to start capture worker: %s", SDL_GetError());
+        worker_running = 0;
+    }
+    return 0;
+}
+
+void capture_close() {
+    capture_stream_stop();
+    if(worker != NULL) {
+        SDL_LockMutex(lock);
+        worker_running = 0;
+        SDL_CondSignal(cond);
+        SDL_UnlockMutex(lock);
+        SDL_WaitThread(worker, NULL);
+        worker = NULL;
+    }
+    for(int i = 0; i < CAPTURE_BUFFERS; i++) {
+        omf_free(frames[i].data);
+    }
+    SDL_DestroyCond(cond);
+    SDL_DestroyMutex(lock);
+    cond = NULL;
+    lock = NULL;
+}
+
+/*
+ * Requests a screenshot of the next rendered frame. The PNG is written by the capture worker.
+ */
+void capture_screenshot(const char *filename) {
+    snprintf(screenshot_filename, sizeof(screenshot_filename), "%s", filename);
+    screenshot_pending = 1;
+}
+
+int capture_screenshot_pending() {
+    return screenshot_pending;
+}
+
+/*
+ * Starts writing every native resolution frame to a file, as raw RGBA video at CAPTURE_STREAM_FPS.
+ * In fixed step mode, every rendered frame is exactly one stream frame, and no frames are ever
+ * dropped; the renderer waits for the worker instead. Returns 0 on success, 1 on error.
+ */
+int capture_stream_start(const char *filename, int fixed_step) {
+    if(stream != NULL) {
+        return 1;
+    }
+    stream = fopen(filename, "wb");
+    if(stream == NULL) {
+        PERROR("Unable to open capture stream %s for writing", filename);
+        return 1;
+    }
+    snprintf(stream_filename, sizeof(stream_filename), "%s", filename);
+    stream_start_ticks = SDL_GetTicks();
+    stream_frames = 0;
+    stream_dropped = 0;
+    stream_fixed_step = fixed_step;
+    INFO("Capture stream started: %s", filename);
+    return 0;
+}
+
+void capture_stream_stop() {
+    if(stream == NULL) {
+        return;
+    }
+
+    // The file is closed by the worker, after all frames queued before this have been written.
+    capture_job job;
+    memset(&job, 0, sizeof(job));
+    job.type = CAPTURE_JOB_STREAM_CLOSE;
+    job.stream = stream;
+    capture_run(&job);
+    stream = NULL;
+
+    INFO("Capture stream stopped: %u frames, %u dropped", stream_frames, stream_dropped);
+    INFO("Convert with: ffmpeg -f rawvideo -pixel_format rgba -video_size 320x200 -framerate %d -i %s out.mkv",
+         CAPTURE_STREAM_FPS, stream_filename);
+}
+
+int capture_stream_is_running() {
+    return stream != NULL;
+}
+
+/*
+ * Returns how many stream frames should be emitted for a frame rendered at the given time,
+ * to keep the stream at a constant frame rate. Zero if the stream is not running.
+ */
+int capture_stream_frames_due(unsigned int ticks) {
+    if(stream == NULL) {
+        return 0;
+    }
+    if(stream_fixed_step) {
+        return 1;
+    }
+    unsigned int target = (unsigned int)((uint64_t)(ticks - stream_start_ticks) * CAPTURE_STREAM_FPS / 1000) + 1;
+    return (target > stream_frames) ? target - stream_frames : 0;
+}
+
+/*
+ * Gets a free frame buffer of at least w*h RGBA pixels, or NULL if all buffers are still in use.
+ */
+capture_frame *capture_acquire(int w, int h) {
+    capture_frame *frame = NULL;
+    while(1) {
+        if(lock != NULL) {
+            SDL_LockMutex(lock);
+        }
+        for(int i = 0; i < CAPTURE_BUFFERS; i++) {
+            if(!frames[i].busy) {
+                frames[i].busy = 1;
+                frame = &frames[i];
+                break;
+            }
+        }
+        if(lock != NULL) {
+            SDL_UnlockMutex(lock);
+        }
+        if(frame != NULL || stream == NULL || !stream_fixed_step) {
+            break;
+        }
+        SDL_Delay(1);
+    }
+    if(frame == NULL) {
+        if(stream != NULL) {
+            stream_dropped++;
+        }
+        return NULL;
+    }
+    size_t size = (size_t)w * h * 4;
+    if(frame->size < size) {
+        frame->data = omf_realloc(frame->data, size);
+        frame->size = size;
+    }
+    frame->w = w;
+    frame->h = h;
+    return frame;
+}
+
+void *capture_frame_data(capture_frame *frame) {
+    return frame->data;
+}
+
+void capture_submit_screenshot(capture_frame *frame) {
+    capture_job job;
+    memset(&job, 0, sizeof(job));
+    job.type = CAPTURE_JOB_SCREENSHOT;
+    job.frame = frame;
+    snprintf(job.filename, sizeof(job.filename), "%s", screenshot_filename);
+    screenshot_pending = 0;
+    capture_run(&job);
+}
+
+/*
+ * Queues a native resolution frame for the stream, to be written repeat times.
+ */
+void capture_submit_stream(capture_frame *frame, int repeat) {
+    if(stream == NULL) {
+        capture_release(frame);
+        return;
+    }
+    capture_job job;
+    memset(&job, 0, sizeof(job));
+    job.type = CAPTURE_JOB_STREAM;
+    job.frame = frame;
+    job.stream = stream;
+    job.repeat = repeat;
+    stream_frames += repeat;
+    capture_run(&job);
+}
+
+/*
+ * Returns an acquired frame buffer without submitting it.
+ */
+void capture_release(capture_frame *frame) {
+    if(lock != NULL) {
+        SDL_LockMutex(lock);
+    }
+    frame->busy = 0;
+    if(lock != NULL) {
+        SDL_UnlockMutex(lock);
+    }
+}
+
+static void capture_audio_put_u32(uint8_t *dst, uint32_t v) {
+    dst[0] = v & 0xFF;
+    dst[1] = (v >> 8) & 0xFF;
+    dst[2] = (v >> 16) & 0xFF;
+    dst[3] = (v >> 24) & 0xFF;
+}
+
+static void capture_audio_write_header(uint32_t freq) {
+    uint8_t h[44] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0,
+                     0,   0,   0,   0,   0, 0, 0, 0, 4,   0,   16,  0,   'd', 'a', 't', 'a', 0, 0, 0, 0};
+    capture_audio_put_u32(h + 4, 36 + audio_bytes);
+    capture_audio_put_u32(h + 24, freq);
+    capture_audio_put_u32(h + 28, freq * 4);
+    capture_audio_put_u32(h + 40, audio_bytes);
+    fwrite(h, 1, sizeof(h), audio_stream);
+}
+
+/*
+ * Starts writing 16-bit stereo audio to a WAV file. Returns 0 on success, 1 on error.
+ */
+int capture_audio_start(const char *filename, int freq) {
+    if(audio_stream != NULL) {
+        return 1;
+    }
+    audio_stream = fopen(filename, "wb");
+    if(audio_stream == NULL) {
+        PERROR("Unable to open audio capture %s for writing", filename);
+        return 1;
+    }
+    audio_bytes = 0;
+    capture_audio_write_header(freq);
+    return 0;
+}
+
+void capture_audio_write(const int16_t *samples, int frames) {
+    if(audio_stream == NULL) {
+        return;
+    }
+    uint8_t buf[1024];
+    int len = frames * 2;
+    int n = 0;
+    for(int i = 0; i < len; i++) {
+        // WAV is always little endian
+        buf[n++] = samples[i] & 0xFF;
+        buf[n++] = (samples[i] >> 8) & 0xFF;
+        if(n == sizeof(buf) || i == len - 1) {
+            fwrite(buf, 1, n, audio_stream);
+            n = 0;
+        }
+    }
+    audio_bytes += len * 2;
+}
+
+void capture_audio_stop(int freq) {
+    if(audio_stream == NULL) {
+        return;
+    }
+    // Sizes are only known now; rewrite the header.
+    fseek(audio_stream, 0, SEEK_SET);
+    capture_audio_write_header(freq);
+    fclose(audio_stream);
+    audio_stream = NULL;
+}
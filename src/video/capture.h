@@ -0,0 +1,35 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+
+// Frame rate of the continuous capture stream. Rendered frames are repeated or skipped to match it.
+#define CAPTURE_STREAM_FPS 60
+
+/**
+ * @brief Frame buffer handed from the renderer to the capture worker thread.
+ */
+typedef struct capture_frame_t capture_frame;
+
+int capture_init();
+void capture_close();
+
+void capture_screenshot(const char *filename);
+int capture_stream_start(const char *filename, int fixed_step);
+void capture_stream_stop();
+int capture_stream_is_running();
+
+int capture_screenshot_pending();
+int capture_stream_frames_due(unsigned int ticks);
+
+capture_frame *capture_acquire(int w, int h);
+void *capture_frame_data(capture_frame *frame);
+void capture_submit_screenshot(capture_frame *frame);
+void capture_submit_stream(capture_frame *frame, int repeat);
+void capture_release(capture_frame *frame);
+
+int capture_audio_start(const char *filename, int freq);
+void capture_audio_write(const int16_t *samples, int frames);
+void capture_audio_stop(int freq);
+
+#endif // CAPTURE_H
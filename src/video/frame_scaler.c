@@ -0,0 +1,146 @@
+#include "video/frame_scaler.h"
+#include "utils/log.h"
+#include <SDL.h>
+#include <stdint.h>
+
+// Most threads used for scaling a frame, including the calling thread
+#define FRAME_SCALER_MAX_THREADS 8
+
+typedef struct {
+    scaler_plugin *scaler;
+    const char *in;
+    char *out;
+    int w;
+    int h;
+    int factor;
+} frame_scaler_job;
+
+static SDL_Thread *workers[FRAME_SCALER_MAX_THREADS - 1];
+static int worker_count = 0;
+static SDL_mutex *lock = NULL;
+static SDL_cond *cond = NULL;
+static int workers_running = 0;
+
+static frame_scaler_job job;
+static unsigned int job_serial = 0;
+static int bands_left = 0;
+static int band_failed = 0;
+
+// Scales one horizontal band of the current job. There is one band per thread.
+static int frame_scaler_band(int band) {
+    int bands = worker_count + 1;
+    int y0 = job.h * band / bands;
+    int y1 = job.h * (band + 1) / bands;
+    return job.scaler->scale_rows(job.in, job.out, job.w, job.h, job.factor, y0, y1);
+}
+
+static int frame_scaler_worker(void *userdata) {
+    int band = (int)(intptr_t)userdata;
+    unsigned int serial = 0;
+    SDL_LockMutex(lock);
+    while(1) {
+        while(serial == job_serial && workers_running) {
+            SDL_CondWait(cond, lock);
+        }
+        if(!workers_running) {
+            break;
+        }
+        serial = job_serial;
+
+        SDL_UnlockMutex(lock);
+        int ret = frame_scaler_band(band);
+        SDL_LockMutex(lock);
+
+        band_failed |= ret;
+        if(--bands_left == 0) {
+            SDL_CondBroadcast(cond);
+        }
+    }
+    SDL_UnlockMutex(lock);
+    return 0;
+}
+
+int frame_scaler_init() {
+    int threads = SDL_GetCPUCount();
+    if(threads > FRAME_SCALER_MAX_THREADS) {
+        threads = FRAME_SCALER_MAX_THREADS;
+    }
+    worker_count = 0;
+    job_serial = 0;
+    if(threads <= 1) {
+        return 0;
+    }
+    lock = SDL_CreateMutex();
+    cond = SDL_CreateCond();
+    if(lock == NULL || cond == NULL) {
+        PERROR("Unable to create scaler lock: %s", SDL_GetError());
+        return 1;
+    }
+    workers_running = 1;
+    for(int i = 0; i < threads - 1; i++) {
+        workers[i] = SDL_CreateThread(frame_scaler_worker, "scaler", (void *)(intptr_t)(i + 1));
+        if(workers[i] == NULL) {
+            // Fewer bands, but still works
+            PERROR("Unable to start scaler thread: %s", SDL_GetError());
+            break;
+        }
+        worker_count++;
+    }
+    DEBUG("Frame scaler uses %d threads", worker_count + 1);
+    return 0;
+}
+
+void frame_scaler_close() {
+    if(lock != NULL) {
+        SDL_LockMutex(lock);
+        workers_running = 0;
+        SDL_CondBroadcast(cond);
+        SDL_UnlockMutex(lock);
+    }
+    for(int i = 0; i < worker_count; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+    worker_count = 0;
+    SDL_DestroyCond(cond);
+    SDL_DestroyMutex(lock);
+    cond = NULL;
+    lock = NULL;
+}
+
+/*
+ * Scales a whole frame. Scalers that can work on bands of rows get the frame split between the scaler
+ * threads; others scale it on the calling thread.
+ */
+int frame_scaler_run(scaler_plugin *scaler, const char *in, char *out, int w, int h, int factor) {
+    if(scaler->scale_rows == NULL) {
+        return scaler_scale(scaler, in, out, w, h, factor);
+    }
+
+    job.scaler = scaler;
+    job.in = in;
+    job.out = out;
+    job.w = w;
+    job.h = h;
+    job.factor = factor;
+    if(worker_count == 0) {
+        return frame_scaler_band(0);
+    }
+
+    SDL_LockMutex(lock);
+    bands_left = worker_count;
+    band_failed = 0;
+    job_serial++;
+    SDL_CondBroadcast(cond);
+    SDL_UnlockMutex(lock);
+
+    // The calling thread takes the first band
+    int ret = frame_scaler_band(0);
+
+    SDL_LockMutex(lock);
+    while(bands_left > 0) {
+        SDL_CondWait(cond, lock);
+    }
+    ret |= band_failed;
+    SDL_UnlockMutex(lock);
+    return ret;
+}
@@ -0,0 +1,10 @@
+#ifndef FRAME_SCALER_H
+#define FRAME_SCALER_H
+
+#include "plugins/scaler_plugin.h"
+
+int frame_scaler_init();
+void frame_scaler_close();
+int frame_scaler_run(scaler_plugin *scaler, const char *in, char *out, int w, int h, int factor);
+
+#endif // FRAME_SCALER_H
@@ -47,8 +47,41 @@ void image_clear(image *img, color c) {
     image_filled_rect(img, 0, 0, img->w, img->h, c);
 }
 
+// Fills pixels x0..x1 (inclusive, x0 <= x1) of a row.
+static void image_fill_row(image *img, int x0, int x1, int y, color c) {
+    if(x0 < 0 || y < 0 || x1 >= (int)img->w || y >= (int)img->h) {
+        // Out of bounds pixels get clamped by image_set_pixel
+        for(int x = x0; x <= x1; x++) {
+            image_set_pixel(img, x, y, c);
+        }
+        return;
+    }
+    char *dst = img->data + (y * img->w + x0) * 4;
+    for(int x = x0; x <= x1; x++) {
+        dst[0] = c.r;
+        dst[1] = c.g;
+        dst[2] = c.b;
+        dst[3] = c.a;
+        dst += 4;
+    }
+}
+
 // Bresenham
 void image_line(image *img, int x0, int y0, int x1, int y1, color c) {
+    // Straight lines are the common case (borders, bevels); skip the stepping for them.
+    if(y0 == y1) {
+        image_fill_row(img, (x0 < x1) ? x0 : x1, (x0 < x1) ? x1 : x0, y0, c);
+        return;
+    }
+    if(x0 == x1) {
+        int ys = (y0 < y1) ? y0 : y1;
+        int ye = (y0 < y1) ? y1 : y0;
+        for(int y = ys; y <= ye; y++) {
+            image_set_pixel(img, x0, y, c);
+        }
+        return;
+    }
+
     int dx = abs(x1 - x0);
     int sx = (x0 < x1) ? 1 : -1;
     int dy = abs(y1 - y0);
@@ -96,10 +129,11 @@ void image_rect_bevel(image *img, int x, int y, int w, int h, color ctop, color
 }
 
 void image_filled_rect(image *img, int x, int y, int w, int h, color c) {
+    if(w <= 0) {
+        return;
+    }
     for(int my = y; my < y + h; my++) {
-        for(int mx = x; mx < x + w; mx++) {
-            image_set_pixel(img, mx, my, c);
-        }
+        image_fill_row(img, x, x + w - 1, my, c);
     }
 }
 
@@ -0,0 +1,51 @@
+#include "video/screen_palette.h"
+
+// Shared by all palettes, so that a range version always refers to one set of colors
+static unsigned int last_version = 0;
+
+unsigned int screen_palette_new_version() {
+    return ++last_version;
+}
+
+// Returns the ranges that the given colors fall into
+palette_range_mask screen_palette_range_mask(int start, int count) {
+    palette_range_mask mask = 0;
+    if(count <= 0) {
+        return 0;
+    }
+    int first = (start < 0) ? 0 : start;
+    int last = (start + count > 256) ? 255 : start + count - 1;
+    for(int r = first >> PALETTE_RANGE_BITS; r <= last >> PALETTE_RANGE_BITS; r++) {
+        mask |= 1 << r;
+    }
+    return mask;
+}
+
+/*
+ * Marks the given colors as changed. Must be called after changing the palette data, so that textures
+ * using those colors get redrawn.
+ */
+void screen_palette_touch(screen_palette *pal, int start, int count) {
+    palette_range_mask mask = screen_palette_range_mask(start, count);
+    if(mask == 0) {
+        return;
+    }
+    unsigned int version = screen_palette_new_version();
+    for(int r = 0; r < PALETTE_RANGES; r++) {
+        if(mask & (1 << r)) {
+            pal->range_version[r] = version;
+        }
+    }
+    pal->version = version;
+}
+
+// Checks whether the colors of the given ranges are the same as when the range versions were taken.
+bool screen_palette_ranges_match(const screen_palette *pal, const unsigned int *range_version,
+                                 palette_range_mask ranges) {
+    for(int r = 0; r < PALETTE_RANGES; r++) {
+        if((ranges & (1 << r)) && pal->range_version[r] != range_version[r]) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,11 +1,27 @@
 #ifndef SCREEN_PALETTE_H
 #define SCREEN_PALETTE_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+// Palettes are versioned in ranges of 16 colors, so that effects on a few colors (eg. HAR flashes)
+// only affect the textures that use those colors.
+#define PALETTE_RANGE_BITS 4
+#define PALETTE_RANGE_SIZE (1 << PALETTE_RANGE_BITS)
+#define PALETTE_RANGES (256 / PALETTE_RANGE_SIZE)
+
+typedef uint16_t palette_range_mask; // One bit per palette range
+
 typedef struct {
     uint8_t data[256][3];
-    unsigned int version;
+    unsigned int version;                       // Changes whenever any of the colors change
+    unsigned int range_version[PALETTE_RANGES]; // Identifies the colors of the range; equal means same colors
 } screen_palette;
 
+unsigned int screen_palette_new_version();
+palette_range_mask screen_palette_range_mask(int start, int count);
+void screen_palette_touch(screen_palette *pal, int start, int count);
+bool screen_palette_ranges_match(const screen_palette *pal, const unsigned int *range_version,
+                                 palette_range_mask ranges);
+
 #endif // SCREEN_PALETTE_H
@@ -0,0 +1,171 @@
+#include "video/snapshot.h"
+#include "utils/allocator.h"
+#include <string.h>
+
+void snapshot_create(snapshot *snap) {
+    vector_create(&snap->cmds, sizeof(snapshot_cmd));
+    vector_create(&snap->palettes, sizeof(screen_palette));
+    vector_create(&snap->captures, sizeof(snapshot_capture));
+    vector_create(&snap->buffers, sizeof(char *));
+    vector_create(&snap->garbage, sizeof(snapshot_texture));
+    snap->has_frame = false;
+    snap->fade = 1.0f;
+    snap->move_x = 0;
+    snap->move_y = 0;
+    snap->ticks = 0;
+    snap->clear_tcache = false;
+}
+
+static void snapshot_free_buffers(snapshot *snap) {
+    for(unsigned int i = 0; i < vector_size(&snap->buffers); i++) {
+        char **buf = vector_get(&snap->buffers, i);
+        omf_free(*buf);
+    }
+    vector_clear(&snap->buffers);
+}
+
+void snapshot_free(snapshot *snap) {
+    snapshot_free_buffers(snap);
+    vector_free(&snap->cmds);
+    vector_free(&snap->palettes);
+    vector_free(&snap->captures);
+    vector_free(&snap->buffers);
+    vector_free(&snap->garbage);
+}
+
+/*
+ * Drops the recorded frame, but keeps the work that has to reach the renderer anyway.
+ */
+void snapshot_clear_frame(snapshot *snap) {
+    vector_clear(&snap->cmds);
+    vector_clear(&snap->palettes);
+    snapshot_free_buffers(snap);
+    snap->has_frame = false;
+}
+
+void snapshot_reset(snapshot *snap) {
+    snapshot_clear_frame(snap);
+    vector_clear(&snap->captures);
+    vector_clear(&snap->garbage);
+    snap->ticks = 0;
+    snap->clear_tcache = false;
+}
+
+/*
+ * Moves everything except the frame itself from src to dst. Used when a recorded frame is thrown away.
+ */
+void snapshot_move_work(snapshot *dst, snapshot *src) {
+    for(unsigned int i = 0; i < vector_size(&src->captures); i++) {
+        snapshot_capture capture = *(snapshot_capture *)vector_get(&src->captures, i);
+        capture.at = 0;
+        vector_append(&dst->captures, &capture);
+    }
+    for(unsigned int i = 0; i < vector_size(&src->garbage); i++) {
+        vector_append(&dst->garbage, vector_get(&src->garbage, i));
+    }
+    dst->ticks += src->ticks;
+    dst->clear_tcache = dst->clear_tcache || src->clear_tcache;
+    snapshot_reset(src);
+}
+
+snapshot_cmd *snapshot_add_cmd(snapshot *snap, uint8_t type) {
+    snapshot_cmd cmd;
+    memset(&cmd, 0, sizeof(snapshot_cmd));
+    cmd.type = type;
+    vector_append(&snap->cmds, &cmd);
+    return vector_get(&snap->cmds, vector_size(&snap->cmds) - 1);
+}
+
+unsigned int snapshot_add_palette(snapshot *snap, const screen_palette *pal) {
+    vector_append(&snap->palettes, pal);
+    return vector_size(&snap->palettes) - 1;
+}
+
+static char *snapshot_copy_buffer(snapshot *snap, const char *src, size_t size) {
+    char *buf = omf_calloc(1, size);
+    memcpy(buf, src, size);
+    vector_append(&snap->buffers, &buf);
+    return buf;
+}
+
+/*
+ * Points a recorded surface header at copies of its pixels, owned by the snapshot.
+ */
+void snapshot_own_pixels(snapshot *snap, surface *sur) {
+    size_t pixels = (size_t)sur->w * sur->h;
+    if(sur->data != NULL) {
+        sur->data = snapshot_copy_buffer(snap, sur->data, pixels * ((sur->type == SURFACE_TYPE_RGBA) ? 4 : 1));
+    }
+    if(sur->stencil != NULL) {
+        sur->stencil = snapshot_copy_buffer(snap, sur->stencil, pixels);
+    }
+}
+
+void snapshot_add_capture(snapshot *snap, surface *sur, const SDL_Rect *area) {
+    snapshot_capture capture;
+    capture.sur = sur;
+    capture.area = *area;
+    capture.at = vector_size(&snap->cmds);
+    vector_append(&snap->captures, &capture);
+}
+
+void snapshot_add_garbage(snapshot *snap, SDL_Texture *tex, unsigned int generation) {
+    snapshot_texture garbage;
+    garbage.tex = tex;
+    garbage.generation = generation;
+    vector_append(&snap->garbage, &garbage);
+}
+
+bool snapshot_references(const snapshot *snap, const void *key) {
+    for(unsigned int i = 0; i < vector_size(&snap->cmds); i++) {
+        const snapshot_cmd *cmd = vector_get(&snap->cmds, i);
+        if(cmd->key == key) {
+            return true;
+        }
+    }
+    for(unsigned int i = 0; i < vector_size(&snap->captures); i++) {
+        const snapshot_capture *capture = vector_get(&snap->captures, i);
+        if(capture->sur == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Makes the snapshot independent of a surface or video cache that is about to be freed. Surfaces get their
+ * pixels copied, and cache commands are dropped. The copies get a key of their own, so that they never
+ * match a new surface allocated at the same address.
+ */
+void snapshot_detach(snapshot *snap, const void *key) {
+    const snapshot_cmd *copy = NULL;
+    for(unsigned int i = 0; i < vector_size(&snap->cmds); i++) {
+        snapshot_cmd *cmd = vector_get(&snap->cmds, i);
+        if(cmd->key != key) {
+            continue;
+        }
+        if(cmd->type != SNAPSHOT_CMD_SPRITE && cmd->type != SNAPSHOT_CMD_BACKGROUND) {
+            cmd->type = SNAPSHOT_CMD_NONE;
+            cmd->key = NULL;
+            continue;
+        }
+        if(copy == NULL) {
+            snapshot_own_pixels(snap, &cmd->sur);
+            copy = cmd;
+        } else {
+            cmd->sur.data = copy->sur.data;
+            cmd->sur.stencil = copy->sur.stencil;
+        }
+        cmd->key = copy->sur.data;
+        cmd->sur.force_refresh = 1;
+    }
+
+    iterator it;
+    vector_iter_begin(&snap->captures, &it);
+    snapshot_capture *capture;
+    while((capture = iter_next(&it)) != NULL) {
+        if(capture->sur == key) {
+            vector_delete(&snap->captures, &it);
+        }
+    }
+}
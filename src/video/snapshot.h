@@ -0,0 +1,83 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "utils/vector.h"
+#include "video/color.h"
+#include "video/screen_palette.h"
+#include "video/surface.h"
+#include <SDL.h>
+
+/*
+ * Everything needed to render one frame. The simulation records draw calls into a snapshot, and after that
+ * it is left alone until the renderer is done with it. Surfaces are referenced by their pixel data, which
+ * must stay unchanged while the surface is alive; surfaces freed before the frame is rendered are detached
+ * from the snapshot with snapshot_detach().
+ */
+
+enum
+{
+    SNAPSHOT_CMD_NONE = 0,
+    SNAPSHOT_CMD_BACKGROUND,
+    SNAPSHOT_CMD_SPRITE,
+    SNAPSHOT_CMD_CACHE_BEGIN,
+    SNAPSHOT_CMD_CACHE_END,
+    SNAPSHOT_CMD_CACHE_RENDER,
+};
+
+typedef struct {
+    uint8_t type;
+    uint8_t blend_mode;    // SDL_BlendMode of the sprite
+    uint8_t flip;          // SDL_RendererFlip of the sprite
+    uint8_t opacity;       // Sprite alpha modulation
+    uint8_t pal_offset;    // Palette offset of the sprite
+    bool bg_separately;    // Whether the background goes to its own render target
+    uint16_t pal;          // Index of the palette to convert the surface with
+    color tint;            // Sprite color modulation
+    SDL_Rect dst;          // Destination, or the area to redraw for caches. In native coordinates.
+    const void *key;       // Texture cache key; the recorded surface, or the video cache
+    surface sur;           // Copy of the surface header. Refresh flag is the one at record time.
+} snapshot_cmd;
+
+typedef struct {
+    surface *sur;    // Surface to read the screen into
+    SDL_Rect area;   // Area to read, in window pixels
+    unsigned int at; // Amount of commands to execute before reading
+} snapshot_capture;
+
+typedef struct {
+    SDL_Texture *tex;
+    unsigned int generation;
+} snapshot_texture;
+
+typedef struct snapshot_t {
+    vector cmds;     // snapshot_cmd
+    vector palettes; // screen_palette, as they were when the commands were recorded
+    vector captures; // snapshot_capture, done in between the commands
+    vector buffers;  // char *; pixel data of detached surfaces
+    vector garbage;  // snapshot_texture; textures to destroy before the frame is drawn
+    bool has_frame;  // Whether a frame was recorded, or the snapshot only carries work for the renderer
+    float fade;
+    int move_x;
+    int move_y;
+    unsigned int ticks; // Texture cache ticks run since the previous snapshot
+    bool clear_tcache;  // Drop all cached textures before drawing
+} snapshot;
+
+void snapshot_create(snapshot *snap);
+void snapshot_free(snapshot *snap);
+void snapshot_clear_frame(snapshot *snap);
+void snapshot_reset(snapshot *snap);
+void snapshot_move_work(snapshot *dst, snapshot *src);
+
+snapshot_cmd *snapshot_add_cmd(snapshot *snap, uint8_t type);
+unsigned int snapshot_add_palette(snapshot *snap, const screen_palette *pal);
+void snapshot_own_pixels(snapshot *snap, surface *sur);
+void snapshot_add_capture(snapshot *snap, surface *sur, const SDL_Rect *area);
+void snapshot_add_garbage(snapshot *snap, SDL_Texture *tex, unsigned int generation);
+
+bool snapshot_references(const snapshot *snap, const void *key);
+void snapshot_detach(snapshot *snap, const void *key);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,185 @@
+#include "video/soft_render.h"
+#include "utils/allocator.h"
+#include <string.h>
+
+char *soft_layer_create() {
+    return omf_calloc(1, SOFT_LAYER_SIZE);
+}
+
+// Clears the area (or the whole layer, if NULL) to transparent black
+void soft_layer_clear(char *layer, const SDL_Rect *area) {
+    if(area == NULL) {
+        memset(layer, 0, SOFT_LAYER_SIZE);
+        return;
+    }
+    int x0 = (area->x > 0) ? area->x : 0;
+    int y0 = (area->y > 0) ? area->y : 0;
+    int x1 = (area->x + area->w < NATIVE_W) ? area->x + area->w : NATIVE_W;
+    int y1 = (area->y + area->h < NATIVE_H) ? area->y + area->h : NATIVE_H;
+    for(int y = y0; y < y1; y++) {
+        memset(layer + (y * NATIVE_W + x0) * 4, 0, (x1 - x0) * 4);
+    }
+}
+
+static inline void blend_pixel(uint8_t *out, int r, int g, int b, int a, SDL_BlendMode blend_mode) {
+    switch(blend_mode) {
+        case SDL_BLENDMODE_NONE:
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            out[3] = a;
+            break;
+        case SDL_BLENDMODE_ADD:
+            r = out[0] + r * a / 255;
+            g = out[1] + g * a / 255;
+            b = out[2] + b * a / 255;
+            out[0] = (r > 255) ? 255 : r;
+            out[1] = (g > 255) ? 255 : g;
+            out[2] = (b > 255) ? 255 : b;
+            break;
+        default:
+            if(a == 255) {
+                out[0] = r;
+                out[1] = g;
+                out[2] = b;
+                out[3] = 255;
+            } else if(a > 0) {
+                out[0] = (r * a + out[0] * (255 - a)) / 255;
+                out[1] = (g * a + out[1] * (255 - a)) / 255;
+                out[2] = (b * a + out[2] * (255 - a)) / 255;
+                out[3] = a + out[3] * (255 - a) / 255;
+            }
+            break;
+    }
+}
+
+/*
+ * Draws a surface to the layer, stretched to dst and clipped to clip (if not NULL). Palette surfaces are
+ * converted while drawing, the same way surface_to_rgba() does it.
+ */
+void soft_render_sprite(char *layer, const SDL_Rect *clip, const surface *sur, const screen_palette *pal,
+                        uint8_t pal_offset, const SDL_Rect *dst, SDL_RendererFlip flip, SDL_BlendMode blend_mode,
+                        uint8_t opacity, color tint) {
+    if(dst->w <= 0 || dst->h <= 0 || sur->w <= 0 || sur->h <= 0 || sur->data == NULL) {
+        return;
+    }
+
+    // Visible part of the destination
+    int x0 = (dst->x > 0) ? dst->x : 0;
+    int y0 = (dst->y > 0) ? dst->y : 0;
+    int x1 = (dst->x + dst->w < NATIVE_W) ? dst->x + dst->w : NATIVE_W;
+    int y1 = (dst->y + dst->h < NATIVE_H) ? dst->y + dst->h : NATIVE_H;
+    if(clip != NULL) {
+        x0 = (clip->x > x0) ? clip->x : x0;
+        y0 = (clip->y > y0) ? clip->y : y0;
+        x1 = (clip->x + clip->w < x1) ? clip->x + clip->w : x1;
+        y1 = (clip->y + clip->h < y1) ? clip->y + clip->h : y1;
+    }
+    if(x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    bool modulate = opacity != 0xFF || tint.r != 0xFF || tint.g != 0xFF || tint.b != 0xFF;
+    const uint8_t *src = (const uint8_t *)sur->data;
+    for(int y = y0; y < y1; y++) {
+        int sy = (y - dst->y) * sur->h / dst->h;
+        if(flip & SDL_FLIP_VERTICAL) {
+            sy = sur->h - 1 - sy;
+        }
+        uint8_t *out = (uint8_t *)layer + (y * NATIVE_W + x0) * 4;
+        for(int x = x0; x < x1; x++, out += 4) {
+            int sx = (x - dst->x) * sur->w / dst->w;
+            if(flip & SDL_FLIP_HORIZONTAL) {
+                sx = sur->w - 1 - sx;
+            }
+            int i = sy * sur->w + sx;
+            int r, g, b, a;
+            if(sur->type == SURFACE_TYPE_RGBA) {
+                r = src[i * 4 + 0];
+                g = src[i * 4 + 1];
+                b = src[i * 4 + 2];
+                a = src[i * 4 + 3];
+            } else {
+                a = (sur->stencil[i] == 1) ? 0xFF : 0;
+                if(a == 0 && blend_mode != SDL_BLENDMODE_NONE) {
+                    continue;
+                }
+                uint8_t idx = src[i];
+                if(idx < 48) {
+                    idx += pal_offset;
+                }
+                r = pal->data[idx][0];
+                g = pal->data[idx][1];
+                b = pal->data[idx][2];
+            }
+            if(modulate) {
+                r = r * tint.r / 255;
+                g = g * tint.g / 255;
+                b = b * tint.b / 255;
+                a = a * opacity / 255;
+            }
+            blend_pixel(out, r, g, b, a, blend_mode);
+        }
+    }
+}
+
+// Draws a layer that was drawn onto a transparent one (so its colors are already multiplied by alpha)
+void soft_render_layer(char *dst, const char *src) {
+    uint8_t *out = (uint8_t *)dst;
+    const uint8_t *in = (const uint8_t *)src;
+    for(int i = 0; i < NATIVE_W * NATIVE_H; i++, out += 4, in += 4) {
+        int a = in[3];
+        if(a == 0) {
+            continue;
+        }
+        for(int c = 0; c < 4; c++) {
+            out[c] = in[c] + out[c] * (255 - a) / 255;
+        }
+    }
+}
+
+/*
+ * Composites the background and foreground layers to an opaque frame. Layers are offset by the screen
+ * shake, and darkened by fade.
+ */
+void soft_render_compose(char *out, const char *bg, const char *fg, int move_x, int move_y, uint8_t fade) {
+    memset(out, 0, SOFT_LAYER_SIZE);
+    for(int y = 0; y < NATIVE_H; y++) {
+        int sy = y - move_y;
+        for(int x = 0; x < NATIVE_W; x++) {
+            int sx = x - move_x;
+            uint8_t *o = (uint8_t *)out + (y * NATIVE_W + x) * 4;
+            if(sy < 0 || sy >= NATIVE_H || sx < 0 || sx >= NATIVE_W) {
+                // Shaken off the layers; opaque black
+                o[3] = 0xFF;
+                continue;
+            }
+            const uint8_t *b = (const uint8_t *)bg + (sy * NATIVE_W + sx) * 4;
+            const uint8_t *f = (const uint8_t *)fg + (sy * NATIVE_W + sx) * 4;
+            int a = f[3];
+            for(int c = 0; c < 3; c++) {
+                int under = b[c] * fade / 255;
+                int over = f[c] * fade / 255;
+                o[c] = (over * a + under * (255 - a)) / 255;
+            }
+            o[3] = 0xFF;
+        }
+    }
+}
+
+// Copies an area of the layer to a RGBA buffer of the same size. Parts outside of the layer are left alone.
+void soft_layer_read(const char *layer, const SDL_Rect *area, char *out) {
+    for(int y = 0; y < area->h; y++) {
+        int ly = area->y + y;
+        if(ly < 0 || ly >= NATIVE_H) {
+            continue;
+        }
+        for(int x = 0; x < area->w; x++) {
+            int lx = area->x + x;
+            if(lx < 0 || lx >= NATIVE_W) {
+                continue;
+            }
+            memcpy(out + (y * area->w + x) * 4, layer + (ly * NATIVE_W + lx) * 4, 4);
+        }
+    }
+}
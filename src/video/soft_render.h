@@ -0,0 +1,26 @@
+#ifndef SOFT_RENDER_H
+#define SOFT_RENDER_H
+
+#include "video/color.h"
+#include "video/screen_palette.h"
+#include "video/surface.h"
+#include "video/video.h"
+#include <SDL.h>
+
+/*
+ * Compositing in CPU memory. Layers are NATIVE_W x NATIVE_H pixels, in the same RGBA byte order the texture
+ * cache uploads surfaces in, and blending follows what SDL does with the render targets.
+ */
+
+#define SOFT_LAYER_SIZE (NATIVE_W * NATIVE_H * 4)
+
+char *soft_layer_create();
+void soft_layer_clear(char *layer, const SDL_Rect *area);
+void soft_render_sprite(char *layer, const SDL_Rect *clip, const surface *sur, const screen_palette *pal,
+                        uint8_t pal_offset, const SDL_Rect *dst, SDL_RendererFlip flip, SDL_BlendMode blend_mode,
+                        uint8_t opacity, color tint);
+void soft_render_layer(char *dst, const char *src);
+void soft_render_compose(char *out, const char *bg, const char *fg, int move_x, int move_y, uint8_t fade);
+void soft_layer_read(const char *layer, const SDL_Rect *area, char *out);
+
+#endif // SOFT_RENDER_H
@@ -1,9 +1,15 @@
 #include "video/surface.h"
 #include "utils/allocator.h"
+#include "video/video.h"
 #include <stdlib.h>
 #include <string.h>
 #include <utils/log.h>
 
+// Frames that are recorded, but not yet rendered, must keep seeing the old pixels
+static void surface_modify(surface *sur) {
+    video_forget_surface(sur);
+}
+
 void surface_create(surface *sur, int type, int w, int h) {
     if(type == SURFACE_TYPE_RGBA) {
         sur->data = omf_calloc(1, w * h * 4);
@@ -16,6 +22,24 @@ void surface_create(surface *sur, int type, int w, int h) {
     sur->h = h;
     sur->type = type;
     sur->force_refresh = 0;
+    sur->in_arena = 0;
+}
+
+// Creates a surface with pixel data allocated from the given allocator arena.
+// The data will be released along with the arena; surface_free() will not touch it.
+void surface_create_in_arena(surface *sur, int arena_id, int type, int w, int h) {
+    if(type == SURFACE_TYPE_RGBA) {
+        sur->data = omf_arena_calloc(arena_id, 1, w * h * 4);
+        sur->stencil = NULL;
+    } else {
+        sur->data = omf_arena_calloc(arena_id, 1, w * h);
+        sur->stencil = omf_arena_calloc(arena_id, 1, w * h);
+    }
+    sur->w = w;
+    sur->h = h;
+    sur->type = type;
+    sur->force_refresh = 0;
+    sur->in_arena = 1;
 }
 
 void surface_force_refresh(surface *sur) {
@@ -46,6 +70,12 @@ int surface_to_image(surface *sur, image *img) {
 }
 
 void surface_free(surface *sur) {
+    if(sur->in_arena) {
+        sur->data = NULL;
+        sur->stencil = NULL;
+        return;
+    }
+    video_forget_surface(sur);
     omf_free(sur->data);
     omf_free(sur->stencil);
 }
@@ -55,6 +85,7 @@ int surface_get_type(surface *sur) {
 }
 
 void surface_clear(surface *sur) {
+    surface_modify(sur);
     if(sur->type == SURFACE_TYPE_RGBA) {
         memset(sur->data, 0, sur->w * sur->h * 4);
     } else {
@@ -64,6 +95,7 @@ void surface_clear(surface *sur) {
 
 // Fills the whole surface with color
 void surface_fill(surface *sur, color c) {
+    surface_modify(sur);
     // Only for RGBA for now
     if(sur->type == SURFACE_TYPE_PALETTE) {
         return;
@@ -79,6 +111,7 @@ void surface_fill(surface *sur, color c) {
 }
 
 void surface_copy_ex(surface *dst, surface *src) {
+    surface_modify(dst);
     if(src->type != dst->type) {
         return;
     }
@@ -105,6 +138,7 @@ void surface_copy(surface *dst, surface *src) {
 
 // Copies a an area of old surface to an entirely new surface
 void surface_sub(surface *dst, surface *src, int dst_x, int dst_y, int src_x, int src_y, int w, int h, int method) {
+    surface_modify(dst);
 
     // Make sure the source and destination are of the same type.
     if(dst->type != src->type) {
@@ -137,6 +171,7 @@ void surface_sub(surface *dst, surface *src, int dst_x, int dst_y, int src_x, in
 
 void surface_additive_blit(surface *dst, surface *src, int dst_x, int dst_y, palette *remap_pal,
                            SDL_RendererFlip flip) {
+    surface_modify(dst);
 
     // Both surfaces must be paletted
     if(dst->type != SURFACE_TYPE_PALETTE || src->type != SURFACE_TYPE_PALETTE) {
@@ -170,6 +205,7 @@ void surface_additive_blit(surface *dst, surface *src, int dst_x, int dst_y, pal
 }
 
 void surface_rgba_blit(surface *dst, const surface *src, int dst_x, int dst_y) {
+    surface_modify(dst);
     // Both surfaces must be rgba
     if(dst->type != SURFACE_TYPE_RGBA || src->type != SURFACE_TYPE_RGBA) {
         return;
@@ -196,6 +232,7 @@ void surface_rgba_blit(surface *dst, const surface *src, int dst_x, int dst_y) {
 }
 
 void surface_alpha_blit(surface *dst, surface *src, int dst_x, int dst_y, SDL_RendererFlip flip) {
+    surface_modify(dst);
 
     // Both surfaces must be paletted
     if(dst->type != SURFACE_TYPE_PALETTE || src->type != SURFACE_TYPE_PALETTE) {
@@ -234,10 +271,10 @@ void surface_convert_to_rgba(surface *sur, screen_palette *pal, int pal_offset)
     surface_to_rgba(sur, pixels, pal, NULL, pal_offset);
 
     // Free old data
-    omf_free(sur->data);
-    omf_free(sur->stencil);
+    surface_free(sur);
     sur->data = pixels;
     sur->type = SURFACE_TYPE_RGBA;
+    sur->in_arena = 0;
 }
 
 // Creates a new RGBA surface
@@ -270,6 +307,31 @@ void surface_to_rgba(surface *sur, char *dst, screen_palette *pal, char *remap_t
     }
 }
 
+// Returns the palette ranges surface_to_rgba() reads colors from, with the same remapping and offset.
+palette_range_mask surface_palette_ranges(const surface *sur, const char *remap_table, uint8_t pal_offset) {
+    if(sur->type == SURFACE_TYPE_RGBA) {
+        return 0;
+    }
+
+    bool used[256] = {false};
+    for(int i = 0; i < sur->w * sur->h; i++) {
+        used[(uint8_t)sur->data[i]] = true;
+    }
+
+    palette_range_mask mask = 0;
+    for(int i = 0; i < 256; i++) {
+        if(!used[i]) {
+            continue;
+        }
+        uint8_t idx = (remap_table != NULL) ? (uint8_t)remap_table[i] : i;
+        if(idx < 48) {
+            idx += pal_offset;
+        }
+        mask |= 1 << (idx >> PALETTE_RANGE_BITS);
+    }
+    return mask;
+}
+
 // Copies surface to an existing texture.
 // Note, texture has to be streaming type
 int surface_to_texture(surface *src, SDL_Texture *tex, screen_palette *pal, char *remap_table, uint8_t pal_offset) {
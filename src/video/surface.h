@@ -13,6 +13,7 @@ typedef struct {
     char *data;
     char *stencil;
     uint8_t force_refresh;
+    uint8_t in_arena; // Data is owned by an allocator arena, and must not be freed separately
 } surface;
 
 enum
@@ -28,6 +29,7 @@ enum
 };
 
 void surface_create(surface *sur, int type, int w, int h);
+void surface_create_in_arena(surface *sur, int arena_id, int type, int w, int h);
 void surface_force_refresh(surface *sur);
 void surface_create_from_image(surface *sur, image *img);
 void surface_create_from_data(surface *sur, int type, int w, int h, const char *src);
@@ -41,6 +43,7 @@ void surface_sub(surface *dst, surface *src, int dst_x, int dst_y, int src_x, in
 void surface_convert_to_rgba(surface *sur, screen_palette *pal, int pal_offset);
 int surface_get_type(surface *sur);
 void surface_to_rgba(surface *sur, char *dst, screen_palette *pal, char *remap_table, uint8_t pal_offset);
+palette_range_mask surface_palette_ranges(const surface *sur, const char *remap_table, uint8_t pal_offset);
 void surface_additive_blit(surface *dst, surface *src, int dst_x, int dst_y, palette *remap_pal, SDL_RendererFlip flip);
 void surface_rgba_blit(surface *dst, const surface *src, int dst_x, int dst_y);
 void surface_alpha_blit(surface *dst, surface *src, int dst_x, int dst_y, SDL_RendererFlip flip);
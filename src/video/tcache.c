@@ -1,13 +1,14 @@
 #include "video/tcache.h"
 #include "utils/allocator.h"
-#include "utils/hashmap.h"
+#include "utils/flatmap.h"
 #include "utils/log.h"
 #include <stdlib.h>
+#include <string.h>
 
 #define CACHE_LIFETIME 300
 
 typedef struct tcache_entry_key_t {
-    surface *c_surface;
+    const void *c_surface;
     char *c_remap_table;
     uint16_t w, h;
     uint8_t c_pal_offset;
@@ -16,16 +17,16 @@ typedef struct tcache_entry_key_t {
 typedef struct tcache_entry_value_t {
     SDL_Texture *tex;
     unsigned int age;
-    unsigned int pal_version;
+    palette_range_mask pal_ranges;              // Palette ranges the texture was drawn with
+    unsigned int range_version[PALETTE_RANGES]; // Versions of the palette ranges at the time
 } tcache_entry_value;
 
 typedef struct tcache_t {
-    hashmap entries;
+    flatmap entries;
     unsigned int hits;
     unsigned int misses;
     unsigned int old_frees;
-    uint8_t scale_factor;
-    scaler_plugin *scaler;
+    unsigned int frame_misses;
     SDL_Renderer *renderer;
 } tcache;
 
@@ -33,57 +34,48 @@ static tcache *cache = NULL;
 
 // Helper method for getting cache entry
 tcache_entry_value *tcache_add_entry(tcache_entry_key *key, tcache_entry_value *val) {
-    return hashmap_put(&cache->entries, (void *)key, sizeof(tcache_entry_key), (void *)val, sizeof(tcache_entry_value));
+    return flatmap_put(&cache->entries, key, val);
 }
 
 // Helper method for setting cache entry
 tcache_entry_value *tcache_get_entry(tcache_entry_key *key) {
-    tcache_entry_value *val = NULL;
-    unsigned int tmp_size;
-    hashmap_get(&cache->entries, (void *)key, sizeof(tcache_entry_key), (void **)&val, &tmp_size);
-    return val;
+    return flatmap_get(&cache->entries, key);
 }
 
-void tcache_init(SDL_Renderer *renderer, int scale_factor, scaler_plugin *scaler) {
+void tcache_init(SDL_Renderer *renderer) {
     cache = omf_calloc(1, sizeof(tcache));
-    hashmap_create(&cache->entries, 6);
+    flatmap_create(&cache->entries, sizeof(tcache_entry_key), sizeof(tcache_entry_value), 6);
     cache->renderer = renderer;
-    cache->scaler = scaler;
-    cache->scale_factor = scale_factor;
     cache->hits = 0;
     cache->old_frees = 0;
     cache->misses = 0;
     DEBUG("Texture cache initialized.");
 }
 
-void tcache_reinit(SDL_Renderer *renderer, int scale_factor, scaler_plugin *scaler) {
+void tcache_reinit(SDL_Renderer *renderer) {
     cache->renderer = renderer;
-    cache->scaler = scaler;
-    cache->scale_factor = scale_factor;
     tcache_clear();
 }
 
 void tcache_clear() {
     iterator it;
-    hashmap_iter_begin(&cache->entries, &it);
-    hashmap_pair *pair;
-    while((pair = iter_next(&it)) != NULL) {
-        tcache_entry_value *entry = pair->val;
+    flatmap_iter_begin(&cache->entries, &it);
+    tcache_entry_value *entry;
+    while((entry = iter_next(&it)) != NULL) {
         SDL_DestroyTexture(entry->tex);
     }
-    hashmap_clear(&cache->entries);
+    flatmap_clear(&cache->entries);
 }
 
 void tcache_tick() {
     iterator it;
-    hashmap_iter_begin(&cache->entries, &it);
-    hashmap_pair *pair;
-    while((pair = iter_next(&it)) != NULL) {
-        tcache_entry_value *entry = pair->val;
+    flatmap_iter_begin(&cache->entries, &it);
+    tcache_entry_value *entry;
+    while((entry = iter_next(&it)) != NULL) {
         entry->age++;
         if(entry->age > CACHE_LIFETIME) {
             SDL_DestroyTexture(entry->tex);
-            hashmap_delete(&cache->entries, &it);
+            flatmap_delete(&cache->entries, &it);
             cache->old_frees++;
         }
     }
@@ -95,11 +87,22 @@ void tcache_close() {
     DEBUG(" * Hits:      %d", cache->hits);
     DEBUG(" * Old frees: %d", cache->old_frees);
     tcache_clear();
-    hashmap_free(&cache->entries);
+    flatmap_free(&cache->entries);
     omf_free(cache);
 }
 
-SDL_Texture *tcache_get(surface *sur, screen_palette *pal, char *remap_table, uint8_t pal_offset) {
+// Returns the amount of misses since the last call
+unsigned int tcache_take_misses() {
+    unsigned int misses = cache->frame_misses;
+    cache->frame_misses = 0;
+    return misses;
+}
+
+/*
+ * Returns a texture of the surface. The texture is cached by the given key, which is normally the surface
+ * itself; sur may be a copy of the surface header.
+ */
+SDL_Texture *tcache_get(const void *key_id, surface *sur, screen_palette *pal, char *remap_table, uint8_t pal_offset) {
     if(sur == NULL) {
         DEBUG("Invalid surface requested from tcache: surface is NULL.");
         return NULL;
@@ -115,14 +118,16 @@ SDL_Texture *tcache_get(surface *sur, screen_palette *pal, char *remap_table, ui
     memset(&key, 0, sizeof(tcache_entry_key));
     key.c_pal_offset = (sur->type == SURFACE_TYPE_RGBA) ? 0 : pal_offset;
     key.c_remap_table = (sur->type == SURFACE_TYPE_RGBA) ? 0 : remap_table;
-    key.c_surface = sur;
+    key.c_surface = key_id;
     key.w = sur->w;
     key.h = sur->h;
 
     // Attempt to find appropriate surface
-    // If surface is cacheable and hasn't changed, just return here.
+    // If surface is cacheable and hasn't changed, just return here. Palette changes only matter if they hit
+    // colors the surface uses.
     tcache_entry_value *val = tcache_get_entry(&key);
-    if(val != NULL && (val->pal_version == pal->version || sur->type == SURFACE_TYPE_RGBA) && !sur->force_refresh) {
+    if(val != NULL && !sur->force_refresh &&
+       (sur->type == SURFACE_TYPE_RGBA || screen_palette_ranges_match(pal, val->range_version, val->pal_ranges))) {
         val->age = 0;
         cache->hits++;
         return val->tex;
@@ -136,35 +141,24 @@ SDL_Texture *tcache_get(surface *sur, screen_palette *pal, char *remap_table, ui
     if(val == NULL) {
         tcache_entry_value new_entry;
         new_entry.age = 0;
-        new_entry.pal_version = pal->version;
         new_entry.tex = SDL_CreateTexture(cache->renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING,
-                                          sur->w * cache->scale_factor, sur->h * cache->scale_factor);
+                                          sur->w, sur->h);
         SDL_SetTextureBlendMode(new_entry.tex, SDL_BLENDMODE_BLEND);
         val = tcache_add_entry(&key, &new_entry);
     }
 
     // We have a texture either from the cache, or we just created one.
     // Either one, it needs to be updated. Let's do it now.
-    // Also, scale surface if necessary
-    if(cache->scale_factor > 1) {
-        char *raw = omf_calloc(1, sur->w * sur->h * 4);
-        surface scaled;
-        surface_create(&scaled, SURFACE_TYPE_RGBA, sur->w * cache->scale_factor, sur->h * cache->scale_factor);
-
-        surface_to_rgba(sur, raw, pal, remap_table, pal_offset);
-        scaler_scale(cache->scaler, raw, scaled.data, sur->w, sur->h, cache->scale_factor);
-        surface_to_texture(&scaled, val->tex, pal, remap_table, pal_offset);
-        surface_free(&scaled);
-        omf_free(raw);
-    } else {
-        surface_to_texture(sur, val->tex, pal, remap_table, pal_offset);
-    }
+    // Scaling is done later for the whole frame.
+    surface_to_texture(sur, val->tex, pal, remap_table, pal_offset);
 
-    // Set correct age and palette version
+    // Set correct age and palette versions
     val->age = 0;
-    val->pal_version = pal->version;
+    val->pal_ranges = surface_palette_ranges(sur, remap_table, key.c_pal_offset);
+    memcpy(val->range_version, pal->range_version, sizeof(val->range_version));
 
     // Do some statistics stuff
     cache->misses++;
+    cache->frame_misses++;
     return val->tex;
 }
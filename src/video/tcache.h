@@ -1,16 +1,16 @@
 #ifndef TCACHE_H
 #define TCACHE_H
 
-#include "plugins/scaler_plugin.h"
 #include "video/screen_palette.h"
 #include "video/surface.h"
 #include <SDL.h>
 
-void tcache_init(SDL_Renderer *renderer, int scale_factor, scaler_plugin *scaler);
-void tcache_reinit(SDL_Renderer *renderer, int scale_factor, scaler_plugin *scaler);
+void tcache_init(SDL_Renderer *renderer);
+void tcache_reinit(SDL_Renderer *renderer);
 void tcache_close();
 void tcache_clear();
-SDL_Texture *tcache_get(surface *sur, screen_palette *pal, char *remap_table, uint8_t pal_offset);
+SDL_Texture *tcache_get(const void *key_id, surface *sur, screen_palette *pal, char *remap_table, uint8_t pal_offset);
+unsigned int tcache_take_misses();
 void tcache_tick();
 
 #endif // TCACHE_H
@@ -8,13 +8,61 @@
 #include "utils/allocator.h"
 #include "utils/list.h"
 #include "utils/log.h"
+#include "utils/profiler.h"
+#include "video/capture.h"
+#include "video/frame_scaler.h"
 #include "video/image.h"
+#include "video/snapshot.h"
+#include "video/soft_render.h"
 #include "video/tcache.h"
 #include "video/video.h"
 #include "video/video_state.h"
 
 static video_state state;
 
+struct video_cache_t {
+    // Recording side
+    unsigned int generation;                    // state.target_generation the recorded contents are for
+    palette_range_mask pal_ranges;              // Palette ranges the contents were drawn with
+    unsigned int range_version[PALETTE_RANGES]; // Versions of the screen palette ranges at the time
+    bool valid;
+
+    // Render side
+    SDL_Texture *tex;
+    unsigned int tex_generation; // state.target_generation at the time tex was created
+    char *pixels;                // Contents when rendering in software
+};
+
+/*
+ * Frames are recorded into snapshots by the game, and rendered from them. Without a render thread, this
+ * happens right away in video_render_finish(). With one, finished snapshots are handed over to
+ * video_render_frame(), and the game goes on with the next one.
+ */
+typedef struct {
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    bool threaded;
+    snapshot snapshots[3];
+    snapshot *recording; // Being recorded by the game
+    snapshot *pending;   // Finished, and waiting for the render thread. NULL if none.
+    snapshot *executing; // Being rendered. NULL if none.
+
+    // Video settings change requested by the game, applied by the render thread
+    bool reinit_pending;
+    int reinit_w;
+    int reinit_h;
+    int reinit_fs;
+    int reinit_vsync;
+    int reinit_scale_factor;
+    char reinit_scaler[17];
+
+    // Statistics of rendered frames, not yet handed to the profiler
+    unsigned int draw_calls;
+    unsigned int tcache_misses;
+} video_handoff;
+
+static video_handoff handoff;
+
 void reset_targets() {
     if(state.fg_target != NULL) {
         SDL_DestroyTexture(state.fg_target);
@@ -22,12 +70,47 @@ void reset_targets() {
     if(state.bg_target != NULL) {
         SDL_DestroyTexture(state.bg_target);
     }
-    state.fg_target = SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET,
-                                        NATIVE_W * state.scale_factor, NATIVE_H * state.scale_factor);
-    state.bg_target = SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET,
-                                        NATIVE_W * state.scale_factor, NATIVE_H * state.scale_factor);
+    // Everything is drawn at native resolution. Scaling is done once for the whole frame when presenting.
+    state.fg_target =
+        SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, NATIVE_W, NATIVE_H);
+    state.bg_target =
+        SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, NATIVE_W, NATIVE_H);
     SDL_SetTextureBlendMode(state.bg_target, SDL_BLENDMODE_NONE);
     SDL_SetTextureBlendMode(state.fg_target, SDL_BLENDMODE_BLEND);
+    state.draw_target = state.fg_target;
+
+    // Any video caches belonged to the old targets, and need to be redrawn.
+    SDL_AtomicIncRef(&state.target_generation);
+    SDL_AtomicSet(&state.cache_unsupported, 0);
+
+    // Capture target is created when a capture stream or the scaler needs it.
+    if(state.capture_target != NULL) {
+        SDL_DestroyTexture(state.capture_target);
+        state.capture_target = NULL;
+    }
+
+    // Scaled frames are uploaded here
+    if(state.scaled_target != NULL) {
+        SDL_DestroyTexture(state.scaled_target);
+        state.scaled_target = NULL;
+    }
+    if(state.soft_target != NULL) {
+        SDL_DestroyTexture(state.soft_target);
+        state.soft_target = NULL;
+    }
+    if(state.software) {
+        state.soft_target =
+            SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, NATIVE_W, NATIVE_H);
+    }
+    if(state.scale_factor > 1) {
+        state.scaled_target = SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING,
+                                                NATIVE_W * state.scale_factor, NATIVE_H * state.scale_factor);
+        state.scaled_frame =
+            omf_realloc(state.scaled_frame, NATIVE_W * NATIVE_H * 4 * state.scale_factor * state.scale_factor);
+        if(state.native_frame == NULL) {
+            state.native_frame = omf_calloc(1, NATIVE_W * NATIVE_H * 4);
+        }
+    }
 }
 
 int video_load_scaler(const char *name, int scale_factor) {
@@ -52,9 +135,21 @@ int video_init(int window_w, int window_h, int fullscreen, int vsync, const char
     state.fade = 1.0f;
     state.fg_target = NULL;
     state.bg_target = NULL;
+    state.capture_target = NULL;
+    state.scaled_target = NULL;
+    state.native_frame = NULL;
+    state.scaled_frame = NULL;
+    state.software = false;
+    state.soft_fg = NULL;
+    state.soft_bg = NULL;
+    state.soft_target = NULL;
     state.target_move_x = 0;
     state.target_move_y = 0;
     state.render_bg_separately = true;
+    state.offline = false;
+    state.clip_enabled = false;
+    state.screen_pal_index = -1;
+    state.extra_pal_index = -1;
 
     // Load scaler (if any)
     memset(state.scaler_name, 0, sizeof(state.scaler_name));
@@ -73,6 +168,7 @@ int video_init(int window_w, int window_h, int fullscreen, int vsync, const char
     state.screen_palette = omf_calloc(1, sizeof(screen_palette));
     state.extra_palette->version = 0;
     state.screen_palette->version = 1;
+    memset(state.base_range_version, 0, sizeof(state.base_range_version));
 
     // Form title string
     char title[32];
@@ -120,7 +216,28 @@ int video_init(int window_w, int window_h, int fullscreen, int vsync, const char
     reset_targets();
 
     // Init texture cache
-    tcache_init(state.renderer, state.scale_factor, &state.scaler);
+    tcache_init(state.renderer);
+
+    // Scaler threads
+    if(frame_scaler_init()) {
+        return 1;
+    }
+
+    // Frame snapshots
+    handoff.lock = SDL_CreateMutex();
+    handoff.cond = SDL_CreateCond();
+    if(handoff.lock == NULL || handoff.cond == NULL) {
+        PERROR("Could not create frame lock: %s", SDL_GetError());
+        return 1;
+    }
+    for(int i = 0; i < 3; i++) {
+        snapshot_create(&handoff.snapshots[i]);
+    }
+    handoff.recording = &handoff.snapshots[0];
+    handoff.pending = NULL;
+    handoff.executing = NULL;
+    handoff.threaded = false;
+    handoff.reinit_pending = false;
 
     // Get renderer data
     SDL_RendererInfo rinfo;
@@ -136,6 +253,19 @@ int video_init(int window_w, int window_h, int fullscreen, int vsync, const char
     return 0;
 }
 
+/*
+ * Sets up video for offline rendering: a hidden window at native resolution, and frames are never
+ * presented. Combined with the software renderer, this works without a display.
+ */
+int video_init_offline() {
+    if(video_init(NATIVE_W, NATIVE_H, 0, 0, "", 1)) {
+        return 1;
+    }
+    SDL_HideWindow(state.window);
+    state.offline = true;
+    return 0;
+}
+
 void video_reinit_renderer() {
     // Clear old texture cache entries
     tcache_clear();
@@ -150,13 +280,14 @@ void video_reinit_renderer() {
     }
     state.renderer = SDL_CreateRenderer(state.window, -1, renderer_flags);
     SDL_RenderSetLogicalSize(state.renderer, NATIVE_W * state.scale_factor, NATIVE_H * state.scale_factor);
-    tcache_reinit(state.renderer, state.scale_factor, &state.scaler);
+    tcache_reinit(state.renderer);
 
     // Reset rendertarget
     reset_targets();
 }
 
-int video_reinit(int window_w, int window_h, int fullscreen, int vsync, const char *scaler_name, int scale_factor) {
+static int video_apply_settings(int window_w, int window_h, int fullscreen, int vsync, const char *scaler_name,
+                                int scale_factor) {
 
     // Tells if something has changed in video settings
     int changed = 0;
@@ -198,11 +329,13 @@ int video_reinit(int window_w, int window_h, int fullscreen, int vsync, const ch
         changed = 1;
     }
 
-    // Set video state
+    // Set video state. The game thread may be reading it.
+    SDL_LockMutex(handoff.lock);
     state.vsync = vsync;
     state.fs = fullscreen;
     state.w = window_w;
     state.h = window_h;
+    SDL_UnlockMutex(handoff.lock);
 
     // Load scaler
     if(video_load_scaler(scaler_name, scale_factor)) {
@@ -221,12 +354,51 @@ int video_reinit(int window_w, int window_h, int fullscreen, int vsync, const ch
     return 0;
 }
 
+int video_reinit(int window_w, int window_h, int fullscreen, int vsync, const char *scaler_name, int scale_factor) {
+    if(!handoff.threaded) {
+        return video_apply_settings(window_w, window_h, fullscreen, vsync, scaler_name, scale_factor);
+    }
+
+    // The renderer belongs to the render thread; it picks the change up before the next frame.
+    SDL_LockMutex(handoff.lock);
+    handoff.reinit_pending = true;
+    handoff.reinit_w = window_w;
+    handoff.reinit_h = window_h;
+    handoff.reinit_fs = fullscreen;
+    handoff.reinit_vsync = vsync;
+    handoff.reinit_scale_factor = scale_factor;
+    memset(handoff.reinit_scaler, 0, sizeof(handoff.reinit_scaler));
+    strncpy(handoff.reinit_scaler, scaler_name, sizeof(handoff.reinit_scaler) - 1);
+    SDL_UnlockMutex(handoff.lock);
+    return 0;
+}
+
+static void apply_pending_settings() {
+    SDL_LockMutex(handoff.lock);
+    if(!handoff.reinit_pending) {
+        SDL_UnlockMutex(handoff.lock);
+        return;
+    }
+    handoff.reinit_pending = false;
+    int w = handoff.reinit_w;
+    int h = handoff.reinit_h;
+    int fs = handoff.reinit_fs;
+    int vsync = handoff.reinit_vsync;
+    int scale_factor = handoff.reinit_scale_factor;
+    char scaler_name[sizeof(handoff.reinit_scaler)];
+    memcpy(scaler_name, handoff.reinit_scaler, sizeof(scaler_name));
+    SDL_UnlockMutex(handoff.lock);
+
+    video_apply_settings(w, h, fs, vsync, scaler_name, scale_factor);
+}
+
 void video_move_target(int x, int y) {
-    state.target_move_x = x * state.scale_factor;
-    state.target_move_y = y * state.scale_factor;
+    state.target_move_x = x;
+    state.target_move_y = y;
 }
 
 void video_get_state(int *w, int *h, int *fs, int *vsync) {
+    SDL_LockMutex(handoff.lock);
     if(w != NULL) {
         *w = state.w;
     }
@@ -239,25 +411,22 @@ void video_get_state(int *w, int *h, int *fs, int *vsync) {
     if(vsync != NULL) {
         *vsync = state.vsync;
     }
+    SDL_UnlockMutex(handoff.lock);
 }
 
 void video_set_fade(float fade) {
     state.fade = fade;
 }
 
-int video_screenshot(image *img) {
-    image_create(img, state.w, state.h);
-    int ret = SDL_RenderReadPixels(state.renderer, NULL, SDL_PIXELFORMAT_ABGR8888, img->data, img->w * 4);
-    if(ret != 0) {
-        PERROR("Unable to read pixels from rendertarget: %s", SDL_GetError());
-        return 1;
-    }
-    return 0;
-}
-
+/*
+ * Captures an area of the screen into a new surface. The pixels are read before the next frame is drawn,
+ * so the surface stays blank until then.
+ */
 int video_area_capture(surface *sur, int x, int y, int w, int h) {
+    SDL_LockMutex(handoff.lock);
     float scale_x = (float)state.w / NATIVE_W;
     float scale_y = (float)state.h / NATIVE_H;
+    SDL_UnlockMutex(handoff.lock);
 
     // Correct position (take scaling into account)
     SDL_Rect r;
@@ -266,25 +435,34 @@ int video_area_capture(surface *sur, int x, int y, int w, int h) {
     r.w = w * scale_x;
     r.h = h * scale_y;
 
-    // Create a new surface
+    // Create a new surface. It may reuse the address of an older capture, so make sure it gets uploaded.
     surface_create(sur, SURFACE_TYPE_RGBA, r.w, r.h);
+    surface_force_refresh(sur);
+    snapshot_add_capture(handoff.recording, sur, &r);
+    return 0;
+}
 
-    // Read pixels
-    int ret = SDL_RenderReadPixels(state.renderer, &r, SDL_PIXELFORMAT_ABGR8888, sur->data, sur->w * 4);
-    if(ret != 0) {
-        surface_free(sur);
-        PERROR("Unable to read pixels from renderer: %s", SDL_GetError());
-        return 1;
+// Copies the given range of the base palette to the screen palettes, under a new version
+static void video_refresh_pal_range(int start, int count) {
+    palette_range_mask mask = screen_palette_range_mask(start, count);
+    unsigned int version = screen_palette_new_version();
+    for(int r = 0; r < PALETTE_RANGES; r++) {
+        if(!(mask & (1 << r))) {
+            continue;
+        }
+        int offset = r * PALETTE_RANGE_SIZE;
+        memcpy(state.screen_palette->data[offset], state.base_palette->data[offset], PALETTE_RANGE_SIZE * 3);
+        memcpy(state.extra_palette->data[offset], state.base_palette->data[offset], PALETTE_RANGE_SIZE * 3);
+        state.base_range_version[r] = version;
+        state.screen_palette->range_version[r] = version;
+        state.extra_palette->range_version[r] = version;
     }
-
-    return 0;
+    state.screen_palette->version = version;
+    state.extra_palette->version = version;
 }
 
 void video_force_pal_refresh() {
-    memcpy(state.screen_palette->data, state.base_palette->data, 768);
-    memcpy(state.extra_palette->data, state.base_palette->data, 768);
-    state.extra_palette->version = state.screen_palette->version + 1;
-    state.screen_palette->version = state.extra_palette->version + 1;
+    video_refresh_pal_range(0, 256);
 }
 
 void video_set_base_palette(const palette *src) {
@@ -297,29 +475,61 @@ palette *video_get_base_palette() {
 }
 
 void video_copy_pal_range(const palette *src, int src_start, int dst_start, int amount) {
-    memcpy(state.screen_palette->data + dst_start * 3, src->data + src_start * 3, amount * 3);
-    state.screen_palette->version++;
+    memcpy(state.screen_palette->data[dst_start], src->data[src_start], amount * 3);
+    screen_palette_touch(state.screen_palette, dst_start, amount);
 }
 
 void video_copy_base_pal_range(const palette *src, int src_start, int dst_start, int amount) {
     memcpy(state.base_palette->data + dst_start, src->data + src_start, amount * 3);
-    video_force_pal_refresh();
+    video_refresh_pal_range(dst_start, amount);
 }
 
 screen_palette *video_get_pal_ref() {
     return state.screen_palette;
 }
 
-static void clear_render_target(SDL_Texture *target) {
-    SDL_SetRenderTarget(state.renderer, target);
-    SDL_SetRenderDrawColor(state.renderer, 0, 0, 0, 0);
-    SDL_RenderClear(state.renderer);
+// Returns the index of a snapshot copy of the palette. A new copy is made whenever the palette has changed.
+static uint16_t record_palette(screen_palette *pal, int *index, unsigned int *at) {
+    if(*index < 0 || *at != pal->version) {
+        *index = snapshot_add_palette(handoff.recording, pal);
+        *at = pal->version;
+    }
+    return *index;
+}
+
+// Copies the surface header to the command. The texture cache only gets to see the copy, so the refresh
+// flag is consumed here.
+static void record_surface(snapshot_cmd *cmd, surface *sur) {
+    cmd->key = sur;
+    cmd->sur = *sur;
+    sur->force_refresh = 0;
+
+    // Refreshed surfaces are being changed by the game, and may change again before a render thread gets
+    // to them.
+    if(cmd->sur.force_refresh && handoff.threaded) {
+        snapshot_own_pixels(handoff.recording, &cmd->sur);
+    }
 }
 
 void video_render_prepare() {
-    // Reset palette
-    memcpy(state.screen_palette->data, state.base_palette->data, 768);
-    clear_render_target(state.fg_target);
+    // Reset the palette ranges that effects changed during the last frame
+    bool restored = false;
+    for(int r = 0; r < PALETTE_RANGES; r++) {
+        if(state.screen_palette->range_version[r] != state.base_range_version[r]) {
+            int offset = r * PALETTE_RANGE_SIZE;
+            memcpy(state.screen_palette->data[offset], state.base_palette->data[offset], PALETTE_RANGE_SIZE * 3);
+            state.screen_palette->range_version[r] = state.base_range_version[r];
+            restored = true;
+        }
+    }
+    if(restored) {
+        state.screen_palette->version = screen_palette_new_version();
+    }
+
+    snapshot_clear_frame(handoff.recording);
+    handoff.recording->has_frame = true;
+    state.screen_pal_index = -1;
+    state.extra_pal_index = -1;
 }
 
 void video_render_bg_separately(bool separate) {
@@ -327,56 +537,40 @@ void video_render_bg_separately(bool separate) {
 }
 
 void video_render_background(surface *sur) {
-    SDL_Texture *tex = tcache_get(sur, state.screen_palette, NULL, 0);
-    if(tex == NULL) {
+    if(sur == NULL) {
         return;
     }
-
-    if(state.render_bg_separately) {
-        SDL_SetRenderTarget(state.renderer, state.bg_target);
-    } else {
-        SDL_SetRenderTarget(state.renderer, state.fg_target);
-    }
-    SDL_SetTextureColorMod(tex, 0xFF, 0xFF, 0xFF);
-    SDL_SetTextureAlphaMod(tex, 0xFF);
-    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
-    SDL_RenderCopy(state.renderer, tex, NULL, NULL);
-}
-
-static void scale_rect(const video_state *state, SDL_Rect *rct) {
-    rct->w = rct->w * state->scale_factor;
-    rct->h = rct->h * state->scale_factor;
-    rct->x = rct->x * state->scale_factor;
-    rct->y = rct->y * state->scale_factor;
+    snapshot_cmd *cmd = snapshot_add_cmd(handoff.recording, SNAPSHOT_CMD_BACKGROUND);
+    cmd->pal = record_palette(state.screen_palette, &state.screen_pal_index, &state.screen_pal_at);
+    cmd->bg_separately = state.render_bg_separately;
+    record_surface(cmd, sur);
 }
 
 static void render_sprite_fsot(video_state *state, surface *sur, SDL_Rect *dst, SDL_BlendMode blend_mode,
                                int pal_offset, SDL_RendererFlip flip_mode, uint8_t opacity, color color_mod) {
-    // Scale the object to actual screen size
-    scale_rect(state, dst);
+    if(sur == NULL) {
+        return;
+    }
+    snapshot_cmd *cmd = snapshot_add_cmd(handoff.recording, SNAPSHOT_CMD_SPRITE);
 
     // If this is additive blend, always use the base palette.
     // This is because additive blending effects should not stack
     // with other effects.
-    screen_palette *pal = state->screen_palette;
     if(blend_mode == SDL_BLENDMODE_ADD) {
-        pal = state->extra_palette;
+        cmd->pal = record_palette(state->extra_palette, &state->extra_pal_index, &state->extra_pal_at);
+    } else {
+        cmd->pal = record_palette(state->screen_palette, &state->screen_pal_index, &state->screen_pal_at);
+    }
+    cmd->blend_mode = blend_mode;
+    cmd->flip = flip_mode;
+    cmd->opacity = opacity;
+    cmd->pal_offset = pal_offset;
+    cmd->tint = color_mod;
+    cmd->dst = *dst;
+    record_surface(cmd, sur);
+    if(state->clip_enabled) {
+        state->clip_ranges |= surface_palette_ranges(sur, NULL, pal_offset);
     }
-
-    // Fetch object from texture cache. Palettes are versioned, so
-    // we if object does not yet exist with given palette, it will be rendered
-    // and uploaded to videomem.
-    SDL_Texture *tex = tcache_get(sur, pal, NULL, pal_offset);
-    if(tex == NULL)
-        return;
-
-    // Always render objects to foreground rendertarget. This way we avoid
-    // doing effects on the background (which is on another rendertarget).
-    SDL_SetRenderTarget(state->renderer, state->fg_target);
-    SDL_SetTextureAlphaMod(tex, opacity);
-    SDL_SetTextureColorMod(tex, color_mod.r, color_mod.g, color_mod.b);
-    SDL_SetTextureBlendMode(tex, blend_mode);
-    SDL_RenderCopyEx(state->renderer, tex, NULL, dst, 0, NULL, flip_mode);
 }
 
 void video_render_sprite_tint(surface *sur, int sx, int sy, color c, int pal_offset) {
@@ -443,52 +637,803 @@ void video_render_sprite_flip_scale_opacity_tint(surface *sur, int sx, int sy, u
     render_sprite_fsot(&state, sur, &dst, blend_mode, pal_offset, flip, opacity, tint);
 }
 
+// Blend mode for drawing a cache to the screen. Cache contents are already multiplied by their alpha,
+// since they were blended onto a transparent texture.
+static SDL_BlendMode cache_blend_mode() {
+    return SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                      SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+}
+
+/*
+ * Makes sure no frame that is still to be rendered depends on a surface or video cache that is about
+ * to be freed. With a render thread, this may wait for the frame being rendered.
+ */
+static void video_forget(const void *key) {
+    if(handoff.recording == NULL) {
+        return;
+    }
+    snapshot_detach(handoff.recording, key);
+    if(!handoff.threaded) {
+        return;
+    }
+    SDL_LockMutex(handoff.lock);
+    if(handoff.pending != NULL) {
+        snapshot_detach(handoff.pending, key);
+    }
+    while(handoff.executing != NULL && snapshot_references(handoff.executing, key)) {
+        SDL_CondWait(handoff.cond, handoff.lock);
+    }
+    SDL_UnlockMutex(handoff.lock);
+}
+
+// Called by the surface functions before the pixels of a surface are changed or released.
+void video_forget_surface(surface *sur) {
+    video_forget(sur);
+}
+
+video_cache *video_cache_create() {
+    return omf_calloc(1, sizeof(video_cache));
+}
+
+void video_cache_free(video_cache *cache) {
+    if(cache == NULL) {
+        return;
+    }
+    video_forget(cache);
+
+    // The texture belongs to the renderer. Textures of an old renderer are already gone.
+    if(cache->tex != NULL && handoff.recording != NULL) {
+        snapshot_add_garbage(handoff.recording, cache->tex, cache->tex_generation);
+    }
+    omf_free(cache->pixels);
+    omf_free(cache);
+}
+
+bool video_cache_is_valid(const video_cache *cache) {
+    return cache->valid && cache->generation == (unsigned int)SDL_AtomicGet(&state.target_generation) &&
+           screen_palette_ranges_match(state.screen_palette, cache->range_version, cache->pal_ranges);
+}
+
+void video_cache_invalidate(video_cache *cache) {
+    cache->valid = false;
+}
+
+/*
+ * Starts redrawing an area of the cache. The area is cleared, and all sprite rendering is clipped to it
+ * until video_cache_end(). If the cache is not valid, the whole screen is redrawn instead. Returns false
+ * if the renderer can not do caching; the caller should then render directly.
+ */
+bool video_cache_begin(video_cache *cache, int x, int y, int w, int h) {
+    if(SDL_AtomicGet(&state.cache_unsupported)) {
+        return false;
+    }
+    if(!video_cache_is_valid(cache)) {
+        x = 0;
+        y = 0;
+        w = NATIVE_W;
+        h = NATIVE_H;
+        cache->pal_ranges = 0;
+    }
+
+    state.clip_enabled = true;
+    state.clip.x = x;
+    state.clip.y = y;
+    state.clip.w = w;
+    state.clip.h = h;
+    state.clip_ranges = 0;
+
+    snapshot_cmd *cmd = snapshot_add_cmd(handoff.recording, SNAPSHOT_CMD_CACHE_BEGIN);
+    cmd->key = cache;
+    cmd->dst = state.clip;
+
+    cache->generation = SDL_AtomicGet(&state.target_generation);
+    // Ranges outside of the area were not changed since they were drawn, or the cache would not be valid
+    memcpy(cache->range_version, state.screen_palette->range_version, sizeof(cache->range_version));
+    cache->valid = true;
+    return true;
+}
+
+void video_cache_end(video_cache *cache) {
+    state.clip_enabled = false;
+    cache->pal_ranges |= state.clip_ranges;
+    snapshot_cmd *cmd = snapshot_add_cmd(handoff.recording, SNAPSHOT_CMD_CACHE_END);
+    cmd->key = cache;
+}
+
+void video_cache_render(video_cache *cache) {
+    snapshot_cmd *cmd = snapshot_add_cmd(handoff.recording, SNAPSHOT_CMD_CACHE_RENDER);
+    cmd->key = cache;
+}
+
+/*
+ * Tells whether anything drawn in the given area could end up on the screen. Only false while
+ * redrawing part of a video cache, for areas outside of it.
+ */
+bool video_area_visible(int x, int y, int w, int h) {
+    if(!state.clip_enabled) {
+        return true;
+    }
+    SDL_Rect area = {x, y, w, h};
+    return SDL_HasIntersection(&area, &state.clip);
+}
+
 // Called on every game tick
 void video_tick() {
-    tcache_tick();
+    handoff.recording->ticks++;
 }
 
-// Called after frame has been rendered
-void video_render_finish() {
-    // Set our rendertarget to screen buffer.
-    SDL_SetRenderTarget(state.renderer, NULL);
+// Video caches that a thrown away frame would have redrawn are out of date, and need a full redraw
+static void invalidate_snapshot_caches(const snapshot *snap) {
+    for(unsigned int i = 0; i < vector_size(&snap->cmds); i++) {
+        const snapshot_cmd *cmd = vector_get(&snap->cmds, i);
+        if(cmd->type == SNAPSHOT_CMD_CACHE_BEGIN) {
+            video_cache_invalidate((video_cache *)cmd->key);
+        }
+    }
+}
 
-    // Clear screen (borders)
+/*
+ * Drops all cached textures before the next frame. Called on scene changes, since the textures are keyed
+ * by surface pointers, and the new scene reuses the memory of the old one. With a render thread, frames
+ * of the old scene are finished or thrown away before this returns.
+ */
+void video_clear_texture_cache() {
+    handoff.recording->clear_tcache = true;
+    if(!handoff.threaded) {
+        return;
+    }
+    SDL_LockMutex(handoff.lock);
+    if(handoff.pending != NULL) {
+        invalidate_snapshot_caches(handoff.pending);
+        snapshot_move_work(handoff.recording, handoff.pending);
+        handoff.pending = NULL;
+        SDL_CondBroadcast(handoff.cond);
+    }
+    while(handoff.executing != NULL) {
+        SDL_CondWait(handoff.cond, handoff.lock);
+    }
+    SDL_UnlockMutex(handoff.lock);
+}
+
+static void clear_render_target(SDL_Texture *target) {
+    SDL_SetRenderTarget(state.renderer, target);
+    SDL_SetRenderDrawColor(state.renderer, 0, 0, 0, 0);
+    SDL_RenderClear(state.renderer);
+}
+
+// Reads back screen areas requested by video_area_capture() after the given amount of commands. Like before,
+// this reads whatever has been drawn on the foreground target so far.
+static void render_captures(snapshot *snap, unsigned int at) {
+    for(unsigned int i = 0; i < vector_size(&snap->captures); i++) {
+        snapshot_capture *capture = vector_get(&snap->captures, i);
+        if(capture->at != at) {
+            continue;
+        }
+        if(state.software) {
+            soft_layer_read(state.soft_fg, &capture->area, capture->sur->data);
+            continue;
+        }
+        SDL_SetRenderTarget(state.renderer, state.fg_target);
+        if(SDL_RenderReadPixels(state.renderer, &capture->area, SDL_PIXELFORMAT_ABGR8888, capture->sur->data,
+                                capture->sur->w * 4) != 0) {
+            PERROR("Unable to read pixels from renderer: %s", SDL_GetError());
+        }
+    }
+}
+
+static void render_background(snapshot *snap, snapshot_cmd *cmd, unsigned int *draw_calls) {
+    SDL_Texture *tex = tcache_get(cmd->key, &cmd->sur, vector_get(&snap->palettes, cmd->pal), NULL, 0);
+    if(tex == NULL) {
+        return;
+    }
+
+    if(cmd->bg_separately) {
+        SDL_SetRenderTarget(state.renderer, state.bg_target);
+    } else {
+        SDL_SetRenderTarget(state.renderer, state.fg_target);
+    }
+    SDL_SetTextureColorMod(tex, 0xFF, 0xFF, 0xFF);
+    SDL_SetTextureAlphaMod(tex, 0xFF);
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
+    SDL_RenderCopy(state.renderer, tex, NULL, NULL);
+    (*draw_calls)++;
+}
+
+static void render_sprite(snapshot *snap, snapshot_cmd *cmd, unsigned int *draw_calls) {
+    // Fetch object from texture cache. Palettes are versioned, so
+    // we if object does not yet exist with given palette, it will be rendered
+    // and uploaded to videomem.
+    SDL_Texture *tex = tcache_get(cmd->key, &cmd->sur, vector_get(&snap->palettes, cmd->pal), NULL, cmd->pal_offset);
+    if(tex == NULL)
+        return;
+
+    SDL_Rect dst = cmd->dst;
+
+    // Always render objects to foreground rendertarget (or a cache on top of it). This way we avoid
+    // doing effects on the background (which is on another rendertarget).
+    SDL_SetRenderTarget(state.renderer, state.draw_target);
+    SDL_SetTextureAlphaMod(tex, cmd->opacity);
+    SDL_SetTextureColorMod(tex, cmd->tint.r, cmd->tint.g, cmd->tint.b);
+    SDL_SetTextureBlendMode(tex, cmd->blend_mode);
+    SDL_RenderCopyEx(state.renderer, tex, NULL, &dst, 0, NULL, cmd->flip);
+    (*draw_calls)++;
+}
+
+// Redirects drawing to a video cache. If the renderer can't do that, the contents get drawn directly.
+static void render_cache_begin(const snapshot_cmd *cmd, unsigned int generation) {
+    video_cache *cache = (video_cache *)cmd->key;
+    SDL_Rect area = cmd->dst;
+    if(cache->tex != NULL && cache->tex_generation != generation) {
+        cache->tex = NULL;
+    }
+    if(cache->tex == NULL) {
+        cache->tex =
+            SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, NATIVE_W, NATIVE_H);
+        if(cache->tex == NULL || SDL_SetTextureBlendMode(cache->tex, cache_blend_mode()) != 0) {
+            DEBUG("Render caching is not supported by this renderer: %s", SDL_GetError());
+            if(cache->tex != NULL) {
+                SDL_DestroyTexture(cache->tex);
+                cache->tex = NULL;
+            }
+            SDL_AtomicSet(&state.cache_unsupported, 1);
+            return;
+        }
+        cache->tex_generation = generation;
+
+        // Targets were recreated after the frame was recorded. Rest of the cache gets redrawn next frame.
+        area.x = 0;
+        area.y = 0;
+        area.w = NATIVE_W;
+        area.h = NATIVE_H;
+    }
+
+    state.draw_target = cache->tex;
+    SDL_SetRenderTarget(state.renderer, cache->tex);
+    SDL_RenderSetClipRect(state.renderer, &area);
+    SDL_SetRenderDrawBlendMode(state.renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(state.renderer, 0, 0, 0, 0);
+    SDL_RenderFillRect(state.renderer, &area);
+}
+
+static void render_cache_end() {
+    SDL_RenderSetClipRect(state.renderer, NULL);
+    state.draw_target = state.fg_target;
+    SDL_SetRenderTarget(state.renderer, state.fg_target);
+}
+
+static void render_cache(const snapshot_cmd *cmd, unsigned int generation, unsigned int *draw_calls) {
+    const video_cache *cache = cmd->key;
+    if(cache->tex == NULL || cache->tex_generation != generation) {
+        return;
+    }
+    SDL_SetRenderTarget(state.renderer, state.fg_target);
+    SDL_RenderCopy(state.renderer, cache->tex, NULL, NULL);
+    (*draw_calls)++;
+}
+
+static void render_background_soft(snapshot *snap, snapshot_cmd *cmd, unsigned int *draw_calls) {
+    char *layer = cmd->bg_separately ? state.soft_bg : state.soft_fg;
+    SDL_Rect dst = {0, 0, NATIVE_W, NATIVE_H};
+    soft_render_sprite(layer, NULL, &cmd->sur, vector_get(&snap->palettes, cmd->pal), 0, &dst, SDL_FLIP_NONE,
+                       SDL_BLENDMODE_NONE, 0xFF, color_create(0xFF, 0xFF, 0xFF, 0xFF));
+    (*draw_calls)++;
+}
+
+static void render_sprite_soft(snapshot *snap, snapshot_cmd *cmd, unsigned int *draw_calls) {
+    const SDL_Rect *clip = (state.soft_draw != state.soft_fg) ? &state.soft_clip : NULL;
+    soft_render_sprite(state.soft_draw, clip, &cmd->sur, vector_get(&snap->palettes, cmd->pal), cmd->pal_offset,
+                       &cmd->dst, cmd->flip, cmd->blend_mode, cmd->opacity, cmd->tint);
+    (*draw_calls)++;
+}
+
+static void render_cache_begin_soft(const snapshot_cmd *cmd) {
+    video_cache *cache = (video_cache *)cmd->key;
+    state.soft_clip = cmd->dst;
+    if(cache->pixels == NULL) {
+        cache->pixels = soft_layer_create();
+        state.soft_clip.x = 0;
+        state.soft_clip.y = 0;
+        state.soft_clip.w = NATIVE_W;
+        state.soft_clip.h = NATIVE_H;
+    }
+    state.soft_draw = cache->pixels;
+    soft_layer_clear(state.soft_draw, &state.soft_clip);
+}
+
+static void render_cache_soft(const snapshot_cmd *cmd, unsigned int *draw_calls) {
+    const video_cache *cache = cmd->key;
+    if(cache->pixels == NULL) {
+        return;
+    }
+    soft_render_layer(state.soft_fg, cache->pixels);
+    (*draw_calls)++;
+}
+
+/*
+ * Draws the commands of a snapshot to the software layers. With caches_only, only the commands that redraw
+ * video caches are run, and the screen is left alone.
+ */
+static void render_cmds_soft(snapshot *snap, bool caches_only, unsigned int *draw_calls) {
+    if(!caches_only) {
+        soft_layer_clear(state.soft_fg, NULL);
+    }
+    state.soft_draw = state.soft_fg;
+    bool captures = !caches_only && vector_size(&snap->captures) > 0;
+    bool in_cache = false;
+    for(unsigned int i = 0; i < vector_size(&snap->cmds); i++) {
+        snapshot_cmd *cmd = vector_get(&snap->cmds, i);
+        if(captures) {
+            render_captures(snap, i);
+        }
+        if(caches_only && !in_cache && cmd->type != SNAPSHOT_CMD_CACHE_BEGIN) {
+            continue;
+        }
+        switch(cmd->type) {
+            case SNAPSHOT_CMD_BACKGROUND:
+                render_background_soft(snap, cmd, draw_calls);
+                break;
+            case SNAPSHOT_CMD_SPRITE:
+                render_sprite_soft(snap, cmd, draw_calls);
+                break;
+            case SNAPSHOT_CMD_CACHE_BEGIN:
+                render_cache_begin_soft(cmd);
+                in_cache = true;
+                break;
+            case SNAPSHOT_CMD_CACHE_END:
+                state.soft_draw = state.soft_fg;
+                in_cache = false;
+                break;
+            case SNAPSHOT_CMD_CACHE_RENDER:
+                render_cache_soft(cmd, draw_calls);
+                break;
+        }
+    }
+    if(captures) {
+        render_captures(snap, vector_size(&snap->cmds));
+    }
+}
+
+// Same as render_cmds_soft(), but with the renderer
+static void render_cmds(snapshot *snap, unsigned int generation, bool caches_only, unsigned int *draw_calls) {
+    if(!caches_only) {
+        clear_render_target(state.fg_target);
+    }
+    state.draw_target = state.fg_target;
+    bool captures = !caches_only && vector_size(&snap->captures) > 0;
+    bool in_cache = false;
+    for(unsigned int i = 0; i < vector_size(&snap->cmds); i++) {
+        snapshot_cmd *cmd = vector_get(&snap->cmds, i);
+        if(captures) {
+            render_captures(snap, i);
+        }
+        if(caches_only && !in_cache && cmd->type != SNAPSHOT_CMD_CACHE_BEGIN) {
+            continue;
+        }
+        switch(cmd->type) {
+            case SNAPSHOT_CMD_BACKGROUND:
+                render_background(snap, cmd, draw_calls);
+                break;
+            case SNAPSHOT_CMD_SPRITE:
+                render_sprite(snap, cmd, draw_calls);
+                break;
+            case SNAPSHOT_CMD_CACHE_BEGIN:
+                render_cache_begin(cmd, generation);
+                in_cache = true;
+                break;
+            case SNAPSHOT_CMD_CACHE_END:
+                render_cache_end();
+                in_cache = false;
+                break;
+            case SNAPSHOT_CMD_CACHE_RENDER:
+                render_cache(cmd, generation, draw_calls);
+                break;
+        }
+    }
+    if(captures) {
+        render_captures(snap, vector_size(&snap->cmds));
+    }
+}
+
+// Reads back the finished frame for a pending screenshot. Current render target must be the screen.
+static void capture_screen() {
+    capture_frame *frame = capture_acquire(state.w, state.h);
+    if(frame == NULL) {
+        return; // Worker is busy; try again on the next frame.
+    }
+    if(SDL_RenderReadPixels(state.renderer, NULL, SDL_PIXELFORMAT_ABGR8888, capture_frame_data(frame), state.w * 4)) {
+        PERROR("Unable to read pixels from rendertarget: %s", SDL_GetError());
+        capture_release(frame);
+        return;
+    }
+    capture_submit_screenshot(frame);
+}
+
+// Composites the render targets at native resolution to the capture target.
+static void compose_native(const SDL_Rect *dst) {
+    if(state.capture_target == NULL) {
+        state.capture_target =
+            SDL_CreateTexture(state.renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET, NATIVE_W, NATIVE_H);
+    }
+    SDL_SetRenderTarget(state.renderer, state.capture_target);
     SDL_SetRenderDrawColor(state.renderer, 0, 0, 0, 255);
     SDL_RenderClear(state.renderer);
+    SDL_RenderCopy(state.renderer, state.bg_target, NULL, dst);
+    SDL_RenderCopy(state.renderer, state.fg_target, NULL, dst);
+}
+
+// Composites the frame again at native resolution, and hands it to the capture stream.
+static void capture_native(int repeat, const SDL_Rect *dst) {
+    capture_frame *frame = capture_acquire(NATIVE_W, NATIVE_H);
+    if(frame == NULL) {
+        return; // Dropped; the next frame will be repeated to fill the gap.
+    }
+    compose_native(dst);
+    int ret = SDL_RenderReadPixels(state.renderer, NULL, SDL_PIXELFORMAT_ABGR8888, capture_frame_data(frame),
+                                   NATIVE_W * 4);
+    SDL_SetRenderTarget(state.renderer, NULL);
+    if(ret != 0) {
+        PERROR("Unable to read pixels from capture target: %s", SDL_GetError());
+        capture_release(frame);
+        return;
+    }
+    capture_submit_stream(frame, repeat);
+}
 
+// Hands an already read back native frame to the capture stream.
+static void capture_native_frame(int repeat, const char *pixels) {
+    capture_frame *frame = capture_acquire(NATIVE_W, NATIVE_H);
+    if(frame == NULL) {
+        return;
+    }
+    memcpy(capture_frame_data(frame), pixels, NATIVE_W * NATIVE_H * 4);
+    capture_submit_stream(frame, repeat);
+}
+
+/*
+ * Composites the frame at native resolution, reads it back and runs the scaler on the whole frame at once.
+ * The result is left in the scaled target. Returns 0 on success; on failure the caller should draw the
+ * render targets directly.
+ */
+static int scale_frame(const SDL_Rect *dst, int repeat) {
+    if(state.scaled_target == NULL) {
+        return 1;
+    }
+    compose_native(dst);
+    int ret =
+        SDL_RenderReadPixels(state.renderer, NULL, SDL_PIXELFORMAT_ABGR8888, state.native_frame, NATIVE_W * 4);
+    SDL_SetRenderTarget(state.renderer, NULL);
+    if(ret != 0) {
+        PERROR("Unable to read pixels from capture target: %s", SDL_GetError());
+        return 1;
+    }
+    if(repeat > 0) {
+        capture_native_frame(repeat, state.native_frame);
+    }
+    if(frame_scaler_run(&state.scaler, state.native_frame, state.scaled_frame, NATIVE_W, NATIVE_H,
+                        state.scale_factor)) {
+        return 1;
+    }
+    SDL_UpdateTexture(state.scaled_target, NULL, state.scaled_frame, NATIVE_W * state.scale_factor * 4);
+    return 0;
+}
+
+// Composites the render targets on the screen.
+static void draw_targets(const snapshot *snap) {
     // Handle fading by color modulation
-    uint8_t v = 255.0f * state.fade;
+    uint8_t v = 255.0f * snap->fade;
     SDL_SetTextureColorMod(state.fg_target, v, v, v);
     SDL_SetTextureColorMod(state.bg_target, v, v, v);
 
-    // Set screen position. take into account scaling and target moves (screen shakes)
-    SDL_Rect dst;
-    dst.x = state.target_move_x * state.scale_factor;
-    dst.y = state.target_move_y * state.scale_factor;
-    dst.w = NATIVE_W * state.scale_factor;
-    dst.h = NATIVE_H * state.scale_factor;
-    SDL_RenderCopy(state.renderer, state.bg_target, NULL, &dst);
-    SDL_RenderCopy(state.renderer, state.fg_target, NULL, &dst);
+    // Set screen position. take into account target moves (screen shakes)
+    SDL_Rect native_dst = {snap->move_x, snap->move_y, NATIVE_W, NATIVE_H};
+    int repeat = capture_stream_frames_due(SDL_GetTicks());
+
+    // Scaled frames are composited at native resolution first, and the finished frame is scaled once.
+    int scaled = 0;
+    if(state.scale_factor > 1) {
+        scaled = (scale_frame(&native_dst, repeat) == 0);
+    }
+
+    // Set our rendertarget to screen buffer.
+    SDL_SetRenderTarget(state.renderer, NULL);
+
+    // Clear screen (borders)
+    SDL_SetRenderDrawColor(state.renderer, 0, 0, 0, 255);
+    SDL_RenderClear(state.renderer);
+
+    if(scaled) {
+        SDL_RenderCopy(state.renderer, state.scaled_target, NULL, NULL);
+    } else {
+        SDL_Rect dst;
+        dst.x = snap->move_x * state.scale_factor;
+        dst.y = snap->move_y * state.scale_factor;
+        dst.w = NATIVE_W * state.scale_factor;
+        dst.h = NATIVE_H * state.scale_factor;
+        SDL_RenderCopy(state.renderer, state.bg_target, NULL, &dst);
+        SDL_RenderCopy(state.renderer, state.fg_target, NULL, &dst);
+    }
+
+    // Frame captures. Readback has to happen before present; encoding is done on the capture thread.
+    if(capture_screenshot_pending()) {
+        capture_screen();
+    }
+    if(repeat > 0 && !scaled) {
+        capture_native(repeat, &native_dst);
+    }
 
     // Reset color modulation to normal
     SDL_SetTextureColorMod(state.fg_target, 0xFF, 0xFF, 0xFF);
     SDL_SetTextureColorMod(state.bg_target, 0xFF, 0xFF, 0xFF);
+}
+
+// Composites the software layers in memory, and uploads the frame as a single texture.
+static void draw_soft_frame(const snapshot *snap) {
+    uint8_t v = 255.0f * snap->fade;
+    soft_render_compose(state.native_frame, state.soft_bg, state.soft_fg, snap->move_x, snap->move_y, v);
+
+    int repeat = capture_stream_frames_due(SDL_GetTicks());
+    if(repeat > 0) {
+        capture_native_frame(repeat, state.native_frame);
+    }
+
+    SDL_Texture *frame = state.soft_target;
+    if(state.scaled_target != NULL && frame_scaler_run(&state.scaler, state.native_frame, state.scaled_frame,
+                                                       NATIVE_W, NATIVE_H, state.scale_factor) == 0) {
+        SDL_UpdateTexture(state.scaled_target, NULL, state.scaled_frame, NATIVE_W * state.scale_factor * 4);
+        frame = state.scaled_target;
+    } else {
+        SDL_UpdateTexture(state.soft_target, NULL, state.native_frame, NATIVE_W * 4);
+    }
 
-    // Flip buffers. If vsync is off, we should sleep here
-    // so hat our main loop doesn't eat up all cpu :)
+    SDL_SetRenderTarget(state.renderer, NULL);
+    SDL_SetRenderDrawColor(state.renderer, 0, 0, 0, 255);
+    SDL_RenderClear(state.renderer);
+    SDL_RenderCopy(state.renderer, frame, NULL, NULL);
+
+    if(capture_screenshot_pending()) {
+        capture_screen();
+    }
+}
+
+// Draws the finished frame on the screen, and presents it.
+static void render_present(const snapshot *snap) {
+    if(state.software) {
+        draw_soft_frame(snap);
+    } else {
+        draw_targets(snap);
+    }
+
+    // Nobody is looking at the window when rendering offline, and there is no reason to wait.
+    if(state.offline) {
+        return;
+    }
+
+    // Flip buffers. Without vsync, the engine loop sleeps between frames instead.
     SDL_RenderPresent(state.renderer);
-    if(!state.vsync) {
-        SDL_Delay(1);
+}
+
+// Textures from before a renderer reset are already gone
+static void destroy_garbage(snapshot *snap, unsigned int generation) {
+    for(unsigned int i = 0; i < vector_size(&snap->garbage); i++) {
+        snapshot_texture *garbage = vector_get(&snap->garbage, i);
+        if(garbage->generation == generation) {
+            SDL_DestroyTexture(garbage->tex);
+        }
+    }
+}
+
+/*
+ * Renders a recorded snapshot. Work queued for the renderer is always done, but the frame itself is only
+ * drawn if draw is set. The game already counts on the video caches redrawn in the frame, so those are
+ * redrawn in any case.
+ */
+static void render_snapshot(snapshot *snap, bool draw, unsigned int *draw_calls) {
+    unsigned int generation = SDL_AtomicGet(&state.target_generation);
+
+    for(unsigned int i = 0; i < snap->ticks; i++) {
+        tcache_tick();
+    }
+    if(snap->clear_tcache) {
+        tcache_clear();
+    }
+    destroy_garbage(snap, generation);
+    if(!draw || !snap->has_frame) {
+        // Nothing gets drawn, so captures get what is left of the previous frame
+        for(unsigned int i = 0; i < vector_size(&snap->captures); i++) {
+            ((snapshot_capture *)vector_get(&snap->captures, i))->at = 0;
+        }
+        render_captures(snap, 0);
+        if(snap->has_frame && state.software) {
+            render_cmds_soft(snap, true, draw_calls);
+        } else if(snap->has_frame) {
+            render_cmds(snap, generation, true, draw_calls);
+        }
+        return;
+    }
+
+    if(state.software) {
+        render_cmds_soft(snap, false, draw_calls);
+    } else {
+        render_cmds(snap, generation, false, draw_calls);
     }
+    render_present(snap);
+}
+
+static snapshot *unused_snapshot() {
+    for(int i = 0; i < 3; i++) {
+        snapshot *snap = &handoff.snapshots[i];
+        if(snap != handoff.recording && snap != handoff.pending && snap != handoff.executing) {
+            return snap;
+        }
+    }
+    return NULL;
+}
+
+// Called after frame has been recorded
+void video_render_finish() {
+    snapshot *snap = handoff.recording;
+    snap->fade = state.fade;
+    snap->move_x = state.target_move_x;
+    snap->move_y = state.target_move_y;
+
+    unsigned int draw_calls = 0;
+    unsigned int tcache_misses = 0;
+    if(!handoff.threaded) {
+        render_snapshot(snap, true, &draw_calls);
+        snapshot_reset(snap);
+        tcache_misses = tcache_take_misses();
+    } else {
+        SDL_LockMutex(handoff.lock);
+        // Only waits if the game did not check video_render_ready() first
+        while(handoff.pending != NULL) {
+            SDL_CondWait(handoff.cond, handoff.lock);
+        }
+        handoff.pending = snap;
+        handoff.recording = unused_snapshot();
+        SDL_CondBroadcast(handoff.cond);
+
+        // Statistics lag behind by a frame or so
+        draw_calls = handoff.draw_calls;
+        tcache_misses = handoff.tcache_misses;
+        handoff.draw_calls = 0;
+        handoff.tcache_misses = 0;
+        SDL_UnlockMutex(handoff.lock);
+    }
+    profiler_count(PROF_DRAW_CALLS, draw_calls);
+    profiler_count(PROF_TCACHE_MISSES, tcache_misses);
+}
+
+/*
+ * Tells whether a new frame can be recorded without waiting for the render thread. Waits for up to
+ * timeout milliseconds for that to happen.
+ */
+bool video_render_ready(unsigned int timeout) {
+    if(!handoff.threaded) {
+        return true;
+    }
+    SDL_LockMutex(handoff.lock);
+    if(handoff.pending != NULL && timeout > 0) {
+        SDL_CondWaitTimeout(handoff.cond, handoff.lock, timeout);
+    }
+    bool ready = handoff.pending == NULL;
+    SDL_UnlockMutex(handoff.lock);
+    return ready;
+}
+
+/*
+ * Renders the latest recorded frame on the render thread. Waits for up to timeout milliseconds for a frame
+ * to be recorded. If draw is not set, the frame is consumed without drawing it. Returns true if a frame
+ * was presented.
+ */
+bool video_render_frame(unsigned int timeout, bool draw) {
+    apply_pending_settings();
+
+    SDL_LockMutex(handoff.lock);
+    if(handoff.pending == NULL && timeout > 0) {
+        SDL_CondWaitTimeout(handoff.cond, handoff.lock, timeout);
+    }
+    snapshot *snap = handoff.pending;
+    if(snap == NULL) {
+        SDL_UnlockMutex(handoff.lock);
+        return false;
+    }
+    handoff.executing = snap;
+    handoff.pending = NULL;
+    SDL_CondBroadcast(handoff.cond);
+    SDL_UnlockMutex(handoff.lock);
+
+    unsigned int draw_calls = 0;
+    bool presented = draw && snap->has_frame;
+    render_snapshot(snap, draw, &draw_calls);
+    unsigned int tcache_misses = tcache_take_misses();
+
+    SDL_LockMutex(handoff.lock);
+    snapshot_reset(snap);
+    handoff.executing = NULL;
+    handoff.draw_calls += draw_calls;
+    handoff.tcache_misses += tcache_misses;
+    SDL_CondBroadcast(handoff.cond);
+    SDL_UnlockMutex(handoff.lock);
+    return presented;
+}
+
+/*
+ * Switches between rendering frames in video_render_finish(), and handing them over to a render thread
+ * that calls video_render_frame(). The render thread must be the one that created the window. Only call
+ * this while no game thread is running.
+ */
+void video_set_render_thread(bool enabled) {
+    if(handoff.threaded && !enabled) {
+        // Work queued for the renderer still needs to be done
+        video_render_frame(0, false);
+    }
+    handoff.threaded = enabled;
+}
+
+/*
+ * Switches between compositing frames with the renderer, and compositing them in memory and uploading
+ * a single texture per frame. The latter is faster when there is no GPU to render with. Only call this
+ * while no game thread is running.
+ */
+void video_set_software_render(bool enabled) {
+    if(enabled == state.software) {
+        return;
+    }
+    state.software = enabled;
+    if(enabled) {
+        state.soft_fg = soft_layer_create();
+        state.soft_bg = soft_layer_create();
+        if(state.native_frame == NULL) {
+            state.native_frame = omf_calloc(1, NATIVE_W * NATIVE_H * 4);
+        }
+    } else {
+        omf_free(state.soft_fg);
+        omf_free(state.soft_bg);
+    }
+    state.soft_draw = state.soft_fg;
+
+    // Video caches are redrawn for the new backend
+    reset_targets();
+    INFO("Software rendering %s", enabled ? "enabled" : "disabled");
+}
+
+// Wakes up the render thread from waiting in video_render_frame().
+void video_render_wake() {
+    SDL_LockMutex(handoff.lock);
+    SDL_CondBroadcast(handoff.cond);
+    SDL_UnlockMutex(handoff.lock);
 }
 
 void video_close() {
+    destroy_garbage(handoff.recording, SDL_AtomicGet(&state.target_generation));
     tcache_close();
     SDL_DestroyTexture(state.fg_target);
     SDL_DestroyTexture(state.bg_target);
+    if(state.capture_target != NULL) {
+        SDL_DestroyTexture(state.capture_target);
+    }
+    if(state.scaled_target != NULL) {
+        SDL_DestroyTexture(state.scaled_target);
+    }
+    if(state.soft_target != NULL) {
+        SDL_DestroyTexture(state.soft_target);
+    }
+    omf_free(state.soft_fg);
+    omf_free(state.soft_bg);
+    omf_free(state.native_frame);
+    omf_free(state.scaled_frame);
+    frame_scaler_close();
     SDL_DestroyRenderer(state.renderer);
     SDL_DestroyWindow(state.window);
+    SDL_AtomicIncRef(&state.target_generation);
+    for(int i = 0; i < 3; i++) {
+        snapshot_free(&handoff.snapshots[i]);
+    }
+    handoff.recording = NULL;
+    handoff.pending = NULL;
+    handoff.executing = NULL;
+    SDL_DestroyCond(handoff.cond);
+    SDL_DestroyMutex(handoff.lock);
     omf_free(state.screen_palette);
     omf_free(state.extra_palette);
     omf_free(state.base_palette);
@@ -26,6 +26,7 @@ enum VIDEO_FLIP_MODE
 };
 
 int video_init(int window_w, int window_h, int fullscreen, int vsync, const char *scaler_name, int scale_factor);
+int video_init_offline();
 int video_reinit(int window_w, int window_h, int fullscreen, int vsync, const char *scaler_name, int scale_factor);
 void video_reinit_renderer();
 void video_get_state(int *w, int *h, int *fs, int *vsync);
@@ -47,12 +48,38 @@ void video_render_sprite_flip_scale_opacity_tint(surface *sur, int x, int y, uns
                                                  unsigned int flip_mode, float x_percent, float y_percent,
                                                  uint8_t opacity, color tint);
 
+/**
+ * @brief Retained render layer. Sprites drawn between video_cache_begin() and video_cache_end()
+ * end up in the cache, and video_cache_render() draws the whole cache on the screen again.
+ */
+typedef struct video_cache_t video_cache;
+
+video_cache *video_cache_create();
+void video_cache_free(video_cache *cache);
+bool video_cache_is_valid(const video_cache *cache);
+void video_cache_invalidate(video_cache *cache);
+bool video_cache_begin(video_cache *cache, int x, int y, int w, int h);
+void video_cache_end(video_cache *cache);
+void video_cache_render(video_cache *cache);
+bool video_area_visible(int x, int y, int w, int h);
+
 void video_tick();
 void video_render_background(surface *sur);
 void video_render_prepare();
 void video_render_finish();
 void video_close();
-int video_screenshot(image *img);
+void video_forget_surface(surface *sur);
+void video_clear_texture_cache();
+
+/**
+ * @brief Render thread. The game thread records frames as usual, and the thread that owns the window
+ * renders them with video_render_frame().
+ */
+void video_set_render_thread(bool enabled);
+bool video_render_ready(unsigned int timeout);
+bool video_render_frame(unsigned int timeout, bool draw);
+void video_render_wake();
+void video_set_software_render(bool enabled);
 int video_area_capture(surface *sur, int x, int y, int w, int h);
 void video_set_fade(float fade);
 void video_render_bg_separately(bool separate);
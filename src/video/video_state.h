@@ -20,18 +20,45 @@ typedef struct video_state_t {
     scaler_plugin scaler;
     char scaler_name[17];
 
+    bool offline;
+    SDL_Texture *fg_target;
+    SDL_Texture *bg_target;
+    SDL_Texture *capture_target; // Native resolution copy of the screen, for capture streams and scaling
+    SDL_Texture *scaled_target;  // Scaled frame, uploaded from scaled_frame
+    char *native_frame;          // Native frame, read back for the scaler or composited in software
+    char *scaled_frame;          // Scaler output
+
+    // Software rendering. Frames are composited in memory, and uploaded as a single texture.
+    bool software;
+    char *soft_fg;
+    char *soft_bg;
+    char *soft_draw;          // Where sprites are drawn to; soft_fg, or the pixels of a video_cache
+    SDL_Rect soft_clip;       // Area of a video_cache being redrawn
+    SDL_Texture *soft_target; // Native resolution frame
+
+    // Render caches
+    SDL_Texture *draw_target;       // Where sprites are drawn to; fg_target, or a video_cache texture
+    SDL_atomic_t target_generation; // Bumped whenever render targets are recreated
+    SDL_atomic_t cache_unsupported; // Renderer can't do the premultiplied blending video_cache needs
+
+    // Frame recording. Only touched by the thread running the game.
     float fade;
     int target_move_x;
     int target_move_y;
-
     bool render_bg_separately;
-    SDL_Texture *fg_target;
-    SDL_Texture *bg_target;
+    bool clip_enabled;              // Whether a video_cache area is being redrawn
+    SDL_Rect clip;                  // Area being redrawn, in native coordinates
+    palette_range_mask clip_ranges; // Palette ranges of the sprites drawn to the area
+    int screen_pal_index;           // Snapshot copy of the screen palette, or -1
+    unsigned int screen_pal_at;     // Screen palette version the copy was made at
+    int extra_pal_index;            // Snapshot copy of the extra palette, or -1
+    unsigned int extra_pal_at;      // Extra palette version the copy was made at
 
     // Palettes
-    palette *base_palette;          // Copy of the scenes base palette
-    screen_palette *screen_palette; // Normal rendering palette
-    screen_palette *extra_palette;  // Reflects base palette, used for additive blending
+    palette *base_palette;                           // Copy of the scenes base palette
+    unsigned int base_range_version[PALETTE_RANGES]; // Range versions the screen palette has when unmodified
+    screen_palette *screen_palette;                  // Normal rendering palette
+    screen_palette *extra_palette;                   // Reflects base palette, used for additive blending
 } video_state;
 
 #endif // VIDEO_STATE_H
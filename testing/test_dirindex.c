@@ -0,0 +1,98 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <resources/dirindex.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <utime.h>
+
+#define TESTFILE "test.dixtest"
+#define TESTINDEX "test.dixindex"
+
+static int reads = 0;
+
+// Info block is the first byte of the file
+static int read_first(const char *path, void *info) {
+    FILE *fp = fopen(path, "rb");
+    if(fp == NULL) {
+        return 1;
+    }
+    int c = fgetc(fp);
+    fclose(fp);
+    *(char *)info = (char)c;
+    reads++;
+    return 0;
+}
+
+static void write_file(const char *content, time_t mtime) {
+    FILE *fp = fopen(TESTFILE, "wb");
+    CU_ASSERT_FATAL(fp != NULL);
+    fputs(content, fp);
+    fclose(fp);
+    if(mtime != 0) {
+        struct utimbuf times = {mtime, mtime};
+        utime(TESTFILE, &times);
+    }
+}
+
+static char scan(dirindex *index) {
+    CU_ASSERT_FATAL(dirindex_scan(index, "./", ".dixtest", TESTINDEX, read_first) == 0);
+    CU_ASSERT_FATAL(dirindex_size(index) == 1);
+    CU_ASSERT(strcmp(dirindex_get_filename(index, 0), TESTFILE) == 0);
+    return *(const char *)dirindex_get_info(index, 0);
+}
+
+void test_dirindex_cached(void) {
+    dirindex index;
+    dirindex_create(&index, 1);
+    remove(TESTINDEX);
+    reads = 0;
+
+    // Written well before the scan, so it can be trusted afterwards without opening it
+    write_file("AAAA", time(NULL) - 1000);
+    CU_ASSERT(scan(&index) == 'A');
+    CU_ASSERT(reads == 1);
+    CU_ASSERT(scan(&index) == 'A');
+    CU_ASSERT(reads == 1);
+
+    // Same size, other timestamp
+    write_file("BBBB", time(NULL) - 900);
+    CU_ASSERT(scan(&index) == 'B');
+    CU_ASSERT(reads == 2);
+
+    dirindex_free(&index);
+    remove(TESTFILE);
+    remove(TESTINDEX);
+}
+
+void test_dirindex_racy(void) {
+    dirindex index;
+    dirindex_create(&index, 1);
+    remove(TESTINDEX);
+    reads = 0;
+
+    // Written again right after the scan, with the same size and most likely the same timestamp
+    write_file("AAAA", 0);
+    CU_ASSERT(scan(&index) == 'A');
+    write_file("BBBB", 0);
+    CU_ASSERT(scan(&index) == 'B');
+    CU_ASSERT(reads == 2);
+
+    // Touched without changing; the hash tells it apart
+    write_file("BBBB", 0);
+    CU_ASSERT(scan(&index) == 'B');
+    CU_ASSERT(reads == 2);
+
+    dirindex_free(&index);
+    remove(TESTFILE);
+    remove(TESTINDEX);
+}
+
+void dirindex_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of cached files", test_dirindex_cached) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of files written during a scan", test_dirindex_racy) == NULL) {
+        return;
+    }
+}
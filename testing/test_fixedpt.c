@@ -0,0 +1,143 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <stdint.h>
+#include <utils/fixedpt.h>
+
+static int close_to(fixedpt v, float expected, float tolerance) {
+    float f = fixedpt_to_float(v);
+    return f > expected - tolerance && f < expected + tolerance;
+}
+
+void test_fixedpt_convert(void) {
+    CU_ASSERT(fixedpt_to_int(fixedpt_from_int(42)) == 42);
+    CU_ASSERT(fixedpt_to_int(fixedpt_from_int(-42)) == -42);
+    CU_ASSERT(fixedpt_to_int(FIXEDPT(2.75)) == 2);
+    CU_ASSERT(fixedpt_to_int(FIXEDPT(-2.75)) == -2);
+    CU_ASSERT(fixedpt_to_float(FIXEDPT(0.5)) == 0.5f);
+    CU_ASSERT(fixedpt_from_float(1.25f) == FIXEDPT(1.25));
+}
+
+void test_fixedpt_arithmetic(void) {
+    CU_ASSERT(fixedpt_mul(FIXEDPT(1.5), FIXEDPT(-2.0)) == FIXEDPT(-3.0));
+    CU_ASSERT(fixedpt_div(FIXEDPT(3.0), FIXEDPT(1.5)) == FIXEDPT(2.0));
+    CU_ASSERT(fixedpt_abs(FIXEDPT(-0.25)) == FIXEDPT(0.25));
+    CU_ASSERT(close_to(fixedpt_mul(FIXEDPT(0.2), fixedpt_from_int(300)), 60.0f, 0.01f));
+    CU_ASSERT(close_to(fixedpt_div(fixedpt_from_int(-160), fixedpt_from_int(14)), -11.4286f, 0.001f));
+}
+
+void test_fixedpt_sqrt(void) {
+    CU_ASSERT(fixedpt_sqrt(0) == 0);
+    CU_ASSERT(close_to(fixedpt_sqrt(fixedpt_from_int(4)), 2.0f, 0.0001f));
+    CU_ASSERT(close_to(fixedpt_sqrt(FIXEDPT(2.0)), 1.41421f, 0.0001f));
+    CU_ASSERT(close_to(fixedpt_sqrt(fixedpt_from_int(10000)), 100.0f, 0.001f));
+}
+
+void test_fixedpt_trig(void) {
+    CU_ASSERT(close_to(fixedpt_sin(0), 0.0f, 0.002f));
+    CU_ASSERT(close_to(fixedpt_sin(FIXEDPT(1.5707963)), 1.0f, 0.002f));
+    CU_ASSERT(close_to(fixedpt_sin(FIXEDPT(-0.5)), -0.479426f, 0.002f));
+    CU_ASSERT(close_to(fixedpt_cos(0), 1.0f, 0.002f));
+    CU_ASSERT(close_to(fixedpt_cos(FIXEDPT(3.1415926)), -1.0f, 0.002f));
+
+    // Angles from the animation scripts are whole radians, well outside of -pi .. pi
+    CU_ASSERT(close_to(fixedpt_sin(fixedpt_from_int(90)), 0.893997f, 0.002f));
+    CU_ASSERT(close_to(fixedpt_cos(fixedpt_from_int(-200)), 0.487187f, 0.002f));
+}
+
+#ifdef FIXED_POINT_PHYSICS
+
+// The reference values below are exact, worked out with arbitrary precision integers
+
+void test_fixedpt_rounding(void) {
+    // Products and quotients round towards zero, like casting a float to an integer
+    CU_ASSERT(fixedpt_mul(1, 1) == 0);
+    CU_ASSERT(fixedpt_mul(-1, 1) == 0);
+    CU_ASSERT(fixedpt_mul(FIXEDPT(0.5), 3) == 1);
+    CU_ASSERT(fixedpt_mul(FIXEDPT(-0.5), 3) == -1);
+    CU_ASSERT(fixedpt_mul(FIXEDPT(3.3), FIXEDPT(-2.7)) == -583922);
+    CU_ASSERT(fixedpt_div(FIXEDPT(1.0), FIXEDPT(3.0)) == 21845);
+    CU_ASSERT(fixedpt_div(FIXEDPT(-1.0), FIXEDPT(3.0)) == -21845);
+    CU_ASSERT(fixedpt_div(1, FIXEDPT(2.0)) == 0);
+    CU_ASSERT(fixedpt_div(fixedpt_from_int(100), fixedpt_from_int(7)) == 936228);
+    CU_ASSERT(fixedpt_to_int(FIXEDPT(-0.75)) == 0);
+}
+
+void test_fixedpt_overflow(void) {
+    // The largest products and quotients that still fit
+    CU_ASSERT(fixedpt_mul(fixedpt_from_int(181), fixedpt_from_int(181)) == fixedpt_from_int(32761));
+    CU_ASSERT(fixedpt_mul(fixedpt_from_int(-181), fixedpt_from_int(181)) == fixedpt_from_int(-32761));
+    CU_ASSERT(fixedpt_div(fixedpt_from_int(16000), FIXEDPT(0.5)) == fixedpt_from_int(32000));
+
+    // Past that, results are clamped instead of wrapping around
+    CU_ASSERT(fixedpt_mul(fixedpt_from_int(200), fixedpt_from_int(200)) == INT32_MAX);
+    CU_ASSERT(fixedpt_mul(fixedpt_from_int(-200), fixedpt_from_int(200)) == INT32_MIN);
+    CU_ASSERT(fixedpt_mul(INT32_MIN, INT32_MIN) == INT32_MAX);
+    CU_ASSERT(fixedpt_div(fixedpt_from_int(30000), FIXEDPT(0.5)) == INT32_MAX);
+    CU_ASSERT(fixedpt_div(fixedpt_from_int(-30000), FIXEDPT(0.5)) == INT32_MIN);
+    CU_ASSERT(fixedpt_div(INT32_MIN, -FIXEDPT_ONE) == INT32_MAX);
+
+    // Division by zero
+    CU_ASSERT(fixedpt_div(FIXEDPT(1.0), 0) == INT32_MAX);
+    CU_ASSERT(fixedpt_div(FIXEDPT(-1.0), 0) == INT32_MIN);
+    CU_ASSERT(fixedpt_div(0, 0) == 0);
+}
+
+void test_fixedpt_sqrt_exact(void) {
+    // Rounds down, to the largest value whose square is not above v
+    CU_ASSERT(fixedpt_sqrt(1) == 256);
+    CU_ASSERT(fixedpt_sqrt(3) == 443);
+    CU_ASSERT(fixedpt_sqrt(FIXEDPT(0.25)) == FIXEDPT(0.5));
+    CU_ASSERT(fixedpt_sqrt(FIXEDPT(2.0)) == 92681);
+    CU_ASSERT(fixedpt_sqrt(fixedpt_from_int(10000)) == fixedpt_from_int(100));
+    CU_ASSERT(fixedpt_sqrt(INT32_MAX) == 11863283);
+    CU_ASSERT(fixedpt_sqrt(FIXEDPT(-4.0)) == 0);
+}
+
+#endif // FIXED_POINT_PHYSICS
+
+void fixedpt_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of conversions", test_fixedpt_convert) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of arithmetic", test_fixedpt_arithmetic) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of square root", test_fixedpt_sqrt) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of sine and cosine", test_fixedpt_trig) == NULL) {
+        return;
+    }
+#ifdef FIXED_POINT_PHYSICS
+    if(CU_add_test(suite, "test of rounding", test_fixedpt_rounding) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of overflows", test_fixedpt_overflow) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of exact square roots", test_fixedpt_sqrt_exact) == NULL) {
+        return;
+    }
+#endif
+}
+
+#ifdef FIXEDPT_TEST_MAIN
+// The game is usually built with float physics, so these tests are also built on their own with fixed point
+int main(int argc, char **argv) {
+    int ret = 0;
+    if(CU_initialize_registry() != CUE_SUCCESS) {
+        return CU_get_error();
+    }
+    CU_pSuite suite = CU_add_suite("Fixed point", NULL, NULL);
+    if(suite != NULL) {
+        fixedpt_test_suite(suite);
+        CU_basic_set_mode(CU_BRM_VERBOSE);
+        CU_basic_run_tests();
+    }
+    if(CU_get_number_of_tests_failed() != 0 || CU_get_error() != CUE_SUCCESS) {
+        ret = 1;
+    }
+    CU_cleanup_registry();
+    return ret;
+}
+#endif // FIXEDPT_TEST_MAIN
@@ -1,6 +1,7 @@
 #include <CUnit/Basic.h>
 #include <CUnit/CUnit.h>
-#include <stdio.h>
+#include <string.h>
+#include <utils/flatmap.h>
 #include <utils/hashmap.h>
 #include <utils/iterator.h>
 
@@ -183,6 +184,118 @@ void hashmap_test_autoresize(void) {
     hashmap_free(&test_map);
 }
 
+flatmap test_fmap;
+
+void test_flatmap_create(void) {
+    flatmap_create(&test_fmap, sizeof(int), sizeof(int), 4);
+    CU_ASSERT_PTR_NOT_NULL(test_fmap.slots);
+    CU_ASSERT(flatmap_reserved(&test_fmap) == 0);
+    CU_ASSERT(flatmap_size(&test_fmap) == 16);
+}
+
+void test_flatmap_insert(void) {
+    unsigned int i, k;
+    int *v;
+    for(i = 0; i < TEST_VAL_COUNT; i++) {
+        k = TEST_VAL_COUNT - i;
+        v = flatmap_iput(&test_fmap, i, &k);
+        CU_ASSERT_PTR_NOT_NULL(v);
+        CU_ASSERT(*v == k);
+        test_values[i] = k;
+    }
+    CU_ASSERT(flatmap_reserved(&test_fmap) == TEST_VAL_COUNT);
+
+    // Map should have grown, but stay under the maximum load
+    CU_ASSERT(flatmap_size(&test_fmap) >= TEST_VAL_COUNT);
+
+    // Re-adding an existing key replaces the value; size shouldn't change
+    i = TEST_VAL_COUNT / 2;
+    k = 12345;
+    v = flatmap_iput(&test_fmap, i, &k);
+    CU_ASSERT(*v == 12345);
+    k = test_values[i];
+    flatmap_iput(&test_fmap, i, &k);
+    CU_ASSERT(flatmap_reserved(&test_fmap) == TEST_VAL_COUNT);
+}
+
+void test_flatmap_get(void) {
+    unsigned int *val;
+    for(unsigned int i = 0; i < TEST_VAL_COUNT; i++) {
+        val = flatmap_iget(&test_fmap, i);
+        CU_ASSERT_FATAL(val != NULL);
+        CU_ASSERT(*val == test_values[i]);
+    }
+    CU_ASSERT_PTR_NULL(flatmap_iget(&test_fmap, TEST_VAL_COUNT + 1));
+}
+
+void test_flatmap_delete(void) {
+    int removed = 0;
+    for(unsigned int i = 0; i < TEST_VAL_COUNT; i += 10) {
+        CU_ASSERT(flatmap_idel(&test_fmap, i) == 0);
+        CU_ASSERT(flatmap_idel(&test_fmap, i) == 1);
+        CU_ASSERT_PTR_NULL(flatmap_iget(&test_fmap, i));
+        test_values[i] = 0;
+        removed++;
+    }
+    CU_ASSERT(flatmap_reserved(&test_fmap) == TEST_VAL_COUNT - removed);
+
+    // Remaining keys must still be reachable after the backward shifts
+    for(unsigned int i = 0; i < TEST_VAL_COUNT; i++) {
+        if(test_values[i] != 0) {
+            unsigned int *val = flatmap_iget(&test_fmap, i);
+            CU_ASSERT_FATAL(val != NULL);
+            CU_ASSERT(*val == test_values[i]);
+        }
+    }
+}
+
+void test_flatmap_iterator(void) {
+    iterator it;
+    unsigned int *val;
+    unsigned int seen = 0;
+    flatmap_iter_begin(&test_fmap, &it);
+    while((val = iter_next(&it)) != NULL) {
+        unsigned int key = TEST_VAL_COUNT - *val;
+        CU_ASSERT(test_values[key] == *val);
+        test_values[key] = 0;
+        seen++;
+    }
+    CU_ASSERT(seen == flatmap_reserved(&test_fmap));
+    for(unsigned int i = 0; i < TEST_VAL_COUNT; i++) {
+        CU_ASSERT(test_values[i] == 0);
+    }
+}
+
+void test_flatmap_iter_del(void) {
+    iterator it;
+    unsigned int *val;
+    unsigned int seen = 0;
+    unsigned int size = flatmap_reserved(&test_fmap);
+
+    // Delete every other entry; every entry must be visited exactly once
+    flatmap_iter_begin(&test_fmap, &it);
+    while((val = iter_next(&it)) != NULL) {
+        if(seen++ % 2 == 0) {
+            CU_ASSERT(flatmap_delete(&test_fmap, &it) == 0);
+        }
+    }
+    CU_ASSERT(seen == size);
+    CU_ASSERT(flatmap_reserved(&test_fmap) == size / 2);
+
+    flatmap_iter_begin(&test_fmap, &it);
+    while((val = iter_next(&it)) != NULL) {
+        CU_ASSERT(flatmap_delete(&test_fmap, &it) == 0);
+    }
+    CU_ASSERT(flatmap_reserved(&test_fmap) == 0);
+}
+
+void test_flatmap_free(void) {
+    flatmap_free(&test_fmap);
+    CU_ASSERT_PTR_NULL(test_fmap.slots);
+    CU_ASSERT_PTR_NULL(test_fmap.hashes);
+    CU_ASSERT(test_fmap.reserved == 0);
+}
+
 void hashmap_test_suite(CU_pSuite suite) {
     // Add tests
     if(CU_add_test(suite, "Test for hashmap create", test_hashmap_create) == NULL) {
@@ -219,3 +332,28 @@ void hashmap_test_suite(CU_pSuite suite) {
         return;
     }
 }
+
+void flatmap_test_suite(CU_pSuite suite) {
+    // Add tests
+    if(CU_add_test(suite, "Test for flatmap create", test_flatmap_create) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for flatmap insert operation", test_flatmap_insert) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for flatmap get operation", test_flatmap_get) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for flatmap delete operation", test_flatmap_delete) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for flatmap iterator", test_flatmap_iterator) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for flatmap iterator delete operation", test_flatmap_iter_del) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for flatmap free operation", test_flatmap_free) == NULL) {
+        return;
+    }
+}
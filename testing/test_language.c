@@ -0,0 +1,97 @@
+#include "formats/error.h"
+#include "formats/language.h"
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+#include <utils/allocator.h>
+
+#define TESTFILE "test.lngtest"
+#define TEST_STRINGS 5
+
+static char long_string[600];
+
+// An empty string in the middle, and one long enough for the xor key to wrap around
+static const char *test_string(int i) {
+    switch(i) {
+        case 0:
+            return "Hello";
+        case 1:
+            return "";
+        case 2:
+            return long_string;
+        case 3:
+            return "x";
+        default:
+            return "Last one, ends at the end of the file";
+    }
+}
+
+static void save_language(void) {
+    sd_language lang;
+    CU_ASSERT_FATAL(sd_language_create(&lang) == SD_SUCCESS);
+    memset(long_string, 0, sizeof(long_string));
+    for(unsigned int i = 0; i < sizeof(long_string) - 1; i++) {
+        long_string[i] = 'A' + i % 50;
+    }
+    lang.count = TEST_STRINGS;
+    lang.strings = omf_calloc(TEST_STRINGS, sizeof(sd_lang_string));
+    for(int i = 0; i < TEST_STRINGS; i++) {
+        snprintf(lang.strings[i].description, sizeof(lang.strings[i].description), "string %d", i);
+        size_t len = strlen(test_string(i));
+        lang.strings[i].data = omf_calloc(len + 1, 1);
+        memcpy(lang.strings[i].data, test_string(i), len);
+    }
+    CU_ASSERT(sd_language_save(&lang, TESTFILE) == SD_SUCCESS);
+    sd_language_free(&lang);
+}
+
+void test_language_roundtrip(void) {
+    sd_language lang;
+    sd_language_index index;
+    char description[32];
+
+    save_language();
+    CU_ASSERT_FATAL(sd_language_create(&lang) == SD_SUCCESS);
+    CU_ASSERT_FATAL(sd_language_load(&lang, TESTFILE) == SD_SUCCESS);
+    CU_ASSERT_FATAL(sd_language_load_index(&index, TESTFILE) == SD_SUCCESS);
+    CU_ASSERT(lang.count == TEST_STRINGS);
+    CU_ASSERT(index.count == TEST_STRINGS);
+
+    // Strings decoded on demand are the same as the ones loaded all at once
+    for(int i = 0; i < TEST_STRINGS && i < (int)index.count; i++) {
+        char *str = NULL;
+        snprintf(description, sizeof(description), "string %d", i);
+        CU_ASSERT(strcmp(sd_language_get(&lang, i)->description, description) == 0);
+        CU_ASSERT(strcmp(sd_language_get(&lang, i)->data, test_string(i)) == 0);
+        CU_ASSERT(sd_language_load_string(&str, &index, TESTFILE, i) == SD_SUCCESS);
+        if(str != NULL) {
+            CU_ASSERT(strcmp(str, lang.strings[i].data) == 0);
+            omf_free(str);
+        }
+    }
+
+    char *str = NULL;
+    CU_ASSERT(sd_language_load_string(&str, &index, TESTFILE, TEST_STRINGS) == SD_INVALID_INPUT);
+    CU_ASSERT(sd_language_load_string(&str, &index, TESTFILE, -1) == SD_INVALID_INPUT);
+    CU_ASSERT(sd_language_get(&lang, TEST_STRINGS) == NULL);
+
+    sd_language_index_free(&index);
+    sd_language_free(&lang);
+    remove(TESTFILE);
+}
+
+void test_language_missing(void) {
+    sd_language_index index;
+    CU_ASSERT(sd_language_load_index(&index, "no_such_file.lngtest") == SD_FILE_OPEN_ERROR);
+    CU_ASSERT(sd_language_load_index(NULL, TESTFILE) == SD_INVALID_INPUT);
+}
+
+void language_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of language roundtrip", test_language_roundtrip) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of missing language file", test_language_missing) == NULL) {
+        return;
+    }
+}
@@ -0,0 +1,125 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <controller/controller.h>
+#include <net/lockstep.h>
+
+// Delivers a message from one end to the other, unless it gets lost
+static void deliver(const lockstep *from, lockstep *to, int lost) {
+    serial ser;
+    serial_create(&ser);
+    lockstep_write(from, &ser, 0);
+    if(!lost) {
+        CU_ASSERT(lockstep_read(to, &ser) == 0);
+    }
+    serial_free(&ser);
+}
+
+void test_lockstep_delay(void) {
+    lockstep a, b;
+    const lockstep_input *local, *remote;
+    lockstep_create(&a, 2);
+    lockstep_create(&b, 2);
+
+    // Frames before the delay are empty, and need nothing from the peer
+    CU_ASSERT(lockstep_ready(&a));
+    lockstep_add_local(&a, ACT_PUNCH);
+    lockstep_advance(&a, &local, &remote);
+    CU_ASSERT(local->count == 0);
+    CU_ASSERT(remote != NULL && remote->count == 0);
+    lockstep_advance(&a, &local, &remote);
+    CU_ASSERT(!lockstep_ready(&a));
+
+    // The punch is due on frame 2 on both ends
+    lockstep_advance(&b, &local, &remote);
+    lockstep_advance(&b, &local, &remote);
+    deliver(&a, &b, 0);
+    deliver(&b, &a, 0);
+    CU_ASSERT(lockstep_ready(&a));
+    CU_ASSERT(lockstep_ready(&b));
+    lockstep_advance(&a, &local, &remote);
+    CU_ASSERT(local->count == 1 && local->actions[0] == ACT_PUNCH);
+    CU_ASSERT(remote->count == 0);
+    lockstep_advance(&b, &local, &remote);
+    CU_ASSERT(local->count == 0);
+    CU_ASSERT(remote->count == 1 && remote->actions[0] == ACT_PUNCH);
+}
+
+void test_lockstep_loss(void) {
+    lockstep a, b;
+    const lockstep_input *local, *remote;
+    lockstep_create(&a, 3);
+    lockstep_create(&b, 3);
+
+    // The messages of the first frames get lost, and the last one carries all of the inputs
+    for(int frame = 0; frame < 3; frame++) {
+        lockstep_add_local(&a, ACT_UP << frame);
+        lockstep_advance(&a, &local, &remote);
+        deliver(&a, &b, frame < 2);
+    }
+    CU_ASSERT(b.remote_last == 5);
+    for(int frame = 0; frame < 6; frame++) {
+        CU_ASSERT(lockstep_ready(&b));
+        lockstep_advance(&b, &local, &remote);
+        if(frame >= 3) {
+            CU_ASSERT(remote->count == 1 && remote->actions[0] == (ACT_UP << (frame - 3)));
+        }
+    }
+    CU_ASSERT(!lockstep_ready(&b));
+
+    // Acknowledged inputs are not sent again
+    deliver(&b, &a, 0);
+    CU_ASSERT(a.acked == 5);
+    serial ser;
+    serial_create(&ser);
+    lockstep_write(&a, &ser, 0);
+    CU_ASSERT(ser.wpos == 10);
+    serial_free(&ser);
+}
+
+void test_lockstep_done(void) {
+    lockstep a, b;
+    const lockstep_input *local, *remote;
+    lockstep_create(&a, 1);
+    lockstep_create(&b, 1);
+    lockstep_advance(&b, &local, &remote);
+    CU_ASSERT(!lockstep_ready(&b));
+
+    serial ser;
+    serial_create(&ser);
+    lockstep_write(&a, &ser, 1);
+    CU_ASSERT(lockstep_read(&b, &ser) == 0);
+    serial_free(&ser);
+    CU_ASSERT(lockstep_ready(&b));
+    lockstep_advance(&b, &local, &remote);
+    CU_ASSERT(remote == NULL);
+}
+
+void test_lockstep_broken(void) {
+    lockstep ls;
+    lockstep_create(&ls, 1);
+    serial ser;
+    serial_create(&ser);
+    serial_write_int8(&ser, 0);
+    serial_write_int32(&ser, 0);
+    serial_write_int32(&ser, 1);
+    serial_write_int8(&ser, 1);
+    serial_write_int8(&ser, LOCKSTEP_MAX_ACTIONS + 1);
+    CU_ASSERT(lockstep_read(&ls, &ser) == 1);
+    CU_ASSERT(ls.remote_last == 0);
+    serial_free(&ser);
+}
+
+void lockstep_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of input delay", test_lockstep_delay) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of lost messages", test_lockstep_loss) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of peer leaving", test_lockstep_done) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of broken messages", test_lockstep_broken) == NULL) {
+        return;
+    }
+}
@@ -0,0 +1,123 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+#include <utils/log.h>
+
+#define TESTFILE "test.logtest"
+#define TEST_LINES 3000
+#define TEST_LINE_MAX 1024
+
+// Deferred records are 16 bytes or more, so this many of them wrap a 64 KiB ring
+#define TEST_WRAP_RECORDS 4200
+
+typedef void (*expected_fn)(char *out, int i, int variant);
+
+static void log_text(int i, int len) {
+    char payload[1200];
+    memset(payload, 'a' + i % 26, len);
+    payload[len] = 0;
+    log_print('I', NULL, "msg %d %s", i, payload);
+}
+
+static void log_trace(int i) {
+    int args[LOG_TRACE_ARGS] = {i, i * 7, 0, 0};
+    log_print_deferred('D', NULL, "trace %d %d", args);
+}
+
+static void expected_text(char *out, int i, int len) {
+    int pos = snprintf(out, TEST_LINE_MAX, "msg %d ", i);
+    if(len > TEST_LINE_MAX - 1 - pos) {
+        len = TEST_LINE_MAX - 1 - pos;
+    }
+    memset(out + pos, 'a' + i % 26, len);
+    out[pos + len] = 0;
+}
+
+static void expected_trace(char *out, int i) {
+    snprintf(out, TEST_LINE_MAX, "trace %d %d", i, i * 7);
+}
+
+// Checks that every line came out once, in order, and that long lines were cut short
+static void check_log(int count, expected_fn expected, int variant) {
+    char want[TEST_LINE_MAX];
+    char line[TEST_LINE_MAX + 64];
+    FILE *fp = fopen(TESTFILE, "r");
+    CU_ASSERT_FATAL(fp != NULL);
+    int lines = 0;
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        line[strcspn(line, "\n")] = 0;
+        const char *text = strstr(line, "] ");
+        if(lines >= count || text == NULL) {
+            lines++;
+            break;
+        }
+        expected(want, lines, variant);
+        if(strcmp(text + 2, want) != 0) {
+            CU_FAIL("Log line does not match");
+            break;
+        }
+        lines++;
+    }
+    fclose(fp);
+    CU_ASSERT(lines == count);
+    remove(TESTFILE);
+}
+
+// Every third message is deferred, the others are text of up to more than the longest line
+static void expected_mixed(char *out, int i, int variant) {
+    if(i % 3 == 2) {
+        expected_trace(out, i);
+    } else {
+        expected_text(out, i, (i * 37) % 1200);
+    }
+}
+
+// A text line of the given length, and then deferred ones
+static void expected_shifted(char *out, int i, int len) {
+    if(i == 0) {
+        expected_text(out, i, len);
+    } else {
+        expected_trace(out, i);
+    }
+}
+
+void test_log_ring(void) {
+    // Text records reserve room for the longest line, so they wrap the ring with long padding at its end
+    remove(TESTFILE);
+    CU_ASSERT_FATAL(log_init(TESTFILE) == 0);
+    for(int i = 0; i < TEST_LINES; i++) {
+        if(i % 3 == 2) {
+            log_trace(i);
+        } else {
+            log_text(i, (i * 37) % 1200);
+        }
+    }
+    log_close();
+    check_log(TEST_LINES, expected_mixed, 0);
+}
+
+void test_log_ring_padding(void) {
+    // Each run starts from an empty ring. The text line moves the deferred records that follow it by
+    // a multiple of the record alignment, so that the space left at the end when they wrap is every
+    // size there is, including ones too short to hold a padding record.
+    for(int len = 0; len < 48; len++) {
+        remove(TESTFILE);
+        CU_ASSERT_FATAL(log_init(TESTFILE) == 0);
+        log_text(0, len);
+        for(int i = 1; i < TEST_WRAP_RECORDS; i++) {
+            log_trace(i);
+        }
+        log_close();
+        check_log(TEST_WRAP_RECORDS, expected_shifted, len);
+    }
+}
+
+void log_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of log ring", test_log_ring) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of log ring padding", test_log_ring_padding) == NULL) {
+        return;
+    }
+}
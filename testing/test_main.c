@@ -9,10 +9,26 @@ void trn_test_suite(CU_pSuite suite);
 void script_test_suite(CU_pSuite suite);
 void str_test_suite(CU_pSuite suite);
 void hashmap_test_suite(CU_pSuite suite);
+void flatmap_test_suite(CU_pSuite suite);
 void vector_test_suite(CU_pSuite suite);
 void list_test_suite(CU_pSuite suite);
 void array_test_suite(CU_pSuite suite);
+void memarena_test_suite(CU_pSuite suite);
+void object_pool_test_suite(CU_pSuite suite);
+void sync_delta_test_suite(CU_pSuite suite);
+void relay_stream_test_suite(CU_pSuite suite);
+void fixedpt_test_suite(CU_pSuite suite);
+void lockstep_test_suite(CU_pSuite suite);
+void netsim_test_suite(CU_pSuite suite);
+void replay_trace_test_suite(CU_pSuite suite);
 void text_render_test_suite(CU_pSuite suite);
+void video_cache_test_suite(CU_pSuite suite);
+void dirindex_test_suite(CU_pSuite suite);
+void scalers_test_suite(CU_pSuite suite);
+void soft_render_test_suite(CU_pSuite suite);
+void log_test_suite(CU_pSuite suite);
+void language_test_suite(CU_pSuite suite);
+void tcache_test_suite(CU_pSuite suite);
 
 int main(int argc, char **argv) {
     CU_pSuite suite = NULL;
@@ -63,6 +79,11 @@ int main(int argc, char **argv) {
         goto end;
     hashmap_test_suite(hashmap_suite);
 
+    CU_pSuite flatmap_suite = CU_add_suite("Flatmap", NULL, NULL);
+    if(flatmap_suite == NULL)
+        goto end;
+    flatmap_test_suite(flatmap_suite);
+
     CU_pSuite vector_suite = CU_add_suite("Vector", NULL, NULL);
     if(vector_suite == NULL)
         goto end;
@@ -78,11 +99,87 @@ int main(int argc, char **argv) {
         goto end;
     array_test_suite(array_suite);
 
+    CU_pSuite memarena_suite = CU_add_suite("Memory arena", NULL, NULL);
+    if(memarena_suite == NULL)
+        goto end;
+    memarena_test_suite(memarena_suite);
+
+    CU_pSuite object_pool_suite = CU_add_suite("Object pool", NULL, NULL);
+    if(object_pool_suite == NULL)
+        goto end;
+    object_pool_test_suite(object_pool_suite);
+
+    CU_pSuite sync_delta_suite = CU_add_suite("Sync delta", NULL, NULL);
+    if(sync_delta_suite == NULL)
+        goto end;
+    sync_delta_test_suite(sync_delta_suite);
+
+    CU_pSuite relay_stream_suite = CU_add_suite("Relay stream", NULL, NULL);
+    if(relay_stream_suite == NULL)
+        goto end;
+    relay_stream_test_suite(relay_stream_suite);
+
+    CU_pSuite fixedpt_suite = CU_add_suite("Fixed point", NULL, NULL);
+    if(fixedpt_suite == NULL)
+        goto end;
+    fixedpt_test_suite(fixedpt_suite);
+
+    CU_pSuite lockstep_suite = CU_add_suite("Lockstep", NULL, NULL);
+    if(lockstep_suite == NULL)
+        goto end;
+    lockstep_test_suite(lockstep_suite);
+
+    CU_pSuite netsim_suite = CU_add_suite("Network simulator", NULL, NULL);
+    if(netsim_suite == NULL)
+        goto end;
+    netsim_test_suite(netsim_suite);
+
+    CU_pSuite replay_trace_suite = CU_add_suite("Replay trace", NULL, NULL);
+    if(replay_trace_suite == NULL)
+        goto end;
+    replay_trace_test_suite(replay_trace_suite);
+
     CU_pSuite text_render_suite = CU_add_suite("Text Renderer", NULL, NULL);
     if(text_render_suite == NULL)
         goto end;
     text_render_test_suite(text_render_suite);
 
+    CU_pSuite video_cache_suite = CU_add_suite("Video caches", NULL, NULL);
+    if(video_cache_suite == NULL)
+        goto end;
+    video_cache_test_suite(video_cache_suite);
+
+    CU_pSuite dirindex_suite = CU_add_suite("Directory index", NULL, NULL);
+    if(dirindex_suite == NULL)
+        goto end;
+    dirindex_test_suite(dirindex_suite);
+
+    CU_pSuite scalers_suite = CU_add_suite("Scalers", NULL, NULL);
+    if(scalers_suite == NULL)
+        goto end;
+    scalers_test_suite(scalers_suite);
+
+    CU_pSuite soft_render_suite = CU_add_suite("Software rendering", NULL, NULL);
+    if(soft_render_suite == NULL)
+        goto end;
+    soft_render_test_suite(soft_render_suite);
+
+    CU_pSuite log_suite = CU_add_suite("Log", NULL, NULL);
+    if(log_suite == NULL)
+        goto end;
+    log_test_suite(log_suite);
+
+    CU_pSuite language_suite = CU_add_suite("Language", NULL, NULL);
+    if(language_suite == NULL)
+        goto end;
+    language_test_suite(language_suite);
+
+    // After the video caches, which have their own texture cache open while they run
+    CU_pSuite tcache_suite = CU_add_suite("Texture cache", NULL, NULL);
+    if(tcache_suite == NULL)
+        goto end;
+    tcache_test_suite(tcache_suite);
+
     // Run tests
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
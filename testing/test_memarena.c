@@ -0,0 +1,92 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+#include <utils/memarena.h>
+
+#define TEST_BLOCK_SIZE 256
+#define TEST_ALLOC_COUNT 100
+
+memarena test_arena;
+
+void test_memarena_create(void) {
+    memarena_create(&test_arena, TEST_BLOCK_SIZE);
+    CU_ASSERT_PTR_NULL(test_arena.head);
+    CU_ASSERT(test_arena.used == 0);
+    CU_ASSERT(test_arena.block_num == 0);
+}
+
+void test_memarena_alloc(void) {
+    char *ptrs[TEST_ALLOC_COUNT];
+    for(int i = 0; i < TEST_ALLOC_COUNT; i++) {
+        ptrs[i] = memarena_alloc(&test_arena, 24);
+        CU_ASSERT_PTR_NOT_NULL(ptrs[i]);
+        CU_ASSERT((uintptr_t)ptrs[i] % alignof(max_align_t) == 0);
+        memset(ptrs[i], i, 24);
+    }
+
+    // Make sure allocations did not overlap
+    for(int i = 0; i < TEST_ALLOC_COUNT; i++) {
+        CU_ASSERT(ptrs[i][0] == (char)i);
+        CU_ASSERT(ptrs[i][23] == (char)i);
+    }
+    CU_ASSERT(test_arena.allocs == TEST_ALLOC_COUNT);
+    CU_ASSERT(test_arena.block_num > 1);
+
+    // Allocations larger than the block size must also work
+    char *big = memarena_alloc(&test_arena, TEST_BLOCK_SIZE * 4);
+    CU_ASSERT_PTR_NOT_NULL(big);
+    memset(big, 0xFF, TEST_BLOCK_SIZE * 4);
+}
+
+void test_memarena_rewind(void) {
+    size_t used = test_arena.used;
+    memarena_mark mark = memarena_get_mark(&test_arena);
+    for(int i = 0; i < TEST_ALLOC_COUNT; i++) {
+        memarena_alloc(&test_arena, TEST_BLOCK_SIZE / 2);
+    }
+    CU_ASSERT(test_arena.used > used);
+    memarena_rewind(&test_arena, mark);
+    CU_ASSERT(test_arena.used == used);
+    CU_ASSERT_PTR_EQUAL(test_arena.head, mark.block);
+}
+
+void test_memarena_reset(void) {
+    size_t peak = test_arena.peak;
+    memarena_reset(&test_arena);
+    CU_ASSERT(test_arena.used == 0);
+    CU_ASSERT(test_arena.allocs == 0);
+
+    // Blocks should have been merged into one that can hold the peak usage
+    CU_ASSERT(test_arena.block_num == 1);
+    for(size_t i = 0; i < peak / 64; i++) {
+        memarena_alloc(&test_arena, 64);
+    }
+    CU_ASSERT(test_arena.block_num == 1);
+}
+
+void test_memarena_free(void) {
+    memarena_free(&test_arena);
+    CU_ASSERT_PTR_NULL(test_arena.head);
+    CU_ASSERT(test_arena.block_num == 0);
+}
+
+void memarena_test_suite(CU_pSuite suite) {
+    // Add tests
+    if(CU_add_test(suite, "Test for memarena create", test_memarena_create) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for memarena alloc", test_memarena_alloc) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for memarena rewind", test_memarena_rewind) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for memarena reset", test_memarena_reset) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for memarena free", test_memarena_free) == NULL) {
+        return;
+    }
+}
@@ -0,0 +1,114 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <net/netsim.h>
+
+#define MAX_RECEIVED 16
+
+typedef struct {
+    int count;
+    char first_bytes[MAX_RECEIVED];
+} received;
+
+static void receive(const char *data, size_t len, void *userdata) {
+    received *r = userdata;
+    if(r->count < MAX_RECEIVED) {
+        r->first_bytes[r->count] = data[0];
+    }
+    r->count++;
+}
+
+static void conditions(netsim_conditions *cond, int delay, int loss, int duplicate, int reorder) {
+    cond->delay = delay;
+    cond->jitter = 0;
+    cond->loss = loss;
+    cond->duplicate = duplicate;
+    cond->reorder = reorder;
+}
+
+void test_netsim_delay(void) {
+    netsim_conditions cond;
+    netsim_link link;
+    received r = {0};
+    conditions(&cond, 100, 0, 0, 0);
+    netsim_link_create(&link, &cond, 1);
+    netsim_link_push(&link, "a", 1, 0);
+    netsim_link_push(&link, "b", 1, 10);
+
+    netsim_link_release(&link, 99, receive, &r);
+    CU_ASSERT(r.count == 0);
+    netsim_link_release(&link, 100, receive, &r);
+    CU_ASSERT(r.count == 1);
+    netsim_link_release(&link, 110, receive, &r);
+    CU_ASSERT(r.count == 2);
+    CU_ASSERT(r.first_bytes[0] == 'a');
+    CU_ASSERT(r.first_bytes[1] == 'b');
+    CU_ASSERT(link.stats.delivered == 2);
+    CU_ASSERT(link.stats.bytes == 2);
+    netsim_link_free(&link);
+}
+
+void test_netsim_loss(void) {
+    netsim_conditions cond;
+    netsim_link link;
+    received r = {0};
+    conditions(&cond, 0, 10, 0, 0);
+    netsim_link_create(&link, &cond, 1);
+    for(int i = 0; i < 1000; i++) {
+        netsim_link_push(&link, "a", 1, 0);
+    }
+    netsim_link_release(&link, 0, receive, &r);
+    CU_ASSERT(link.stats.datagrams == 1000);
+    CU_ASSERT(link.stats.lost > 50 && link.stats.lost < 150);
+    CU_ASSERT(r.count + link.stats.lost == 1000);
+    netsim_link_free(&link);
+}
+
+void test_netsim_duplicate(void) {
+    netsim_conditions cond;
+    netsim_link link;
+    received r = {0};
+    conditions(&cond, 0, 0, 100, 0);
+    netsim_link_create(&link, &cond, 1);
+    netsim_link_push(&link, "a", 1, 0);
+    netsim_link_push(&link, "b", 1, 0);
+    netsim_link_release(&link, 0, receive, &r);
+    CU_ASSERT(r.count == 4);
+    CU_ASSERT(link.stats.duplicated == 2);
+    netsim_link_free(&link);
+}
+
+void test_netsim_reorder(void) {
+    netsim_conditions cond;
+    netsim_link link;
+    received r = {0};
+    conditions(&cond, 20, 0, 0, 100);
+    netsim_link_create(&link, &cond, 1);
+
+    // Only the first datagram is held back, and the second one passes it
+    netsim_link_push(&link, "a", 1, 0);
+    link.cond.reorder = 0;
+    netsim_link_push(&link, "b", 1, 5);
+    netsim_link_release(&link, 25, receive, &r);
+    CU_ASSERT(r.count == 1);
+    netsim_link_release(&link, 1000, receive, &r);
+    CU_ASSERT(r.count == 2);
+    CU_ASSERT(r.first_bytes[0] == 'b');
+    CU_ASSERT(r.first_bytes[1] == 'a');
+    CU_ASSERT(link.stats.reordered == 1);
+    netsim_link_free(&link);
+}
+
+void netsim_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of delay", test_netsim_delay) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of loss", test_netsim_loss) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of duplicates", test_netsim_duplicate) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of reordering", test_netsim_reorder) == NULL) {
+        return;
+    }
+}
@@ -0,0 +1,92 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <game/protos/object.h>
+#include <game/utils/object_pool.h>
+
+#define TEST_OBJ_COUNT 200
+
+static object_pool test_pool;
+static object test_objs[TEST_OBJ_COUNT];
+static object_handle test_handles[TEST_OBJ_COUNT];
+
+void test_object_pool_create(void) {
+    object_pool_create(&test_pool);
+    CU_ASSERT(object_pool_size(&test_pool) == 0);
+    CU_ASSERT_PTR_NULL(object_pool_get(&test_pool, OBJECT_HANDLE_NONE));
+}
+
+void test_object_pool_add(void) {
+    for(int i = 0; i < TEST_OBJ_COUNT; i++) {
+        test_objs[i].group = i % 3;
+        test_objs[i].layers = 1 << (i % 8);
+        test_handles[i] = object_pool_add(&test_pool, &test_objs[i], i % 3, 0);
+        CU_ASSERT(test_handles[i] != OBJECT_HANDLE_NONE);
+        CU_ASSERT(test_objs[i].handle == test_handles[i]);
+    }
+    CU_ASSERT(object_pool_size(&test_pool) == TEST_OBJ_COUNT);
+    for(int i = 0; i < TEST_OBJ_COUNT; i++) {
+        CU_ASSERT_PTR_EQUAL(object_pool_get(&test_pool, test_handles[i]), &test_objs[i]);
+        CU_ASSERT(test_pool.group[i] == i % 3);
+        CU_ASSERT(test_pool.render_layer[i] == i % 3);
+    }
+}
+
+void test_object_pool_remove(void) {
+    for(int i = 0; i < TEST_OBJ_COUNT; i += 2) {
+        CU_ASSERT(object_pool_remove(&test_pool, test_handles[i]) == 0);
+        CU_ASSERT(object_pool_remove(&test_pool, test_handles[i]) == 1);
+        CU_ASSERT_PTR_NULL(object_pool_get(&test_pool, test_handles[i]));
+        CU_ASSERT(test_objs[i].handle == OBJECT_HANDLE_NONE);
+    }
+    CU_ASSERT(object_pool_size(&test_pool) == TEST_OBJ_COUNT / 2);
+}
+
+void test_object_pool_compact(void) {
+    object_pool_compact(&test_pool);
+    CU_ASSERT(test_pool.count == TEST_OBJ_COUNT / 2);
+
+    // Order must be preserved, and handles must still resolve
+    for(unsigned int i = 0; i < test_pool.count; i++) {
+        CU_ASSERT_PTR_EQUAL(test_pool.objs[i], &test_objs[i * 2 + 1]);
+        CU_ASSERT_PTR_EQUAL(object_pool_get(&test_pool, test_handles[i * 2 + 1]), &test_objs[i * 2 + 1]);
+    }
+}
+
+void test_object_pool_reuse(void) {
+    // Reused slots must not make old handles resolve again
+    object_handle h = object_pool_add(&test_pool, &test_objs[0], 0, OBJECT_POOL_PERSISTENT);
+    CU_ASSERT(h != test_handles[0]);
+    CU_ASSERT_PTR_EQUAL(object_pool_get(&test_pool, h), &test_objs[0]);
+    for(int i = 0; i < TEST_OBJ_COUNT; i += 2) {
+        CU_ASSERT_PTR_NULL(object_pool_get(&test_pool, test_handles[i]));
+    }
+    CU_ASSERT(test_pool.flags[test_pool.count - 1] == OBJECT_POOL_PERSISTENT);
+}
+
+void test_object_pool_free(void) {
+    object_pool_free(&test_pool);
+    CU_ASSERT_PTR_NULL(test_pool.objs);
+    CU_ASSERT(test_pool.count == 0);
+}
+
+void object_pool_test_suite(CU_pSuite suite) {
+    // Add tests
+    if(CU_add_test(suite, "Test for object pool create", test_object_pool_create) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for object pool add", test_object_pool_add) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for object pool remove", test_object_pool_remove) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for object pool compact", test_object_pool_compact) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for object pool slot reuse", test_object_pool_reuse) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "Test for object pool free", test_object_pool_free) == NULL) {
+        return;
+    }
+}
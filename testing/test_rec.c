@@ -4,6 +4,7 @@
 #include <CUnit/CUnit.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 sd_rec_file rec;
 
@@ -64,6 +65,44 @@ void test_rec_roundtrip(void) {
     sd_rec_free(&loaded);
 }
 
+void test_rec_checksum_roundtrip(void) {
+    sd_rec_file saved;
+    sd_rec_file loaded;
+    CU_ASSERT(sd_rec_create(&saved) == SD_SUCCESS);
+    CU_ASSERT(sd_rec_create(&loaded) == SD_SUCCESS);
+
+    // Checksum records between regular moves
+    for(int i = 0; i < 10; i++) {
+        sd_rec_move mv;
+        memset(&mv, 0, sizeof(sd_rec_move));
+        mv.tick = i;
+        if(i % 3 == 0) {
+            mv.lookup_id = 2;
+            mv.action = SD_ACT_PUNCH | SD_ACT_UP;
+        } else {
+            mv.lookup_id = SD_REC_CHECKSUM;
+            mv.checksum = 0xDEADBE00 + i;
+        }
+        sd_rec_insert_action(&saved, i, &mv);
+    }
+
+    CU_ASSERT(sd_rec_save(&saved, "test_checksum.rec") == SD_SUCCESS);
+    CU_ASSERT(sd_rec_load(&loaded, "test_checksum.rec") == SD_SUCCESS);
+    CU_ASSERT(saved.move_count == loaded.move_count);
+    for(int i = 0; i < saved.move_count && i < loaded.move_count; i++) {
+        CU_ASSERT(saved.moves[i].tick == loaded.moves[i].tick);
+        CU_ASSERT(saved.moves[i].lookup_id == loaded.moves[i].lookup_id);
+        if(saved.moves[i].lookup_id == SD_REC_CHECKSUM) {
+            CU_ASSERT(saved.moves[i].checksum == loaded.moves[i].checksum);
+        } else {
+            CU_ASSERT(saved.moves[i].action == loaded.moves[i].action);
+        }
+    }
+
+    sd_rec_free(&saved);
+    sd_rec_free(&loaded);
+}
+
 void test_crystal_shirro_load(void) {
     CU_ASSERT(sd_rec_create(&rec) == SD_SUCCESS);
     CU_ASSERT(sd_rec_load(&rec, TESTS_ROOT_DIR "/recs/crystal-shirro.rec") == SD_SUCCESS);
@@ -80,6 +119,9 @@ void rec_test_suite(CU_pSuite suite) {
     if(CU_add_test(suite, "test of sd_rec_free", test_sd_rec_free) == NULL) {
         return;
     }
+    if(CU_add_test(suite, "test of REC checksum records", test_rec_checksum_roundtrip) == NULL) {
+        return;
+    }
     if(CU_add_test(suite, "test loading crystal-shirro.rec", test_crystal_shirro_load) == NULL) {
         return;
     }
@@ -0,0 +1,119 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <net/relay.h>
+#include <net/relay_stream.h>
+
+#define MAX_RECEIVED 16
+
+typedef struct {
+    int count;
+    char types[MAX_RECEIVED];
+    size_t lens[MAX_RECEIVED];
+} received;
+
+static void receive(const serial *msg, void *userdata) {
+    received *r = userdata;
+    if(r->count < MAX_RECEIVED) {
+        r->types[r->count] = msg->data[0];
+        r->lens[r->count] = msg->wpos;
+    }
+    r->count++;
+}
+
+static void push(relay_stream *stream, char type, size_t len, unsigned int now) {
+    char data[32] = {0};
+    data[0] = type;
+    relay_stream_push(stream, data, len, now);
+}
+
+void test_relay_stream_delay(void) {
+    relay_stream stream;
+    received r = {0};
+    relay_stream_create(&stream, 1000);
+    push(&stream, RELAY_MATCH, 11, 0);
+    push(&stream, RELAY_ACTION, 8, 500);
+
+    relay_stream_release(&stream, 999, receive, &r);
+    CU_ASSERT(r.count == 0);
+    relay_stream_release(&stream, 1000, receive, &r);
+    CU_ASSERT(r.count == 1);
+    CU_ASSERT(r.types[0] == RELAY_MATCH);
+    CU_ASSERT(r.lens[0] == 11);
+    relay_stream_release(&stream, 1500, receive, &r);
+    CU_ASSERT(r.count == 2);
+    CU_ASSERT(r.types[1] == RELAY_ACTION);
+    relay_stream_free(&stream);
+}
+
+void test_relay_stream_catch_up(void) {
+    relay_stream stream;
+    received r = {0};
+    relay_stream_create(&stream, 0);
+
+    // Nothing to catch up with before there is a match
+    relay_stream_catch_up(&stream, receive, &r);
+    CU_ASSERT(r.count == 0);
+
+    push(&stream, RELAY_MATCH, 11, 0);
+    push(&stream, RELAY_ACTION, 8, 0);
+    push(&stream, RELAY_SNAPSHOT, 20, 0);
+    push(&stream, RELAY_ACTION, 8, 0);
+    push(&stream, RELAY_ACTION, 8, 0);
+    relay_stream_release(&stream, 0, receive, &r);
+    CU_ASSERT(r.count == 5);
+
+    // The action before the snapshot is already part of it
+    r.count = 0;
+    relay_stream_catch_up(&stream, receive, &r);
+    CU_ASSERT(r.count == 4);
+    CU_ASSERT(r.types[0] == RELAY_MATCH);
+    CU_ASSERT(r.types[1] == RELAY_SNAPSHOT);
+    CU_ASSERT(r.lens[1] == 20);
+    CU_ASSERT(r.types[2] == RELAY_ACTION);
+    CU_ASSERT(r.types[3] == RELAY_ACTION);
+    relay_stream_free(&stream);
+}
+
+void test_relay_stream_end(void) {
+    relay_stream stream;
+    received r = {0};
+    relay_stream_create(&stream, 0);
+    push(&stream, RELAY_MATCH, 11, 0);
+    push(&stream, RELAY_SNAPSHOT, 20, 0);
+    push(&stream, RELAY_ACTION, 8, 0);
+    push(&stream, RELAY_END, 1, 0);
+    relay_stream_release(&stream, 0, receive, &r);
+    CU_ASSERT(r.count == 4);
+    CU_ASSERT(r.types[3] == RELAY_END);
+
+    r.count = 0;
+    relay_stream_catch_up(&stream, receive, &r);
+    CU_ASSERT(r.count == 0);
+    relay_stream_free(&stream);
+}
+
+void test_relay_stream_unknown(void) {
+    relay_stream stream;
+    received r = {0};
+    relay_stream_create(&stream, 0);
+    push(&stream, 0x7F, 4, 0);
+    push(&stream, RELAY_WATCH, 1, 0);
+    relay_stream_release(&stream, 0, receive, &r);
+    CU_ASSERT(r.count == 0);
+    relay_stream_free(&stream);
+}
+
+void relay_stream_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of delayed release", test_relay_stream_delay) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of late join catch up", test_relay_stream_catch_up) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of match end", test_relay_stream_end) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of unknown messages", test_relay_stream_unknown) == NULL) {
+        return;
+    }
+}
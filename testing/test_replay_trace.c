@@ -0,0 +1,83 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <game/utils/replay_trace.h>
+#include <stdio.h>
+
+static void fill(replay_trace *trace, unsigned int ticks) {
+    replay_trace_create(trace);
+    for(unsigned int i = 0; i < ticks; i++) {
+        replay_trace_add(trace, i + 10, i * 2654435761u);
+    }
+    trace->outcome.winner = 1;
+    trace->outcome.health[0] = 0;
+    trace->outcome.health[1] = 120;
+    trace->outcome.score[0] = 4500;
+    trace->outcome.score[1] = 31200;
+}
+
+void test_replay_trace_roundtrip(void) {
+    replay_trace saved;
+    replay_trace loaded;
+    unsigned int tick = 0;
+    fill(&saved, 100);
+    replay_trace_create(&loaded);
+
+    CU_ASSERT(replay_trace_save(&saved, "test.trace") == 0);
+    CU_ASSERT(replay_trace_load(&loaded, "test.trace") == 0);
+    CU_ASSERT(vector_size(&loaded.ticks) == 100);
+    CU_ASSERT(loaded.outcome.winner == 1);
+    CU_ASSERT(loaded.outcome.health[1] == 120);
+    CU_ASSERT(loaded.outcome.score[1] == 31200);
+    CU_ASSERT(replay_trace_compare(&saved, &loaded, &tick) == REPLAY_TRACE_MATCH);
+
+    replay_trace_free(&saved);
+    replay_trace_free(&loaded);
+    remove("test.trace");
+}
+
+void test_replay_trace_compare(void) {
+    replay_trace golden;
+    replay_trace trace;
+    unsigned int tick = 0;
+    fill(&golden, 50);
+
+    // A checksum that differs
+    fill(&trace, 50);
+    ((replay_tick *)vector_get(&trace.ticks, 20))->checksum ^= 1;
+    CU_ASSERT(replay_trace_compare(&golden, &trace, &tick) == REPLAY_TRACE_DIVERGED);
+    CU_ASSERT(tick == 30);
+    replay_trace_free(&trace);
+
+    // Ending early
+    fill(&trace, 40);
+    CU_ASSERT(replay_trace_compare(&golden, &trace, &tick) == REPLAY_TRACE_LENGTH);
+    CU_ASSERT(tick == 50);
+    replay_trace_free(&trace);
+
+    // Same ticks, other winner
+    fill(&trace, 50);
+    trace.outcome.winner = 0;
+    CU_ASSERT(replay_trace_compare(&golden, &trace, &tick) == REPLAY_TRACE_OUTCOME);
+    replay_trace_free(&trace);
+
+    replay_trace_free(&golden);
+}
+
+void test_replay_trace_missing(void) {
+    replay_trace trace;
+    replay_trace_create(&trace);
+    CU_ASSERT(replay_trace_load(&trace, "missing.trace") == 1);
+    replay_trace_free(&trace);
+}
+
+void replay_trace_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of saving and loading", test_replay_trace_roundtrip) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of comparing", test_replay_trace_compare) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of missing traces", test_replay_trace_missing) == NULL) {
+        return;
+    }
+}
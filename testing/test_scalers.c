@@ -0,0 +1,128 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <plugins/builtin_scalers.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/random.h>
+
+// Odd widths end in the middle of an SSE2 block, and narrow ones have no full block at all
+static const int widths[] = {1, 2, 3, 4, 5, 6, 7, 9, 13, 17, 33, 320};
+static const int heights[] = {1, 2, 3, 7};
+
+static scaler_plugin scaler;
+static struct random_t rand_state;
+
+// Pixel at x, y; outside of the image, the nearest edge pixel
+static uint32_t px(const uint32_t *img, int w, int h, int x, int y) {
+    x = x < 0 ? 0 : (x >= w ? w - 1 : x);
+    y = y < 0 ? 0 : (y >= h ? h - 1 : y);
+    return img[y * w + x];
+}
+
+// Scale2x and Scale3x as written in their description, one output pixel at a time
+static void reference_scale(const uint32_t *in, uint32_t *out, int w, int h, int factor) {
+    int ow = w * factor;
+    for(int y = 0; y < h; y++) {
+        for(int x = 0; x < w; x++) {
+            uint32_t a = px(in, w, h, x - 1, y - 1), b = px(in, w, h, x, y - 1), c = px(in, w, h, x + 1, y - 1);
+            uint32_t d = px(in, w, h, x - 1, y), e = px(in, w, h, x, y), f = px(in, w, h, x + 1, y);
+            uint32_t g = px(in, w, h, x - 1, y + 1), hh = px(in, w, h, x, y + 1), i = px(in, w, h, x + 1, y + 1);
+            uint32_t *o = out + y * factor * ow + x * factor;
+            if(b != hh && d != f) {
+                if(factor == 2) {
+                    o[0] = d == b ? d : e;
+                    o[1] = b == f ? f : e;
+                    o[ow] = d == hh ? d : e;
+                    o[ow + 1] = hh == f ? f : e;
+                } else {
+                    o[0] = d == b ? d : e;
+                    o[1] = (d == b && e != c) || (b == f && e != a) ? b : e;
+                    o[2] = b == f ? f : e;
+                    o[ow] = (d == b && e != g) || (d == hh && e != a) ? d : e;
+                    o[ow + 1] = e;
+                    o[ow + 2] = (b == f && e != i) || (hh == f && e != c) ? f : e;
+                    o[ow * 2] = d == hh ? d : e;
+                    o[ow * 2 + 1] = (d == hh && e != i) || (hh == f && e != g) ? hh : e;
+                    o[ow * 2 + 2] = hh == f ? f : e;
+                }
+            } else {
+                for(int k = 0; k < factor; k++) {
+                    for(int j = 0; j < factor; j++) {
+                        o[k * ow + j] = e;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Few colors, so that neighbouring pixels are often the same and the rules actually kick in
+static void random_image(uint32_t *img, int w, int h) {
+    static const uint32_t colors[] = {0xFF000000, 0xFFFFFFFF, 0xFF0000FF, 0x80FF0000};
+    for(int i = 0; i < w * h; i++) {
+        img[i] = colors[random_int(&rand_state, 4)];
+    }
+}
+
+static void check_factor(int factor) {
+    for(unsigned int wi = 0; wi < sizeof(widths) / sizeof(widths[0]); wi++) {
+        for(unsigned int hi = 0; hi < sizeof(heights) / sizeof(heights[0]); hi++) {
+            int w = widths[wi];
+            int h = heights[hi];
+            size_t out_size = (size_t)w * h * factor * factor * 4;
+            uint32_t *in = malloc((size_t)w * h * 4);
+            uint32_t *expected = malloc(out_size);
+            uint32_t *out = malloc(out_size);
+            uint32_t *banded = malloc(out_size);
+            for(int round = 0; round < 20; round++) {
+                random_image(in, w, h);
+                reference_scale(in, expected, w, h, factor);
+
+                // Whole image at once
+                memset(out, 0, out_size);
+                CU_ASSERT(scaler.scale((const char *)in, (char *)out, w, h, factor) == 0);
+                CU_ASSERT(memcmp(out, expected, out_size) == 0);
+
+                // A row at a time, like the render threads do with bands; every band has edge rows
+                memset(banded, 0, out_size);
+                for(int y = 0; y < h; y++) {
+                    CU_ASSERT(scaler.scale_rows((const char *)in, (char *)banded, w, h, factor, y, y + 1) == 0);
+                }
+                CU_ASSERT(memcmp(banded, expected, out_size) == 0);
+            }
+            free(in);
+            free(expected);
+            free(out);
+            free(banded);
+        }
+    }
+}
+
+void test_scalers_init(void) {
+    random_seed(&rand_state, 0x2097);
+    CU_ASSERT(builtin_scalers_get(&scaler, "Scale2x") == 0);
+    CU_ASSERT(builtin_scalers_get(&scaler, "NoSuchScaler") == 1);
+    CU_ASSERT(scaler.is_factor_available(2));
+    CU_ASSERT(scaler.is_factor_available(3));
+    CU_ASSERT(!scaler.is_factor_available(4));
+}
+
+void test_scalers_scale2x(void) {
+    check_factor(2);
+}
+
+void test_scalers_scale3x(void) {
+    check_factor(3);
+}
+
+void scalers_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of scaler lookup", test_scalers_init) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of Scale2x", test_scalers_scale2x) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of Scale3x", test_scalers_scale3x) == NULL) {
+        return;
+    }
+}
@@ -0,0 +1,252 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <string.h>
+#include <utils/allocator.h>
+#include <video/soft_render.h>
+
+// Expected values are worked out by hand from the blend equations SDL uses, with integer division
+
+static char *layer;
+static screen_palette pal;
+static const color no_tint = {0xFF, 0xFF, 0xFF, 0xFF};
+
+static void fill_layer(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    uint8_t *p = (uint8_t *)layer;
+    for(int i = 0; i < NATIVE_W * NATIVE_H; i++, p += 4) {
+        p[0] = r;
+        p[1] = g;
+        p[2] = b;
+        p[3] = a;
+    }
+}
+
+static bool pixel_is(const char *buf, int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    const uint8_t *p = (const uint8_t *)buf + (y * NATIVE_W + x) * 4;
+    return p[0] == r && p[1] == g && p[2] == b && p[3] == a;
+}
+
+// 2x2 RGBA surface: the top row is 0x10.. and 0x20.., the bottom one 0x30.. and 0x40..
+static void create_quad(surface *sur) {
+    static const uint8_t quad[] = {
+        0x10, 0x11, 0x12, 0x13, 0x20, 0x21, 0x22, 0x23, 0x30, 0x31, 0x32, 0x33, 0x40, 0x41, 0x42, 0x43,
+    };
+    surface_create_from_data(sur, SURFACE_TYPE_RGBA, 2, 2, (const char *)quad);
+}
+
+static void draw_pixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a, SDL_BlendMode blend_mode, uint8_t opacity,
+                       color tint) {
+    uint8_t data[4] = {r, g, b, a};
+    surface sur;
+    SDL_Rect dst = {5, 7, 1, 1};
+    surface_create_from_data(&sur, SURFACE_TYPE_RGBA, 1, 1, (const char *)data);
+    soft_render_sprite(layer, NULL, &sur, &pal, 0, &dst, SDL_FLIP_NONE, blend_mode, opacity, tint);
+    surface_free(&sur);
+}
+
+void test_soft_render_init(void) {
+    layer = soft_layer_create();
+    CU_ASSERT_FATAL(layer != NULL);
+    memset(&pal, 0, sizeof(pal));
+}
+
+void test_soft_render_blend_none(void) {
+    // Copied as is, alpha included
+    fill_layer(100, 100, 100, 255);
+    draw_pixel(200, 0, 50, 0, SDL_BLENDMODE_NONE, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 200, 0, 50, 0));
+    CU_ASSERT(pixel_is(layer, 4, 7, 100, 100, 100, 255));
+    CU_ASSERT(pixel_is(layer, 6, 7, 100, 100, 100, 255));
+}
+
+void test_soft_render_blend_alpha(void) {
+    // src * a + dst * (1 - a), and dst alpha a + dst_a * (1 - a)
+    fill_layer(100, 100, 100, 255);
+    draw_pixel(200, 0, 50, 128, SDL_BLENDMODE_BLEND, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 150, 49, 74, 255));
+
+    // Onto a transparent layer
+    fill_layer(0, 0, 0, 0);
+    draw_pixel(200, 0, 50, 128, SDL_BLENDMODE_BLEND, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 100, 0, 25, 128));
+
+    // Opaque pixels replace, transparent ones leave the layer alone
+    fill_layer(100, 100, 100, 77);
+    draw_pixel(1, 2, 3, 255, SDL_BLENDMODE_BLEND, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 1, 2, 3, 255));
+    fill_layer(100, 100, 100, 77);
+    draw_pixel(1, 2, 3, 0, SDL_BLENDMODE_BLEND, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 100, 100, 100, 77));
+}
+
+void test_soft_render_blend_add(void) {
+    // dst + src * a, with the alpha of the layer left alone
+    fill_layer(100, 200, 0, 77);
+    draw_pixel(200, 100, 50, 128, SDL_BLENDMODE_ADD, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 200, 250, 25, 77));
+
+    // Saturates
+    draw_pixel(255, 255, 255, 255, SDL_BLENDMODE_ADD, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 255, 255, 255, 77));
+}
+
+void test_soft_render_modulate(void) {
+    // Color is multiplied by the tint and alpha by the opacity, before blending
+    fill_layer(0, 0, 0, 255);
+    draw_pixel(200, 100, 50, 255, SDL_BLENDMODE_BLEND, 128, color_create(128, 255, 0, 0xFF));
+    CU_ASSERT(pixel_is(layer, 5, 7, 50, 50, 0, 255));
+
+    fill_layer(10, 10, 10, 0);
+    draw_pixel(200, 100, 50, 255, SDL_BLENDMODE_ADD, 128, color_create(128, 255, 0, 0xFF));
+    CU_ASSERT(pixel_is(layer, 5, 7, 60, 60, 10, 0));
+}
+
+void test_soft_render_palette(void) {
+    // Indexes below 48 are moved by the palette offset, and the stencil makes pixels transparent
+    static const uint8_t idx[] = {1, 1, 50, 2};
+    surface sur;
+    SDL_Rect dst = {5, 7, 4, 1};
+    surface_create_from_data(&sur, SURFACE_TYPE_PALETTE, 4, 1, (const char *)idx);
+    sur.stencil[1] = 0;
+    pal.data[17][0] = 170;
+    pal.data[18][1] = 180;
+    pal.data[50][2] = 250;
+
+    fill_layer(100, 100, 100, 255);
+    soft_render_sprite(layer, NULL, &sur, &pal, 16, &dst, SDL_FLIP_NONE, SDL_BLENDMODE_BLEND, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 5, 7, 170, 0, 0, 255));
+    CU_ASSERT(pixel_is(layer, 6, 7, 100, 100, 100, 255));
+    CU_ASSERT(pixel_is(layer, 7, 7, 0, 0, 250, 255));
+    CU_ASSERT(pixel_is(layer, 8, 7, 0, 180, 0, 255));
+
+    // Without blending the transparent pixels are written too
+    soft_render_sprite(layer, NULL, &sur, &pal, 16, &dst, SDL_FLIP_NONE, SDL_BLENDMODE_NONE, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 6, 7, 170, 0, 0, 0));
+
+    surface_free(&sur);
+    memset(&pal, 0, sizeof(pal));
+}
+
+void test_soft_render_clipped(void) {
+    surface sur;
+    create_quad(&sur);
+
+    // Stretched 4x and hanging over the top left corner, so only the last two columns and rows of each
+    // source pixel are on the layer; the clip rectangle cuts it further
+    SDL_Rect dst = {-2, -2, 8, 8};
+    SDL_Rect clip = {1, 1, 3, 2};
+    fill_layer(1, 1, 1, 1);
+    soft_render_sprite(layer, &clip, &sur, &pal, 0, &dst, SDL_FLIP_NONE, SDL_BLENDMODE_NONE, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 1, 1, 0x10, 0x11, 0x12, 0x13));
+    CU_ASSERT(pixel_is(layer, 2, 1, 0x20, 0x21, 0x22, 0x23));
+    CU_ASSERT(pixel_is(layer, 3, 1, 0x20, 0x21, 0x22, 0x23));
+    CU_ASSERT(pixel_is(layer, 1, 2, 0x30, 0x31, 0x32, 0x33));
+    CU_ASSERT(pixel_is(layer, 3, 2, 0x40, 0x41, 0x42, 0x43));
+    CU_ASSERT(pixel_is(layer, 0, 1, 1, 1, 1, 1));
+    CU_ASSERT(pixel_is(layer, 4, 1, 1, 1, 1, 1));
+    CU_ASSERT(pixel_is(layer, 1, 0, 1, 1, 1, 1));
+    CU_ASSERT(pixel_is(layer, 1, 3, 1, 1, 1, 1));
+
+    // Over the bottom right corner only the top left pixel is visible, and nothing wraps around
+    SDL_Rect corner = {NATIVE_W - 1, NATIVE_H - 1, 2, 2};
+    fill_layer(1, 1, 1, 1);
+    soft_render_sprite(layer, NULL, &sur, &pal, 0, &corner, SDL_FLIP_NONE, SDL_BLENDMODE_NONE, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, NATIVE_W - 1, NATIVE_H - 1, 0x10, 0x11, 0x12, 0x13));
+    CU_ASSERT(pixel_is(layer, 0, 0, 1, 1, 1, 1));
+    CU_ASSERT(pixel_is(layer, NATIVE_W - 2, NATIVE_H - 1, 1, 1, 1, 1));
+    CU_ASSERT(pixel_is(layer, NATIVE_W - 1, NATIVE_H - 2, 1, 1, 1, 1));
+
+    // Clip rectangle outside of the sprite draws nothing
+    char *copy = omf_calloc(1, SOFT_LAYER_SIZE);
+    SDL_Rect away = {100, 100, 10, 10};
+    memcpy(copy, layer, SOFT_LAYER_SIZE);
+    soft_render_sprite(layer, &away, &sur, &pal, 0, &dst, SDL_FLIP_NONE, SDL_BLENDMODE_NONE, 0xFF, no_tint);
+    CU_ASSERT(memcmp(copy, layer, SOFT_LAYER_SIZE) == 0);
+    omf_free(copy);
+
+    surface_free(&sur);
+}
+
+void test_soft_render_flip(void) {
+    surface sur;
+    create_quad(&sur);
+    SDL_Rect dst = {10, 10, 2, 2};
+    fill_layer(0, 0, 0, 0);
+    soft_render_sprite(layer, NULL, &sur, &pal, 0, &dst, SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL,
+                       SDL_BLENDMODE_NONE, 0xFF, no_tint);
+    CU_ASSERT(pixel_is(layer, 10, 10, 0x40, 0x41, 0x42, 0x43));
+    CU_ASSERT(pixel_is(layer, 11, 10, 0x30, 0x31, 0x32, 0x33));
+    CU_ASSERT(pixel_is(layer, 10, 11, 0x20, 0x21, 0x22, 0x23));
+    CU_ASSERT(pixel_is(layer, 11, 11, 0x10, 0x11, 0x12, 0x13));
+    surface_free(&sur);
+}
+
+void test_soft_render_layers(void) {
+    // Premultiplied layer drawn over another: src + dst * (1 - a)
+    char *fg = soft_layer_create();
+    uint8_t *f = (uint8_t *)fg + (7 * NATIVE_W + 5) * 4;
+    f[0] = 64;
+    f[3] = 128;
+    fill_layer(100, 100, 100, 255);
+    soft_render_layer(layer, fg);
+    CU_ASSERT(pixel_is(layer, 5, 7, 113, 49, 49, 255));
+    CU_ASSERT(pixel_is(layer, 6, 7, 100, 100, 100, 255));
+
+    // Composited frame is opaque, moved by the screen shake and darkened by the fade
+    char *out = soft_layer_create();
+    f[0] = 200;
+    fill_layer(100, 50, 0, 255);
+    soft_render_compose(out, layer, fg, 0, 0, 0xFF);
+    CU_ASSERT(pixel_is(out, 5, 7, 150, 24, 0, 255));
+    soft_render_compose(out, layer, fg, 2, 1, 128);
+    CU_ASSERT(pixel_is(out, 7, 8, 75, 12, 0, 255));
+    CU_ASSERT(pixel_is(out, 5, 7, 50, 25, 0, 255));
+    CU_ASSERT(pixel_is(out, 1, 0, 0, 0, 0, 255));
+
+    // Reading an area that is partly off the layer leaves the rest of the buffer alone
+    uint8_t area[2 * 2 * 4];
+    SDL_Rect rect = {-1, 6, 2, 2};
+    memset(area, 0xAA, sizeof(area));
+    soft_layer_read(layer, &rect, (char *)area);
+    CU_ASSERT(area[0] == 0xAA && area[3] == 0xAA);
+    CU_ASSERT(area[4] == 100 && area[5] == 50 && area[6] == 0 && area[7] == 255);
+
+    omf_free(out);
+    omf_free(fg);
+}
+
+void test_soft_render_free(void) {
+    omf_free(layer);
+}
+
+void soft_render_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of layer create", test_soft_render_init) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of blend none", test_soft_render_blend_none) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of alpha blending", test_soft_render_blend_alpha) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of additive blending", test_soft_render_blend_add) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of opacity and tint", test_soft_render_modulate) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of palette sprites", test_soft_render_palette) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of clipped blits", test_soft_render_clipped) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of flipped blits", test_soft_render_flip) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of layer compositing", test_soft_render_layers) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of layer free", test_soft_render_free) == NULL) {
+        return;
+    }
+}
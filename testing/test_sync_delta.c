@@ -0,0 +1,154 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <game/utils/sync_delta.h>
+#include <string.h>
+
+#define TEST_STATE_LEN 300
+
+static void make_state(serial *s, size_t len, int seed) {
+    serial_create(s);
+    for(size_t i = 0; i < len; i++) {
+        serial_write_int8(s, (int8_t)((i * 7 + seed) & 0xFF));
+    }
+}
+
+static void roundtrip(const serial *base, const serial *state, size_t *encoded_len) {
+    serial enc, dec;
+    serial_create(&enc);
+    serial_create(&dec);
+    sync_delta_encode(&enc, base, state);
+    *encoded_len = enc.wpos;
+    CU_ASSERT(sync_delta_decode(&dec, base, &enc) == 0);
+    CU_ASSERT(enc.rpos == enc.wpos);
+    CU_ASSERT(dec.wpos == state->wpos);
+    if(dec.wpos == state->wpos) {
+        CU_ASSERT(memcmp(dec.data, state->data, state->wpos) == 0);
+    }
+    serial_free(&enc);
+    serial_free(&dec);
+}
+
+void test_sync_delta_full(void) {
+    serial state;
+    size_t len;
+    make_state(&state, TEST_STATE_LEN, 1);
+    roundtrip(NULL, &state, &len);
+    CU_ASSERT(len > TEST_STATE_LEN);
+    serial_free(&state);
+}
+
+void test_sync_delta_unchanged(void) {
+    serial base, state;
+    size_t len;
+    make_state(&base, TEST_STATE_LEN, 1);
+    make_state(&state, TEST_STATE_LEN, 1);
+    roundtrip(&base, &state, &len);
+    CU_ASSERT(len <= 6);
+    serial_free(&base);
+    serial_free(&state);
+}
+
+void test_sync_delta_changed(void) {
+    serial base, state;
+    size_t len;
+    make_state(&base, TEST_STATE_LEN, 1);
+    make_state(&state, TEST_STATE_LEN, 1);
+    state.data[0] ^= 1;
+    state.data[10] ^= 1;
+    state.data[12] ^= 1;
+    state.data[200] ^= 1;
+    state.data[TEST_STATE_LEN - 1] ^= 1;
+    roundtrip(&base, &state, &len);
+    CU_ASSERT(len < 30);
+    serial_free(&base);
+    serial_free(&state);
+}
+
+void test_sync_delta_packed(void) {
+    serial base, state;
+    size_t len;
+    make_state(&base, TEST_STATE_LEN, 1);
+    make_state(&state, TEST_STATE_LEN, 1);
+
+    // Low byte of every int32 changed, like counters that all ticked; only the changed bytes and masks are sent
+    for(size_t i = 0; i < TEST_STATE_LEN; i += 4) {
+        state.data[i] ^= 1;
+    }
+    roundtrip(&base, &state, &len);
+    CU_ASSERT(len < TEST_STATE_LEN / 2);
+    serial_free(&base);
+    serial_free(&state);
+}
+
+void test_sync_delta_resized(void) {
+    serial base, state;
+    size_t len;
+    make_state(&base, TEST_STATE_LEN, 1);
+    make_state(&state, TEST_STATE_LEN + 50, 1);
+    roundtrip(&base, &state, &len);
+    serial_free(&state);
+
+    make_state(&state, TEST_STATE_LEN / 2, 1);
+    roundtrip(&base, &state, &len);
+    serial_free(&state);
+    serial_free(&base);
+}
+
+void test_sync_delta_broken(void) {
+    serial base, state, enc, dec;
+    make_state(&base, TEST_STATE_LEN, 1);
+    make_state(&state, TEST_STATE_LEN, 2);
+    serial_create(&enc);
+    serial_create(&dec);
+    sync_delta_encode(&enc, &base, &state);
+    enc.wpos /= 2;
+    CU_ASSERT(sync_delta_decode(&dec, &base, &enc) == 1);
+    serial_free(&enc);
+    serial_free(&dec);
+    serial_free(&base);
+    serial_free(&state);
+}
+
+void test_sync_delta_oversized(void) {
+    // A state of 2^34 bytes that is all one run of unchanged bytes; must be refused without trying to
+    // write it out
+    static const uint8_t huge[] = {0x80, 0x80, 0x80, 0x80, 0x40, 0x80, 0x80, 0x80, 0x80, 0x40, 0x00};
+    serial enc, dec;
+    serial_create_from(&enc, (const char *)huge, sizeof(huge));
+    serial_create(&dec);
+    CU_ASSERT(sync_delta_decode(&dec, NULL, &enc) == 1);
+    CU_ASSERT(dec.wpos == 0);
+    serial_free(&enc);
+    serial_free(&dec);
+
+    // Largest state that is allowed still goes through
+    serial state;
+    size_t len;
+    make_state(&state, SYNC_DELTA_MAX_STATE, 1);
+    roundtrip(NULL, &state, &len);
+    serial_free(&state);
+}
+
+void sync_delta_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of full state", test_sync_delta_full) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of unchanged state", test_sync_delta_unchanged) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of changed state", test_sync_delta_changed) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of packed changes", test_sync_delta_packed) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of resized state", test_sync_delta_resized) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of broken data", test_sync_delta_broken) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of oversized state", test_sync_delta_oversized) == NULL) {
+        return;
+    }
+}
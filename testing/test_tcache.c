@@ -0,0 +1,170 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <SDL.h>
+#include <string.h>
+#include <video/screen_palette.h>
+#include <video/surface.h>
+#include <video/tcache.h>
+
+#define RANGE(r) ((palette_range_mask)(1 << (r)))
+
+// Gives every range of the palette a version of its own
+static void fresh_palette(screen_palette *pal) {
+    memset(pal, 0, sizeof(screen_palette));
+    for(int r = 0; r < PALETTE_RANGES; r++) {
+        pal->range_version[r] = screen_palette_new_version();
+    }
+    pal->version = screen_palette_new_version();
+}
+
+// A palette surface with the top half in one color and the bottom half in another
+static void two_color_surface(surface *sur, uint8_t top, uint8_t bottom) {
+    surface_create(sur, SURFACE_TYPE_PALETTE, 4, 4);
+    memset(sur->data, top, 8);
+    memset(sur->data + 8, bottom, 8);
+    memset(sur->stencil, 1, 16);
+}
+
+void test_palette_range_mask(void) {
+    CU_ASSERT(screen_palette_range_mask(0, 1) == RANGE(0));
+    CU_ASSERT(screen_palette_range_mask(16, 16) == RANGE(1));
+    CU_ASSERT(screen_palette_range_mask(30, 4) == (RANGE(1) | RANGE(2)));
+    CU_ASSERT(screen_palette_range_mask(0, 256) == 0xFFFF);
+    CU_ASSERT(screen_palette_range_mask(-5, 10) == RANGE(0));
+    CU_ASSERT(screen_palette_range_mask(250, 20) == RANGE(15));
+    CU_ASSERT(screen_palette_range_mask(100, 0) == 0);
+}
+
+void test_palette_ranges_match(void) {
+    screen_palette pal;
+    unsigned int taken[PALETTE_RANGES];
+    fresh_palette(&pal);
+    memcpy(taken, pal.range_version, sizeof(taken));
+    unsigned int version = pal.version;
+
+    // Changing colors in range 1 only touches range 1
+    screen_palette_touch(&pal, 20, 4);
+    CU_ASSERT(pal.version != version);
+    CU_ASSERT(screen_palette_ranges_match(&pal, taken, RANGE(0) | RANGE(2) | RANGE(15)));
+    CU_ASSERT(!screen_palette_ranges_match(&pal, taken, RANGE(1)));
+    CU_ASSERT(!screen_palette_ranges_match(&pal, taken, RANGE(0) | RANGE(1)));
+    CU_ASSERT(screen_palette_ranges_match(&pal, taken, 0));
+
+    // Colors across a range boundary touch both ranges
+    memcpy(taken, pal.range_version, sizeof(taken));
+    screen_palette_touch(&pal, 47, 2);
+    CU_ASSERT(!screen_palette_ranges_match(&pal, taken, RANGE(2)));
+    CU_ASSERT(!screen_palette_ranges_match(&pal, taken, RANGE(3)));
+    CU_ASSERT(screen_palette_ranges_match(&pal, taken, RANGE(1) | RANGE(4)));
+
+    // Nothing changes when no colors do
+    memcpy(taken, pal.range_version, sizeof(taken));
+    version = pal.version;
+    screen_palette_touch(&pal, 60, 0);
+    CU_ASSERT(pal.version == version);
+    CU_ASSERT(screen_palette_ranges_match(&pal, taken, 0xFFFF));
+}
+
+void test_surface_palette_ranges(void) {
+    surface sur;
+    char remap[256];
+    two_color_surface(&sur, 1, 200);
+    CU_ASSERT(surface_palette_ranges(&sur, NULL, 0) == (RANGE(0) | RANGE(12)));
+
+    // Only the HAR colors below 48 get the offset
+    CU_ASSERT(surface_palette_ranges(&sur, NULL, 48) == (RANGE(3) | RANGE(12)));
+
+    // Colors are looked up in the remap table before the offset is applied
+    for(int i = 0; i < 256; i++) {
+        remap[i] = (char)i;
+    }
+    remap[1] = 100;
+    remap[200] = 40;
+    CU_ASSERT(surface_palette_ranges(&sur, remap, 0) == (RANGE(6) | RANGE(2)));
+    CU_ASSERT(surface_palette_ranges(&sur, remap, 48) == (RANGE(6) | RANGE(5)));
+    surface_free(&sur);
+
+    // RGBA surfaces don't use the palette at all
+    surface_create(&sur, SURFACE_TYPE_RGBA, 4, 4);
+    CU_ASSERT(surface_palette_ranges(&sur, NULL, 0) == 0);
+    surface_free(&sur);
+}
+
+void test_tcache_palette_ranges(void) {
+    SDL_Surface *target = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 32, SDL_PIXELFORMAT_ABGR8888);
+    CU_ASSERT_FATAL(target != NULL);
+    SDL_Renderer *renderer = SDL_CreateSoftwareRenderer(target);
+    CU_ASSERT_FATAL(renderer != NULL);
+    tcache_init(renderer);
+
+    screen_palette pal;
+    surface low, high;
+    fresh_palette(&pal);
+    two_color_surface(&low, 1, 2);     // Range 0, or range 3 with the player 2 offset
+    two_color_surface(&high, 130, 140); // Range 8
+
+    CU_ASSERT(tcache_get(&low, &low, &pal, NULL, 0) != NULL);
+    CU_ASSERT(tcache_get(&low, &low, &pal, NULL, 48) != NULL);
+    CU_ASSERT(tcache_get(&high, &high, &pal, NULL, 0) != NULL);
+    CU_ASSERT(tcache_take_misses() == 3);
+
+    // Nothing has changed
+    tcache_get(&low, &low, &pal, NULL, 0);
+    tcache_get(&low, &low, &pal, NULL, 48);
+    tcache_get(&high, &high, &pal, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 0);
+
+    // A flash on range 8 only redraws the texture that uses it
+    screen_palette_touch(&pal, 128, 16);
+    tcache_get(&low, &low, &pal, NULL, 0);
+    tcache_get(&low, &low, &pal, NULL, 48);
+    CU_ASSERT(tcache_take_misses() == 0);
+    tcache_get(&high, &high, &pal, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 1);
+    tcache_get(&high, &high, &pal, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 0);
+
+    // Range 3 is only used through the offset
+    screen_palette_touch(&pal, 49, 1);
+    tcache_get(&low, &low, &pal, NULL, 0);
+    tcache_get(&high, &high, &pal, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 0);
+    tcache_get(&low, &low, &pal, NULL, 48);
+    CU_ASSERT(tcache_take_misses() == 1);
+
+    // Range 0 is used without it
+    screen_palette_touch(&pal, 0, 16);
+    tcache_get(&low, &low, &pal, NULL, 48);
+    tcache_get(&high, &high, &pal, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 0);
+    tcache_get(&low, &low, &pal, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 1);
+
+    // Another palette with the same colors keeps the textures valid
+    screen_palette copy = pal;
+    tcache_get(&low, &low, &copy, NULL, 0);
+    tcache_get(&low, &low, &copy, NULL, 48);
+    tcache_get(&high, &high, &copy, NULL, 0);
+    CU_ASSERT(tcache_take_misses() == 0);
+
+    surface_free(&low);
+    surface_free(&high);
+    tcache_close();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+}
+
+void tcache_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of palette range masks", test_palette_range_mask) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of palette range versions", test_palette_ranges_match) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of surface palette ranges", test_surface_palette_ranges) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of texture cache palette ranges", test_tcache_palette_ranges) == NULL) {
+        return;
+    }
+}
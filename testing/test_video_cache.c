@@ -0,0 +1,143 @@
+#include <CUnit/Basic.h>
+#include <CUnit/CUnit.h>
+#include <SDL.h>
+#include <string.h>
+#include <video/video.h>
+
+static video_cache *cache;
+static surface sprite;
+static bool video_ok = false;
+
+// Renders a frame the way the render thread does, and reads back a pixel from where the sprite is drawn
+static void render_cached_frame(bool redraw_cache, bool draw, uint8_t *pixel) {
+    surface capture;
+    video_render_prepare();
+    if(redraw_cache) {
+        CU_ASSERT_FATAL(video_cache_begin(cache, 0, 0, NATIVE_W, NATIVE_H));
+        video_render_sprite(&sprite, 10, 10, BLEND_ALPHA, 0);
+        video_cache_end(cache);
+    }
+    video_cache_render(cache);
+    video_area_capture(&capture, 12, 12, 1, 1);
+    video_render_finish();
+    video_render_frame(0, draw);
+    memcpy(pixel, capture.data, 4);
+    surface_free(&capture);
+}
+
+void test_video_cache_init(void) {
+    // Headless, like offline rendering. The SDL software renderer can't do the blend mode of the
+    // caches, so frames are composited in memory.
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    if(SDL_Init(SDL_INIT_VIDEO) != 0 || video_init_offline() != 0) {
+        CU_FAIL("Unable to initialize video");
+        return;
+    }
+    video_set_software_render(true);
+    video_set_render_thread(true);
+    video_ok = true;
+
+    palette pal;
+    memset(&pal, 0, sizeof(pal));
+    pal.data[1][0] = 0xFF;
+    video_set_base_palette(&pal);
+
+    surface_create(&sprite, SURFACE_TYPE_PALETTE, 8, 8);
+    memset(sprite.data, 1, 8 * 8);
+    memset(sprite.stencil, 1, 8 * 8);
+    cache = video_cache_create();
+}
+
+void test_video_cache_skipped_frame(void) {
+    uint8_t pixel[4];
+    if(!video_ok) {
+        return;
+    }
+
+    // Frame that fills the cache is not drawn, eg. because the window is minimized
+    render_cached_frame(true, false, pixel);
+    CU_ASSERT(video_cache_is_valid(cache));
+
+    // Next frame relies on the cache being filled
+    render_cached_frame(false, true, pixel);
+    CU_ASSERT(pixel[0] == 0xFF);
+    CU_ASSERT(pixel[1] == 0);
+    CU_ASSERT(pixel[3] == 0xFF);
+}
+
+void test_video_cache_thrown_away_frame(void) {
+    if(!video_ok) {
+        return;
+    }
+    video_cache_invalidate(cache);
+    video_render_prepare();
+    CU_ASSERT_FATAL(video_cache_begin(cache, 0, 0, NATIVE_W, NATIVE_H));
+    video_render_sprite(&sprite, 10, 10, BLEND_ALPHA, 0);
+    video_cache_end(cache);
+    video_cache_render(cache);
+    video_render_finish();
+
+    // Frame is still waiting for the renderer, and a scene change throws it away
+    video_clear_texture_cache();
+    CU_ASSERT(!video_cache_is_valid(cache));
+    video_render_frame(0, true);
+}
+
+void test_video_cache_palette(void) {
+    uint8_t pixel[4];
+    if(!video_ok) {
+        return;
+    }
+    video_cache_invalidate(cache);
+    render_cached_frame(true, true, pixel);
+    CU_ASSERT(video_cache_is_valid(cache));
+
+    // Effect on colors the cache doesn't use, eg. a HAR flash
+    video_render_prepare();
+    screen_palette *pal = video_get_pal_ref();
+    screen_palette_touch(pal, 128, 16);
+    CU_ASSERT(video_cache_is_valid(cache));
+
+    // Effect on the color of the sprite
+    pal->data[1][1] = 0xFF;
+    screen_palette_touch(pal, 1, 1);
+    CU_ASSERT(!video_cache_is_valid(cache));
+    video_render_finish();
+    video_render_frame(0, true);
+
+    // Colors are back to normal on the next frame, and so is the cache
+    render_cached_frame(false, true, pixel);
+    CU_ASSERT(video_cache_is_valid(cache));
+    CU_ASSERT(pixel[0] == 0xFF);
+    CU_ASSERT(pixel[1] == 0);
+}
+
+void test_video_cache_free(void) {
+    if(!video_ok) {
+        return;
+    }
+    video_cache_free(cache);
+    surface_free(&sprite);
+    video_set_render_thread(false);
+    video_close();
+    SDL_Quit();
+}
+
+void video_cache_test_suite(CU_pSuite suite) {
+    if(CU_add_test(suite, "test of video init", test_video_cache_init) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of skipped frames", test_video_cache_skipped_frame) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of thrown away frames", test_video_cache_thrown_away_frame) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of palette effects", test_video_cache_palette) == NULL) {
+        return;
+    }
+    if(CU_add_test(suite, "test of video close", test_video_cache_free) == NULL) {
+        return;
+    }
+}